@@ -1,4 +1,5 @@
 #include "AppState.h"
+#include "FilterExpression.h"
 #include <map>
 #include <atomic>
 #include "PacketHeaders.h"
@@ -16,7 +17,10 @@ namespace kx {
 	// --- UI State ---
 	bool g_isInspectorWindowOpen = true;
 	bool g_showInspectorWindow = true;
-	bool g_capturePaused = false;
+	std::atomic<bool> g_capturePaused = false;
+	std::atomic<bool> g_captureSent = true;
+	std::atomic<bool> g_captureReceived = true;
+	std::atomic<std::shared_ptr<const Filtering::FilterProgram>> g_captureFilterExpression;
 
 	// --- Filtering State ---
 	// Header Filtering
@@ -28,7 +32,19 @@ namespace kx {
 
 	// Direction Filtering
 	DirectionFilterMode g_packetDirectionFilterMode = DirectionFilterMode::ShowAll; // Default to showing all directions
+	std::shared_ptr<const Filtering::FilterProgram> g_displayFilterExpression;
 
+	uint64_t g_filterStateVersion = 0;
+
+
+	// --- Display Settings ---
+	TimestampFormat g_timestampFormat = TimestampFormat::Millis;
+	int g_displayHexByteLimit = 32;
+	uint64_t g_displaySettingsVersion = 0;
+
+	// --- Overlay Frame Budget ---
+	bool g_overlayBudgetEnabled = true;
+	float g_overlayBudgetMs = 0.5f;
 
 	// --- Shutdown Synchronization ---
 	std::atomic<bool> g_isShuttingDown = false;
@@ -3,10 +3,15 @@
 #include "PacketHeaders.h" // For PacketHeader in filter map
 #include <map>
 #include <atomic>
+#include <memory>
 #include <cstdint> // For uintptr_t
 
 namespace kx {
 
+    namespace Filtering {
+        class FilterProgram; // FilterExpression.h
+    }
+
     // --- Status Information ---
     enum class HookStatus {
         Unknown,
@@ -23,7 +28,22 @@ namespace kx {
     // --- UI State ---
     extern bool g_isInspectorWindowOpen; // Controls main loop / unload trigger
     extern bool g_showInspectorWindow;   // Controls GUI visibility (toggle via hotkey)
-    extern bool g_capturePaused;         // Controls packet capture logging
+    // Capture switches. Read by the hook threads; changed on the render thread, which then
+    // calls ApplyCaptureState() (Hooks.h) so the game hooks are only enabled while needed.
+    extern std::atomic<bool> g_capturePaused;    // Pauses capture in both directions
+    extern std::atomic<bool> g_captureSent;      // Capture outgoing (CMSG) packets
+    extern std::atomic<bool> g_captureReceived;  // Capture incoming (SMSG) messages
+
+    inline bool IsCaptureEnabled(PacketDirection direction) {
+        if (g_capturePaused.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        return (direction == PacketDirection::Sent ? g_captureSent : g_captureReceived).load(std::memory_order_relaxed);
+    }
+
+    // Packets that fail this filter expression are counted but not logged; null: log all.
+    // Replaced on the render thread, evaluated on the hook threads. Never uses field(...).
+    extern std::atomic<std::shared_ptr<const Filtering::FilterProgram>> g_captureFilterExpression;
 
     // --- Filtering State ---
 	// Header Filtering Mode (Include/Exclude/All) - applies to items checked below
@@ -49,6 +69,29 @@ namespace kx {
     };
     extern DirectionFilterMode g_packetDirectionFilterMode;
 
+    // Filter expression ANDed with the settings above; null: none.
+    extern std::shared_ptr<const Filtering::FilterProgram> g_displayFilterExpression;
+
+    // Incremented whenever any filter setting above changes (render thread only), so
+    // cached filter results (FilterView) know when they are stale.
+    extern uint64_t g_filterStateVersion;
+
+    // --- Display Settings ---
+    enum class TimestampFormat {
+        Millis, // HH:MM:SS.mmm
+        Micros  // HH:MM:SS.uuuuuu
+    };
+    extern TimestampFormat g_timestampFormat;
+    extern int g_displayHexByteLimit; // Hex bytes shown per log row before "..."
+
+    // Incremented whenever a display setting above changes (render thread only), so
+    // cached row text (RowTextCache) knows when it is stale.
+    extern uint64_t g_displaySettingsVersion;
+
+    // --- Overlay Frame Budget ---
+    extern bool g_overlayBudgetEnabled; // Degrade the overlay when it exceeds its budget (FrameBudget.h)
+    extern float g_overlayBudgetMs;     // Overlay CPU time allowed per game frame
+
     // --- Shutdown Synchronization ---
     extern std::atomic<bool> g_isShuttingDown; // Flag to signal shutdown to hooks
 
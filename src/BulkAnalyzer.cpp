@@ -0,0 +1,341 @@
+#include "BulkAnalyzer.h"
+#include "PacketHeaders.h"
+#include "PacketParser.h"
+#include "PacketStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace kx::Analysis {
+
+    namespace {
+        // Large enough to amortise scheduling, small enough to balance across cores.
+        constexpr std::size_t ANALYSIS_CHUNK_SIZE = 4096;
+
+        using OpcodeKey = std::pair<PacketDirection, uint16_t>;
+        using OpcodeMap = std::map<OpcodeKey, OpcodeSummary>;
+
+        // The name depends only on these, so each chunk resolves it once per distinct key.
+        using NameKey = std::tuple<PacketDirection, uint16_t, InternalPacketType>;
+
+        struct ChunkResult {
+            OpcodeMap opcodes;
+            uint64_t decodedCount = 0;
+            uint64_t unknownHeaderCount = 0;
+            std::map<NameKey, uint32_t> nameIdByKey;
+            std::vector<std::string> names; // Chunk-local name table; nameIds are remapped on merge
+            std::vector<std::size_t> changedIndices;
+            bool processed = false;
+        };
+
+        void MergeSummary(OpcodeSummary& into, const OpcodeSummary& from) {
+            if (into.count == 0) {
+                into = from;
+                return;
+            }
+            into.count += from.count;
+            into.totalBytes += from.totalBytes;
+            into.minSize = std::min(into.minSize, from.minSize);
+            into.maxSize = std::max(into.maxSize, from.maxSize);
+            into.decodedCount += from.decodedCount;
+        }
+
+        // --- Background driver state ---
+        std::mutex g_jobMutex;
+        bool g_jobRunning = false;
+        std::atomic<bool> g_cancelRequested{ false };
+        std::atomic<std::size_t> g_progressPackets{ 0 };
+        std::atomic<std::size_t> g_snapshotPackets{ 0 };
+        std::unique_ptr<AnalysisReport> g_completedReport; // Guarded by g_jobMutex
+
+        // Render thread only
+        std::unique_ptr<AnalysisReport> g_applyingReport;
+        std::size_t g_applyCursor = 0; // Next entry of g_applyingReport->changedIndices
+        std::unique_ptr<AnalysisReport> g_lastAppliedReport;
+    }
+
+    namespace {
+        /**
+         * @brief Shared implementation of AnalyzePackets and the log re-analysis.
+         * @param readChunk Called as readChunk(begin, end, visit) for each chunk; calls
+         *        visit(packet, index) for every index in [begin, end) and returns true, or
+         *        returns false without visiting if the input is no longer available.
+         */
+        template <typename ReadChunk>
+        AnalysisReport AnalyzeChunks(std::size_t packetCount,
+                                     Threading::ThreadPool& pool,
+                                     const std::atomic<bool>* cancel,
+                                     std::atomic<std::size_t>* progress,
+                                     const ReadChunk& readChunk)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+
+            AnalysisReport report;
+            report.packetCount = packetCount;
+            report.nameIds.resize(packetCount);
+            report.specialTypes.resize(packetCount);
+            report.chunkCount = (packetCount + ANALYSIS_CHUNK_SIZE - 1) / ANALYSIS_CHUNK_SIZE;
+            report.threadCount = pool.GetThreadCount() + 1; // Workers plus the calling thread
+
+            // One result slot per chunk; each chunk writes only its own slot and its own
+            // index range of the per-packet vectors, so no synchronisation is needed.
+            std::vector<ChunkResult> chunkResults(report.chunkCount);
+            std::atomic<bool> inputLost{ false };
+
+            pool.ParallelFor(packetCount, ANALYSIS_CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+                if ((cancel && cancel->load(std::memory_order_relaxed)) || inputLost.load(std::memory_order_relaxed)) {
+                    return;
+                }
+
+                ChunkResult& result = chunkResults[begin / ANALYSIS_CHUNK_SIZE];
+                const bool read = readChunk(begin, end, [&](const PacketInfo& packet, std::size_t i) {
+                    // Classification: same rules as the capture path.
+                    const InternalPacketType specialType = ClassifyPacketType(
+                        packet.direction, packet.rawHeaderId, packet.data.size(), packet.specialType);
+                    const auto [slot, inserted] = result.nameIdByKey.try_emplace(
+                        NameKey{ packet.direction, packet.rawHeaderId, specialType }, static_cast<uint32_t>(result.names.size()));
+                    if (inserted) {
+                        result.names.push_back(ResolvePacketName(packet.direction, packet.rawHeaderId, specialType));
+                    }
+                    const std::string& name = result.names[slot->second];
+
+                    // Decoding: run the registered parser (if any) against the original packet.
+                    const bool decoded = Parsing::GetParsedDataTooltipString(packet).has_value();
+
+                    // Statistics
+                    OpcodeSummary& summary = result.opcodes[{ packet.direction, packet.rawHeaderId }];
+                    const int size = static_cast<int>(packet.data.size());
+                    if (summary.count == 0) {
+                        summary.direction = packet.direction;
+                        summary.opcode = packet.rawHeaderId;
+                        summary.name = name;
+                        summary.minSize = size;
+                        summary.maxSize = size;
+                    }
+                    summary.count++;
+                    summary.totalBytes += static_cast<uint64_t>(size);
+                    summary.minSize = std::min(summary.minSize, size);
+                    summary.maxSize = std::max(summary.maxSize, size);
+                    if (decoded) {
+                        summary.decodedCount++;
+                        result.decodedCount++;
+                    }
+                    if (specialType == InternalPacketType::UNKNOWN_HEADER) {
+                        result.unknownHeaderCount++;
+                    }
+
+                    report.nameIds[i] = slot->second;
+                    report.specialTypes[i] = specialType;
+                    if (packet.specialType != specialType || packet.name != name) {
+                        result.changedIndices.push_back(i);
+                    }
+                });
+                if (!read) {
+                    inputLost.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                result.processed = true;
+
+                if (progress) {
+                    progress->fetch_add(end - begin, std::memory_order_relaxed);
+                }
+            });
+
+            report.cancelled = (cancel && cancel->load(std::memory_order_relaxed)) || inputLost.load(std::memory_order_relaxed);
+
+            // Deterministic merge: always in chunk order, independent of completion order.
+            OpcodeMap merged;
+            std::unordered_map<std::string, uint32_t> nameIdByName;
+            std::vector<uint32_t> globalIds;
+            for (std::size_t chunk = 0; chunk < chunkResults.size(); ++chunk) {
+                const ChunkResult& result = chunkResults[chunk];
+                for (const auto& [key, summary] : result.opcodes) {
+                    MergeSummary(merged[key], summary);
+                }
+                report.decodedCount += result.decodedCount;
+                report.unknownHeaderCount += result.unknownHeaderCount;
+                if (report.cancelled || !result.processed) {
+                    continue;
+                }
+
+                globalIds.clear();
+                for (const std::string& name : result.names) {
+                    const auto [slot, inserted] = nameIdByName.try_emplace(name, static_cast<uint32_t>(report.nameTable.size()));
+                    if (inserted) {
+                        report.nameTable.push_back(name);
+                    }
+                    globalIds.push_back(slot->second);
+                }
+                const std::size_t begin = chunk * ANALYSIS_CHUNK_SIZE;
+                const std::size_t end = std::min(begin + ANALYSIS_CHUNK_SIZE, packetCount);
+                for (std::size_t i = begin; i < end; ++i) {
+                    report.nameIds[i] = globalIds[report.nameIds[i]];
+                }
+                report.changedIndices.insert(report.changedIndices.end(), result.changedIndices.begin(), result.changedIndices.end());
+            }
+            report.opcodes.reserve(merged.size());
+            for (auto& [key, summary] : merged) {
+                report.opcodes.push_back(std::move(summary));
+            }
+
+            report.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+            return report;
+        }
+    }
+
+    AnalysisReport AnalyzePackets(const std::vector<PacketInfo>& packets,
+                                  Threading::ThreadPool& pool,
+                                  const std::atomic<bool>* cancel,
+                                  std::atomic<std::size_t>* progress)
+    {
+        return AnalyzeChunks(packets.size(), pool, cancel, progress,
+            [&packets](std::size_t begin, std::size_t end, const auto& visit) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    visit(packets[i], i);
+                }
+                return true;
+            });
+    }
+
+    bool StartLogReanalysis() {
+        {
+            std::lock_guard<std::mutex> lock(g_jobMutex);
+            if (g_jobRunning) {
+                return false;
+            }
+            g_jobRunning = true;
+            g_completedReport.reset();
+            g_cancelRequested.store(false, std::memory_order_relaxed); // Under the lock so a concurrent cancel is not lost
+        }
+        g_progressPackets.store(0, std::memory_order_relaxed);
+        g_snapshotPackets.store(0, std::memory_order_relaxed);
+
+        Threading::ThreadPool& pool = Threading::GetBackgroundPool();
+        pool.Submit([&pool]() {
+            std::unique_ptr<AnalysisReport> report;
+            try {
+                // Cancelled while still queued: nothing to do.
+                if (!g_cancelRequested.load(std::memory_order_relaxed)) {
+                    // The log is append-only, so the packets below this size stay put until
+                    // the next Clear(); read them in place instead of copying them.
+                    uint64_t generation = 0;
+                    std::size_t packetCount = 0;
+                    {
+                        auto lock = g_packetLog.LockForReading();
+                        generation = g_packetLog.GetGeneration();
+                        packetCount = g_packetLog.Size();
+                    }
+                    g_snapshotPackets.store(packetCount, std::memory_order_relaxed);
+
+                    // Each chunk holds the reader lock only while it runs, so a Clear() waits
+                    // for at most one chunk per worker and the next chunk sees the new generation.
+                    report = std::make_unique<AnalysisReport>(AnalyzeChunks(packetCount, pool, &g_cancelRequested, &g_progressPackets,
+                        [generation](std::size_t begin, std::size_t end, const auto& visit) {
+                            auto lock = g_packetLog.LockForReading();
+                            if (g_packetLog.GetGeneration() != generation) {
+                                return false;
+                            }
+                            for (std::size_t i = begin; i < end; ++i) {
+                                visit(g_packetLog[i], i);
+                            }
+                            return true;
+                        }));
+                    report->logGeneration = generation;
+                }
+            }
+            catch (...) {
+                report.reset(); // Allocation failure on a huge log; nothing to apply.
+            }
+
+            std::lock_guard<std::mutex> lock(g_jobMutex);
+            // Checked under the lock so a cancel that raced the last chunk still discards the result.
+            if (report && !report->cancelled && !g_cancelRequested.load(std::memory_order_relaxed)) {
+                // Stays "running" until the render thread has written it back, so a second
+                // analysis cannot compare against names this one is about to replace.
+                g_completedReport = std::move(report);
+            } else {
+                g_jobRunning = false;
+            }
+        });
+        return true;
+    }
+
+    bool IsReanalysisRunning() {
+        std::lock_guard<std::mutex> lock(g_jobMutex);
+        return g_jobRunning;
+    }
+
+    float GetReanalysisProgress() {
+        const std::size_t total = g_snapshotPackets.load(std::memory_order_relaxed);
+        if (total == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(g_progressPackets.load(std::memory_order_relaxed)) / static_cast<float>(total);
+    }
+
+    void CancelReanalysis() {
+        std::lock_guard<std::mutex> lock(g_jobMutex);
+        g_cancelRequested.store(true, std::memory_order_relaxed);
+        if (g_completedReport) {
+            g_completedReport.reset();
+            g_jobRunning = false; // Finished but not yet picked up; a write-back in progress stops on its next call
+        }
+    }
+
+    bool ApplyCompletedReanalysis() {
+        if (!g_applyingReport) {
+            std::lock_guard<std::mutex> lock(g_jobMutex);
+            g_applyingReport = std::move(g_completedReport);
+            g_applyCursor = 0;
+        }
+        if (!g_applyingReport) {
+            return false;
+        }
+
+        AnalysisReport& report = *g_applyingReport;
+        const std::vector<std::size_t>& changed = report.changedIndices;
+        bool discard = g_cancelRequested.load(std::memory_order_relaxed);
+        std::size_t written = 0;
+        if (!discard) {
+            auto lock = g_packetLog.LockExclusive(); // Background readers must not see a half-written name
+            if (report.logGeneration != g_packetLog.GetGeneration()) {
+                discard = true; // Log was cleared since the snapshot; indices are meaningless now.
+            } else {
+                const std::size_t end = std::min(g_applyCursor + REANALYSIS_APPLY_BATCH, changed.size());
+                for (; g_applyCursor < end; ++g_applyCursor) {
+                    const std::size_t i = changed[g_applyCursor];
+                    PacketInfo& packet = g_packetLog.GetMutable(i);
+                    packet.name = report.GetName(i);
+                    packet.specialType = report.specialTypes[i];
+                    ++written;
+                }
+            }
+        }
+
+        const bool finished = !discard && g_applyCursor == changed.size();
+        if (finished) {
+            // The per-packet vectors are only needed for the write-back.
+            report.nameIds = {};
+            report.specialTypes = {};
+            report.changedIndices = {};
+            g_lastAppliedReport = std::move(g_applyingReport);
+        }
+        if (finished || discard) {
+            g_applyingReport.reset();
+            std::lock_guard<std::mutex> lock(g_jobMutex);
+            g_jobRunning = false;
+        }
+        return written > 0 || finished;
+    }
+
+    const AnalysisReport* GetLastReanalysisReport() {
+        return g_lastAppliedReport.get();
+    }
+
+} // namespace kx::Analysis
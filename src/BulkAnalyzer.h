@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+ * @file BulkAnalyzer.h
+ * @brief Re-runs classification, decoding and statistics over a whole packet set.
+ * @details New parsers or header names only affect packets processed after they were
+ *          added. The bulk analyzer partitions an existing packet set (the live log or
+ *          packets loaded by offline tooling) into chunks, processes them on a
+ *          work-stealing pool and merges the per-chunk results in chunk order so the
+ *          outcome does not depend on thread scheduling.
+ */
+
+#include "PacketData.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kx::Analysis {
+
+    // Aggregated results for one (direction, opcode) pair.
+    struct OpcodeSummary {
+        PacketDirection direction = PacketDirection::Sent;
+        uint16_t opcode = 0;
+        std::string name;
+        uint64_t count = 0;
+        uint64_t totalBytes = 0;
+        int minSize = 0;
+        int maxSize = 0;
+        uint64_t decodedCount = 0; // Packets for which a registered parser produced output
+    };
+
+    struct AnalysisReport {
+        uint64_t logGeneration = 0;  // Packet log generation the input snapshot was taken from
+        std::size_t packetCount = 0;
+
+        // Per-packet classification, index-aligned with the analysed input (not filled in
+        // if cancelled). Names are interned: each packet stores an index into nameTable.
+        std::vector<std::string> nameTable; // Distinct names, in order of first use
+        std::vector<uint32_t> nameIds;
+        std::vector<InternalPacketType> specialTypes;
+        std::vector<std::size_t> changedIndices; // Packets whose name or type differed from the input, ascending
+
+        const std::string& GetName(std::size_t index) const { return nameTable[nameIds[index]]; }
+
+        std::vector<OpcodeSummary> opcodes; // Sorted by (direction, opcode)
+        uint64_t decodedCount = 0;
+        uint64_t unknownHeaderCount = 0;
+
+        std::size_t chunkCount = 0;
+        std::size_t threadCount = 0;
+        double elapsedMs = 0.0;
+        bool cancelled = false;
+    };
+
+    /**
+     * @brief Analyses a packet set in parallel.
+     * @param packets Input packets. Not modified.
+     * @param pool Pool to run the chunks on (the calling thread participates).
+     * @param cancel Optional flag polled between chunks.
+     * @param progress Optional counter incremented by the number of packets processed.
+     * @return The merged report. Identical for identical input regardless of thread count.
+     */
+    AnalysisReport AnalyzePackets(const std::vector<PacketInfo>& packets,
+                                  Threading::ThreadPool& pool,
+                                  const std::atomic<bool>* cancel = nullptr,
+                                  std::atomic<std::size_t>* progress = nullptr);
+
+    // --- In-game "Re-analyse All" driver ---
+    // Packets written back per ApplyCompletedReanalysis() call.
+    constexpr std::size_t REANALYSIS_APPLY_BATCH = 16384;
+
+    // Runs on the low-priority background pool. Results are applied to the log from
+    // the render thread so that packet names are never mutated while being drawn.
+
+    /**
+     * @brief Starts a background re-analysis of the packets currently in the log.
+     * @details The packets are read in place, chunk by chunk; a Clear() part way through
+     *          ends the job and its result is discarded.
+     * @return False if a re-analysis is already running, still being written back, or
+     *         still winding down after a cancel.
+     */
+    bool StartLogReanalysis();
+
+    bool IsReanalysisRunning();
+
+    /**
+     * @brief Fraction of the snapshot processed so far (0..1).
+     */
+    float GetReanalysisProgress();
+
+    /**
+     * @brief Requests cancellation and returns at once.
+     * @details The job stops at its next chunk and the rest of its result is never applied.
+     *          IsReanalysisRunning() stays true until it has stopped.
+     */
+    void CancelReanalysis();
+
+    /**
+     * @brief Writes part of a finished report's classification back into the log.
+     * @details Call from the render thread once per frame. Only packets whose name or type
+     *          changed are written, at most REANALYSIS_APPLY_BATCH per call, so the exclusive
+     *          log lock is held briefly. Reports taken before the last log clear are discarded.
+     * @return True if packets were updated or a report finished applying this call.
+     */
+    bool ApplyCompletedReanalysis();
+
+    /**
+     * @brief The most recently applied report, or nullptr. Render thread only.
+     */
+    const AnalysisReport* GetLastReanalysisReport();
+
+} // namespace kx::Analysis
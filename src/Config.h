@@ -1,12 +1,27 @@
 #pragma once
 
+#include <cstddef>     // For size_t
 #include <string_view> // For std::string_view
+#include "PatternLiteral.h"
 
 namespace kx {
     constexpr std::string_view APP_VERSION = "1.5";
 
-    // Configuration for the target process and function signature
+    // Configuration for the target process and function signature.
+    // Signatures are compiled at build time; a malformed one fails the build.
     constexpr std::string_view TARGET_PROCESS_NAME = "Gw2-64.exe";
-    constexpr std::string_view MSG_CONN_FLUSH_PACKET_BUFFER_PATTERN = "40 ? 48 83 EC ? 48 8D ? ? ? 48 89 ? ? 48 89 ? ? 48 89 ? ? 4C 89 ? ? 48 8B ? ? ? ? ? 48 33 ? 48 89 ? ? 48 8B ? E8";
-    constexpr std::string_view MSG_DISPATCH_STREAM_PATTERN = "48 89 5C 24 ? 4C 89 44 24 ? 55 56 57 41 54 41 55 41 56 41 57 48 8B EC 48 83 EC ? 8B 82";
+    constexpr auto MSG_CONN_FLUSH_PACKET_BUFFER_PATTERN = Scanning::CompilePattern<"40 ? 48 83 EC ? 48 8D ? ? ? 48 89 ? ? 48 89 ? ? 48 89 ? ? 4C 89 ? ? 48 8B ? ? ? ? ? 48 33 ? 48 89 ? ? 48 8B ? E8">();
+    constexpr auto MSG_DISPATCH_STREAM_PATTERN = Scanning::CompilePattern<"48 89 5C 24 ? 4C 89 44 24 ? 55 56 57 41 54 41 55 41 56 41 57 48 8B EC 48 83 EC ? 8B 82">();
+    // Fixed bytes a signature may differ in after a game patch before it counts as not found.
+    constexpr size_t SIGNATURE_MAX_MISMATCHES = 3;
+
+    // Runtime schema catalogue, looked up next to the DLL and reloaded when it changes.
+    // Build it with tools/schema/kx_schema_compile.py.
+    constexpr std::string_view SCHEMA_CATALOG_FILENAME = "kx_schema.bin";
+
+    // SMSG schemas harvested from the running game, in the same format, saved next to the DLL.
+    constexpr std::string_view SCHEMA_HARVEST_FILENAME = "kx_schema_harvested.bin";
+
+    // Signature matches of the last game build scanned, saved next to the DLL.
+    constexpr std::string_view SIGNATURE_CACHE_FILENAME = "kx_signatures.bin";
 }
@@ -0,0 +1,92 @@
+#include "CpuFeatures.h"
+
+#include <cstdint>
+
+#if KX_ARCH_X64
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace kx::Cpu {
+
+    namespace {
+#if KX_ARCH_X64
+        void QueryCpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+            int info[4] = {};
+            __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+            for (int i = 0; i < 4; ++i) {
+                regs[i] = static_cast<uint32_t>(info[i]);
+            }
+#else
+            __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        }
+
+        uint64_t ReadXcr0() {
+#if defined(_MSC_VER)
+            return _xgetbv(0);
+#else
+            uint32_t eax = 0;
+            uint32_t edx = 0;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+        }
+#endif
+
+        Features Detect() {
+            Features features;
+#if KX_ARCH_X64
+            uint32_t regs[4] = {};
+            QueryCpuid(0, 0, regs);
+            const uint32_t maxLeaf = regs[0];
+            if (maxLeaf < 1) {
+                return features;
+            }
+
+            QueryCpuid(1, 0, regs);
+            const uint32_t ecx = regs[2];
+            const uint32_t edx = regs[3];
+            features.sse2 = (edx >> 26) & 1;
+            features.ssse3 = (ecx >> 9) & 1;
+            features.sse42 = (ecx >> 20) & 1;
+            features.popcnt = (ecx >> 23) & 1;
+
+            // AVX2 also needs the OS to save YMM registers (OSXSAVE, then XCR0 bits 1 and 2).
+            const bool osxsave = (ecx >> 27) & 1;
+            const bool avx = (ecx >> 28) & 1;
+            if (maxLeaf >= 7 && osxsave && avx && (ReadXcr0() & 0x6) == 0x6) {
+                QueryCpuid(7, 0, regs);
+                features.avx2 = (regs[1] >> 5) & 1;
+            }
+#endif
+            return features;
+        }
+    }
+
+    namespace {
+        Features& GetActiveFeatures() {
+            static Features features = Detect();
+            return features;
+        }
+    }
+
+    const Features& GetFeatures() {
+        return GetActiveFeatures();
+    }
+
+    void RestrictFeatures(const Features& allowed) {
+        const Features detected = Detect();
+        Features& active = GetActiveFeatures();
+        active.sse2 = detected.sse2 && allowed.sse2;
+        active.ssse3 = detected.ssse3 && allowed.ssse3;
+        active.sse42 = detected.sse42 && allowed.sse42;
+        active.popcnt = detected.popcnt && allowed.popcnt;
+        active.avx2 = detected.avx2 && allowed.avx2;
+    }
+
+} // namespace kx::Cpu
@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file CpuFeatures.h
+ * @brief Runtime detection of the SIMD instruction sets used by the hot formatting
+ *        and scanning loops, plus the function attributes needed to compile them.
+ * @details The DLL is built for baseline x64 (SSE2), so wider code paths are compiled
+ *          per function and selected at runtime. MSVC accepts intrinsics for any
+ *          instruction set without flags; GCC and Clang (offline tooling) need a target
+ *          attribute on each function that uses them.
+ */
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define KX_ARCH_X64 1
+#else
+#define KX_ARCH_X64 0
+#endif
+
+#if KX_ARCH_X64 && (defined(__GNUC__) || defined(__clang__))
+#define KX_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define KX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define KX_TARGET_SSSE3
+#define KX_TARGET_AVX2
+#endif
+
+namespace kx::Cpu {
+
+    struct Features {
+        bool sse2 = false;
+        bool ssse3 = false;
+        bool sse42 = false;
+        bool popcnt = false;
+        bool avx2 = false; // Includes the OS check that YMM state is saved
+    };
+
+    /**
+     * @brief Features of the CPU the process runs on. Detected once, thread-safe.
+     */
+    const Features& GetFeatures();
+
+    /**
+     * @brief Makes GetFeatures() report only the features in `allowed` that the CPU has.
+     * @details For offline tools that check every code path on one machine; pass every
+     *          feature to undo. Not thread-safe: call while no other thread is running
+     *          code that dispatches on GetFeatures(). The DLL never calls it.
+     */
+    void RestrictFeatures(const Features& allowed);
+
+} // namespace kx::Cpu
@@ -2,7 +2,9 @@
 #include "HookManager.h"      // To create/remove the hook
 #include "ImGuiManager.h"     // To initialize and render ImGui
 #include "AppState.h"         // For UI visibility state (g_showInspectorWindow, g_isShuttingDown)
+#include "StartupTimeline.h"  // For timing the overlay setup on the first frame
 #include <iostream>           // Replace with logging
+#include <optional>
 
 // Include ImGui backend headers for WndProc handler
 #include "../libs/ImGui/imgui.h"
@@ -25,8 +27,8 @@ namespace kx::Hooking {
     WNDPROC D3DRenderHook::m_pOriginalWndProc = nullptr;
 
     bool D3DRenderHook::Initialize() {
-        if (!FindPresentPointer()) {
-            std::cerr << "[D3DRenderHook] Failed to find Present pointer." << std::endl;
+        if (!m_pTargetPresent) {
+            std::cerr << "[D3DRenderHook] Present pointer not found." << std::endl;
             return false;
         }
 
@@ -149,6 +151,14 @@ namespace kx::Hooking {
         }
 
         if (!m_isInit) {
+            // Only the first attempt is timed; a failed setup is retried every frame.
+            static bool isFirstAttempt = true;
+            std::optional<kx::Startup::ScopedStage> stage;
+            if (isFirstAttempt) {
+                isFirstAttempt = false;
+                stage.emplace("Overlay setup (first Present)");
+                stage->SetSucceeded(false);
+            }
             // Attempt to initialize D3D resources and ImGui using the game's swapchain/device
             if (SUCCEEDED(pSwapChain->GetDevice(__uuidof(ID3D11Device), reinterpret_cast<void**>(&m_pDevice)))) {
                 m_pDevice->GetImmediateContext(&m_pContext);
@@ -197,6 +207,9 @@ namespace kx::Hooking {
                 }
                 else {
                     m_isInit = true; // Full initialization successful
+                    if (stage) {
+                        stage->SetSucceeded(true);
+                    }
                     std::cout << "[D3DRenderHook] ImGui Initialized." << std::endl;
                 }
             }
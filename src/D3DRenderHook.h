@@ -20,8 +20,15 @@ namespace kx::Hooking {
     class D3DRenderHook {
     public:
         /**
-         * @brief Initializes the Present hook, finds the Present function,
-         *        hooks WndProc, and prepares for ImGui rendering.
+         * @brief Finds the address of IDXGISwapChain::Present through a dummy device and
+         *        swap chain. Creates and destroys a window, so call it from one thread.
+         * @return True if the pointer was found, false otherwise.
+         */
+        static bool FindPresentPointer();
+
+        /**
+         * @brief Creates and enables the Present hook at the pointer found by FindPresentPointer().
+         *        WndProc and ImGui are set up on the first hooked Present call.
          * @return True if successful, false otherwise.
          */
         static bool Initialize();
@@ -58,12 +65,6 @@ namespace kx::Hooking {
         static WNDPROC m_pOriginalWndProc; // Pointer to the game's original WndProc
 
         // --- Private Methods ---
-        /**
-         * @brief Finds the address of the IDXGISwapChain::Present function.
-         * @return True if the pointer was found, false otherwise.
-         */
-        static bool FindPresentPointer();
-
         /**
          * @brief The detour function for IDXGISwapChain::Present.
          */
@@ -0,0 +1,282 @@
+#include "FieldLayouts.h"
+#include "PacketHeaders.h"
+#include "PacketStructures.h"
+#include "SchemaCatalog.h"
+#include "SchemaDecoder.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace kx::Parsing {
+
+    namespace {
+
+        enum class FieldKind {
+            U8,
+            U16,
+            U32,
+            F32
+        };
+
+        std::size_t GetKindSize(FieldKind kind) {
+            switch (kind) {
+            case FieldKind::U8:  return 1;
+            case FieldKind::U16: return 2;
+            default:             return 4;
+            }
+        }
+
+        // Adds a little-endian scalar field if it lies inside the payload.
+        bool AddScalar(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans,
+                       const char* label, std::size_t offset, FieldKind kind) {
+            const std::size_t size = GetKindSize(kind);
+            if (offset > packet.data.size() || packet.data.size() - offset < size) {
+                return false;
+            }
+            const uint8_t* p = packet.data.data() + offset;
+            char text[48];
+            if (kind == FieldKind::F32) {
+                float value;
+                std::memcpy(&value, p, sizeof(value));
+                std::snprintf(text, sizeof(text), "%.2f", value);
+            } else {
+                uint32_t value = 0;
+                for (std::size_t i = 0; i < size; ++i) {
+                    value |= static_cast<uint32_t>(p[i]) << (8 * i);
+                }
+                std::snprintf(text, sizeof(text), "0x%0*X (%u)", static_cast<int>(size * 2), value, value);
+            }
+            spans.push_back({ offset, size, 0, label, text });
+            return true;
+        }
+
+        void AddBytes(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans,
+                      const char* label, std::size_t offset, std::size_t size) {
+            if (offset >= packet.data.size() || size == 0) {
+                return;
+            }
+            size = std::min(size, packet.data.size() - offset);
+            spans.push_back({ offset, size, 0, label, std::to_string(size) + " bytes" });
+        }
+
+        // Outgoing captures start with the opcode itself.
+        void AddOpcode(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddScalar(packet, spans, "Opcode", 0, FieldKind::U16);
+        }
+
+        // --- CMSG layouts (offsets as read by the matching parsers) ---
+
+        void LayoutSessionTick(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+            AddScalar(packet, spans, "Timestamp", 2, FieldKind::U32);
+        }
+
+        void LayoutPerformanceResponse(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+            if (packet.data.size() >= 6) {
+                AddScalar(packet, spans, "Perf Value", 2, FieldKind::U32);
+            }
+        }
+
+        void LayoutHeartbeat(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+            AddScalar(packet, spans, "Value", 2, FieldKind::U16);
+        }
+
+        void LayoutMovement(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+            constexpr std::size_t assumed_offset_from_end = 16;
+            if (packet.data.size() < assumed_offset_from_end) {
+                return;
+            }
+            const std::size_t start = packet.data.size() - assumed_offset_from_end;
+            AddScalar(packet, spans, "X", start + offsetof(kx::Packets::MovementPayload, x), FieldKind::F32);
+            AddScalar(packet, spans, "Y", start + offsetof(kx::Packets::MovementPayload, y), FieldKind::F32);
+            AddScalar(packet, spans, "Z", start + offsetof(kx::Packets::MovementPayload, z), FieldKind::F32);
+        }
+
+        void LayoutSelectAgent(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            using Payload = kx::Packets::CMSG_SelectAgentPayload;
+            AddScalar(packet, spans, "Opcode", offsetof(Payload, opcode), FieldKind::U16);
+            AddScalar(packet, spans, "Agent ID", offsetof(Payload, agentId), FieldKind::U16);
+            AddScalar(packet, spans, "Unknown", offsetof(Payload, unknown), FieldKind::U16);
+            AddScalar(packet, spans, "Agent ID (repeat)", offsetof(Payload, agentId_repeat), FieldKind::U16);
+        }
+
+        void LayoutInteractWithAgent(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+            AddScalar(packet, spans, "Command ID", 2, FieldKind::U16);
+        }
+
+        void LayoutInteractionResponse(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+            AddScalar(packet, spans, "Status", 2, FieldKind::U8);
+        }
+
+        void LayoutOpcodeOnly(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+        }
+
+        void LayoutCombatBatch(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            AddOpcode(packet, spans);
+            // Same heuristic walk as ParseCombatBatchPacket: known sub-opcodes every 26 bytes.
+            for (std::size_t offset = 4; offset + 2 <= packet.data.size(); offset += 26) {
+                const uint16_t subOpcode = static_cast<uint16_t>(packet.data[offset] | (packet.data[offset + 1] << 8));
+                if (kx::g_cmsgNames.count(static_cast<kx::CMSG_HeaderId>(subOpcode))) {
+                    const std::size_t before = spans.size();
+                    AddScalar(packet, spans, "Sub-packet", offset, FieldKind::U16);
+                    if (spans.size() > before) {
+                        spans.back().value.append(" ").append(kx::GetPacketName(kx::PacketDirection::Sent, subOpcode));
+                    }
+                }
+            }
+        }
+
+        // --- SMSG layouts ---
+
+        void LayoutPlayerStateUpdate(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            using Payload = kx::Packets::SMSG_PlayerStateUpdatePayload;
+            if (packet.data.size() < sizeof(Payload)) {
+                return;
+            }
+            AddScalar(packet, spans, "Header", offsetof(Payload, hdr), FieldKind::U16);
+            AddScalar(packet, spans, "Mode/Index", offsetof(Payload, mode_or_ix), FieldKind::U8);
+            AddScalar(packet, spans, "Tick Lo", offsetof(Payload, tick_lo), FieldKind::U16);
+            AddScalar(packet, spans, "Millis/K", offsetof(Payload, millis_or_k), FieldKind::U16);
+            AddScalar(packet, spans, "World/ID", offsetof(Payload, world_or_id), FieldKind::U16);
+            AddScalar(packet, spans, "Flags", offsetof(Payload, flags), FieldKind::U16);
+        }
+
+        void LayoutTimeSync(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            if (packet.data.size() < 10) {
+                return;
+            }
+            const uint16_t type = static_cast<uint16_t>(packet.data[0] | (packet.data[1] << 8));
+            if (type == 0x050F) {
+                using Payload = kx::Packets::SMSG_TimeSyncTickPayload;
+                AddScalar(packet, spans, "Type", offsetof(Payload, type), FieldKind::U16);
+                AddScalar(packet, spans, "Time Lo", offsetof(Payload, time_lo), FieldKind::U32);
+                AddScalar(packet, spans, "Time Hi", offsetof(Payload, time_hi), FieldKind::U16);
+                AddScalar(packet, spans, "Flags/ID", offsetof(Payload, flags_or_id), FieldKind::U16);
+            } else if (type == 0x050D) {
+                using Payload = kx::Packets::SMSG_TimeSyncSeedPayload;
+                AddScalar(packet, spans, "Type", offsetof(Payload, type), FieldKind::U16);
+                AddScalar(packet, spans, "Seed", offsetof(Payload, seed), FieldKind::U16);
+                AddScalar(packet, spans, "Millis", offsetof(Payload, millis), FieldKind::U16);
+                AddScalar(packet, spans, "World/ID", offsetof(Payload, world_or_id), FieldKind::U16);
+                AddScalar(packet, spans, "Flags", offsetof(Payload, flags), FieldKind::U16);
+            } else {
+                AddScalar(packet, spans, "Type", 0, FieldKind::U16);
+            }
+        }
+
+        void LayoutServerCommand(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            if (!AddScalar(packet, spans, "Subtype", 0, FieldKind::U16)) {
+                return;
+            }
+            const uint16_t subtype = static_cast<uint16_t>(packet.data[0] | (packet.data[1] << 8));
+            if (subtype == 0x0004) {
+                AddScalar(packet, spans, "Value", 2, FieldKind::U32);
+            }
+        }
+
+        void LayoutAgentMovementState(const kx::PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            if (!AddScalar(packet, spans, "Subtype", 0, FieldKind::U16)) {
+                return;
+            }
+            const uint16_t subtype = static_cast<uint16_t>(packet.data[0] | (packet.data[1] << 8));
+            if ((subtype == 0x03CC || subtype == 0x03C6) && packet.data.size() >= 7) {
+                AddScalar(packet, spans, "Agent ID", 2, FieldKind::U32);
+                if (subtype == 0x03C6) {
+                    AddBytes(packet, spans, "Animation & Physics Data", 7, packet.data.size() - 7);
+                }
+            }
+        }
+
+        PacketFieldSpans GetSchemaFieldSpans(const kx::PacketInfo& packet) {
+            PacketFieldSpans result;
+            const std::shared_ptr<const Schema::Catalog> catalog = Schema::GetActiveCatalog();
+            if (!catalog) {
+                return result;
+            }
+            const Schema::MessageSchema* message = catalog->Find(packet.direction, packet.rawHeaderId);
+            if (!message || message->fieldCount == 0) {
+                return result;
+            }
+
+            const Schema::DecodeResult decoded = Schema::DecodePayload(*catalog, *message, packet.data.data(), packet.data.size(),
+                                                                       Schema::GetLayoutForDirection(packet.direction));
+            result.source = FieldSource::Schema;
+            result.spans.reserve(decoded.fields.size());
+            for (const Schema::DecodedField& field : decoded.fields) {
+                if (field.size == 0 || field.offset >= packet.data.size()) {
+                    continue; // Absent optionals and empty arrays have nothing to highlight
+                }
+                FieldSpan span;
+                span.offset = field.offset;
+                span.size = std::min(field.size, packet.data.size() - field.offset);
+                span.depth = field.depth;
+                span.label = field.path;
+                if (!field.def->name.empty()) {
+                    span.label += ' ';
+                    span.label += field.def->name;
+                }
+                span.label += " [";
+                span.label += Schema::GetFieldTypeName(field.def->type);
+                span.label += ']';
+                span.value = field.value;
+                result.spans.push_back(std::move(span));
+            }
+            return result;
+        }
+
+    } // namespace
+
+    const LayoutRegistry& GetLayoutRegistry() {
+        static LayoutRegistry registry = {
+            // CMSG Layouts
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::SESSION_TICK)}, LayoutSessionTick},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::PERFORMANCE_RESPONSE)}, LayoutPerformanceResponse},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::HEARTBEAT)}, LayoutHeartbeat},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::MOVEMENT)}, LayoutMovement},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::LOGOUT_TO_CHAR_SELECT)}, LayoutOpcodeOnly},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::DESELECT_AGENT)}, LayoutOpcodeOnly},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::SELECT_AGENT)}, LayoutSelectAgent},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::INTERACT_WITH_AGENT)}, LayoutInteractWithAgent},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::INTERACTION_RESPONSE)}, LayoutInteractionResponse},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::COMBAT_ACTION_BATCH)}, LayoutCombatBatch},
+            {{kx::PacketDirection::Sent, static_cast<uint16_t>(kx::CMSG_HeaderId::INTERACTION_CLEANUP)}, LayoutCombatBatch},
+
+            // SMSG Layouts
+            {{kx::PacketDirection::Received, static_cast<uint16_t>(kx::SMSG_HeaderId::PLAYER_STATE_UPDATE)}, LayoutPlayerStateUpdate},
+            {{kx::PacketDirection::Received, static_cast<uint16_t>(kx::SMSG_HeaderId::TIME_SYNC)}, LayoutTimeSync},
+            {{kx::PacketDirection::Received, static_cast<uint16_t>(kx::SMSG_HeaderId::SERVER_COMMAND)}, LayoutServerCommand},
+            {{kx::PacketDirection::Received, static_cast<uint16_t>(kx::SMSG_HeaderId::AGENT_MOVEMENT_STATE_CHANGE)}, LayoutAgentMovementState},
+        };
+        return registry;
+    }
+
+    PacketFieldSpans GetPacketFieldSpans(const kx::PacketInfo& packet) {
+        const auto& registry = GetLayoutRegistry();
+        auto it = registry.find(std::make_pair(packet.direction, packet.rawHeaderId));
+        if (it != registry.end()) {
+            PacketFieldSpans result;
+            result.source = FieldSource::Handwritten;
+            it->second(packet, result.spans);
+            return result;
+        }
+        return GetSchemaFieldSpans(packet);
+    }
+
+    const char* GetFieldSourceName(FieldSource source) {
+        switch (source) {
+        case FieldSource::Handwritten: return "handwritten layout";
+        case FieldSource::Schema:      return "schema";
+        default:                       return "none";
+        }
+    }
+
+} // namespace kx::Parsing
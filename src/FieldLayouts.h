@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * @file FieldLayouts.h
+ * @brief Byte ranges of the fields in a packet payload, for the hex viewer overlays.
+ * @details The handwritten parsers only produce text, so their layouts are described
+ *          here as well, keyed like the parser registry and kept next to it in spirit:
+ *          a layout must read the same offsets as its parser. Packets without a
+ *          handwritten layout fall back to the schema decoder's field ranges.
+ */
+
+#include "PacketData.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kx::Parsing {
+
+    struct FieldSpan {
+        std::size_t offset = 0; // Byte range within PacketInfo::data
+        std::size_t size = 0;
+        int depth = 0;          // Nesting level; deeper spans are drawn over their parents
+        std::string label;      // e.g. "Agent ID" or "3[1].0 name [u32]"
+        std::string value;      // Formatted value
+    };
+
+    enum class FieldSource {
+        None,
+        Handwritten,
+        Schema
+    };
+
+    struct PacketFieldSpans {
+        std::vector<FieldSpan> spans; // In payload order, parents before their children
+        FieldSource source = FieldSource::None;
+    };
+
+    // Appends the spans of one packet. Must tolerate payloads of any length.
+    using LayoutFunc = void(*)(const kx::PacketInfo&, std::vector<FieldSpan>&);
+
+    // Maps (direction, raw header id) to the layout of that packet
+    using LayoutRegistry = std::map<std::pair<kx::PacketDirection, uint16_t>, LayoutFunc>;
+
+    /**
+     * @brief Returns the registry of handwritten packet layouts.
+     */
+    const LayoutRegistry& GetLayoutRegistry();
+
+    /**
+     * @brief Field spans for a packet from its handwritten layout, else from the active schema catalogue.
+     * @details Spans never extend past the payload.
+     */
+    PacketFieldSpans GetPacketFieldSpans(const kx::PacketInfo& packet);
+
+    const char* GetFieldSourceName(FieldSource source);
+
+} // namespace kx::Parsing
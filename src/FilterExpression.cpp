@@ -0,0 +1,1178 @@
+#include "FilterExpression.h"
+#include "FieldLayouts.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+
+namespace kx::Filtering {
+
+    namespace {
+        constexpr uint64_t MICROS_PER_DAY = 86400ull * 1000000ull;
+        constexpr std::size_t MAX_NESTING = 48;
+        constexpr uint32_t TO_END = UINT32_MAX; // Region length of `data` and `data[a:]`
+
+        // Read instead of the payload when a load is out of bounds, so the load never branches.
+        constexpr std::array<uint8_t, 8> ZERO_BYTES{};
+
+        uint64_t LoadLittleEndian(const uint8_t* p, std::size_t width) {
+            uint64_t value = 0;
+            switch (width) {
+            case 1: value = p[0]; break;
+            case 2: { uint16_t v; std::memcpy(&v, p, 2); value = v; break; }
+            case 4: { uint32_t v; std::memcpy(&v, p, 4); value = v; break; }
+            case 8: std::memcpy(&value, p, 8); break;
+            default:
+                for (std::size_t i = 0; i < width; ++i) {
+                    value |= static_cast<uint64_t>(p[i]) << (8 * i);
+                }
+            }
+            return value;
+        }
+
+        uint64_t TimeOfDay(std::chrono::system_clock::time_point timestamp, int64_t utcOffsetUs) {
+            const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count() + utcOffsetUs;
+            const int64_t day = static_cast<int64_t>(MICROS_PER_DAY);
+            return static_cast<uint64_t>(((us % day) + day) % day);
+        }
+
+        // Local time minus UTC now, in microseconds. Fixed per program: a DST switch while a
+        // filter is active shifts its time windows until the filter is edited.
+        int64_t GetUtcOffsetUs() {
+            const std::time_t now = std::time(nullptr);
+            std::tm local{};
+            std::tm utc{};
+#ifdef _WIN32
+            if (localtime_s(&local, &now) != 0 || gmtime_s(&utc, &now) != 0) {
+                return 0;
+            }
+#else
+            if (!localtime_r(&now, &local) || !gmtime_r(&now, &utc)) {
+                return 0;
+            }
+#endif
+            int dayDelta = local.tm_yday - utc.tm_yday;
+            if (local.tm_year != utc.tm_year) {
+                dayDelta = local.tm_year > utc.tm_year ? 1 : -1;
+            }
+            const int64_t seconds = dayDelta * 86400ll + (local.tm_hour - utc.tm_hour) * 3600ll +
+                                    (local.tm_min - utc.tm_min) * 60ll + (local.tm_sec - utc.tm_sec);
+            return seconds * 1000000;
+        }
+
+        // Schema labels are "<path> <name> [<type>]" or "<path> [<type>]"; handwritten ones are plain names.
+        bool FieldLabelMatches(std::string_view label, std::string_view name) {
+            if (label == name) {
+                return true;
+            }
+            const std::size_t typeStart = label.rfind(" [");
+            if (typeStart == std::string_view::npos) {
+                return false;
+            }
+            const std::string_view head = label.substr(0, typeStart);
+            if (head == name) {
+                return true;
+            }
+            const std::size_t space = head.find(' ');
+            return space != std::string_view::npos && (head.substr(0, space) == name || head.substr(space + 1) == name);
+        }
+
+        bool InRange(const FilterInstruction& instruction, uint64_t value) {
+            return (((value & instruction.mask) ^ instruction.bias) - instruction.lo <= instruction.span) != instruction.negate;
+        }
+
+        const char* GetOpName(FilterOp op) {
+            switch (op) {
+            case FilterOp::Push:          return "push";
+            case FilterOp::Direction:     return "sent";
+            case FilterOp::Opcode:        return "op";
+            case FilterOp::OpcodeSet:     return "op.set";
+            case FilterOp::Size:          return "size";
+            case FilterOp::TimeOfDay:     return "time";
+            case FilterOp::LoadLE:        return "load.le";
+            case FilterOp::LoadBE:        return "load.be";
+            case FilterOp::Bytes:         return "bytes";
+            case FilterOp::Contains:      return "contains";
+            case FilterOp::NameEquals:    return "name.eq";
+            case FilterOp::NameContains:  return "name.has";
+            case FilterOp::Field:         return "field";
+            case FilterOp::FieldEquals:   return "field.eq";
+            case FilterOp::FieldContains: return "field.has";
+            case FilterOp::FieldExists:   return "field.any";
+            case FilterOp::And:           return "and";
+            case FilterOp::Or:            return "or";
+            case FilterOp::Not:           return "not";
+            case FilterOp::AndThen:       return "and.then";
+            case FilterOp::OrElse:        return "or.else";
+            default:                      return "?";
+            }
+        }
+
+        bool IsNumericOp(FilterOp op) {
+            return op == FilterOp::Opcode || op == FilterOp::Size || op == FilterOp::TimeOfDay ||
+                   op == FilterOp::LoadLE || op == FilterOp::LoadBE || op == FilterOp::Field;
+        }
+
+        // --- Lexer ---
+
+        enum class TokenKind {
+            End,
+            Identifier,
+            Number,
+            String,
+            Symbol
+        };
+
+        struct Token {
+            TokenKind kind = TokenKind::End;
+            std::string text;          // Strings: unescaped contents
+            std::size_t position = 0;  // Of the first character, 1-based for messages
+        };
+
+        struct CompileError {
+            std::size_t position;
+            std::string message;
+        };
+
+        std::vector<Token> Tokenize(std::string_view text) {
+            static constexpr std::string_view TWO_CHAR_SYMBOLS[] = { "&&", "||", "==", "!=", "<=", ">=", ".." };
+            static constexpr std::string_view ONE_CHAR_SYMBOLS = "(){}[]:,&!<>~-";
+
+            std::vector<Token> tokens;
+            std::size_t i = 0;
+            auto isIdentifierChar = [](char c) {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+            };
+            while (i < text.size()) {
+                const char c = text[i];
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                    ++i;
+                    continue;
+                }
+                Token token;
+                token.position = i + 1;
+                if (c >= '0' && c <= '9') {
+                    // Digits, hex digits and an optional fraction (seconds of a time literal).
+                    std::size_t end = i;
+                    while (end < text.size() && isIdentifierChar(text[end])) {
+                        ++end;
+                    }
+                    if (end + 1 < text.size() && text[end] == '.' && text[end + 1] >= '0' && text[end + 1] <= '9') {
+                        ++end;
+                        while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+                            ++end;
+                        }
+                    }
+                    token.kind = TokenKind::Number;
+                    token.text = std::string(text.substr(i, end - i));
+                    i = end;
+                } else if (isIdentifierChar(c)) {
+                    std::size_t end = i;
+                    while (end < text.size() && isIdentifierChar(text[end])) {
+                        ++end;
+                    }
+                    token.kind = TokenKind::Identifier;
+                    token.text = std::string(text.substr(i, end - i));
+                    i = end;
+                } else if (c == '"') {
+                    token.kind = TokenKind::String;
+                    ++i;
+                    bool closed = false;
+                    while (i < text.size()) {
+                        if (text[i] == '"') {
+                            closed = true;
+                            ++i;
+                            break;
+                        }
+                        if (text[i] == '\\' && i + 1 < text.size()) {
+                            ++i;
+                        }
+                        token.text += text[i++];
+                    }
+                    if (!closed) {
+                        throw CompileError{ token.position, "unterminated string" };
+                    }
+                } else {
+                    token.kind = TokenKind::Symbol;
+                    const std::string_view rest = text.substr(i);
+                    for (const std::string_view symbol : TWO_CHAR_SYMBOLS) {
+                        if (rest.starts_with(symbol)) {
+                            token.text = std::string(symbol);
+                            break;
+                        }
+                    }
+                    if (token.text.empty()) {
+                        if (ONE_CHAR_SYMBOLS.find(c) == std::string_view::npos) {
+                            throw CompileError{ token.position, std::string("unexpected character '") + c + "'" };
+                        }
+                        token.text = std::string(1, c);
+                    }
+                    i += token.text.size();
+                }
+                tokens.push_back(std::move(token));
+            }
+            Token end;
+            end.position = text.size() + 1;
+            tokens.push_back(end);
+            return tokens;
+        }
+
+        // --- Syntax tree ---
+
+        struct Node {
+            enum class Kind {
+                Leaf,
+                Not,
+                And,
+                Or
+            };
+            Kind kind = Kind::Leaf;
+            std::vector<FilterInstruction> code; // Leaf: pushes exactly one value
+            std::size_t leafDepth = 1;           // Leaf: stack slots it uses at most
+            std::unique_ptr<Node> left;          // Not: the operand
+            std::unique_ptr<Node> right;
+            bool expensive = false;              // Worth skipping with a jump
+        };
+
+        // What a comparison is applied to.
+        struct Subject {
+            enum class Kind {
+                Numeric,
+                Region, // Bytes: data, data[a:] or a data[a:b] too long for a number
+                Name,
+                Field
+            };
+            Kind kind = Kind::Numeric;
+            FilterInstruction load;          // Numeric: the instruction without its range
+            uint64_t max = 0;                // Largest value, in unsigned order
+            bool isSigned = false;
+            bool isTime = false;
+            uint32_t regionOffset = 0;       // Byte region, also set for numeric data[a:b]
+            uint32_t regionLength = TO_END;
+            bool hasRegion = false;
+            uint32_t fieldName = 0;          // Field: string index
+            std::string description;         // For messages
+        };
+
+        // Big-endian bytes of a number literal, without leading zero bytes (at least one).
+        struct Literal {
+            std::vector<uint8_t> bytes;
+            bool isHex = false;
+        };
+
+        uint64_t MaxForWidth(std::size_t width) {
+            return width >= 8 ? ~0ull : (1ull << (8 * width)) - 1;
+        }
+
+    } // namespace
+
+    class FilterCompiler {
+    public:
+        FilterCompiler(std::string_view text, FilterProgram& program)
+            : m_tokens(Tokenize(text)), m_program(program) {}
+
+        void Compile() {
+            if (Peek().kind == TokenKind::End) {
+                throw CompileError{ 1, "empty expression" };
+            }
+            std::unique_ptr<Node> root = ParseOr();
+            if (Peek().kind != TokenKind::End) {
+                throw CompileError{ Peek().position, "unexpected '" + Peek().text + "'" };
+            }
+            std::size_t depth = 0;
+            std::size_t maxDepth = 0;
+            Emit(*root, depth, maxDepth);
+            if (maxDepth > FILTER_MAX_STACK_DEPTH) {
+                throw CompileError{ 1, "expression is nested too deeply" };
+            }
+        }
+
+    private:
+        std::vector<Token> m_tokens;
+        std::size_t m_next = 0;
+        std::size_t m_nesting = 0;
+        FilterProgram& m_program;
+
+        const Token& Peek() const { return m_tokens[m_next]; }
+        const Token& Take() { return m_tokens[m_next < m_tokens.size() - 1 ? m_next++ : m_next]; }
+
+        bool IsSymbol(std::string_view symbol) const {
+            return Peek().kind == TokenKind::Symbol && Peek().text == symbol;
+        }
+
+        bool IsKeyword(std::string_view keyword) const {
+            return Peek().kind == TokenKind::Identifier && Peek().text == keyword;
+        }
+
+        bool Accept(std::string_view symbol) {
+            if (IsSymbol(symbol)) {
+                Take();
+                return true;
+            }
+            return false;
+        }
+
+        [[noreturn]] void Fail(const std::string& message) const {
+            throw CompileError{ Peek().position, message };
+        }
+
+        bool AcceptKeyword(std::string_view keyword) {
+            if (IsKeyword(keyword)) {
+                Take();
+                return true;
+            }
+            return false;
+        }
+
+        void Expect(std::string_view symbol) {
+            if (!Accept(symbol)) {
+                Fail("expected '" + std::string(symbol) + "'");
+            }
+        }
+
+        // --- Expressions ---
+
+        static std::unique_ptr<Node> MakeLeaf(const FilterInstruction& instruction) {
+            auto node = std::make_unique<Node>();
+            node->code.push_back(instruction);
+            const FilterOp op = instruction.op;
+            node->expensive = op == FilterOp::Bytes || op == FilterOp::Contains || op == FilterOp::NameEquals ||
+                              op == FilterOp::NameContains || op == FilterOp::Field || op == FilterOp::FieldEquals ||
+                              op == FilterOp::FieldContains || op == FilterOp::FieldExists;
+            return node;
+        }
+
+        static std::unique_ptr<Node> MakeBinary(Node::Kind kind, std::unique_ptr<Node> left, std::unique_ptr<Node> right) {
+            auto node = std::make_unique<Node>();
+            node->kind = kind;
+            node->expensive = left->expensive || right->expensive;
+            node->left = std::move(left);
+            node->right = std::move(right);
+            return node;
+        }
+
+        std::unique_ptr<Node> ParseOr() {
+            std::unique_ptr<Node> node = ParseAnd();
+            while (Accept("||") || AcceptKeyword("or")) {
+                node = MakeBinary(Node::Kind::Or, std::move(node), ParseAnd());
+            }
+            return node;
+        }
+
+        std::unique_ptr<Node> ParseAnd() {
+            std::unique_ptr<Node> node = ParseUnary();
+            while (Accept("&&") || AcceptKeyword("and")) {
+                node = MakeBinary(Node::Kind::And, std::move(node), ParseUnary());
+            }
+            return node;
+        }
+
+        std::unique_ptr<Node> ParseUnary() {
+            if (++m_nesting > MAX_NESTING) {
+                Fail("expression is nested too deeply");
+            }
+            std::unique_ptr<Node> node;
+            if (Accept("!") || AcceptKeyword("not")) {
+                node = std::make_unique<Node>();
+                node->kind = Node::Kind::Not;
+                node->left = ParseUnary();
+                node->expensive = node->left->expensive;
+            } else {
+                node = ParsePrimary();
+            }
+            --m_nesting;
+            return node;
+        }
+
+        std::unique_ptr<Node> ParsePrimary() {
+            if (Accept("(")) {
+                std::unique_ptr<Node> node = ParseOr();
+                Expect(")");
+                return node;
+            }
+            if (Peek().kind != TokenKind::Identifier) {
+                Fail(Peek().kind == TokenKind::End ? "unexpected end of expression" : "unexpected '" + Peek().text + "'");
+            }
+
+            const std::string word = Peek().text;
+            FilterInstruction instruction;
+            if (word == "true" || word == "false") {
+                Take();
+                instruction.op = FilterOp::Push;
+                instruction.negate = word == "false";
+                return MakeLeaf(instruction);
+            }
+            if (word == "sent" || word == "recv" || word == "received") {
+                Take();
+                instruction.op = FilterOp::Direction;
+                instruction.negate = word != "sent";
+                return MakeLeaf(instruction);
+            }
+            return ParseComparison(ParseSubject());
+        }
+
+        // --- Subjects ---
+
+        uint32_t ParseOffset() {
+            if (Peek().kind != TokenKind::Number) {
+                Fail("expected a byte offset");
+            }
+            const Literal literal = ParseLiteral(Take());
+            const uint64_t value = ToValue(literal, 4, "offset");
+            return static_cast<uint32_t>(value);
+        }
+
+        Subject ParseSubject() {
+            const Token word = Take();
+            Subject subject;
+            subject.description = word.text;
+
+            if (word.text == "op" || word.text == "opcode") {
+                subject.load.op = FilterOp::Opcode;
+                subject.max = 0xFFFF;
+                return subject;
+            }
+            if (word.text == "size") {
+                subject.load.op = FilterOp::Size;
+                subject.max = 0xFFFFFFFF;
+                return subject;
+            }
+            if (word.text == "time") {
+                subject.load.op = FilterOp::TimeOfDay;
+                subject.max = MICROS_PER_DAY - 1;
+                subject.isTime = true;
+                m_program.m_utcOffsetUs = GetUtcOffsetUs();
+                return subject;
+            }
+            if (word.text == "name") {
+                subject.kind = Subject::Kind::Name;
+                return subject;
+            }
+            if (word.text == "field") {
+                Expect("(");
+                if (Peek().kind != TokenKind::String) {
+                    Fail("expected a field name in quotes");
+                }
+                subject.kind = Subject::Kind::Field;
+                subject.fieldName = AddString(Take().text);
+                subject.description = "field(\"";
+                subject.description += m_program.m_strings[subject.fieldName];
+                subject.description += "\")";
+                Expect(")");
+                subject.load.op = FilterOp::Field;
+                subject.load.width = 8;
+                subject.max = ~0ull;
+                m_program.m_usesFields = true;
+                return subject;
+            }
+            if (word.text == "data") {
+                subject.kind = Subject::Kind::Region;
+                subject.hasRegion = true;
+                if (!Accept("[")) {
+                    return subject; // The whole payload
+                }
+                subject.regionOffset = ParseOffset();
+                if (Accept(":")) {
+                    if (IsSymbol("]")) {
+                        Take();
+                        return subject; // data[a:]
+                    }
+                    const uint32_t end = ParseOffset();
+                    if (end <= subject.regionOffset) {
+                        Fail("the slice is empty");
+                    }
+                    subject.regionLength = end - subject.regionOffset;
+                } else {
+                    subject.regionLength = 1;
+                }
+                Expect("]");
+                if (subject.regionLength <= 8) {
+                    // Short slices are also numbers, read in written (big-endian) order.
+                    subject.kind = Subject::Kind::Numeric;
+                    subject.load.op = FilterOp::LoadBE;
+                    subject.load.width = static_cast<uint8_t>(subject.regionLength);
+                    subject.load.offset = subject.regionOffset;
+                    subject.max = MaxForWidth(subject.regionLength);
+                }
+                return subject;
+            }
+
+            // u8[a] .. u64[a], i8[a] .. i64[a]
+            if (word.text.size() >= 2 && (word.text[0] == 'u' || word.text[0] == 'i')) {
+                const std::string_view bits = std::string_view(word.text).substr(1);
+                if (bits == "8" || bits == "16" || bits == "32" || bits == "64") {
+                    const std::size_t width = static_cast<std::size_t>(std::stoi(std::string(bits))) / 8;
+                    Expect("[");
+                    subject.load.op = FilterOp::LoadLE;
+                    subject.load.width = static_cast<uint8_t>(width);
+                    subject.load.offset = ParseOffset();
+                    Expect("]");
+                    subject.max = MaxForWidth(width);
+                    subject.isSigned = word.text[0] == 'i';
+                    if (subject.isSigned) {
+                        subject.load.bias = 1ull << (8 * width - 1);
+                    }
+                    subject.description += '[';
+                    subject.description += std::to_string(subject.load.offset);
+                    subject.description += ']';
+                    return subject;
+                }
+            }
+            throw CompileError{ word.position, "unknown name '" + word.text + "'" };
+        }
+
+        // --- Values ---
+
+        Literal ParseLiteral(const Token& token) {
+            Literal literal;
+            std::string_view text = token.text;
+            if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+                literal.isHex = true;
+                std::string digits(text.substr(2));
+                if (digits.size() % 2) {
+                    digits.insert(digits.begin(), '0');
+                }
+                for (std::size_t i = 0; i < digits.size(); i += 2) {
+                    uint8_t byte = 0;
+                    const auto result = std::from_chars(digits.data() + i, digits.data() + i + 2, byte, 16);
+                    if (result.ec != std::errc() || result.ptr != digits.data() + i + 2) {
+                        throw CompileError{ token.position, "invalid hex number '" + token.text + "'" };
+                    }
+                    literal.bytes.push_back(byte);
+                }
+            } else {
+                uint64_t value = 0;
+                const auto result = std::from_chars(text.data(), text.data() + text.size(), value, 10);
+                if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+                    throw CompileError{ token.position, "invalid number '" + token.text + "'" };
+                }
+                for (int shift = 56; shift >= 0; shift -= 8) {
+                    literal.bytes.push_back(static_cast<uint8_t>(value >> shift));
+                }
+            }
+            const auto firstSignificant = std::find_if(literal.bytes.begin(), literal.bytes.end() - 1, [](uint8_t b) { return b != 0; });
+            literal.bytes.erase(literal.bytes.begin(), firstSignificant);
+            return literal;
+        }
+
+        uint64_t ToValue(const Literal& literal, std::size_t width, const std::string& what) {
+            if (literal.bytes.size() > width) {
+                Fail("the number does not fit the " + what);
+            }
+            uint64_t value = 0;
+            for (const uint8_t byte : literal.bytes) {
+                value = (value << 8) | byte;
+            }
+            if (width < 8 && value > MaxForWidth(width)) {
+                Fail("the number does not fit the " + what);
+            }
+            return value;
+        }
+
+        // HH:MM[:SS[.ffffff]] in microseconds.
+        uint64_t ParseTimeOfDay() {
+            auto component = [&](uint64_t limit, const char* name) -> uint64_t {
+                if (Peek().kind != TokenKind::Number || Peek().text.find('.') != std::string::npos) {
+                    Fail(std::string("expected ") + name);
+                }
+                const Token token = Take();
+                uint64_t value = 0;
+                const auto result = std::from_chars(token.text.data(), token.text.data() + token.text.size(), value);
+                if (result.ec != std::errc() || result.ptr != token.text.data() + token.text.size() || value >= limit) {
+                    throw CompileError{ token.position, std::string("invalid ") + name + " '" + token.text + "'" };
+                }
+                return value;
+            };
+            uint64_t us = component(24, "hours") * 3600 * 1000000;
+            Expect(":");
+            us += component(60, "minutes") * 60 * 1000000;
+            if (!Accept(":")) {
+                return us;
+            }
+            if (Peek().kind != TokenKind::Number) {
+                Fail("expected seconds");
+            }
+            const Token token = Take();
+            const std::size_t dot = token.text.find('.');
+            const std::string whole = token.text.substr(0, dot);
+            uint64_t seconds = 0;
+            const auto result = std::from_chars(whole.data(), whole.data() + whole.size(), seconds);
+            if (result.ec != std::errc() || result.ptr != whole.data() + whole.size() || seconds >= 60) {
+                throw CompileError{ token.position, "invalid seconds '" + token.text + "'" };
+            }
+            us += seconds * 1000000;
+            if (dot != std::string::npos) {
+                const std::string fraction = token.text.substr(dot + 1);
+                if (fraction.size() > 6) {
+                    throw CompileError{ token.position, "at most 6 fractional digits" };
+                }
+                uint64_t micros = 0;
+                for (std::size_t i = 0; i < 6; ++i) {
+                    micros = micros * 10 + (i < fraction.size() ? static_cast<uint64_t>(fraction[i] - '0') : 0);
+                }
+                us += micros;
+            }
+            return us;
+        }
+
+        // A value of the subject, in its unsigned order (signed values are biased).
+        uint64_t ParseValue(const Subject& subject) {
+            if (subject.isTime) {
+                return ParseTimeOfDay();
+            }
+            const bool negative = Accept("-");
+            if (negative && !subject.isSigned) {
+                Fail(subject.description + " is unsigned");
+            }
+            if (Peek().kind != TokenKind::Number) {
+                Fail("expected a number");
+            }
+            const Token token = Take();
+            const Literal literal = ParseLiteral(token);
+            const std::size_t width = subject.load.op == FilterOp::Opcode ? 2 : subject.load.op == FilterOp::Size ? 4 :
+                                      subject.load.width;
+            uint64_t value = ToValue(literal, width, subject.description);
+            if (subject.isSigned) {
+                const uint64_t magnitudeLimit = subject.load.bias; // 2^(bits-1)
+                if (literal.isHex && !negative) {
+                    return value ^ subject.load.bias; // Raw bit pattern
+                }
+                if ((negative && value > magnitudeLimit) || (!negative && value >= magnitudeLimit)) {
+                    Fail("the number does not fit " + subject.description);
+                }
+                value = negative ? (0 - value) & subject.max : value;
+                return value ^ subject.load.bias;
+            }
+            return value;
+        }
+
+        // --- Comparisons ---
+
+        // The instruction for `subject <op> value`, as a range test.
+        static FilterInstruction MakeRange(const Subject& subject, const FilterInstruction& base, std::string_view op, uint64_t value) {
+            FilterInstruction instruction = base;
+            const uint64_t max = subject.max;
+            auto setRange = [&](uint64_t lo, uint64_t hi, bool negate) {
+                instruction.lo = lo;
+                instruction.span = hi - lo;
+                instruction.negate = negate;
+            };
+            if (op == "==") {
+                setRange(value, value, false);
+            } else if (op == "!=") {
+                setRange(value, value, true);
+            } else if (op == "<") {
+                value == 0 ? setRange(0, max, true) : setRange(0, value - 1, false);
+            } else if (op == "<=") {
+                setRange(0, value, false);
+            } else if (op == ">") {
+                value == max ? setRange(0, max, true) : setRange(value + 1, max, false);
+            } else {
+                setRange(value, max, false);
+            }
+            return instruction;
+        }
+
+        std::unique_ptr<Node> ParseComparison(const Subject& subject) {
+            FilterInstruction base = subject.load;
+            bool hasMask = false;
+            if (IsSymbol("&")) {
+                if (subject.kind == Subject::Kind::Name || subject.isTime) {
+                    Fail(subject.description + " cannot be masked");
+                }
+                Take();
+                hasMask = true;
+                if (Peek().kind != TokenKind::Number) {
+                    Fail("expected a mask");
+                }
+                const Token token = Take();
+                const Literal mask = ParseLiteral(token);
+                if (subject.kind == Subject::Kind::Region) {
+                    return ParseBytesComparison(subject, &mask);
+                }
+                const std::size_t width = base.op == FilterOp::Opcode ? 2 : base.op == FilterOp::Size ? 4 : base.width;
+                base.mask = ToValue(mask, width, subject.description);
+            }
+
+            if (IsSymbol("~")) {
+                Take();
+                if (hasMask) {
+                    Fail("a pattern cannot be masked; use ? wildcards");
+                }
+                return ParseContains(subject);
+            }
+
+            if (AcceptKeyword("in")) {
+                if (subject.kind != Subject::Kind::Numeric && subject.kind != Subject::Kind::Field) {
+                    Fail("'in' needs a number");
+                }
+                return ParseSet(subject, base);
+            }
+
+            static constexpr std::string_view COMPARISONS[] = { "==", "!=", "<=", ">=", "<", ">" };
+            const auto it = std::find_if(std::begin(COMPARISONS), std::end(COMPARISONS), [&](std::string_view op) { return IsSymbol(op); });
+            if (it == std::end(COMPARISONS)) {
+                if (subject.kind == Subject::Kind::Field && !hasMask) {
+                    FilterInstruction instruction;
+                    instruction.op = FilterOp::FieldExists;
+                    instruction.index = subject.fieldName;
+                    return MakeLeaf(instruction);
+                }
+                Fail("expected a comparison after " + subject.description);
+            }
+            const std::string_view op = *it;
+            Take();
+
+            if (subject.kind == Subject::Kind::Region) {
+                if (op != "==" && op != "!=") {
+                    Fail("slices longer than 8 bytes only support == and !=");
+                }
+                return ParseBytesComparison(subject, nullptr, op == "!=");
+            }
+            if (Peek().kind == TokenKind::String) {
+                return ParseTextComparison(subject, op);
+            }
+            if (subject.kind == Subject::Kind::Name) {
+                Fail("expected a string");
+            }
+            return MakeLeaf(MakeRange(subject, base, op, ParseValue(subject)));
+        }
+
+        // `data[a:b] [& mask] == 0x...` for slices too long for one load.
+        std::unique_ptr<Node> ParseBytesComparison(const Subject& subject, const Literal* mask, bool negate = false) {
+            if (subject.regionLength == TO_END) {
+                Fail("compare a slice data[a:b]; use ~ to search the payload");
+            }
+            if (mask) {
+                // Comparison operator after the mask.
+                if (Accept("==")) {
+                    negate = false;
+                } else if (Accept("!=")) {
+                    negate = true;
+                } else {
+                    Fail("slices longer than 8 bytes only support == and !=");
+                }
+            }
+            if (Peek().kind != TokenKind::Number) {
+                Fail("expected a hex number");
+            }
+            const std::size_t length = subject.regionLength;
+            auto toBytes = [&](const Literal& literal) {
+                if (literal.bytes.size() > length) {
+                    Fail("the number is longer than the slice");
+                }
+                std::vector<uint8_t> bytes(length - literal.bytes.size(), 0);
+                bytes.insert(bytes.end(), literal.bytes.begin(), literal.bytes.end());
+                return bytes;
+            };
+            FilterInstruction instruction;
+            instruction.op = FilterOp::Bytes;
+            instruction.negate = negate;
+            instruction.offset = subject.regionOffset;
+            instruction.length = subject.regionLength;
+            instruction.index = static_cast<uint32_t>(m_program.m_byteValues.size());
+            m_program.m_byteValues.push_back(toBytes(ParseLiteral(Take())));
+            m_program.m_byteValues.push_back(mask ? toBytes(*mask) : std::vector<uint8_t>(length, 0xFF));
+            return MakeLeaf(instruction);
+        }
+
+        std::unique_ptr<Node> ParseTextComparison(const Subject& subject, std::string_view op) {
+            if (op != "==" && op != "!=") {
+                Fail("strings only support ==, != and ~");
+            }
+            FilterInstruction instruction;
+            instruction.negate = op == "!=";
+            if (subject.kind == Subject::Kind::Name) {
+                instruction.op = FilterOp::NameEquals;
+                instruction.index = AddString(Take().text);
+            } else if (subject.kind == Subject::Kind::Field) {
+                instruction.op = FilterOp::FieldEquals;
+                instruction.index = subject.fieldName;
+                instruction.length = AddString(Take().text);
+            } else {
+                Fail(subject.description + " is compared with numbers");
+            }
+            return MakeLeaf(instruction);
+        }
+
+        std::unique_ptr<Node> ParseContains(const Subject& subject) {
+            if (Peek().kind != TokenKind::String) {
+                Fail("expected a string after ~");
+            }
+            const Token token = Take();
+            FilterInstruction instruction;
+            if (subject.kind == Subject::Kind::Name || subject.kind == Subject::Kind::Field) {
+                instruction.op = subject.kind == Subject::Kind::Name ? FilterOp::NameContains : FilterOp::FieldContains;
+                instruction.index = subject.kind == Subject::Kind::Name ? AddString(token.text) : subject.fieldName;
+                instruction.length = subject.kind == Subject::Kind::Name ? 0 : AddString(token.text);
+                return MakeLeaf(instruction);
+            }
+            if (!subject.hasRegion) {
+                throw CompileError{ token.position, subject.description + " cannot be searched; use data or data[a:b]" };
+            }
+            std::string patternError;
+            std::optional<Scanning::BytePattern> pattern = Scanning::BytePattern::Parse(token.text, &patternError);
+            if (!pattern) {
+                throw CompileError{ token.position, "invalid pattern: " + patternError };
+            }
+            if (subject.regionLength != TO_END && pattern->Size() > subject.regionLength) {
+                throw CompileError{ token.position, "the pattern is longer than the slice" };
+            }
+            instruction.op = FilterOp::Contains;
+            instruction.offset = subject.regionOffset;
+            instruction.length = subject.regionLength;
+            instruction.index = static_cast<uint32_t>(m_program.m_patterns.size());
+            m_program.m_patterns.push_back(std::move(*pattern));
+            return MakeLeaf(instruction);
+        }
+
+        // `in {v, lo..hi, ...}`; the braces are optional for a single entry.
+        std::unique_ptr<Node> ParseSet(const Subject& subject, const FilterInstruction& base) {
+            struct Entry {
+                uint64_t lo;
+                uint64_t hi;
+                bool wraps;
+            };
+            std::vector<Entry> entries;
+            const bool braced = Accept("{");
+            do {
+                const std::size_t position = Peek().position;
+                const uint64_t lo = ParseValue(subject);
+                uint64_t hi = lo;
+                if (Accept("..")) {
+                    hi = ParseValue(subject);
+                }
+                if (lo > hi && !subject.isTime) {
+                    throw CompileError{ position, "the range is empty" };
+                }
+                entries.push_back({ lo, hi, lo > hi });
+            } while (braced && Accept(","));
+            if (braced) {
+                Expect("}");
+            }
+
+            auto node = std::make_unique<Node>();
+            node->expensive = subject.kind == Subject::Kind::Field;
+            if (base.op == FilterOp::Opcode && entries.size() > 1) {
+                // One table lookup, however many entries.
+                std::array<uint64_t, 0x10000 / 64> bits{};
+                for (const Entry& entry : entries) {
+                    for (uint64_t value = entry.lo; value <= entry.hi; ++value) {
+                        bits[value >> 6] |= 1ull << (value & 63);
+                    }
+                }
+                FilterInstruction instruction = base;
+                instruction.op = FilterOp::OpcodeSet;
+                instruction.index = static_cast<uint32_t>(m_program.m_opcodeSets.size());
+                m_program.m_opcodeSets.push_back(bits);
+                node->code.push_back(instruction);
+                return node;
+            }
+
+            for (const Entry& entry : entries) {
+                FilterInstruction instruction = base;
+                if (entry.wraps) {
+                    // Outside the gap (hi, lo); a window covering the whole day leaves no gap.
+                    if (entry.lo == entry.hi + 1) {
+                        instruction = FilterInstruction{};
+                        instruction.op = FilterOp::Push;
+                    } else {
+                        instruction.lo = entry.hi + 1;
+                        instruction.span = entry.lo - 1 - instruction.lo;
+                        instruction.negate = true;
+                    }
+                } else {
+                    instruction.lo = entry.lo;
+                    instruction.span = entry.hi - entry.lo;
+                }
+                node->code.push_back(instruction);
+                if (node->code.size() > 1) {
+                    FilterInstruction combine;
+                    combine.op = FilterOp::Or;
+                    node->code.push_back(combine);
+                    node->leafDepth = 2;
+                }
+            }
+            return node;
+        }
+
+        uint32_t AddString(std::string text) {
+            m_program.m_strings.push_back(std::move(text));
+            return static_cast<uint32_t>(m_program.m_strings.size() - 1);
+        }
+
+        // --- Code generation ---
+
+        void Emit(const Node& node, std::size_t& depth, std::size_t& maxDepth) {
+            std::vector<FilterInstruction>& code = m_program.m_code;
+            switch (node.kind) {
+            case Node::Kind::Leaf:
+                code.insert(code.end(), node.code.begin(), node.code.end());
+                maxDepth = std::max(maxDepth, depth + node.leafDepth);
+                ++depth;
+                return;
+            case Node::Kind::Not: {
+                Emit(*node.left, depth, maxDepth);
+                FilterInstruction instruction;
+                instruction.op = FilterOp::Not;
+                code.push_back(instruction);
+                return;
+            }
+            default:
+                break;
+            }
+
+            const bool isAnd = node.kind == Node::Kind::And;
+            Emit(*node.left, depth, maxDepth);
+            FilterInstruction instruction;
+            if (node.right->expensive) {
+                // Skip the costly operand when the left one decides the result.
+                instruction.op = isAnd ? FilterOp::AndThen : FilterOp::OrElse;
+                const std::size_t jump = code.size();
+                code.push_back(instruction);
+                --depth;
+                Emit(*node.right, depth, maxDepth);
+                code[jump].index = static_cast<uint32_t>(code.size());
+                return;
+            }
+            // Both sides are a few instructions without side effects: evaluating both is
+            // cheaper than a data-dependent jump.
+            Emit(*node.right, depth, maxDepth);
+            instruction.op = isAnd ? FilterOp::And : FilterOp::Or;
+            code.push_back(instruction);
+            --depth;
+        }
+    };
+
+    std::optional<FilterProgram> FilterProgram::Compile(std::string_view text, std::string* error) {
+        FilterProgram program;
+        program.m_text = std::string(text);
+        try {
+            FilterCompiler compiler(text, program);
+            compiler.Compile();
+        }
+        catch (const CompileError& compileError) {
+            if (error) {
+                *error = "at " + std::to_string(compileError.position) + ": " + compileError.message;
+            }
+            return std::nullopt;
+        }
+        return program;
+    }
+
+    bool FilterProgram::Matches(const PacketInfo& packet) const {
+        std::array<uint8_t, FILTER_MAX_STACK_DEPTH> stack;
+        std::size_t top = 0;
+        const uint8_t* data = packet.data.data();
+        const std::size_t dataSize = packet.data.size();
+        std::optional<Parsing::PacketFieldSpans> fields; // Decoded on first use
+
+        auto getFields = [&]() -> const std::vector<Parsing::FieldSpan>& {
+            if (!fields) {
+                fields = Parsing::GetPacketFieldSpans(packet);
+            }
+            return fields->spans;
+        };
+
+        const std::size_t codeSize = m_code.size();
+        for (std::size_t pc = 0; pc < codeSize; ++pc) {
+            const FilterInstruction& instruction = m_code[pc];
+            uint64_t value = 0;
+            bool valid = true;
+            switch (instruction.op) {
+            // Numeric subjects: load the value, then the shared range test below.
+            case FilterOp::Opcode:
+                value = packet.rawHeaderId;
+                break;
+            case FilterOp::Size:
+                value = static_cast<uint32_t>(packet.size);
+                break;
+            case FilterOp::TimeOfDay:
+                value = TimeOfDay(packet.timestamp, m_utcOffsetUs);
+                break;
+            case FilterOp::LoadLE:
+            case FilterOp::LoadBE: {
+                valid = instruction.offset <= dataSize && dataSize - instruction.offset >= instruction.width;
+                const uint8_t* p = valid ? data + instruction.offset : ZERO_BYTES.data();
+                value = LoadLittleEndian(p, instruction.width);
+                if (instruction.op == FilterOp::LoadBE) {
+                    value = std::byteswap(value) >> (64 - 8 * instruction.width);
+                }
+                break;
+            }
+
+            case FilterOp::Push:
+                stack[top++] = !instruction.negate;
+                continue;
+            case FilterOp::Direction:
+                stack[top++] = (packet.direction == PacketDirection::Sent) != instruction.negate;
+                continue;
+            case FilterOp::OpcodeSet: {
+                const uint16_t opcode = static_cast<uint16_t>(packet.rawHeaderId & instruction.mask);
+                const auto& bits = m_opcodeSets[instruction.index];
+                stack[top++] = (((bits[opcode >> 6] >> (opcode & 63)) & 1) != 0) != instruction.negate;
+                continue;
+            }
+            case FilterOp::Bytes: {
+                bool result = false;
+                if (instruction.offset <= dataSize && dataSize - instruction.offset >= instruction.length) {
+                    const uint8_t* expected = m_byteValues[instruction.index].data();
+                    const uint8_t* mask = m_byteValues[instruction.index + 1].data();
+                    const uint8_t* p = data + instruction.offset;
+                    uint8_t difference = 0;
+                    for (uint32_t i = 0; i < instruction.length; ++i) {
+                        difference |= (p[i] ^ expected[i]) & mask[i];
+                    }
+                    result = (difference == 0) != instruction.negate;
+                }
+                stack[top++] = result;
+                continue;
+            }
+            case FilterOp::Contains: {
+                bool result = false;
+                const Scanning::BytePattern& pattern = m_patterns[instruction.index];
+                if (instruction.offset <= dataSize) {
+                    const std::size_t available = std::min<std::size_t>(dataSize - instruction.offset, instruction.length);
+                    result = available >= pattern.Size() &&
+                             Scanning::FindFirst(data + instruction.offset, available, pattern).has_value();
+                }
+                stack[top++] = result;
+                continue;
+            }
+            case FilterOp::NameEquals:
+                stack[top++] = (packet.name == m_strings[instruction.index]) != instruction.negate;
+                continue;
+            case FilterOp::NameContains:
+                stack[top++] = packet.name.find(m_strings[instruction.index]) != std::string::npos;
+                continue;
+            case FilterOp::Field:
+            case FilterOp::FieldEquals:
+            case FilterOp::FieldContains:
+            case FilterOp::FieldExists: {
+                bool result = false;
+                const std::string& name = m_strings[instruction.index];
+                for (const Parsing::FieldSpan& span : getFields()) {
+                    if (!FieldLabelMatches(span.label, name)) {
+                        continue;
+                    }
+                    switch (instruction.op) {
+                    case FilterOp::Field:
+                        result = span.size <= 8 && InRange(instruction, LoadLittleEndian(data + span.offset, span.size));
+                        break;
+                    case FilterOp::FieldEquals:
+                        result = (span.value == m_strings[instruction.length]) != instruction.negate;
+                        break;
+                    case FilterOp::FieldContains:
+                        result = span.value.find(m_strings[instruction.length]) != std::string::npos;
+                        break;
+                    default:
+                        result = true;
+                        break;
+                    }
+                    if (result) {
+                        break;
+                    }
+                }
+                stack[top++] = result;
+                continue;
+            }
+
+            case FilterOp::And:
+                --top;
+                stack[top - 1] &= stack[top];
+                continue;
+            case FilterOp::Or:
+                --top;
+                stack[top - 1] |= stack[top];
+                continue;
+            case FilterOp::Not:
+                stack[top - 1] ^= 1;
+                continue;
+            case FilterOp::AndThen:
+            case FilterOp::OrElse:
+                if ((stack[top - 1] != 0) == (instruction.op == FilterOp::OrElse)) {
+                    pc = instruction.index - 1; // Decided: keep the value, skip the right operand
+                } else {
+                    --top;
+                }
+                continue;
+            }
+            stack[top++] = valid & InRange(instruction, value);
+        }
+        return top > 0 && stack[0] != 0;
+    }
+
+    std::string FilterProgram::Disassemble() const {
+        std::string text;
+        char line[160];
+        for (std::size_t pc = 0; pc < m_code.size(); ++pc) {
+            const FilterInstruction& instruction = m_code[pc];
+            int length = std::snprintf(line, sizeof(line), "%3zu  %-10s", pc, GetOpName(instruction.op));
+            auto append = [&](const char* format, auto... args) {
+                if (length >= 0 && static_cast<std::size_t>(length) < sizeof(line)) {
+                    length += std::snprintf(line + length, sizeof(line) - length, format, args...);
+                }
+            };
+            if (instruction.negate) {
+                append(" not");
+            }
+            switch (instruction.op) {
+            case FilterOp::LoadLE:
+            case FilterOp::LoadBE:
+                append(" [+%u, %u bytes]", instruction.offset, static_cast<unsigned>(instruction.width));
+                break;
+            case FilterOp::Bytes:
+            case FilterOp::Contains:
+                if (instruction.length == TO_END) {
+                    append(" [+%u:]", instruction.offset);
+                } else {
+                    append(" [+%u, %u bytes]", instruction.offset, instruction.length);
+                }
+                if (instruction.op == FilterOp::Contains) {
+                    append(" \"%s\"", m_patterns[instruction.index].ToString().c_str());
+                }
+                break;
+            case FilterOp::OpcodeSet:
+                append(" table %u", instruction.index);
+                break;
+            case FilterOp::NameEquals:
+            case FilterOp::NameContains:
+                append(" \"%s\"", m_strings[instruction.index].c_str());
+                break;
+            case FilterOp::Field:
+            case FilterOp::FieldExists:
+                append(" \"%s\"", m_strings[instruction.index].c_str());
+                break;
+            case FilterOp::FieldEquals:
+            case FilterOp::FieldContains:
+                append(" \"%s\" \"%s\"", m_strings[instruction.index].c_str(), m_strings[instruction.length].c_str());
+                break;
+            case FilterOp::AndThen:
+            case FilterOp::OrElse:
+                append(" -> %u", instruction.index);
+                break;
+            default:
+                break;
+            }
+            if (IsNumericOp(instruction.op)) {
+                if (instruction.mask != ~0ull) {
+                    append(" & 0x%llX", static_cast<unsigned long long>(instruction.mask));
+                }
+                if (instruction.bias) {
+                    append(" ^ 0x%llX", static_cast<unsigned long long>(instruction.bias));
+                }
+                append(" in [0x%llX, 0x%llX]", static_cast<unsigned long long>(instruction.lo),
+                       static_cast<unsigned long long>(instruction.lo + instruction.span));
+            }
+            text += line;
+            text += '\n';
+        }
+        return text;
+    }
+
+} // namespace kx::Filtering
@@ -0,0 +1,123 @@
+#pragma once
+
+/**
+ * @file FilterExpression.h
+ * @brief Text filter expressions for the packet log, compiled to a small bytecode.
+ * @details Examples:
+ *
+ *              recv && op in {0x0012, 0x0100..0x01FF} && size >= 64
+ *              data[4:8] == 0xDEADBEEF              // bytes DE AD BE EF, in written order
+ *              u32[4] & 0xFFFF0000 == 0x12340000    // little-endian read, masked
+ *              data ~ "DE ? BE EF" || name ~ "Agent"
+ *              time in 21:30..00:15 && !(field("Agent ID") == 42)
+ *
+ *          Subjects: `op` (opcode), `size`, `time` (local time of day, HH:MM[:SS[.ffffff]]),
+ *          `data[a]` (byte), `data[a:b]` (big-endian as written, any length for == and !=),
+ *          `u8/u16/u32/u64[a]` and `i8..i64[a]` (little-endian at offset a), `field("x")`
+ *          (little-endian value of a decoded field, FieldLayouts.h; `x` is a label, schema
+ *          path or schema field name, and any field of that name may satisfy the test)
+ *          and `name`. Comparisons are == != < <= > >=, `in {v, lo..hi}` (a `time`
+ *          window whose start is after its end wraps past midnight), `~ "pattern"` (the
+ *          bytes contain an IDA-style pattern, PatternSearch.h) or `~ "text"` (the name or
+ *          field value contains the text). Numeric subjects take an optional `& mask`.
+ *          Combine with `&&`/`and`, `||`/`or`, `!`/`not` and parentheses; `sent`, `recv`,
+ *          `true` and `false` stand alone. A predicate whose bytes lie past the end of
+ *          the payload, or whose field is absent, is false.
+ *
+ *          Every numeric test compiles to one instruction evaluated as the same unsigned
+ *          range check, ((value & mask) ^ bias) - lo <= hi - lo, without branching on the
+ *          operator; opcode sets become a 64K-bit table. Cheap operands of && and || are
+ *          combined without jumps; only scans, field decoding and string tests get
+ *          short-circuit jumps. Nothing here depends on Windows.
+ */
+
+#include "PacketData.h"
+#include "PatternSearch.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kx::Filtering {
+
+    // Values an expression may have on its evaluation stack at once.
+    constexpr std::size_t FILTER_MAX_STACK_DEPTH = 64;
+
+    enum class FilterOp : uint8_t {
+        Push,        // Constant (negate: false)
+        Direction,   // Packet was sent (negate: received)
+        Opcode,      // Numeric: rawHeaderId
+        OpcodeSet,   // rawHeaderId (masked) in opcode table `index`
+        Size,        // Numeric: PacketInfo::size
+        TimeOfDay,   // Numeric: microseconds since local midnight
+        LoadLE,      // Numeric: `width` bytes at `offset`, little-endian
+        LoadBE,      // Numeric: `width` bytes at `offset`, big-endian
+        Bytes,       // Masked equality of the bytes at `offset` with bytes constant `index`
+        Contains,    // Pattern `index` occurs in data[offset, offset + length)
+        NameEquals,  // PacketInfo::name == string `index`
+        NameContains,
+        Field,       // Numeric: a field named by string `index`, little-endian
+        FieldEquals, // Formatted value of a field named by string `index` == string `length`
+        FieldContains,
+        FieldExists,
+        And,         // Pops two values, pushes their conjunction
+        Or,
+        Not,
+        AndThen,     // If the top is false, jumps to `index` keeping it; else pops it
+        OrElse       // If the top is true, jumps to `index` keeping it; else pops it
+    };
+
+    struct FilterInstruction {
+        FilterOp op = FilterOp::Push;
+        bool negate = false;
+        uint8_t width = 0;   // Bytes read by LoadLE/LoadBE
+        uint32_t offset = 0; // Payload offset
+        uint32_t index = 0;  // Constant pool index or jump target
+        uint32_t length = 0; // Contains: bytes searched; FieldEquals/FieldContains: string index
+        uint64_t mask = ~0ull;
+        uint64_t bias = 0;   // XORed in after the mask; maps signed values to unsigned order
+        uint64_t lo = 0;
+        uint64_t span = 0;   // hi - lo
+    };
+
+    /**
+     * @brief A compiled filter expression. Immutable and safe to share between threads.
+     */
+    class FilterProgram {
+    public:
+        /**
+         * @brief Compiles `text`.
+         * @param error Receives a description, with the character position, if it is invalid.
+         * @return The program, or std::nullopt if the text is empty or invalid.
+         */
+        static std::optional<FilterProgram> Compile(std::string_view text, std::string* error = nullptr);
+
+        bool Matches(const PacketInfo& packet) const;
+
+        // True if the expression decodes fields (field(...)), which costs far more per packet.
+        bool UsesFields() const { return m_usesFields; }
+
+        const std::string& GetText() const { return m_text; }
+        const std::vector<FilterInstruction>& GetCode() const { return m_code; }
+
+        // One instruction per line, for tools and diagnostics.
+        std::string Disassemble() const;
+
+    private:
+        friend class FilterCompiler;
+
+        std::string m_text;
+        std::vector<FilterInstruction> m_code;
+        std::vector<std::array<uint64_t, 0x10000 / 64>> m_opcodeSets;
+        std::vector<std::vector<uint8_t>> m_byteValues; // Bytes constants; their masks follow at index + 1
+        std::vector<Scanning::BytePattern> m_patterns;
+        std::vector<std::string> m_strings;
+        int64_t m_utcOffsetUs = 0; // Local time offset when compiled, for TimeOfDay
+        bool m_usesFields = false;
+    };
+
+} // namespace kx::Filtering
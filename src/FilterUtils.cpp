@@ -1,4 +1,5 @@
 #include "FilterUtils.h"
+#include "FilterExpression.h"
 #include "PacketHeaders.h" // For GetPacketName, GetSpecialPacketTypeName (needed indirectly for filter map keys)
 
 namespace kx::Filtering {
@@ -52,22 +53,27 @@ namespace kx::Filtering {
             }
         }
 
+        // 3. Apply the filter expression, if any
+        if (kx::g_displayFilterExpression && !kx::g_displayFilterExpression->Matches(packet)) {
+            return false;
+        }
+
         // If all checks passed, display the packet
         return true;
     }
 
 
-    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog) {
-        std::vector<int> filteredIndices;
-        // Reserve likely size? Maybe not necessary if filtering is aggressive.
-        // filteredIndices.reserve(fullLog.size() / 2); // Example guess
-
-        for (int i = 0; i < fullLog.size(); ++i) {
-            if (ShouldDisplayPacket(fullLog[i])) {
-                filteredIndices.push_back(i);
-            }
+    void SyncHeaderFilterSelection() {
+        bool added = false;
+        for (const auto& headerInfo : kx::GetKnownCMSGHeaders()) {
+            added |= kx::g_packetHeaderFilterSelection.try_emplace(std::make_pair(kx::PacketDirection::Sent, headerInfo.first), false).second;
+        }
+        for (const auto& headerInfo : kx::GetKnownSMSGHeaders()) {
+            added |= kx::g_packetHeaderFilterSelection.try_emplace(std::make_pair(kx::PacketDirection::Received, headerInfo.first), false).second;
+        }
+        if (added) {
+            kx::g_filterStateVersion++;
         }
-        return filteredIndices;
     }
 
 } // namespace kx::Filtering
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "FilterView.h"
+#include "AppState.h"
+#include "ThreadPool.h"
+
+namespace kx::Filtering {
+
+    namespace {
+        // Below this many packets a serial scan beats scheduling pool tasks.
+        constexpr std::size_t PARALLEL_FILTER_GRAIN = 64 * 1024;
+
+        void SetAll(std::array<uint64_t, 2 * 0x10000 / 64>& bits, std::size_t dir, bool value) {
+            const std::size_t wordsPerDirection = bits.size() / 2;
+            for (std::size_t i = 0; i < wordsPerDirection; ++i) {
+                bits[dir * wordsPerDirection + i] = value ? ~0ull : 0ull;
+            }
+        }
+
+        void SetBit(uint64_t& word, std::size_t bit, bool value) {
+            if (value) {
+                word |= 1ull << bit;
+            } else {
+                word &= ~(1ull << bit);
+            }
+        }
+    }
+
+    CompiledFilter CompiledFilter::FromCurrentState() {
+        CompiledFilter filter;
+        filter.m_expression = g_displayFilterExpression;
+        const bool showAll = g_packetFilterMode == FilterMode::ShowAll;
+        const bool includeOnly = g_packetFilterMode == FilterMode::IncludeOnly;
+
+        for (std::size_t dir = 0; dir < 2; ++dir) {
+            const PacketDirection direction = dir == 0 ? PacketDirection::Sent : PacketDirection::Received;
+            if ((g_packetDirectionFilterMode == DirectionFilterMode::ShowSentOnly && direction != PacketDirection::Sent) ||
+                (g_packetDirectionFilterMode == DirectionFilterMode::ShowReceivedOnly && direction != PacketDirection::Received)) {
+                continue; // Nothing in this direction passes
+            }
+
+            // Unlisted and unchecked entries: shown unless only checked entries are included.
+            SetAll(filter.m_headerBits, dir, !includeOnly);
+            filter.m_specialBits[dir] = includeOnly ? 0ull : ~0ull;
+            if (showAll) {
+                continue;
+            }
+
+            // Checked entries: shown in Include mode, hidden in Exclude mode.
+            for (const auto& [key, checked] : g_packetHeaderFilterSelection) {
+                if (checked && key.first == direction) {
+                    const std::size_t bit = (dir << 16) | key.second;
+                    SetBit(filter.m_headerBits[bit >> 6], bit & 63, includeOnly);
+                }
+            }
+            for (const auto& [type, checked] : g_specialPacketFilterSelection) {
+                if (checked) {
+                    SetBit(filter.m_specialBits[dir], static_cast<std::size_t>(type), includeOnly);
+                }
+            }
+        }
+        return filter;
+    }
+
+    void FilterView::Update(const PacketStore& store) {
+        const uint64_t generation = store.GetGeneration();
+        const std::size_t count = store.Size();
+
+        if (generation != m_storeGeneration || g_filterStateVersion != m_filterVersion) {
+            if (generation != m_storeGeneration) {
+                // The old indices point at cleared packets; show nothing until the rebuild lands.
+                m_version++;
+                m_indices.clear();
+                m_scanned = 0;
+            }
+            m_storeGeneration = generation;
+            m_filterVersion = g_filterStateVersion;
+            m_filter = CompiledFilter::FromCurrentState();
+            Rebuild(store, count);
+            return;
+        }
+
+        if (m_job) {
+            if (!m_job->done.load(std::memory_order_acquire)) {
+                return; // New packets are scanned once the rebuilt indices are in
+            }
+            const bool current = m_job->storeGeneration == generation && !m_job->cancelled.load(std::memory_order_relaxed);
+            if (current) {
+                m_version++;
+                m_indices = std::move(m_job->indices);
+                m_scanned = m_job->count;
+            }
+            m_job.reset();
+            if (!current) {
+                Rebuild(store, count); // The store was cleared under the job
+                return;
+            }
+        }
+
+        // Common case: test only the packets that arrived since the last frame.
+        ScanNewPackets(store, count);
+    }
+
+    void FilterView::Reset() {
+        CancelJob();
+        m_version++;
+        m_indices.clear();
+        m_scanned = 0;
+        m_storeGeneration = UINT64_MAX;
+    }
+
+    void FilterView::ScanNewPackets(const PacketStore& store, std::size_t count) {
+        for (std::size_t i = m_scanned; i < count; ++i) {
+            if (m_filter.Passes(store[i])) {
+                m_indices.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        m_scanned = count;
+    }
+
+    void FilterView::CancelJob() {
+        if (m_job) {
+            m_job->cancelled.store(true, std::memory_order_relaxed); // It finishes into its own buffer
+            m_job.reset();
+        }
+    }
+
+    void FilterView::Rebuild(const PacketStore& store, std::size_t count) {
+        CancelJob();
+        if (count > PARALLEL_FILTER_GRAIN) {
+            StartRebuildJob(store, count);
+            return;
+        }
+        m_version++;
+        m_indices.clear();
+        m_scanned = 0;
+        ScanNewPackets(store, count);
+    }
+
+    void FilterView::StartRebuildJob(const PacketStore& store, std::size_t count) {
+        // The job owns a copy of the filter and its output, so a superseded job can finish
+        // after the view has moved on.
+        std::shared_ptr<RebuildJob> job = std::make_shared<RebuildJob>();
+        job->filter = m_filter;
+        job->storeGeneration = m_storeGeneration;
+        job->count = count;
+        m_job = job;
+
+        Threading::ThreadPool& pool = Threading::GetBackgroundPool();
+        pool.Submit([job, &store, &pool]() {
+            // Each chunk fills its own vector; concatenating in chunk order keeps the view sorted.
+            const std::size_t chunkCount = (job->count + PARALLEL_FILTER_GRAIN - 1) / PARALLEL_FILTER_GRAIN;
+            std::vector<std::vector<uint32_t>> chunkIndices(chunkCount);
+            pool.ParallelFor(job->count, PARALLEL_FILTER_GRAIN, [&](std::size_t begin, std::size_t end) {
+                if (job->cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                // Held per chunk, so a Clear() on the render thread waits for one chunk at most.
+                auto lock = store.LockForReading();
+                if (store.GetGeneration() != job->storeGeneration) {
+                    job->cancelled.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                std::vector<uint32_t>& out = chunkIndices[begin / PARALLEL_FILTER_GRAIN];
+                out.reserve(end - begin);
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (job->filter.Passes(store[i])) {
+                        out.push_back(static_cast<uint32_t>(i));
+                    }
+                }
+            });
+
+            if (!job->cancelled.load(std::memory_order_relaxed)) {
+                std::size_t total = 0;
+                for (const std::vector<uint32_t>& chunk : chunkIndices) {
+                    total += chunk.size();
+                }
+                job->indices.reserve(total);
+                for (const std::vector<uint32_t>& chunk : chunkIndices) {
+                    job->indices.insert(job->indices.end(), chunk.begin(), chunk.end());
+                }
+            }
+            job->done.store(true, std::memory_order_release);
+        });
+    }
+
+} // namespace kx::Filtering
@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+ * @file FilterView.h
+ * @brief Incrementally maintained list of the packets that pass the display filters.
+ * @details The filter settings (AppState.h) are compiled into flat bitsets, so testing a
+ *          packet is two shifts and a load instead of two std::map lookups. The view
+ *          remembers how far into the packet store it has scanned: each frame only the
+ *          packets appended since the last frame are tested. A full rebuild happens only
+ *          when the filter state version or the store generation changes. Large rebuilds
+ *          run as a background job, split into chunks on the background pool, while the
+ *          view keeps its previous indices; the result is swapped in by a later Update().
+ *          A filter expression, if set, is evaluated only for packets the bitsets let through.
+ */
+
+#include "FilterExpression.h"
+#include "PacketData.h"
+#include "PacketStore.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace kx::Filtering {
+
+    /**
+     * @brief Snapshot of the global filter settings in a form that is cheap to evaluate.
+     * @details Gives the same answers as ShouldDisplayPacket() for the state it was compiled from.
+     */
+    class CompiledFilter {
+    public:
+        /**
+         * @brief Compiles the current global filter state. Render thread only.
+         */
+        static CompiledFilter FromCurrentState();
+
+        bool Passes(const PacketInfo& packet) const {
+            const std::size_t dir = packet.direction == PacketDirection::Sent ? 0 : 1;
+            bool passes;
+            if (packet.specialType == InternalPacketType::NORMAL) {
+                const std::size_t bit = (dir << 16) | packet.rawHeaderId;
+                passes = (m_headerBits[bit >> 6] >> (bit & 63)) & 1;
+            } else {
+                passes = (m_specialBits[dir] >> static_cast<unsigned>(packet.specialType)) & 1;
+            }
+            return passes && (!m_expression || m_expression->Matches(packet));
+        }
+
+    private:
+        std::array<uint64_t, 2 * 0x10000 / 64> m_headerBits{}; // Indexed by (direction << 16) | opcode
+        std::array<uint64_t, 2> m_specialBits{};               // Indexed by direction, bit per special type
+        std::shared_ptr<const FilterProgram> m_expression;     // g_displayFilterExpression when compiled
+    };
+
+    /**
+     * @brief The store indices of the packets that pass the current display filters.
+     * @details Render thread only. The render thread never waits for the pool, whose
+     *          workers run at low priority; rebuild chunks hold the store's reader lock.
+     */
+    class FilterView {
+    public:
+        /**
+         * @brief Brings the view up to date with the store and the filter state version.
+         */
+        void Update(const PacketStore& store);
+
+        /**
+         * @brief Drops all indices, e.g. right after clearing the store.
+         */
+        void Reset();
+
+        const std::vector<uint32_t>& GetIndices() const { return m_indices; }
+        std::size_t GetScannedCount() const { return m_scanned; }
+
+        // Changes whenever the indices are rebuilt or reset; between changes they are only appended to.
+        uint64_t GetVersion() const { return m_version; }
+
+        // True while a background rebuild runs; until it finishes the previous indices are shown.
+        bool IsRebuilding() const { return m_job != nullptr; }
+
+    private:
+        struct RebuildJob {
+            CompiledFilter filter;
+            uint64_t storeGeneration = 0;
+            std::size_t count = 0;
+            std::vector<uint32_t> indices;
+            std::atomic<bool> cancelled{ false };
+            std::atomic<bool> done{ false };
+        };
+
+        void Rebuild(const PacketStore& store, std::size_t count);
+        void StartRebuildJob(const PacketStore& store, std::size_t count);
+        void ScanNewPackets(const PacketStore& store, std::size_t count);
+        void CancelJob();
+
+        CompiledFilter m_filter;
+        std::vector<uint32_t> m_indices;
+        std::size_t m_scanned = 0;                // Store packets already tested
+        uint64_t m_storeGeneration = UINT64_MAX;  // Forces a rebuild on first use
+        uint64_t m_filterVersion = UINT64_MAX;
+        uint64_t m_version = 0;
+        std::shared_ptr<RebuildJob> m_job; // Background rebuild in progress
+    };
+
+} // namespace kx::Filtering
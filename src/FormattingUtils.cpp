@@ -1,7 +1,7 @@
 #include "FormattingUtils.h"
-#include <sstream>
-#include <iomanip>
-#include <ctime>
+#include "HexFormatter.h"
+#include "TimestampFormatter.h"
+#include <charconv>
 
 // Include PacketData.h again here for the implementation details of PacketInfo if needed,
 // although it's already included via the header. Best practice includes what you use.
@@ -11,96 +11,68 @@ namespace kx::Utils {
 
     // --- Function Implementations ---
 
-    std::string FormatTimestamp(const std::chrono::system_clock::time_point& tp) {
-        // Convert to time_t for HH:MM:SS
-        std::time_t time = std::chrono::system_clock::to_time_t(tp);
-        std::tm local_tm;
-        localtime_s(&local_tm, &time); // Use safe version
-
-        // Get milliseconds
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()) % 1000;
-
-        std::stringstream ss;
-        // Format HH:MM:SS
-        ss << std::put_time(&local_tm, "%H:%M:%S");
-        // Append milliseconds, padded with zeros
-        ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-
-        return ss.str();
+    std::string FormatTimestamp(const std::chrono::system_clock::time_point& tp, TimestampFormat format) {
+        char buffer[TIMESTAMP_BUFFER_SIZE];
+        return std::string(buffer, FormatTimestampTo(tp, format, buffer));
     }
 
     std::string FormatBytesToHex(const std::vector<uint8_t>& data, int maxBytes) {
-        std::stringstream ss;
-        int count = 0;
-        bool truncated = false; // Flag to check if truncation happened
-
-        for (const auto& byte : data) {
-            // Apply maxBytes limit (only if positive)
-            if (maxBytes > 0 && count >= maxBytes) {
-                ss << "...";
-                truncated = true;
-                break; // Stop processing bytes
-            }
-
-            if (count > 0) ss << " "; // Add space before the next byte (if not the first)
-
-            ss << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
-            count++;
-        }
-
-        // Handle edge cases for display string
         if (data.empty()) {
             return "(empty)";
         }
-        // If maxBytes forced truncation and no bytes were printed (e.g., maxBytes=0)
-        if (count == 0 && maxBytes == 0 && !data.empty()) {
-            return "...";
-        }
-        // If data exists, but limit was 0 or negative, and nothing printed (shouldn't happen with loop fix)
-        if (ss.str().empty() && !data.empty() && !truncated) {
-            // This case might indicate an issue, but return something sensible.
-            // If maxBytes <= 0, it should have printed everything.
-            return "(Error Formatting Hex?)"; // Or return empty string ""
-        }
 
-
-        return ss.str();
+        HexFormatOptions options;
+        options.maxBytes = maxBytes > 0 ? static_cast<std::size_t>(maxBytes) : 0; // <= 0: no limit
+        std::string hex;
+        AppendHex(hex, data.data(), data.size(), options);
+        return hex;
     }
 
-    std::string FormatDisplayLogEntryString(const PacketInfo& packet, int maxHexBytes) {
-        std::string timestampStr = FormatTimestamp(packet.timestamp);
-        const char* directionStr = (packet.direction == PacketDirection::Sent) ? "[S]" : "[R]";
-        int displaySize = static_cast<int>(packet.data.size());
+    void AppendLogEntryString(std::string& out, const PacketInfo& packet, int maxHexBytes, TimestampFormat timestampFormat) {
+        static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
 
-        std::string dataHexStr = FormatBytesToHex(packet.data, maxHexBytes);
+        HexFormatOptions hexOptions;
+        hexOptions.maxBytes = maxHexBytes > 0 ? static_cast<std::size_t>(maxHexBytes) : 0; // <= 0: no limit
 
-        std::stringstream ss;
-        ss << timestampStr << " "         // Timestamp (HH:MM:SS.mmm)
-            << directionStr << " "         // Direction ([S] or [R])
-            << packet.name << " "          // Resolved Name
-            << "Op:0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << packet.rawHeaderId << std::dec // Opcode (Op:0xABCD)
-            << " | Sz:" << displaySize     // Size (Sz:N)
-            << " | " << dataHexStr;        // Hex Data (potentially truncated)
+        if (out.empty()) { // Appending callers manage their own buffer growth
+            out.reserve(64 + packet.name.size() + GetHexBufferSize(packet.data.size(), hexOptions));
+        }
 
-        return ss.str();
+        AppendTimestamp(out, packet.timestamp, timestampFormat);
+        out += (packet.direction == PacketDirection::Sent) ? " [S] " : " [R] ";
+        out += packet.name;
+
+        const uint16_t opcode = packet.rawHeaderId;
+        const char opcodeText[] = {
+            ' ', 'O', 'p', ':', '0', 'x',
+            HEX_DIGITS[(opcode >> 12) & 0xF], HEX_DIGITS[(opcode >> 8) & 0xF],
+            HEX_DIGITS[(opcode >> 4) & 0xF], HEX_DIGITS[opcode & 0xF]
+        };
+        out.append(opcodeText, sizeof(opcodeText));
+
+        char sizeText[24];
+        const auto sizeResult = std::to_chars(sizeText, sizeText + sizeof(sizeText), packet.data.size());
+        out += " | Sz:";
+        out.append(sizeText, sizeResult.ptr);
+        out += " | ";
+
+        if (packet.data.empty()) {
+            out += "(empty)";
+        } else {
+            AppendHex(out, packet.data.data(), packet.data.size(), hexOptions);
+        }
     }
 
-    std::string FormatFullLogEntryString(const PacketInfo& packet) {
-        std::string timestampStr = FormatTimestamp(packet.timestamp);
-        const char* directionStr = (packet.direction == PacketDirection::Sent) ? "[S]" : "[R]";
-        int displaySize = static_cast<int>(packet.data.size());
-
-        std::string dataHexStr = FormatBytesToHex(packet.data, -1); // Format full hex data
-
-        std::stringstream ss;
-        ss << timestampStr << " "         // Timestamp (HH:MM:SS.mmm)
-            << directionStr << " "         // Direction ([S] or [R])
-            << packet.name << " "          // Resolved Name
-            << "Op:0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << packet.rawHeaderId << std::dec // Opcode (Op:0xABCD)
-            << " | Sz:" << displaySize     // Size (Sz:N)
-            << " | " << dataHexStr;        // Hex Data (full)
+    std::string FormatDisplayLogEntryString(const PacketInfo& packet, int maxHexBytes, TimestampFormat timestampFormat) {
+        std::string entry;
+        AppendLogEntryString(entry, packet, maxHexBytes, timestampFormat);
+        return entry;
+    }
 
-        return ss.str();
+    std::string FormatFullLogEntryString(const PacketInfo& packet, TimestampFormat timestampFormat) {
+        std::string entry;
+        AppendLogEntryString(entry, packet, -1, timestampFormat); // Full hex data
+        return entry;
     }
 
 } // namespace kx::Utils
\ No newline at end of file
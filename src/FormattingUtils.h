@@ -8,15 +8,17 @@
 // Forward declare PacketInfo to avoid including PacketData.h in the header if possible,
 // but since the function signature requires it, we must include it.
 #include "PacketData.h" // Include necessary dependencies for function signatures
+#include "AppState.h"   // For TimestampFormat
 
 namespace kx::Utils {
 
     /**
      * @brief Formats a system time point into HH:MM:SS string.
      * @param tp The time point to format.
+     * @param format Sub-second precision (milliseconds or microseconds).
      * @return Formatted time string.
      */
-    std::string FormatTimestamp(const std::chrono::system_clock::time_point& tp);
+    std::string FormatTimestamp(const std::chrono::system_clock::time_point& tp, TimestampFormat format = TimestampFormat::Millis);
 
     /**
      * @brief Formats a vector of bytes into a space-separated hex string.
@@ -26,19 +28,30 @@ namespace kx::Utils {
      */
     std::string FormatBytesToHex(const std::vector<uint8_t>& data, int maxBytes = 32);
 
+    /**
+     * @brief Appends a log entry ("HH:MM:SS.mmm [S] Name Op:0xABCD | Sz:N | hex") to `out`.
+     * @details Shared by the list rows, the copy actions and the file export.
+     * @param maxHexBytes Max hex bytes before truncating with "...". <= 0 means no limit.
+     */
+    void AppendLogEntryString(std::string& out, const PacketInfo& packet, int maxHexBytes,
+                              TimestampFormat timestampFormat = TimestampFormat::Millis);
+
     /**
      * @brief Formats a PacketInfo for display (potentially truncated hex).
      * @param packet The PacketInfo object.
      * @param maxHexBytes Max hex bytes to display before adding "...".
+     * @param timestampFormat Sub-second precision of the timestamp.
      * @return A formatted string for the log display.
      */
-    std::string FormatDisplayLogEntryString(const PacketInfo& packet, int maxHexBytes = 32);
+    std::string FormatDisplayLogEntryString(const PacketInfo& packet, int maxHexBytes = 32,
+                                            TimestampFormat timestampFormat = TimestampFormat::Millis);
 
     /**
      * @brief Formats a PacketInfo for copying (full, untruncated hex).
      * @param packet The PacketInfo object.
+     * @param timestampFormat Should be g_timestampFormat, so copies match the log on screen.
      * @return A formatted string with the complete hex data.
      */
-    std::string FormatFullLogEntryString(const PacketInfo& packet);
+    std::string FormatFullLogEntryString(const PacketInfo& packet, TimestampFormat timestampFormat);
 
 } // namespace kx::Utils
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "FrameBudget.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace kx::Gui {
+
+    namespace {
+        struct LevelSettings {
+            uint32_t viewRefreshInterval;
+            uint32_t statsRefreshInterval;
+            int hexByteLimit;           // 0: as configured
+            std::size_t hexViewerLines;
+        };
+
+        constexpr std::array<LevelSettings, FrameBudget::MAX_LEVEL + 1> LEVELS = { {
+            { 1, 1, 0, 16 },
+            { 2, 10, 32, 16 },
+            { 4, 30, 16, 8 },
+            { 8, 60, 8, 4 },
+        } };
+
+        constexpr float AVERAGE_WEIGHT = 0.1f;   // Weight of the newest frame in the moving average
+        constexpr uint32_t RAISE_AFTER_FRAMES = 15;  // Minimum frames at a level before degrading further
+        constexpr uint32_t LOWER_AFTER_FRAMES = 120; // ...and before restoring a level
+        constexpr float LOWER_BELOW_FRACTION = 0.5f; // Restore only when this far under budget
+        constexpr uint32_t PEAK_WINDOW_FRAMES = 120;
+
+        int64_t GetTimeNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    void FrameBudget::BeginFrame() {
+        m_frameStart = GetTimeNs();
+    }
+
+    void FrameBudget::EndFrame(float budgetMs, bool adaptive) {
+        m_lastMs = static_cast<float>(GetTimeNs() - m_frameStart) / 1.0e6f;
+        m_averageMs = m_frameIndex == 0 ? m_lastMs : m_averageMs + (m_lastMs - m_averageMs) * AVERAGE_WEIGHT;
+        m_frameIndex++;
+
+        m_windowPeakMs = std::max(m_windowPeakMs, m_lastMs);
+        if (++m_windowFrames >= PEAK_WINDOW_FRAMES) {
+            m_peakMs = m_windowPeakMs;
+            m_windowPeakMs = 0.0f;
+            m_windowFrames = 0;
+        }
+
+        m_framesAtLevel++;
+        int level = m_level;
+        if (!adaptive) {
+            level = 0;
+        } else if (m_averageMs > budgetMs && m_framesAtLevel >= RAISE_AFTER_FRAMES) {
+            level = std::min(m_level + 1, MAX_LEVEL);
+        } else if (m_averageMs < budgetMs * LOWER_BELOW_FRACTION && m_framesAtLevel >= LOWER_AFTER_FRAMES) {
+            level = std::max(m_level - 1, 0);
+        }
+        if (level != m_level) {
+            m_level = level;
+            m_framesAtLevel = 0;
+        }
+    }
+
+    uint32_t FrameBudget::GetViewRefreshInterval() const {
+        return LEVELS[m_level].viewRefreshInterval;
+    }
+
+    uint32_t FrameBudget::GetStatsRefreshInterval() const {
+        return LEVELS[m_level].statsRefreshInterval;
+    }
+
+    int FrameBudget::GetHexByteLimit(int requested) const {
+        const int limit = LEVELS[m_level].hexByteLimit;
+        return limit > 0 ? std::min(requested, limit) : requested;
+    }
+
+    std::size_t FrameBudget::GetHexViewerLines() const {
+        return LEVELS[m_level].hexViewerLines;
+    }
+
+} // namespace kx::Gui
@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * @file FrameBudget.h
+ * @brief Measures the overlay's CPU time per frame and picks how much work it may do.
+ * @details The whole overlay runs inside the game's Present call, so every microsecond
+ *          it takes is added to the game's frame time. The cost is smoothed with an
+ *          exponential moving average and compared against the configured budget.
+ *          Above budget the degradation level rises one step at a time (refresh the
+ *          filtered view and statistics less often, shorten hex previews); it falls
+ *          again only once the cost is well below budget for a while, so the level does
+ *          not flap between two settings. Render thread only.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kx::Gui {
+
+    class FrameBudget {
+    public:
+        static constexpr int MAX_LEVEL = 3;
+
+        /**
+         * @brief Starts timing a frame. Call before any overlay work.
+         */
+        void BeginFrame();
+
+        /**
+         * @brief Stops timing the frame and adjusts the degradation level.
+         * @param budgetMs Allowed overlay CPU time per frame.
+         * @param adaptive If false the level is held at 0 (cost is still measured).
+         */
+        void EndFrame(float budgetMs, bool adaptive);
+
+        int GetLevel() const { return m_level; }
+        uint64_t GetFrameIndex() const { return m_frameIndex; }
+        float GetLastMs() const { return m_lastMs; }
+        float GetAverageMs() const { return m_averageMs; }
+        float GetPeakMs() const { return m_peakMs; } // Highest cost of the previous window of frames
+
+        // Work allowed at the current level.
+        uint32_t GetViewRefreshInterval() const;  // Frames between filtered view updates
+        uint32_t GetStatsRefreshInterval() const; // Frames between statistics snapshots
+        int GetHexByteLimit(int requested) const; // Hex bytes per log row
+        std::size_t GetHexViewerLines() const;    // Lines of the payload hex view
+
+        // True on frames where work refreshed every `interval` frames should run.
+        bool IsDue(uint32_t interval) const { return m_frameIndex % interval == 0; }
+
+    private:
+        int64_t m_frameStart = 0;
+        uint64_t m_frameIndex = 0;
+        float m_lastMs = 0.0f;
+        float m_averageMs = 0.0f;
+        float m_peakMs = 0.0f;
+        float m_windowPeakMs = 0.0f;
+        uint32_t m_windowFrames = 0;
+        uint32_t m_framesAtLevel = 0;
+        int m_level = 0;
+    };
+
+} // namespace kx::Gui
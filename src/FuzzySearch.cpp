@@ -0,0 +1,185 @@
+#include "FuzzySearch.h"
+#include "CpuFeatures.h"
+#include "SectionScan.h"
+
+#include <algorithm>
+#include <bit>
+
+#if KX_ARCH_X64
+#include <immintrin.h>
+#endif
+
+namespace kx::Scanning {
+
+    namespace {
+        std::size_t CountScalar(const uint8_t* data, const BytePattern& pattern, std::size_t i) {
+            std::size_t mismatches = 0;
+            for (; i < pattern.Size(); ++i) {
+                mismatches += ((data[i] ^ pattern.bytes[i]) & pattern.mask[i]) != 0;
+            }
+            return mismatches;
+        }
+
+#if KX_ARCH_X64
+        // Bit i of the compare mask is set where byte i equals the pattern, bit i of the fixed
+        // mask where byte i is not a wildcard; mismatches are popcount(fixed & ~equal).
+        std::size_t CountSse2(const uint8_t* data, const BytePattern& pattern) {
+            std::size_t mismatches = 0;
+            std::size_t i = 0;
+            for (; i + 16 <= pattern.Size(); i += 16) {
+                const uint32_t equal = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.bytes.data() + i)))));
+                const uint32_t fixed = static_cast<uint32_t>(_mm_movemask_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.mask.data() + i))));
+                mismatches += static_cast<std::size_t>(std::popcount(fixed & ~equal));
+            }
+            return mismatches + CountScalar(data, pattern, i);
+        }
+
+        KX_TARGET_AVX2 std::size_t CountAvx2(const uint8_t* data, const BytePattern& pattern) {
+            std::size_t mismatches = 0;
+            std::size_t i = 0;
+            for (; i + 32 <= pattern.Size(); i += 32) {
+                const uint32_t equal = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern.bytes.data() + i)))));
+                const uint32_t fixed = static_cast<uint32_t>(_mm256_movemask_epi8(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern.mask.data() + i))));
+                mismatches += static_cast<std::size_t>(std::popcount(fixed & ~equal));
+            }
+            if (i + 16 <= pattern.Size()) {
+                const uint32_t equal = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.bytes.data() + i)))));
+                const uint32_t fixed = static_cast<uint32_t>(_mm_movemask_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.mask.data() + i))));
+                mismatches += static_cast<std::size_t>(std::popcount(fixed & ~equal));
+                i += 16;
+            }
+            return mismatches + CountScalar(data, pattern, i);
+        }
+#endif
+
+        std::size_t GetFixedByteCount(const BytePattern& pattern) {
+            return static_cast<std::size_t>(std::count(pattern.mask.begin(), pattern.mask.end(), 0xFF));
+        }
+
+        std::size_t ClampMismatches(const BytePattern& pattern, std::size_t maxMismatches) {
+            const std::size_t fixedBytes = GetFixedByteCount(pattern);
+            return std::min({ maxMismatches, MAX_FUZZY_MISMATCHES, fixedBytes - 1 });
+        }
+
+        // Splits the fixed bytes into maxMismatches + 1 runs of about equal length. Each segment
+        // is a full-length pattern with only its run fixed, so its matches are candidate starts.
+        PatternSet BuildSegments(const BytePattern& pattern, std::size_t maxMismatches) {
+            std::vector<std::size_t> fixedPositions;
+            for (std::size_t i = 0; i < pattern.Size(); ++i) {
+                if (pattern.mask[i]) {
+                    fixedPositions.push_back(i);
+                }
+            }
+            PatternSet segments;
+            const std::size_t segmentCount = maxMismatches + 1;
+            for (std::size_t segment = 0; segment < segmentCount; ++segment) {
+                const std::size_t first = segment * fixedPositions.size() / segmentCount;
+                const std::size_t last = (segment + 1) * fixedPositions.size() / segmentCount;
+                std::vector<uint8_t> mask(pattern.Size(), 0x00);
+                for (std::size_t i = first; i < last; ++i) {
+                    mask[fixedPositions[i]] = 0xFF;
+                }
+                segments.Add(*BytePattern::Create(pattern.bytes, std::move(mask)));
+            }
+            return segments;
+        }
+
+        std::vector<std::size_t> MergeCandidates(const auto& segmentMatches) {
+            std::vector<std::size_t> candidates;
+            for (const auto& matches : segmentMatches) {
+                candidates.insert(candidates.end(), matches.begin(), matches.end());
+            }
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            return candidates;
+        }
+    }
+
+    std::size_t SignatureUniqueness::GetNearMatchCount() const {
+        std::size_t count = 0;
+        for (std::size_t distance = 1; distance <= maxMismatches; ++distance) {
+            count += matchesAtDistance[distance];
+        }
+        return count;
+    }
+
+    std::size_t CountMismatches(const uint8_t* data, const BytePattern& pattern) {
+#if KX_ARCH_X64
+        return Cpu::GetFeatures().avx2 ? CountAvx2(data, pattern) : CountSse2(data, pattern);
+#else
+        return CountScalar(data, pattern, 0);
+#endif
+    }
+
+    std::vector<ApproximateMatch> FindApproximate(const uint8_t* data, std::size_t size, const BytePattern& pattern,
+                                                  std::size_t maxMismatches) {
+        maxMismatches = ClampMismatches(pattern, maxMismatches);
+        const PatternSet segments = BuildSegments(pattern, maxMismatches);
+
+        std::vector<ApproximateMatch> matches;
+        for (const std::size_t offset : MergeCandidates(segments.FindAll(data, size))) {
+            const std::size_t mismatches = CountMismatches(data + offset, pattern);
+            if (mismatches <= maxMismatches) {
+                matches.push_back({ offset, mismatches });
+            }
+        }
+        return matches;
+    }
+
+    std::vector<ApproximateMatch> FindApproximateInSections(const uint8_t* data, const PeImage& image, ScanTarget target,
+                                                            const BytePattern& pattern, std::size_t maxMismatches,
+                                                            Threading::ThreadPool& pool) {
+        maxMismatches = ClampMismatches(pattern, maxMismatches);
+        const PatternSet segments = BuildSegments(pattern, maxMismatches);
+
+        // Segment matches lie wholly inside a section, so the full pattern fits at each RVA.
+        std::vector<ApproximateMatch> matches;
+        for (const std::size_t rva : MergeCandidates(FindInSections(data, image, target, segments, pool))) {
+            const std::size_t mismatches = CountMismatches(data + *image.RvaToOffset(static_cast<uint32_t>(rva)), pattern);
+            if (mismatches <= maxMismatches) {
+                matches.push_back({ rva, mismatches });
+            }
+        }
+        return matches;
+    }
+
+    void RankApproximateMatches(std::vector<ApproximateMatch>& matches, std::optional<std::size_t> hint) {
+        auto distanceToHint = [hint](const ApproximateMatch& match) {
+            if (!hint) {
+                return std::size_t{ 0 };
+            }
+            return match.offset > *hint ? match.offset - *hint : *hint - match.offset;
+        };
+        std::sort(matches.begin(), matches.end(), [&](const ApproximateMatch& a, const ApproximateMatch& b) {
+            if (a.mismatches != b.mismatches) {
+                return a.mismatches < b.mismatches;
+            }
+            const std::size_t distanceA = distanceToHint(a);
+            const std::size_t distanceB = distanceToHint(b);
+            return distanceA != distanceB ? distanceA < distanceB : a.offset < b.offset;
+        });
+    }
+
+    SignatureUniqueness MeasureUniqueness(const BytePattern& pattern, std::size_t maxMismatches,
+                                          const std::vector<ApproximateMatch>& matches) {
+        SignatureUniqueness uniqueness;
+        uniqueness.fixedBytes = GetFixedByteCount(pattern);
+        uniqueness.maxMismatches = ClampMismatches(pattern, maxMismatches);
+        for (const ApproximateMatch& match : matches) {
+            if (match.mismatches <= uniqueness.maxMismatches) {
+                uniqueness.matchesAtDistance[match.mismatches]++;
+            }
+        }
+        return uniqueness;
+    }
+
+} // namespace kx::Scanning
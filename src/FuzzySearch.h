@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * @file FuzzySearch.h
+ * @brief Bounded-error pattern search: matches with up to k differing fixed bytes.
+ * @details Used as a fallback when a game patch breaks a signature. By the pigeonhole
+ *          principle, a match with at most k mismatches has at least one of k + 1 disjoint
+ *          segments of the pattern's fixed bytes intact, so the segments are searched
+ *          exactly (one PatternSet pass) and only their hits are scored. Scoring compares
+ *          32 (AVX2) or 16 (SSE2) bytes at a time and counts mismatched fixed bytes with a
+ *          popcount over the comparison mask. The counts of near matches at each distance
+ *          show how unique a signature is: a signature with many one-byte near matches is
+ *          likely to become ambiguous, or to be "found" at the wrong place by this fallback.
+ */
+
+#include "PatternSearch.h"
+#include "PeImage.h"
+#include "ThreadPool.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace kx::Scanning {
+
+    // k + 1 segments still fit the SIMD sweep of one PatternSet.
+    constexpr std::size_t MAX_FUZZY_MISMATCHES = PatternSet::MAX_SIMD_PATTERNS - 1;
+
+    struct ApproximateMatch {
+        std::size_t offset = 0;     // Buffer offset, or RVA for FindApproximateInSections
+        std::size_t mismatches = 0; // Fixed bytes that differ
+    };
+
+    // How distinct a signature is within the searched memory.
+    struct SignatureUniqueness {
+        std::size_t fixedBytes = 0;
+        std::size_t maxMismatches = 0;
+        std::array<std::size_t, MAX_FUZZY_MISMATCHES + 1> matchesAtDistance{}; // [0]: exact matches
+
+        std::size_t GetNearMatchCount() const; // Matches with 1..maxMismatches differing bytes
+    };
+
+    /**
+     * @brief Number of fixed bytes of `pattern` that differ at `data` (which must hold Size() bytes).
+     */
+    std::size_t CountMismatches(const uint8_t* data, const BytePattern& pattern);
+
+    /**
+     * @brief Every position in [data, data + size) where `pattern` matches with at most
+     *        `maxMismatches` differing fixed bytes, in ascending order.
+     * @details `maxMismatches` is clamped so that every segment keeps a fixed byte, and to
+     *          MAX_FUZZY_MISMATCHES.
+     */
+    std::vector<ApproximateMatch> FindApproximate(const uint8_t* data, std::size_t size, const BytePattern& pattern,
+                                                  std::size_t maxMismatches);
+
+    /**
+     * @brief FindApproximate over the `target` sections of `image` (see SectionScan.h); offsets are RVAs.
+     */
+    std::vector<ApproximateMatch> FindApproximateInSections(const uint8_t* data, const PeImage& image, ScanTarget target,
+                                                            const BytePattern& pattern, std::size_t maxMismatches,
+                                                            Threading::ThreadPool& pool);
+
+    /**
+     * @brief Orders matches best first: fewest mismatches, then closest to `hint` (e.g. the
+     *        address the signature resolved to in the previous build), then lowest offset.
+     */
+    void RankApproximateMatches(std::vector<ApproximateMatch>& matches, std::optional<std::size_t> hint);
+
+    SignatureUniqueness MeasureUniqueness(const BytePattern& pattern, std::size_t maxMismatches,
+                                          const std::vector<ApproximateMatch>& matches);
+
+} // namespace kx::Scanning
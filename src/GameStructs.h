@@ -140,4 +140,35 @@ namespace kx::GameStructs {
      * @brief Offset within the Message Definition struct to the size of the message payload. (uint32_t)
      */
     inline constexpr std::ptrdiff_t MSG_DEF_SIZE_OFFSET = 0x20;
+
+
+    // --- Schema Field Definition Offsets ---
+    // The Message Definition is an array of field definitions walked by `MsgUnpack::ParseWithSchema`,
+    // terminated by a typecode of 0 or 0x18. Offsets are relative to one field definition.
+
+    /**
+     * @brief Size of one field definition; the stride of the schema array.
+     */
+    inline constexpr std::size_t SCHEMA_FIELD_DEF_SIZE = 0x28;
+
+    /**
+     * @brief Offset to the field typecode. (uint32_t)
+     */
+    inline constexpr std::ptrdiff_t SCHEMA_FIELD_TYPE_OFFSET = 0x00;
+
+    /**
+     * @brief Offset to the fixed count, or maximum count/length for variable fields. (uint32_t)
+     */
+    inline constexpr std::ptrdiff_t SCHEMA_FIELD_COUNT_OFFSET = 0x10;
+
+    /**
+     * @brief Offset to the sub-schema pointer used by optional and array fields. (void**)
+     */
+    inline constexpr std::ptrdiff_t SCHEMA_FIELD_SUB_SCHEMA_OFFSET = 0x18;
+
+    /**
+     * @brief Offset to the unpacked size of one sub-schema element. (uint32_t)
+     * @details For the first field of a message this is the same slot as MSG_DEF_SIZE_OFFSET.
+     */
+    inline constexpr std::ptrdiff_t SCHEMA_FIELD_ELEMENT_SIZE_OFFSET = 0x20;
 }
\ No newline at end of file
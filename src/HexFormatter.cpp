@@ -0,0 +1,191 @@
+#include "HexFormatter.h"
+#include "CpuFeatures.h"
+
+#include <array>
+#include <cstring>
+
+#if KX_ARCH_X64
+#include <immintrin.h>
+#endif
+
+namespace kx::Utils {
+
+    namespace {
+        constexpr char UPPER_DIGITS[] = "0123456789ABCDEF";
+        constexpr char LOWER_DIGITS[] = "0123456789abcdef";
+
+        // Two characters per byte value: 512 bytes per table.
+        constexpr std::array<char, 512> MakePairTable(const char* digits) {
+            std::array<char, 512> table{};
+            for (std::size_t i = 0; i < 256; ++i) {
+                table[i * 2] = digits[i >> 4];
+                table[i * 2 + 1] = digits[i & 0x0F];
+            }
+            return table;
+        }
+
+        constexpr std::array<char, 512> UPPER_PAIRS = MakePairTable(UPPER_DIGITS);
+        constexpr std::array<char, 512> LOWER_PAIRS = MakePairTable(LOWER_DIGITS);
+
+        // Writes bytes [begin, count) of `data`; every byte but the last is followed by the separator.
+        char* FormatScalar(const uint8_t* data, std::size_t begin, std::size_t count, char* out, char separator, const char* pairs) {
+            for (std::size_t i = begin; i < count; ++i) {
+                std::memcpy(out, pairs + data[i] * 2, 2);
+                out += 2;
+                if (separator != '\0' && i + 1 < count) {
+                    *out++ = separator;
+                }
+            }
+            return out;
+        }
+
+#if KX_ARCH_X64
+        // Shuffle controls spreading the interleaved hex pairs of 16 bytes over three 16-char
+        // outputs as "HL_HL_...": `low` picks from bytes 0-7, `high` from bytes 8-15, and
+        // `separator` marks the separator slots.
+        struct SeparatorMasks {
+            alignas(16) uint8_t low[3][16];
+            alignas(16) uint8_t high[3][16];
+            alignas(16) uint8_t separator[3][16];
+        };
+
+        constexpr SeparatorMasks MakeSeparatorMasks() {
+            SeparatorMasks masks{};
+            for (int t = 0; t < 3; ++t) {
+                for (int j = 0; j < 16; ++j) {
+                    const int c = t * 16 + j;
+                    const int byte = c / 3;
+                    const int slot = c % 3;
+                    masks.low[t][j] = (slot < 2 && byte < 8) ? static_cast<uint8_t>(byte * 2 + slot) : 0x80;
+                    masks.high[t][j] = (slot < 2 && byte >= 8) ? static_cast<uint8_t>((byte - 8) * 2 + slot) : 0x80;
+                    masks.separator[t][j] = slot == 2 ? 0xFF : 0x00;
+                }
+            }
+            return masks;
+        }
+
+        alignas(16) constexpr SeparatorMasks SEPARATOR_MASKS = MakeSeparatorMasks();
+
+        // Formats whole 16-byte blocks; returns the number of bytes consumed.
+        KX_TARGET_SSSE3 std::size_t FormatBlocksSsse3(const uint8_t* data, std::size_t count, char*& out, char separator, const char* digits) {
+            const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+            const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+            std::size_t i = 0;
+
+            if (separator == '\0') {
+                for (; i + 16 <= count; i += 16) {
+                    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                    const __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), nibbleMask));
+                    const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, nibbleMask));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+                    out += 32;
+                }
+                return i;
+            }
+
+            // Each block also writes the separator after its last byte, so leave at least one byte for the tail.
+            const __m128i separators = _mm_set1_epi8(separator);
+            __m128i lowMasks[3];
+            __m128i highMasks[3];
+            __m128i separatorSlots[3];
+            for (int t = 0; t < 3; ++t) {
+                lowMasks[t] = _mm_load_si128(reinterpret_cast<const __m128i*>(SEPARATOR_MASKS.low[t]));
+                highMasks[t] = _mm_load_si128(reinterpret_cast<const __m128i*>(SEPARATOR_MASKS.high[t]));
+                separatorSlots[t] = _mm_and_si128(separators, _mm_load_si128(reinterpret_cast<const __m128i*>(SEPARATOR_MASKS.separator[t])));
+            }
+            for (; i + 16 < count; i += 16) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                const __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), nibbleMask));
+                const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, nibbleMask));
+                const __m128i pairsLow = _mm_unpacklo_epi8(hi, lo);
+                const __m128i pairsHigh = _mm_unpackhi_epi8(hi, lo);
+                for (int t = 0; t < 3; ++t) {
+                    const __m128i fromLow = _mm_shuffle_epi8(pairsLow, lowMasks[t]);
+                    const __m128i fromHigh = _mm_shuffle_epi8(pairsHigh, highMasks[t]);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + t * 16), _mm_or_si128(_mm_or_si128(fromLow, fromHigh), separatorSlots[t]));
+                }
+                out += 48;
+            }
+            return i;
+        }
+
+        // Formats whole 32-byte blocks without separators; returns the number of bytes consumed.
+        KX_TARGET_AVX2 std::size_t FormatBlocksAvx2(const uint8_t* data, std::size_t count, char*& out, const char* digits) {
+            const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)));
+            const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+            std::size_t i = 0;
+            for (; i + 32 <= count; i += 32) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibbleMask));
+                const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibbleMask));
+                // Unpacks work per 128-bit lane: x = bytes 0-7 | 16-23, y = bytes 8-15 | 24-31.
+                const __m256i x = _mm256_unpacklo_epi8(hi, lo);
+                const __m256i y = _mm256_unpackhi_epi8(hi, lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(x, y, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(x, y, 0x31));
+                out += 64;
+            }
+            return i;
+        }
+#endif
+
+        // Characters needed for `count` bytes, with or without the marker.
+        std::size_t FormattedLength(std::size_t count, std::size_t separatorLength, bool truncated) {
+            std::size_t length = count * 2 + (count > 0 ? (count - 1) * separatorLength : 0);
+            return truncated ? length + HEX_TRUNCATION_MARKER.size() : length;
+        }
+    }
+
+    std::size_t GetHexBufferSize(std::size_t byteCount, const HexFormatOptions& options) {
+        const std::size_t separatorLength = options.separator != '\0' ? 1 : 0;
+        const bool truncated = options.maxBytes > 0 && byteCount > options.maxBytes;
+        return FormattedLength(truncated ? options.maxBytes : byteCount, separatorLength, truncated);
+    }
+
+    std::size_t FormatHex(const uint8_t* data, std::size_t size, char* out, std::size_t outCapacity,
+                          const HexFormatOptions& options) {
+        const std::size_t separatorLength = options.separator != '\0' ? 1 : 0;
+        bool truncated = options.maxBytes > 0 && size > options.maxBytes;
+        std::size_t count = truncated ? options.maxBytes : size;
+
+        if (FormattedLength(count, separatorLength, truncated) > outCapacity) {
+            // Fit as many bytes as possible in front of the marker.
+            truncated = true;
+            const std::size_t markerLength = HEX_TRUNCATION_MARKER.size();
+            count = outCapacity >= markerLength + 2 ? (outCapacity - markerLength + separatorLength) / (2 + separatorLength) : 0;
+        }
+
+        const char* digits = options.uppercase ? UPPER_DIGITS : LOWER_DIGITS;
+        const char* pairs = options.uppercase ? UPPER_PAIRS.data() : LOWER_PAIRS.data();
+        char* cursor = out;
+        std::size_t done = 0;
+
+#if KX_ARCH_X64
+        const Cpu::Features& features = Cpu::GetFeatures();
+        if (features.avx2 && options.separator == '\0' && count >= 32) {
+            done = FormatBlocksAvx2(data, count, cursor, digits);
+        }
+        else if (features.ssse3 && count > 16) {
+            done = FormatBlocksSsse3(data, count, cursor, options.separator, digits);
+        }
+#else
+        (void)digits;
+#endif
+        cursor = FormatScalar(data, done, count, cursor, options.separator, pairs);
+
+        if (truncated && static_cast<std::size_t>(cursor - out) + HEX_TRUNCATION_MARKER.size() <= outCapacity) {
+            std::memcpy(cursor, HEX_TRUNCATION_MARKER.data(), HEX_TRUNCATION_MARKER.size());
+            cursor += HEX_TRUNCATION_MARKER.size();
+        }
+        return static_cast<std::size_t>(cursor - out);
+    }
+
+    void AppendHex(std::string& out, const uint8_t* data, std::size_t size, const HexFormatOptions& options) {
+        const std::size_t start = out.size();
+        out.resize(start + GetHexBufferSize(size, options));
+        const std::size_t written = FormatHex(data, size, out.data() + start, out.size() - start, options);
+        out.resize(start + written);
+    }
+
+} // namespace kx::Utils
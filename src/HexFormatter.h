@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * @file HexFormatter.h
+ * @brief Fast byte-to-hex formatting into caller-provided buffers.
+ * @details Used by the packet list, the copy actions and the details pane. Small inputs
+ *          go through a 512-byte pair lookup table; longer runs use an SSSE3 or AVX2
+ *          nibble shuffle, selected at runtime (CpuFeatures.h). All paths produce
+ *          identical output.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace kx::Utils {
+
+    struct HexFormatOptions {
+        char separator = ' ';     // Written between bytes; '\0' for none
+        bool uppercase = true;
+        std::size_t maxBytes = 0; // Bytes formatted before the truncation marker; 0 for no limit
+    };
+
+    // Appended (without a separator) when not all bytes were formatted, e.g. "01 02...".
+    constexpr std::string_view HEX_TRUNCATION_MARKER = "...";
+
+    /**
+     * @brief Buffer size FormatHex() needs to format `byteCount` bytes with `options`.
+     */
+    std::size_t GetHexBufferSize(std::size_t byteCount, const HexFormatOptions& options);
+
+    /**
+     * @brief Formats bytes as hex into `out`. No NUL terminator is written.
+     * @details If `outCapacity` is too small, fewer bytes are formatted and the output
+     *          ends with the truncation marker (if it fits).
+     * @return Number of characters written.
+     */
+    std::size_t FormatHex(const uint8_t* data, std::size_t size, char* out, std::size_t outCapacity,
+                          const HexFormatOptions& options = {});
+
+    /**
+     * @brief Appends the hex form of `data` to `out`.
+     */
+    void AppendHex(std::string& out, const uint8_t* data, std::size_t size, const HexFormatOptions& options = {});
+
+} // namespace kx::Utils
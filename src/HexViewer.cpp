@@ -0,0 +1,162 @@
+#include "HexViewer.h"
+#include "../libs/ImGui/imgui.h"
+#include "SchemaCatalog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace kx::Gui {
+
+    namespace {
+        // Layout in character cells: "00000000  00 01 ... 07  08 ... 0F  0123456789ABCDEF"
+        constexpr float OFFSET_COLUMN_CELLS = 10.0f; // 8 digits + 2 spaces
+        constexpr float HEX_CELLS_PER_BYTE = 3.0f;
+        constexpr float HALF_LINE_GAP_CELLS = 1.0f; // Extra gap after the 8th byte
+        constexpr float ASCII_GAP_CELLS = 2.0f;
+
+        constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+        // The app font is proportional, so every cell is placed explicitly at the widest glyph's width.
+        float GetCellWidth() {
+            float width = 0.0f;
+            for (const char* c = HEX_DIGITS; *c; ++c) {
+                width = std::max(width, ImGui::CalcTextSize(c, c + 1).x);
+            }
+            return width;
+        }
+
+        float GetHexColumnX(std::size_t column, float cellWidth) {
+            const float gap = column >= HexViewer::BYTES_PER_LINE / 2 ? HALF_LINE_GAP_CELLS : 0.0f;
+            return (OFFSET_COLUMN_CELLS + column * HEX_CELLS_PER_BYTE + gap) * cellWidth;
+        }
+
+        float GetAsciiColumnX(std::size_t column, float cellWidth) {
+            const float hexEnd = GetHexColumnX(HexViewer::BYTES_PER_LINE - 1, cellWidth) + 2.0f * cellWidth;
+            return hexEnd + (ASCII_GAP_CELLS + column) * cellWidth;
+        }
+
+        ImU32 GetSpanColor(int32_t spanIndex, bool hovered) {
+            // Golden-ratio hue steps keep neighbouring fields distinguishable.
+            const float hue = std::fmod(static_cast<float>(spanIndex) * 0.618034f, 1.0f);
+            return ImColor::HSV(hue, 0.55f, 0.85f, hovered ? 0.65f : 0.28f);
+        }
+    }
+
+    float HexViewer::GetHeightForLines(std::size_t lineCount) {
+        return static_cast<float>(lineCount) * ImGui::GetTextLineHeightWithSpacing() + ImGui::GetStyle().WindowPadding.y * 2.0f;
+    }
+
+    void HexViewer::Rebuild(const kx::PacketInfo& packet, uint64_t catalogVersion) {
+        m_packetId = packet.id;
+        m_catalogVersion = catalogVersion;
+        m_hoveredSpan = -1;
+        m_fields = Parsing::GetPacketFieldSpans(packet);
+
+        // Later (deeper) spans win, so a struct's members are shown over the struct itself.
+        m_byteSpan.assign(packet.data.size(), -1);
+        for (std::size_t i = 0; i < m_fields.spans.size(); ++i) {
+            const Parsing::FieldSpan& span = m_fields.spans[i];
+            const std::size_t end = std::min(packet.data.size(), span.offset + span.size);
+            for (std::size_t b = span.offset; b < end; ++b) {
+                const int32_t current = m_byteSpan[b];
+                if (current < 0 || span.depth >= m_fields.spans[current].depth) {
+                    m_byteSpan[b] = static_cast<int32_t>(i);
+                }
+            }
+        }
+    }
+
+    const Parsing::PacketFieldSpans& HexViewer::GetFieldSpans(const kx::PacketInfo& packet) {
+        const std::shared_ptr<const Schema::Catalog> catalog = Schema::GetActiveCatalog();
+        const uint64_t catalogVersion = catalog ? catalog->version : 0;
+        if (packet.id != m_packetId || catalogVersion != m_catalogVersion) {
+            Rebuild(packet, catalogVersion);
+        }
+        return m_fields;
+    }
+
+    void HexViewer::Draw(const kx::PacketInfo& packet, float height) {
+        GetFieldSpans(packet);
+
+        const std::vector<uint8_t>& data = packet.data;
+        const float cellWidth = GetCellWidth();
+        const float lineHeight = ImGui::GetTextLineHeight();
+        const float contentWidth = GetAsciiColumnX(BYTES_PER_LINE, cellWidth);
+
+        ImGui::BeginChild("##HexViewer", ImVec2(-1.0f, height), ImGuiChildFlags_Borders, ImGuiWindowFlags_HorizontalScrollbar);
+
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+        const ImU32 dimColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        const bool windowHovered = ImGui::IsWindowHovered();
+        int64_t hoveredByte = -1;
+
+        const std::size_t lineCount = (data.size() + BYTES_PER_LINE - 1) / BYTES_PER_LINE;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(lineCount), ImGui::GetTextLineHeightWithSpacing());
+        while (clipper.Step()) {
+            for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line) {
+                const ImVec2 origin = ImGui::GetCursorScreenPos();
+                const std::size_t lineStart = static_cast<std::size_t>(line) * BYTES_PER_LINE;
+                const std::size_t lineBytes = std::min(BYTES_PER_LINE, data.size() - lineStart);
+
+                char offsetText[16];
+                const int offsetLength = std::snprintf(offsetText, sizeof(offsetText), "%08zX", lineStart);
+                drawList->AddText(origin, dimColor, offsetText, offsetText + offsetLength);
+
+                const bool mouseOnLine = windowHovered && mouse.y >= origin.y && mouse.y < origin.y + lineHeight;
+                for (std::size_t column = 0; column < lineBytes; ++column) {
+                    const std::size_t index = lineStart + column;
+                    const uint8_t byte = data[index];
+                    const float hexX = origin.x + GetHexColumnX(column, cellWidth);
+                    const float asciiX = origin.x + GetAsciiColumnX(column, cellWidth);
+
+                    const int32_t span = m_byteSpan[index];
+                    if (span >= 0) {
+                        const ImU32 color = GetSpanColor(span, span == m_hoveredSpan);
+                        // Tint the gap to the next byte too when it belongs to the same field.
+                        const bool continues = column + 1 < lineBytes && m_byteSpan[index + 1] == span &&
+                                               column + 1 != BYTES_PER_LINE / 2;
+                        const float hexWidth = cellWidth * (continues ? HEX_CELLS_PER_BYTE : 2.0f);
+                        drawList->AddRectFilled(ImVec2(hexX, origin.y), ImVec2(hexX + hexWidth, origin.y + lineHeight), color);
+                        drawList->AddRectFilled(ImVec2(asciiX, origin.y), ImVec2(asciiX + cellWidth, origin.y + lineHeight), color);
+                    }
+
+                    const char hex[2] = { HEX_DIGITS[byte >> 4], HEX_DIGITS[byte & 0xF] };
+                    drawList->AddText(ImVec2(hexX, origin.y), textColor, hex, hex + 2);
+                    const char ascii = (byte >= 0x20 && byte < 0x7F) ? static_cast<char>(byte) : '.';
+                    drawList->AddText(ImVec2(asciiX, origin.y), ascii == '.' ? dimColor : textColor, &ascii, &ascii + 1);
+
+                    if (mouseOnLine &&
+                        ((mouse.x >= hexX && mouse.x < hexX + cellWidth * HEX_CELLS_PER_BYTE) ||
+                         (mouse.x >= asciiX && mouse.x < asciiX + cellWidth))) {
+                        hoveredByte = static_cast<int64_t>(index);
+                    }
+                }
+
+                ImGui::Dummy(ImVec2(contentWidth, lineHeight));
+            }
+        }
+        clipper.End();
+
+        m_hoveredSpan = hoveredByte >= 0 ? m_byteSpan[static_cast<std::size_t>(hoveredByte)] : -1;
+        if (hoveredByte >= 0) {
+            ImGui::BeginTooltip();
+            if (m_hoveredSpan >= 0) {
+                const Parsing::FieldSpan& span = m_fields.spans[m_hoveredSpan];
+                ImGui::TextUnformatted(span.label.c_str());
+                ImGui::Text("Value: %s", span.value.c_str());
+                ImGui::TextDisabled("Bytes 0x%zX-0x%zX (%zu)", span.offset, span.offset + span.size - 1, span.size);
+            } else {
+                const uint8_t byte = data[static_cast<std::size_t>(hoveredByte)];
+                ImGui::Text("Offset 0x%llX: 0x%02X (%u)", static_cast<unsigned long long>(hoveredByte), byte, byte);
+            }
+            ImGui::EndTooltip();
+        }
+
+        ImGui::EndChild();
+    }
+
+} // namespace kx::Gui
@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file HexViewer.h
+ * @brief Virtualised hex/ASCII view of a packet payload with field overlays.
+ * @details Only the visible lines are drawn (ImGuiListClipper), straight from the raw
+ *          bytes, so payloads of any size cost the same per frame. Byte ranges known
+ *          from a handwritten layout or the schema decoder (FieldLayouts.h) are tinted,
+ *          and hovering one shows the field's name and decoded value. Render thread only.
+ */
+
+#include "FieldLayouts.h"
+#include "PacketData.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace kx::Gui {
+
+    class HexViewer {
+    public:
+        static constexpr std::size_t BYTES_PER_LINE = 16;
+
+        /**
+         * @brief Draws the payload of `packet` in a child region of the given height.
+         * @details Field spans are recomputed only when the packet or the schema catalogue changes.
+         */
+        void Draw(const kx::PacketInfo& packet, float height);
+
+        /**
+         * @brief Field spans of `packet`, rebuilt if it is not the packet the viewer last saw.
+         */
+        const Parsing::PacketFieldSpans& GetFieldSpans(const kx::PacketInfo& packet);
+
+        /**
+         * @brief Height that shows `lineCount` lines without scrolling.
+         */
+        static float GetHeightForLines(std::size_t lineCount);
+
+    private:
+        void Rebuild(const kx::PacketInfo& packet, uint64_t catalogVersion);
+
+        uint64_t m_packetId = 0;          // 0: nothing built yet
+        uint64_t m_catalogVersion = 0;
+        Parsing::PacketFieldSpans m_fields;
+        std::vector<int32_t> m_byteSpan;  // Per payload byte: index of the innermost span, or -1
+        int32_t m_hoveredSpan = -1;       // Span under the mouse last frame
+    };
+
+} // namespace kx::Gui
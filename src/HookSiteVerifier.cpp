@@ -0,0 +1,172 @@
+#include "HookSiteVerifier.h"
+#include "../libs/safetyhook/Zydis.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace kx::Hooking {
+
+    namespace {
+        enum class ByteState : uint8_t {
+            Unvisited,
+            InstructionStart,
+            InstructionBody
+        };
+
+        struct SiteMov {
+            std::size_t offset;
+            int64_t displacement;
+        };
+
+        std::optional<DispatcherHookSites> Fail(std::string* error, const char* format, unsigned long long a = 0, unsigned long long b = 0) {
+            if (error) {
+                char message[160];
+                std::snprintf(message, sizeof(message), format, a, b);
+                *error = message;
+            }
+            return std::nullopt;
+        }
+
+        // MOV RDX, qword ptr [RBP + disp]: no index, default (SS) segment.
+        bool IsSiteMov(const ZydisDecodedInstruction& instruction, const ZydisDecodedOperand* operands) {
+            if (instruction.mnemonic != ZYDIS_MNEMONIC_MOV || instruction.operand_count_visible != 2) {
+                return false;
+            }
+            const ZydisDecodedOperand& destination = operands[0];
+            const ZydisDecodedOperand& source = operands[1];
+            return destination.type == ZYDIS_OPERAND_TYPE_REGISTER && destination.reg.value == ZYDIS_REGISTER_RDX &&
+                   source.type == ZYDIS_OPERAND_TYPE_MEMORY && source.mem.type == ZYDIS_MEMOP_TYPE_MEM &&
+                   source.mem.base == ZYDIS_REGISTER_RBP && source.mem.index == ZYDIS_REGISTER_NONE &&
+                   source.mem.segment == ZYDIS_REGISTER_SS && source.size == 64;
+        }
+
+        // CALL through a register or memory operand (the handler pointer), not CALL rel32.
+        bool IsIndirectCall(const ZydisDecodedInstruction& instruction, const ZydisDecodedOperand* operands) {
+            return instruction.meta.category == ZYDIS_CATEGORY_CALL && instruction.operand_count_visible >= 1 &&
+                   operands[0].type != ZYDIS_OPERAND_TYPE_IMMEDIATE;
+        }
+    }
+
+    std::optional<DispatcherHookSites> LocateDispatcherHookSites(const uint8_t* code, std::size_t size, std::string* error) {
+        if (!code || size == 0) {
+            return Fail(error, "no code to decode");
+        }
+
+        ZydisDecoder decoder;
+        if (!ZYAN_SUCCESS(ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64))) {
+            return Fail(error, "could not initialize the decoder");
+        }
+
+        // Recursive descent from the entry: follows direct branches, stops a path at RET,
+        // INT3/UD2 (after no-return calls), unconditional jumps and indirect jumps. Unlike a
+        // linear sweep it does not run into padding or data, and it collects the branch
+        // targets needed to check that no hook splits a jumped-to instruction.
+        std::vector<ByteState> state(size, ByteState::Unvisited);
+        std::vector<uint8_t> lengths(size, 0);
+        std::vector<uint8_t> indirectCall(size, 0);
+        std::vector<SiteMov> movs;
+        std::vector<std::size_t> branchTargets;
+        std::vector<std::size_t> pending = { 0 };
+        std::size_t instructionsDecoded = 0;
+
+        while (!pending.empty()) {
+            std::size_t offset = pending.back();
+            pending.pop_back();
+
+            while (offset < size) {
+                if (state[offset] == ByteState::InstructionStart) {
+                    break; // Joined a path decoded before
+                }
+                if (state[offset] == ByteState::InstructionBody) {
+                    return Fail(error, "a branch lands inside the instruction covering +0x%llX", offset);
+                }
+
+                ZydisDecodedInstruction instruction;
+                ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT];
+                if (!ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, code + offset, size - offset, &instruction, operands))) {
+                    return Fail(error, "undecodable instruction at +0x%llX", offset);
+                }
+                for (std::size_t i = 0; i < instruction.length; ++i) {
+                    if (state[offset + i] != ByteState::Unvisited) {
+                        return Fail(error, "the instruction at +0x%llX overlaps another", offset);
+                    }
+                    state[offset + i] = i == 0 ? ByteState::InstructionStart : ByteState::InstructionBody;
+                }
+                lengths[offset] = instruction.length;
+                ++instructionsDecoded;
+
+                if (IsSiteMov(instruction, operands)) {
+                    movs.push_back({ offset, operands[1].mem.disp.value });
+                }
+                if (IsIndirectCall(instruction, operands)) {
+                    indirectCall[offset] = 1;
+                }
+
+                const ZydisInstructionCategory category = instruction.meta.category;
+                if (category == ZYDIS_CATEGORY_COND_BR || category == ZYDIS_CATEGORY_UNCOND_BR) {
+                    if (operands[0].type == ZYDIS_OPERAND_TYPE_IMMEDIATE && operands[0].imm.is_relative) {
+                        const int64_t target = static_cast<int64_t>(offset + instruction.length) + operands[0].imm.value.s;
+                        // Targets outside the window are tail calls or other functions.
+                        if (target >= 0 && static_cast<uint64_t>(target) < size) {
+                            branchTargets.push_back(static_cast<std::size_t>(target));
+                            pending.push_back(static_cast<std::size_t>(target));
+                        }
+                    }
+                    if (category == ZYDIS_CATEGORY_UNCOND_BR) {
+                        break;
+                    }
+                }
+                if (category == ZYDIS_CATEGORY_RET || instruction.mnemonic == ZYDIS_MNEMONIC_INT3 ||
+                    instruction.mnemonic == ZYDIS_MNEMONIC_UD2) {
+                    break;
+                }
+                offset += instruction.length;
+            }
+        }
+
+        // Hook sites: the MOVs directly followed by an indirect call.
+        std::vector<SiteMov> sites;
+        for (const SiteMov& mov : movs) {
+            const std::size_t next = mov.offset + lengths[mov.offset];
+            if (next < size && state[next] == ByteState::InstructionStart && indirectCall[next]) {
+                sites.push_back(mov);
+            }
+        }
+        std::sort(sites.begin(), sites.end(), [](const SiteMov& a, const SiteMov& b) { return a.offset < b.offset; });
+
+        if (sites.size() != DISPATCHER_HOOK_SITE_COUNT) {
+            return Fail(error, "found %llu MOV RDX,[RBP+disp] before an indirect call, expected %llu",
+                        sites.size(), DISPATCHER_HOOK_SITE_COUNT);
+        }
+
+        DispatcherHookSites result;
+        result.messageDataStackOffset = static_cast<std::ptrdiff_t>(sites[0].displacement);
+        result.instructionsDecoded = instructionsDecoded;
+        for (std::size_t i = 0; i < sites.size(); ++i) {
+            if (sites[i].displacement != sites[0].displacement) {
+                return Fail(error, "the site at +0x%llX reads another stack slot than the one at +0x%llX",
+                            sites[i].offset, sites[0].offset);
+            }
+
+            // The hook's jump replaces whole instructions covering MID_HOOK_PATCH_SIZE bytes;
+            // a branch to any of them but the first would land in the middle of the jump.
+            std::size_t patchEnd = sites[i].offset;
+            while (patchEnd < sites[i].offset + MID_HOOK_PATCH_SIZE) {
+                if (patchEnd >= size || state[patchEnd] != ByteState::InstructionStart) {
+                    return Fail(error, "the code after the site at +0x%llX was not decoded", sites[i].offset);
+                }
+                patchEnd += lengths[patchEnd];
+            }
+            for (const std::size_t target : branchTargets) {
+                if (target > sites[i].offset && target < patchEnd) {
+                    return Fail(error, "a branch to +0x%llX lands in the bytes the hook at +0x%llX overwrites",
+                                target, sites[i].offset);
+                }
+            }
+            result.offsets[i] = static_cast<std::ptrdiff_t>(sites[i].offset);
+        }
+        return result;
+    }
+
+} // namespace kx::Hooking
@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * @file HookSiteVerifier.h
+ * @brief Finds the message handler hook sites by disassembling the dispatcher (Msg::DispatchStream).
+ * @details The dispatcher calls the message handler through a function pointer in four
+ *          places, each time with the message data pointer (a stack local) loaded into RDX
+ *          by the instruction right before the call:
+ *
+ *              MOV  RDX, qword ptr [RBP + disp]   <- hook site
+ *              CALL <indirect>
+ *
+ *          LocateDispatcherHookSites() decodes the dispatcher with Zydis, following its
+ *          branches from the entry, and returns the offsets of those four MOVs and their
+ *          shared displacement. Anything else (another count, differing displacements, a
+ *          branch into the bytes a hook would overwrite, undecodable code) is rejected, so
+ *          a game patch that reshapes the function stops the hooks instead of letting them
+ *          read garbage. Only reads the given bytes; nothing here depends on Windows.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace kx::Hooking {
+
+    constexpr std::size_t DISPATCHER_HOOK_SITE_COUNT = 4;
+
+    // Bytes decoded from the dispatcher's entry at most; its last hook site is at about +0x3E0.
+    constexpr std::size_t DISPATCHER_MAX_SIZE = 0x1000;
+
+    // Bytes a mid-hook overwrites with its jump; no branch may land inside them.
+    constexpr std::size_t MID_HOOK_PATCH_SIZE = 5;
+
+    struct DispatcherHookSites {
+        std::array<std::ptrdiff_t, DISPATCHER_HOOK_SITE_COUNT> offsets{}; // Of each MOV, from the dispatcher entry, ascending
+        std::ptrdiff_t messageDataStackOffset = 0;                        // The MOV's displacement from RBP
+        std::size_t instructionsDecoded = 0;
+    };
+
+    /**
+     * @brief Locates the hook sites in the dispatcher whose entry is at `code`.
+     * @param size Bytes readable from `code`; decoding never leaves [code, code + size).
+     * @return The sites, or std::nullopt with the reason in `error` if the function does not
+     *         have the expected shape.
+     */
+    std::optional<DispatcherHookSites> LocateDispatcherHookSites(const uint8_t* code, std::size_t size,
+                                                                 std::string* error = nullptr);
+
+} // namespace kx::Hooking
@@ -3,8 +3,12 @@
 #include "Config.h"          // For patterns/process name
 #include "PatternScanner.h"  // For finding game functions
 #include "MessageHandlerHook.h"
+#include "StartupTimeline.h"
 
+#include <future>
 #include <iostream>          // Replace with logging
+#include <mutex>
+#include <utility>
 
 namespace kx {
 
@@ -12,15 +16,42 @@ namespace kx {
     // (Could be in its own GameHooks.cpp if it grows more complex)
     namespace GameHooks {
 
-        bool InitializeMsgSendHook() {
-            g_msgSendHookStatus = HookStatus::Unknown; // Start as unknown
-            g_msgSendAddress = 0;
+        namespace {
+            // Picks the hook target from all matches of a signature. A signature that matches
+            // more than once no longer identifies its function; the first match is used, as
+            // before, but the ambiguity is reported so the signature can be tightened.
+            std::optional<uintptr_t> SelectMatch(const char* name, const std::vector<uintptr_t>& matches) {
+                if (matches.empty()) {
+                    return std::nullopt;
+                }
+                if (matches.size() > 1) {
+                    std::cerr << "[GameHooks] Warning: " << name << " pattern is ambiguous (" << matches.size() << " matches:";
+                    for (const uintptr_t match : matches) {
+                        std::cerr << " 0x" << std::hex << match << std::dec;
+                    }
+                    std::cerr << "). Using the first." << std::endl;
+                }
+                return matches.front();
+            }
+        }
 
-            std::cout << "Scanning for MsgSend pattern..." << std::endl;
-            std::optional<uintptr_t> msgSendAddrOpt = kx::PatternScanner::FindPattern(
-                std::string(kx::MSG_CONN_FLUSH_PACKET_BUFFER_PATTERN),
+        SignatureMatches FindSignatures() {
+            std::cout << "Scanning for MsgSend and MsgDispatch patterns..." << std::endl;
+            std::vector<std::vector<uintptr_t>> matches = kx::PatternScanner::FindPatterns(
+                {
+                    { kx::MSG_CONN_FLUSH_PACKET_BUFFER_PATTERN.ToBytePattern(), Scanning::ScanTarget::Code, kx::SIGNATURE_MAX_MISMATCHES },
+                    { kx::MSG_DISPATCH_STREAM_PATTERN.ToBytePattern(), Scanning::ScanTarget::Code, kx::SIGNATURE_MAX_MISMATCHES },
+                },
                 std::string(kx::TARGET_PROCESS_NAME)
             );
+            return { std::move(matches[0]), std::move(matches[1]) };
+        }
+
+        bool InitializeMsgSendHook(const std::vector<uintptr_t>& matches) {
+            g_msgSendHookStatus = HookStatus::Unknown; // Start as unknown
+            g_msgSendAddress = 0;
+
+            std::optional<uintptr_t> msgSendAddrOpt = SelectMatch("MsgSend", matches);
 
             if (!msgSendAddrOpt) {
                 std::cerr << "[GameHooks] MsgSend pattern not found. Hook skipped." << std::endl;
@@ -44,15 +75,11 @@ namespace kx {
             }
         }
 
-        bool InitializeMessageHandlerHook() {
+        bool InitializeMessageHandlerHook(const std::vector<uintptr_t>& matches) {
             g_msgRecvHookStatus = HookStatus::Unknown; // Use Recv status flag
             g_msgRecvAddress = 0; // Base address of dispatcher
 
-            std::cout << "Scanning for MsgDispatch pattern..." << std::endl;
-            std::optional<uintptr_t> msgDispatchAddrOpt = kx::PatternScanner::FindPattern(
-                std::string(kx::MSG_DISPATCH_STREAM_PATTERN), // Use dispatcher pattern
-                std::string(kx::TARGET_PROCESS_NAME)
-            );
+            std::optional<uintptr_t> msgDispatchAddrOpt = SelectMatch("MsgDispatch", matches);
 
             if (!msgDispatchAddrOpt) {
                 std::cerr << "[GameHooks] MsgDispatch pattern not found. Hook skipped." << std::endl;
@@ -89,6 +116,11 @@ namespace kx {
 
     // --- Global Hook Orchestration ---
 
+    namespace {
+        // Serializes capture toggles (render thread) with hook removal (unload thread).
+        std::mutex g_gameHookStateMutex;
+    }
+
     bool InitializeHooks() {
         // Reset status flags
         g_presentHookStatus = HookStatus::Unknown;
@@ -96,26 +128,69 @@ namespace kx {
         g_msgRecvHookStatus = HookStatus::Unknown;
         g_msgSendAddress = 0;
         g_msgRecvAddress = 0;
+        Startup::BeginTimeline();
 
         // 1. Initialize Hook Manager (MinHook)
-        if (!kx::Hooking::HookManager::Initialize()) {
-            return false; // Fatal if MinHook fails
+        {
+            Startup::ScopedStage stage("MinHook initialization");
+            if (!kx::Hooking::HookManager::Initialize()) {
+                stage.SetSucceeded(false);
+                return false; // Fatal if MinHook fails
+            }
         }
 
-        // 2. Initialize D3D Render Hook (Present, WndProc, ImGui)
-        if (!kx::Hooking::D3DRenderHook::Initialize()) {
-            // D3DRenderHook::Initialize already logs errors
-            kx::Hooking::HookManager::Shutdown(); // Cleanup MinHook if Present hook fails
+        // 2. Locate the game functions and Present concurrently. The scan only reads the
+        // module and runs on another thread (plus the background pool); the dummy swap chain
+        // stays on this thread, which owns its window.
+        std::future<GameHooks::SignatureMatches> signatureScan = std::async(std::launch::async, [] {
+            Startup::ScopedStage stage("Signature scan");
+            return GameHooks::FindSignatures();
+        });
+        bool presentFound = false;
+        {
+            Startup::ScopedStage stage("Present lookup (dummy swap chain)");
+            presentFound = kx::Hooking::D3DRenderHook::FindPresentPointer();
+            stage.SetSucceeded(presentFound);
+        }
+        const GameHooks::SignatureMatches signatures = signatureScan.get();
+        if (!presentFound) {
+            std::cerr << "[Hooks] Failed to find the Present pointer." << std::endl;
+            kx::Hooking::HookManager::Shutdown();
             g_presentHookStatus = HookStatus::Failed;
             return false; // Present hook is essential
         }
-        // Status g_presentHookStatus is set inside D3DRenderHook::Initialize
 
         // 3. Initialize Game-Specific Hooks (MsgSend, MsgRecv)
-        // We consider these non-fatal for now if they fail (e.g., pattern not found)
-        GameHooks::InitializeMsgSendHook();
-        GameHooks::InitializeMessageHandlerHook();
+        // We consider these non-fatal for now if they fail (e.g., pattern not found).
+        // Installation stays sequential: MinHook and SafetyHook suspend every other thread
+        // while they patch code, which would include a second installer.
+        {
+            Startup::ScopedStage stage("MsgSend hook");
+            GameHooks::InitializeMsgSendHook(signatures.msgSend);
+            stage.SetSucceeded(g_msgSendHookStatus == HookStatus::OK);
+        }
+        {
+            Startup::ScopedStage stage("Message handler hooks");
+            GameHooks::InitializeMessageHandlerHook(signatures.msgDispatch);
+            stage.SetSucceeded(g_msgRecvHookStatus == HookStatus::OK);
+        }
 
+        // 4. Initialize D3D Render Hook (Present; WndProc and ImGui follow on the first frame).
+        // It goes live last, so the overlay's setup never competes with the scan.
+        {
+            Startup::ScopedStage stage("Present hook");
+            if (!kx::Hooking::D3DRenderHook::Initialize()) {
+                // D3DRenderHook::Initialize already logs errors
+                stage.SetSucceeded(false);
+                GameHooks::Shutdown();
+                kx::Hooking::HookManager::Shutdown(); // Cleanup MinHook if Present hook fails
+                g_presentHookStatus = HookStatus::Failed;
+                return false; // Present hook is essential
+            }
+            // Status g_presentHookStatus is set inside D3DRenderHook::Initialize
+        }
+
+        Startup::LogTimelineSummary();
         std::cout << "[Hooks] Overall initialization finished." << std::endl;
         return true; // Return true even if game hooks failed, as Present hook is OK
     }
@@ -124,7 +199,10 @@ namespace kx {
         std::cout << "[Hooks] Starting cleanup..." << std::endl;
 
         // 1. Shutdown game-specific hooks (if they have specific cleanup)
-        GameHooks::Shutdown();
+        {
+            std::lock_guard<std::mutex> lock(g_gameHookStateMutex);
+            GameHooks::Shutdown();
+        }
 
         // 2. Shutdown D3D Render Hook (Restores WndProc, cleans ImGui/D3D resources)
         kx::Hooking::D3DRenderHook::Shutdown();
@@ -135,4 +213,26 @@ namespace kx {
         std::cout << "[Hooks] Cleanup finished." << std::endl;
     }
 
+    bool ApplyCaptureState() {
+        std::lock_guard<std::mutex> lock(g_gameHookStateMutex);
+        if (g_isShuttingDown.load(std::memory_order_acquire)) {
+            return true; // CleanupHooks removes them anyway
+        }
+
+        bool success = true;
+        if (g_msgSendHookStatus == HookStatus::OK &&
+            !::SetMsgSendHookEnabled(IsCaptureEnabled(PacketDirection::Sent))) {
+            std::cerr << "[Hooks] Failed to switch the MsgSend hook." << std::endl;
+            g_msgSendHookStatus = HookStatus::Failed;
+            success = false;
+        }
+        if (g_msgRecvHookStatus == HookStatus::OK &&
+            !::SetMessageHandlerHooksEnabled(IsCaptureEnabled(PacketDirection::Received))) {
+            std::cerr << "[Hooks] Failed to switch the message handler hooks." << std::endl;
+            g_msgRecvHookStatus = HookStatus::Failed;
+            success = false;
+        }
+        return success;
+    }
+
 } // namespace kx
\ No newline at end of file
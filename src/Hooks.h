@@ -4,21 +4,35 @@
 #include "D3DRenderHook.h"
 #include "MsgSendHook.h"
 
+#include <cstdint>
+#include <vector>
+
 namespace kx {
 
     // Namespace to group game-specific hook initialization logic
     namespace GameHooks {
+        // Every match of each game signature; more than one match means it is ambiguous.
+        struct SignatureMatches {
+            std::vector<uintptr_t> msgSend;
+            std::vector<uintptr_t> msgDispatch;
+        };
+
+        /**
+         * @brief Scans the game module once for all game signatures.
+         */
+        SignatureMatches FindSignatures();
+
         /**
-         * @brief Finds and initializes the MsgSend hook.
+         * @brief Initializes the MsgSend hook at the signature's match.
          * @return True if successful or pattern not found (non-fatal), false on hooking error.
          */
-        bool InitializeMsgSendHook();
+        bool InitializeMsgSendHook(const std::vector<uintptr_t>& matches);
 
         /**
-         * @brief Finds the message dispatcher and initializes the message handler hook(s).
+         * @brief Initializes the message handler hook(s) at the dispatcher signature's match.
          * @return True if successful or pattern not found (non-fatal), false on hooking error.
          */
-        bool InitializeMessageHandlerHook();
+        bool InitializeMessageHandlerHook(const std::vector<uintptr_t>& matches);
 
         /**
          * @brief Cleans up game-specific hooks (if needed beyond HookManager::Shutdown).
@@ -37,4 +51,14 @@ namespace kx {
      */
     void CleanupHooks();
 
+    /**
+     * @brief Enables or disables the game hooks to match g_capturePaused, g_captureSent and
+     *        g_captureReceived. Call after changing any of them.
+     * @details A disabled hook is unpatched rather than early-returning, so a paused
+     *          direction costs the game nothing. Toggling suspends the game's threads for a
+     *          moment while the code is patched. Ignored once shutdown has begun.
+     * @return False if a hook could not be switched; it is then marked Failed.
+     */
+    bool ApplyCaptureState();
+
 } // namespace kx
\ No newline at end of file
@@ -4,31 +4,53 @@
 #include "../libs/ImGui/imgui.h"
 #include "../libs/ImGui/imgui_impl_win32.h"
 #include "../libs/ImGui/imgui_impl_dx11.h"
-#include "PacketData.h" // Include for PacketInfo, g_packetLog, g_packetLogMutex
+#include "PacketData.h" // Include for PacketInfo
+#include "PacketStore.h" // Include for g_packetLog
 #include "AppState.h"   // Include for UI state, filter state, hook status
 #include "GuiStyle.h"  // Include for custom styling functions
 #include "FormattingUtils.h"
 #include "FilterUtils.h"
+#include "FilterExpression.h"
 #include "PacketHeaders.h" // Need this for iterating known headers
 #include "Config.h"
 #include "PacketParser.h"
+#include "BulkAnalyzer.h"
+#include "ParserSelfCheck.h"
+#include "SchemaCatalog.h"
+#include "SchemaHarvester.h"
+#include "StartupTimeline.h"
+#include "Hooks.h"     // For ApplyCaptureState
+#include "MessageHandlerHook.h"
 
 #include <vector>
-#include <mutex>
-#include <deque>
 #include <chrono>
 #include <sstream>
 #include <iomanip>
 #include <ctime>   // For formatting time
 #include <string>
 #include <map>     // For std::map used in filtering
+#include <memory>
 #include <windows.h> // Required for ShellExecuteA
 #include <algorithm>
 
 // Initialize static members
-int ImGuiManager::m_selectedPacketLogIndex = -1;
+uint64_t ImGuiManager::m_selectedPacketId = 0;
 std::string ImGuiManager::m_parsedPayloadBuffer = "";
 std::string ImGuiManager::m_fullLogEntryBuffer = "";
+uint64_t ImGuiManager::m_seenCatalogNamesVersion = 0;
+kx::Filtering::FilterView ImGuiManager::m_packetView;
+kx::Filtering::SortedPacketView ImGuiManager::m_sortedView;
+std::vector<uint32_t> ImGuiManager::m_visibleRows;
+kx::Utils::RowTextCache ImGuiManager::m_rowTextCache;
+kx::Export::ExportFormat ImGuiManager::m_exportFormat = kx::Export::ExportFormat::Text;
+kx::Gui::HexViewer ImGuiManager::m_hexViewer;
+std::vector<kx::Stats::OpcodeStats> ImGuiManager::m_trafficStats;
+uint64_t ImGuiManager::m_trafficStatsDueFrame = 0;
+kx::Gui::FrameBudget ImGuiManager::m_frameBudget;
+std::array<char, 512> ImGuiManager::m_displayFilterInput{};
+std::string ImGuiManager::m_displayFilterError;
+std::array<char, 512> ImGuiManager::m_captureFilterInput{};
+std::string ImGuiManager::m_captureFilterError;
 
 bool ImGuiManager::Initialize(ID3D11Device* device, ID3D11DeviceContext* context, HWND hwnd) {
     IMGUI_CHECKVERSION();
@@ -46,6 +68,7 @@ bool ImGuiManager::Initialize(ID3D11Device* device, ID3D11DeviceContext* context
 }
 
 void ImGuiManager::NewFrame() {
+    m_frameBudget.BeginFrame(); // Everything up to the end of Render() runs inside the game's Present
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplWin32_NewFrame();
     ImGui::NewFrame();
@@ -56,6 +79,7 @@ void ImGuiManager::Render(ID3D11DeviceContext* context, ID3D11RenderTargetView*
     ImGui::Render();
     context->OMSetRenderTargets(1, &mainRenderTargetView, NULL);
     ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    m_frameBudget.EndFrame(kx::g_overlayBudgetMs, kx::g_overlayBudgetEnabled);
 }
 
 
@@ -99,6 +123,52 @@ void ImGuiManager::RenderInfoSection() {
     }
 }
 
+namespace {
+    // One row per startup stage, with a bar placed on a shared time axis so stages that ran
+    // concurrently overlap.
+    void RenderStartupTimeline() {
+        const std::vector<kx::Startup::StageRecord> stages = kx::Startup::GetTimeline();
+        const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+        if (!ImGui::BeginTable("StartupTimeline", 5, flags)) {
+            return;
+        }
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Thread");
+        ImGui::TableSetupColumn("Start");
+        ImGui::TableSetupColumn("Time");
+        ImGui::TableSetupColumn("Timeline", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        double axisMs = 0.001;
+        for (const kx::Startup::StageRecord& stage : stages) {
+            axisMs = std::max(axisMs, stage.startMs + stage.durationMs);
+        }
+        for (const kx::Startup::StageRecord& stage : stages) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (stage.succeeded) {
+                ImGui::TextUnformatted(stage.name.c_str());
+            } else {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s (failed)", stage.name.c_str());
+            }
+            ImGui::TableNextColumn(); ImGui::Text("%u", stage.thread);
+            ImGui::TableNextColumn(); ImGui::Text("+%.1f ms", stage.startMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f ms", stage.durationMs);
+
+            ImGui::TableNextColumn();
+            const ImVec2 origin = ImGui::GetCursorScreenPos();
+            const float width = ImGui::GetContentRegionAvail().x;
+            const float height = ImGui::GetTextLineHeight();
+            const float x0 = origin.x + width * static_cast<float>(stage.startMs / axisMs);
+            const float x1 = origin.x + width * static_cast<float>((stage.startMs + stage.durationMs) / axisMs);
+            const ImU32 color = stage.succeeded ? IM_COL32(90, 170, 240, 255) : IM_COL32(230, 90, 90, 255);
+            ImGui::GetWindowDrawList()->AddRectFilled(ImVec2(x0, origin.y + 2.0f), ImVec2(std::max(x1, x0 + 2.0f), origin.y + height - 2.0f), color);
+            ImGui::Dummy(ImVec2(width, height));
+        }
+        ImGui::EndTable();
+    }
+}
+
 void ImGuiManager::RenderStatusControlsSection() {
     // --- Status & Controls Section ---
     if (ImGui::CollapsingHeader("Status")) {
@@ -114,6 +184,10 @@ void ImGuiManager::RenderStatusControlsSection() {
             default:                       msgSendStatusStr = "Not Found/Hooked"; break;
         }
         ImGui::Text("MsgSend Hook: %s", msgSendStatusStr);
+        if (kx::g_msgSendHookStatus == kx::HookStatus::OK && !IsMsgSendHookEnabled()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(disabled while not capturing)");
+        }
 
         if (kx::g_msgSendAddress != 0) {
             ImGui::Text("MsgSend Address: 0x%p", (void*)kx::g_msgSendAddress);
@@ -135,6 +209,10 @@ void ImGuiManager::RenderStatusControlsSection() {
             default:                       msgRecvStatusStr = "Unknown Status"; break;
         }
         ImGui::Text("MsgRecv Hook: %s", msgRecvStatusStr);
+        if (kx::g_msgRecvHookStatus == kx::HookStatus::OK && !AreMessageHandlerHooksEnabled()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(disabled while not capturing)");
+        }
 
         if (kx::g_msgRecvAddress != 0) {
             ImGui::Text("MsgRecv Address: 0x%p", (void*)kx::g_msgRecvAddress);
@@ -147,6 +225,82 @@ void ImGuiManager::RenderStatusControlsSection() {
         } else {
             ImGui::Text("MsgRecv Address: N/A");
         }
+
+        const kx::Startup::TimelineSummary startup = kx::Startup::GetTimelineSummary();
+        if (startup.stageCount > 0 &&
+            ImGui::TreeNode("StartupTimeline", "Startup: %.1f ms (%.1f ms of work in %zu stages)", startup.endMs, startup.stageSumMs, startup.stageCount)) {
+            RenderStartupTimeline();
+            ImGui::TreePop();
+        }
+
+        // Measured up to the end of the previous frame
+        ImGui::Text("Overlay Cost: %.2f ms (avg %.2f, peak %.2f) / budget %.2f ms",
+            m_frameBudget.GetLastMs(), m_frameBudget.GetAverageMs(), m_frameBudget.GetPeakMs(), kx::g_overlayBudgetMs);
+        if (m_frameBudget.GetLevel() > 0) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "(reduced detail %d/%d)", m_frameBudget.GetLevel(), kx::Gui::FrameBudget::MAX_LEVEL);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Over budget: the log view refreshes every %u frames, statistics every %u frames,\n"
+                                  "and hex previews are shortened.",
+                                  m_frameBudget.GetViewRefreshInterval(), m_frameBudget.GetStatsRefreshInterval());
+            }
+        }
+
+        const kx::Schema::CatalogStatus catalogStatus = kx::Schema::GetCatalogStatus();
+        if (catalogStatus.version != 0) {
+            ImGui::Text("Schema Catalogue: %zu messages (v%llu)", catalogStatus.messageCount,
+                static_cast<unsigned long long>(catalogStatus.version));
+        } else {
+            ImGui::Text("Schema Catalogue: Not loaded (built-in names)");
+        }
+        if (ImGui::IsItemHovered() && !catalogStatus.path.empty()) {
+            ImGui::SetTooltip("%s", catalogStatus.path.c_str());
+        }
+        if (!catalogStatus.lastError.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Catalogue error: %s", catalogStatus.lastError.c_str());
+        }
+
+        const kx::Schema::HarvesterStatus harvesterStatus = kx::Schema::GetHarvesterStatus();
+        ImGui::Text("Harvested Schemas: %zu new, %zu from file, %zu pending, %zu failed",
+            harvesterStatus.harvestedCount, harvesterStatus.loadedCount,
+            harvesterStatus.pendingCount, harvesterStatus.failedCount);
+        if (ImGui::IsItemHovered() && !harvesterStatus.path.empty()) {
+            ImGui::SetTooltip("%s", harvesterStatus.path.c_str());
+        }
+        if (!harvesterStatus.lastError.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Harvester error: %s", harvesterStatus.lastError.c_str());
+        }
+    }
+}
+
+namespace {
+    // Compiles the text of a filter expression input; an empty text means no filter. An
+    // invalid text leaves `program` as it was, so the last valid filter stays in effect while
+    // the user types. Returns true if `program` changed.
+    bool CompileFilterInput(const char* text, bool allowFields, std::shared_ptr<const kx::Filtering::FilterProgram>& program,
+                            std::string& error) {
+        error.clear();
+        if (std::string_view(text).find_first_not_of(" \t") == std::string_view::npos) {
+            const bool changed = program != nullptr;
+            program.reset();
+            return changed;
+        }
+        std::optional<kx::Filtering::FilterProgram> compiled = kx::Filtering::FilterProgram::Compile(text, &error);
+        if (!compiled) {
+            return false;
+        }
+        if (!allowFields && compiled->UsesFields()) {
+            error = "field(...) is not available here: decoding fields would slow the game down";
+            return false;
+        }
+        program = std::make_shared<const kx::Filtering::FilterProgram>(std::move(*compiled));
+        return true;
+    }
+
+    void RenderFilterError(const std::string& error) {
+        if (!error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s (the last valid expression stays in effect)", error.c_str());
+        }
     }
 }
 
@@ -154,6 +308,10 @@ void ImGuiManager::RenderFilteringSection() {
     if (ImGui::CollapsingHeader("Filtering")) {
 		// Reset Filters Button
 		if (ImGui::Button("Reset Filters")) {
+		    kx::g_filterStateVersion++;
+		    kx::g_displayFilterExpression.reset();
+		    m_displayFilterInput[0] = '\0';
+		    m_displayFilterError.clear();
 		    kx::g_packetFilterMode = kx::FilterMode::ShowAll;
 		    kx::g_packetDirectionFilterMode = kx::DirectionFilterMode::ShowAll;
 		    for (auto& pair : kx::g_packetHeaderFilterSelection) {
@@ -165,18 +323,53 @@ void ImGuiManager::RenderFilteringSection() {
 		}
 		ImGui::Separator(); // Add separator after the button
 
+        bool filterChanged = false;
+
+        // --- Filter Expressions (syntax in FilterExpression.h) ---
+        ImGui::SetNextItemWidth(-110.0f);
+        if (ImGui::InputTextWithHint("Show Where", "e.g. recv && op in {0x12, 0x100..0x1FF} && data[4:8] == 0xDEADBEEF",
+                                     m_displayFilterInput.data(), m_displayFilterInput.size())) {
+            filterChanged |= CompileFilterInput(m_displayFilterInput.data(), true, kx::g_displayFilterExpression, m_displayFilterError);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Subjects: op, size, time, data[a], data[a:b], u8..u64[a], i8..i64[a], field(\"name\"), name\n"
+                              "Tests: == != < <= > >=, in {v, lo..hi}, ~ \"DE ? BE EF\" (bytes) or ~ \"text\", & mask\n"
+                              "Combine with && || ! and parentheses; sent and recv stand alone.");
+        }
+        RenderFilterError(m_displayFilterError);
+
+        // Applied only on Enter: packets a half-typed expression drops are lost for good.
+        ImGui::SetNextItemWidth(-110.0f);
+        if (ImGui::InputTextWithHint("Capture Where", "press Enter to apply; packets that fail are counted but not logged",
+                                     m_captureFilterInput.data(), m_captureFilterInput.size(), ImGuiInputTextFlags_EnterReturnsTrue)) {
+            std::shared_ptr<const kx::Filtering::FilterProgram> captureFilter = kx::g_captureFilterExpression.load();
+            if (CompileFilterInput(m_captureFilterInput.data(), false, captureFilter, m_captureFilterError)) {
+                kx::g_captureFilterExpression.store(std::move(captureFilter));
+            }
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Same syntax, without field(...). Applied when Enter is pressed and evaluated on the\n"
+                              "game's threads as packets arrive; traffic statistics still count every packet.");
+        }
+        if (const std::shared_ptr<const kx::Filtering::FilterProgram> active = kx::g_captureFilterExpression.load();
+            active && active->GetText() != m_captureFilterInput.data()) {
+            ImGui::TextDisabled("Capturing where: %s (edited, press Enter to apply)", active->GetText().c_str());
+        }
+        RenderFilterError(m_captureFilterError);
+        ImGui::Separator();
+
         // --- Global Direction Filter ---
         ImGui::Text("Show Direction:"); ImGui::SameLine();
-        ImGui::RadioButton("All##Dir", reinterpret_cast<int*>(&kx::g_packetDirectionFilterMode), static_cast<int>(kx::DirectionFilterMode::ShowAll)); ImGui::SameLine();
-        ImGui::RadioButton("Sent##Dir", reinterpret_cast<int*>(&kx::g_packetDirectionFilterMode), static_cast<int>(kx::DirectionFilterMode::ShowSentOnly)); ImGui::SameLine();
-        ImGui::RadioButton("Received##Dir", reinterpret_cast<int*>(&kx::g_packetDirectionFilterMode), static_cast<int>(kx::DirectionFilterMode::ShowReceivedOnly));
+        filterChanged |= ImGui::RadioButton("All##Dir", reinterpret_cast<int*>(&kx::g_packetDirectionFilterMode), static_cast<int>(kx::DirectionFilterMode::ShowAll)); ImGui::SameLine();
+        filterChanged |= ImGui::RadioButton("Sent##Dir", reinterpret_cast<int*>(&kx::g_packetDirectionFilterMode), static_cast<int>(kx::DirectionFilterMode::ShowSentOnly)); ImGui::SameLine();
+        filterChanged |= ImGui::RadioButton("Received##Dir", reinterpret_cast<int*>(&kx::g_packetDirectionFilterMode), static_cast<int>(kx::DirectionFilterMode::ShowReceivedOnly));
         ImGui::Separator();
 
         // --- Header/Type Filter Mode ---
         ImGui::Text("Filter Mode:"); ImGui::SameLine();
-        ImGui::RadioButton("Show All Types", reinterpret_cast<int*>(&kx::g_packetFilterMode), static_cast<int>(kx::FilterMode::ShowAll)); ImGui::SameLine();
-        ImGui::RadioButton("Include Checked", reinterpret_cast<int*>(&kx::g_packetFilterMode), static_cast<int>(kx::FilterMode::IncludeOnly)); ImGui::SameLine();
-        ImGui::RadioButton("Exclude Checked", reinterpret_cast<int*>(&kx::g_packetFilterMode), static_cast<int>(kx::FilterMode::Exclude));
+        filterChanged |= ImGui::RadioButton("Show All Types", reinterpret_cast<int*>(&kx::g_packetFilterMode), static_cast<int>(kx::FilterMode::ShowAll)); ImGui::SameLine();
+        filterChanged |= ImGui::RadioButton("Include Checked", reinterpret_cast<int*>(&kx::g_packetFilterMode), static_cast<int>(kx::FilterMode::IncludeOnly)); ImGui::SameLine();
+        filterChanged |= ImGui::RadioButton("Exclude Checked", reinterpret_cast<int*>(&kx::g_packetFilterMode), static_cast<int>(kx::FilterMode::Exclude));
 
         // --- Checkbox Section (only if mode is Include/Exclude) ---
         if (kx::g_packetFilterMode != kx::FilterMode::ShowAll) {
@@ -191,7 +384,7 @@ void ImGuiManager::RenderFilteringSection() {
                         uint16_t headerId = pair.first.second;
                         bool& selected = pair.second;
                         std::string name = kx::GetPacketName(kx::PacketDirection::Sent, headerId); // Get name again for display
-                        ImGui::Checkbox(name.c_str(), &selected);
+                        filterChanged |= ImGui::Checkbox(name.c_str(), &selected);
                     }
                 }
                 ImGui::TreePop();
@@ -213,7 +406,7 @@ void ImGuiManager::RenderFilteringSection() {
                             uint16_t headerId = pair.first.second;
                             bool& selected = pair.second;
                             std::string name = kx::GetPacketName(kx::PacketDirection::Received, headerId);
-                            ImGui::Checkbox(name.c_str(), &selected);
+                            filterChanged |= ImGui::Checkbox(name.c_str(), &selected);
                         }
                     }
                 }
@@ -228,7 +421,7 @@ void ImGuiManager::RenderFilteringSection() {
                     kx::InternalPacketType type = pair.first;
                     bool& selected = pair.second;
                     std::string name = kx::GetSpecialPacketTypeName(type);
-                    ImGui::Checkbox(name.c_str(), &selected);
+                    filterChanged |= ImGui::Checkbox(name.c_str(), &selected);
                 }
                 ImGui::TreePop();
             }
@@ -237,15 +430,307 @@ void ImGuiManager::RenderFilteringSection() {
             ImGui::EndChild();
         }
         ImGui::Separator();
+
+        if (filterChanged) {
+            kx::g_filterStateVersion++;
+        }
     }
     ImGui::Spacing();
 }
 
-// Helper function to render a single row in the packet log
-void ImGuiManager::RenderSinglePacketLogRow(const kx::PacketInfo& packet, int display_index, int original_log_index) {
-    std::string displayLogEntry = kx::Utils::FormatDisplayLogEntryString(packet);
+void ImGuiManager::RenderDisplaySettingsSection() {
+    if (ImGui::CollapsingHeader("Display")) {
+        bool displayChanged = false;
+
+        ImGui::Text("Timestamps:"); ImGui::SameLine();
+        displayChanged |= ImGui::RadioButton("Milliseconds", reinterpret_cast<int*>(&kx::g_timestampFormat), static_cast<int>(kx::TimestampFormat::Millis)); ImGui::SameLine();
+        displayChanged |= ImGui::RadioButton("Microseconds", reinterpret_cast<int*>(&kx::g_timestampFormat), static_cast<int>(kx::TimestampFormat::Micros));
+
+        ImGui::SetNextItemWidth(200.0f);
+        displayChanged |= ImGui::SliderInt("Hex Bytes per Row", &kx::g_displayHexByteLimit, 1, 256);
+
+        if (displayChanged) {
+            kx::g_displaySettingsVersion++;
+            m_fullLogEntryBuffer.clear(); // The details pane shows the timestamp too; rebuilt next frame
+        }
+
+        // Not display settings as such: the effective limits are applied by the frame budget each frame.
+        ImGui::Checkbox("Adaptive Frame Budget", &kx::g_overlayBudgetEnabled);
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!kx::g_overlayBudgetEnabled);
+        ImGui::SetNextItemWidth(150.0f);
+        ImGui::SliderFloat("Budget (ms)", &kx::g_overlayBudgetMs, 0.1f, 5.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+        ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+            ImGui::SetTooltip("Overlay CPU time allowed per game frame. Above it the log view and statistics\n"
+                              "refresh less often and hex previews get shorter until the cost is back under budget.");
+        }
+        ImGui::Text("Row cache: %zu rows, %llu hits, %llu misses", m_rowTextCache.GetSize(),
+            static_cast<unsigned long long>(m_rowTextCache.GetHitCount()),
+            static_cast<unsigned long long>(m_rowTextCache.GetMissCount()));
+        ImGui::Separator();
+    }
+    ImGui::Spacing();
+}
+
+namespace {
+    enum TrafficStatsColumn {
+        TrafficColumn_Direction,
+        TrafficColumn_Opcode,
+        TrafficColumn_Name,
+        TrafficColumn_Count,
+        TrafficColumn_Bytes,
+        TrafficColumn_MinSize,
+        TrafficColumn_AvgSize,
+        TrafficColumn_MaxSize,
+        TrafficColumn_Rate1s,
+        TrafficColumn_Rate10s,
+        TrafficColumn_Rate60s,
+        TrafficColumn_ByteRate,
+        TrafficColumn_History,
+        TrafficColumn_Count_
+    };
+
+    double GetTrafficSortValue(const kx::Stats::OpcodeStats& stats, int column) {
+        switch (column) {
+        case TrafficColumn_Direction: return static_cast<double>(stats.direction);
+        case TrafficColumn_Opcode:    return stats.opcode;
+        case TrafficColumn_Bytes:     return static_cast<double>(stats.totalBytes);
+        case TrafficColumn_MinSize:   return stats.minSize;
+        case TrafficColumn_AvgSize:   return static_cast<double>(stats.totalBytes) / static_cast<double>(stats.count);
+        case TrafficColumn_MaxSize:   return stats.maxSize;
+        case TrafficColumn_Rate1s:    return stats.rate1s;
+        case TrafficColumn_Rate10s:   return stats.rate10s;
+        case TrafficColumn_Rate60s:   return stats.rate60s;
+        case TrafficColumn_ByteRate:  return stats.byteRate10s;
+        default:                      return static_cast<double>(stats.count);
+        }
+    }
+}
+
+// Live per-opcode traffic statistics. Counted at capture time, so they cover packets the log filters hide.
+void ImGuiManager::RenderTrafficStatsSection() {
+    if (!ImGui::CollapsingHeader("Traffic Statistics")) {
+        return;
+    }
+
+    // Snapshots are deferred when over the frame budget; sorting is redone only for a new snapshot or sort order.
+    bool snapshotTaken = false;
+    if (m_frameBudget.GetFrameIndex() >= m_trafficStatsDueFrame) {
+        kx::Stats::Snapshot(m_trafficStats);
+        m_trafficStatsDueFrame = m_frameBudget.GetFrameIndex() + m_frameBudget.GetStatsRefreshInterval();
+        snapshotTaken = true;
+    }
+
+    uint64_t totalCount = 0;
+    float totalRate = 0.0f;
+    for (const kx::Stats::OpcodeStats& stats : m_trafficStats) {
+        totalCount += stats.count;
+        totalRate += stats.rate10s;
+    }
+    ImGui::Text("Opcodes: %zu | Packets: %llu | Rate (10s): %.1f/s", m_trafficStats.size(),
+                static_cast<unsigned long long>(totalCount), totalRate);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Reset##TrafficStats")) {
+        kx::Stats::Reset();
+        m_trafficStatsDueFrame = 0; // Show the reset next frame
+    }
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+                                  ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingFixedFit;
+    if (!ImGui::BeginTable("TrafficStats", TrafficColumn_Count_, flags, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 12))) {
+        m_trafficStatsDueFrame = 0; // A snapshot taken now was not sorted; take a new one once visible
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Dir", 0, 0.0f, TrafficColumn_Direction);
+    ImGui::TableSetupColumn("Opcode", 0, 0.0f, TrafficColumn_Opcode);
+    ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_NoSort, 0.0f, TrafficColumn_Name);
+    ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_Count);
+    ImGui::TableSetupColumn("Bytes", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_Bytes);
+    ImGui::TableSetupColumn("Min", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_MinSize);
+    ImGui::TableSetupColumn("Avg", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_AvgSize);
+    ImGui::TableSetupColumn("Max", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_MaxSize);
+    ImGui::TableSetupColumn("1s", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_Rate1s);
+    ImGui::TableSetupColumn("10s", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_DefaultSort, 0.0f, TrafficColumn_Rate10s);
+    ImGui::TableSetupColumn("60s", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_Rate60s);
+    ImGui::TableSetupColumn("B/s (10s)", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TrafficColumn_ByteRate);
+    ImGui::TableSetupColumn("Last 60s", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthStretch, 0.0f, TrafficColumn_History);
+    ImGui::TableHeadersRow();
+
+    ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+    if (sortSpecs && sortSpecs->SpecsCount > 0 && (snapshotTaken || sortSpecs->SpecsDirty)) {
+        sortSpecs->SpecsDirty = false;
+        const ImGuiTableColumnSortSpecs spec = sortSpecs->Specs[0];
+        std::stable_sort(m_trafficStats.begin(), m_trafficStats.end(),
+            [&spec](const kx::Stats::OpcodeStats& a, const kx::Stats::OpcodeStats& b) {
+                const double va = GetTrafficSortValue(a, spec.ColumnUserID);
+                const double vb = GetTrafficSortValue(b, spec.ColumnUserID);
+                return spec.SortDirection == ImGuiSortDirection_Ascending ? va < vb : va > vb;
+            });
+    }
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(m_trafficStats.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const kx::Stats::OpcodeStats& stats = m_trafficStats[row];
+            ImGui::TableNextRow();
+            ImGui::PushID(row);
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(stats.direction == kx::PacketDirection::Sent ? "S" : "R");
+            ImGui::TableNextColumn(); ImGui::Text("0x%04X", stats.opcode);
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(kx::GetPacketName(stats.direction, stats.opcode).c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(stats.count));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(stats.totalBytes));
+            ImGui::TableNextColumn(); ImGui::Text("%u", stats.minSize);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", static_cast<double>(stats.totalBytes) / static_cast<double>(stats.count));
+            ImGui::TableNextColumn(); ImGui::Text("%u", stats.maxSize);
+            ImGui::TableNextColumn(); ImGui::Text("%.0f", stats.rate1s);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", stats.rate10s);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", stats.rate60s);
+            ImGui::TableNextColumn(); ImGui::Text("%.0f", stats.byteRate10s);
+            ImGui::TableNextColumn();
+            ImGui::PlotLines("##History", stats.history.data(), static_cast<int>(stats.history.size()), 0, nullptr,
+                             0.0f, FLT_MAX, ImVec2(-FLT_MIN, ImGui::GetTextLineHeight()));
+            ImGui::PopID();
+        }
+    }
+    clipper.End();
+    ImGui::EndTable();
+}
+
+void ImGuiManager::RenderReanalysisSection() {
+    const kx::Analysis::AnalysisReport* report = kx::Analysis::GetLastReanalysisReport();
+    if (!report) {
+        return;
+    }
+
+    if (ImGui::CollapsingHeader("Re-analysis Results")) {
+        ImGui::Text("Packets: %zu | Decoded: %llu | Unknown headers: %llu",
+            report->packetCount,
+            static_cast<unsigned long long>(report->decodedCount),
+            static_cast<unsigned long long>(report->unknownHeaderCount));
+        ImGui::Text("Chunks: %zu | Threads: %zu | Time: %.1f ms",
+            report->chunkCount, report->threadCount, report->elapsedMs);
+
+        const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+        if (ImGui::BeginTable("ReanalysisOpcodes", 6, flags, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 10))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Name");
+            ImGui::TableSetupColumn("Opcode");
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Bytes");
+            ImGui::TableSetupColumn("Size (min/max)");
+            ImGui::TableSetupColumn("Decoded");
+            ImGui::TableHeadersRow();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(report->opcodes.size()));
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    const kx::Analysis::OpcodeSummary& summary = report->opcodes[row];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(summary.name.c_str());
+                    ImGui::TableNextColumn(); ImGui::Text("0x%04X", summary.opcode);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(summary.count));
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(summary.totalBytes));
+                    ImGui::TableNextColumn(); ImGui::Text("%d / %d", summary.minSize, summary.maxSize);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(summary.decodedCount));
+                }
+            }
+            clipper.End();
+            ImGui::EndTable();
+        }
+    }
+}
+
+void ImGuiManager::RenderParserDiagnosticsSection() {
+    if (ImGui::CollapsingHeader("Parser Diagnostics")) {
+        if (kx::Parsing::IsParserSelfCheckRunning()) {
+            ImGui::TextUnformatted("Running parser self-check...");
+        }
+        else if (ImGui::Button("Run Parser Self-Check")) {
+            kx::Parsing::StartParserSelfCheck();
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("(?)");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Runs every registered parser against generated, layout-structured, random\n"
+                              "and truncated payloads plus the captured log. Exceptions, output for packets\n"
+                              "of another direction/opcode, or rejecting a payload its layout fully\n"
+                              "describes indicate a parser bug.");
+        }
+
+        const std::vector<kx::Parsing::ParserCheckResult>* results = kx::Parsing::GetParserSelfCheckResults();
+        if (!results) {
+            return;
+        }
+
+        const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+        if (ImGui::BeginTable("ParserChecks", 7, flags, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 10))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Parser");
+            ImGui::TableSetupColumn("Inputs");
+            ImGui::TableSetupColumn("Decoded");
+            ImGui::TableSetupColumn("Structured");
+            ImGui::TableSetupColumn("Corpus");
+            ImGui::TableSetupColumn("Failures");
+            ImGui::TableSetupColumn("ns/packet");
+            ImGui::TableHeadersRow();
+
+            for (const kx::Parsing::ParserCheckResult& result : *results) {
+                const uint64_t failures = result.exceptions + result.contractViolations + result.layoutMismatches;
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(result.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(result.inputs));
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(result.decoded));
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(result.structuredInputs));
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(result.corpusInputs));
+                ImGui::TableNextColumn();
+                if (failures > 0) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%llu", static_cast<unsigned long long>(failures));
+                }
+                else {
+                    ImGui::TextUnformatted("0");
+                }
+                ImGui::TableNextColumn(); ImGui::Text("%.0f", result.nsPerPacket);
+            }
+            ImGui::EndTable();
+        }
+    }
+}
+
+namespace {
+    enum PacketTableColumn {
+        PacketColumn_Time,
+        PacketColumn_Delta,
+        PacketColumn_Direction,
+        PacketColumn_Opcode,
+        PacketColumn_Name,
+        PacketColumn_Size,
+        PacketColumn_Data,
+        PacketColumn_Copy,
+        PacketColumn_Count_
+    };
+
+    kx::Filtering::SortColumn GetPacketSortColumn(ImGuiID columnUserId) {
+        switch (columnUserId) {
+        case PacketColumn_Delta:     return kx::Filtering::SortColumn::TimeDelta;
+        case PacketColumn_Direction: return kx::Filtering::SortColumn::Direction;
+        case PacketColumn_Opcode:    return kx::Filtering::SortColumn::Opcode;
+        case PacketColumn_Size:      return kx::Filtering::SortColumn::Size;
+        default:                     return kx::Filtering::SortColumn::Arrival;
+        }
+    }
+}
+
+// Helper function to render a single row of the packet table
+void ImGuiManager::RenderSinglePacketLogRow(const kx::PacketInfo& packet, uint32_t store_index, int display_index) {
+    // Timestamp and hex are formatted once per packet and display-settings version; scrolling back costs no formatting.
+    const kx::Utils::RowText& rowText = m_rowTextCache.Get(packet);
 
     ImGui::PushID(display_index);
+    ImGui::TableNextRow();
 
     // --- Color Coding ---
     ImVec4 textColor;
@@ -257,56 +742,42 @@ void ImGuiManager::RenderSinglePacketLogRow(const kx::PacketInfo& packet, int di
     ImGui::PushStyleColor(ImGuiCol_Text, textColor);
     // --- End Color Coding ---
 
-    // Calculate widths for layout to prevent the selectable from consuming the button's space.
-    float button_width = ImGui::CalcTextSize("Copy").x + ImGui::GetStyle().FramePadding.x * 2.0f;
-    float selectable_width = ImGui::GetContentRegionAvail().x - button_width - ImGui::GetStyle().ItemSpacing.x;
-
-    // Use Selectable with an explicit width to leave space for the button
-    bool is_selected = (m_selectedPacketLogIndex == original_log_index);
-    if (ImGui::Selectable(displayLogEntry.c_str(), is_selected, ImGuiSelectableFlags_AllowDoubleClick, ImVec2(selectable_width, 0))) {
-        m_selectedPacketLogIndex = original_log_index;
+    // The selectable spans the whole row; AllowOverlap keeps the Copy button clickable.
+    ImGui::TableSetColumnIndex(PacketColumn_Time);
+    bool is_selected = (m_selectedPacketId == packet.id);
+    if (ImGui::Selectable(rowText.timestamp.c_str(), is_selected,
+                          ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap | ImGuiSelectableFlags_AllowDoubleClick)) {
+        m_selectedPacketId = packet.id;
         // Clear buffer to force re-parsing when a new packet is selected
         m_parsedPayloadBuffer.clear();
         m_fullLogEntryBuffer.clear(); // Clear full log entry buffer
     }
+
+    ImGui::TableSetColumnIndex(PacketColumn_Delta);
+    ImGui::Text("+%.3f", static_cast<double>(m_sortedView.GetTimeDeltaUs(store_index)) / 1000.0);
+    ImGui::TableSetColumnIndex(PacketColumn_Direction);
+    ImGui::TextUnformatted(packet.direction == kx::PacketDirection::Sent ? "S" : "R");
+    ImGui::TableSetColumnIndex(PacketColumn_Opcode);
+    ImGui::Text("0x%04X", packet.rawHeaderId);
+    ImGui::TableSetColumnIndex(PacketColumn_Name);
+    ImGui::TextUnformatted(packet.name.c_str());
+    ImGui::TableSetColumnIndex(PacketColumn_Size);
+    ImGui::Text("%zu", packet.data.size());
+    ImGui::TableSetColumnIndex(PacketColumn_Data);
+    ImGui::TextUnformatted(rowText.hexPreview.c_str());
     ImGui::PopStyleColor(); // Pop text color style
 
-    // Place the button on the same line; it will now fit in the space reserved for it.
-    ImGui::SameLine();
+    ImGui::TableSetColumnIndex(PacketColumn_Copy);
     if (ImGui::SmallButton("Copy")) {
-        std::string fullLogEntry = kx::Utils::FormatFullLogEntryString(packet);
+        std::string fullLogEntry = kx::Utils::FormatFullLogEntryString(packet, kx::g_timestampFormat);
         ImGui::SetClipboardText(fullLogEntry.c_str());
     }
 
     ImGui::PopID();
 }
 
-// Acquires lock, filters packets, and returns a snapshot for rendering.
-std::vector<kx::PacketInfo> ImGuiManager::GetFilteredPacketsSnapshot(size_t& out_total_packets, std::vector<int>& out_original_indices) {
-    std::vector<kx::PacketInfo> packets_to_render;
-    out_total_packets = 0;
-    out_original_indices.clear();
-    {
-        // Lock scope for accessing global log and creating copy
-        std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
-        out_total_packets = kx::g_packetLog.size(); // Get total count first
-        std::vector<int> filtered_indices = kx::Filtering::GetFilteredPacketIndices(kx::g_packetLog);
-
-        packets_to_render.reserve(filtered_indices.size());
-        out_original_indices.reserve(filtered_indices.size());
-        for (int index : filtered_indices) {
-            // Double-check index validity against the *current* size under lock
-            if (index >= 0 && static_cast<size_t>(index) < kx::g_packetLog.size()) {
-                packets_to_render.push_back(kx::g_packetLog[index]);
-                out_original_indices.push_back(index);
-            }
-        }
-    }
-    return packets_to_render;
-}
-
-// Renders the control buttons (Clear, Copy All) and checkbox (Pause) for the packet log.
-void ImGuiManager::RenderPacketLogControls(size_t displayed_count, size_t total_count, const std::vector<kx::PacketInfo>& packets_to_render) {
+// Renders the control buttons (Clear, Copy All) and capture checkboxes (Pause, directions) for the packet log.
+void ImGuiManager::RenderPacketLogControls(size_t displayed_count, size_t total_count) {
     // Define danger colors locally for the Clear Log button
     const ImVec4 dangerRed       = ImVec4(220.0f / 255.0f, 53.0f / 255.0f, 69.0f / 255.0f, 1.0f);
     const ImVec4 dangerRedHover  = ImVec4(std::min(dangerRed.x * 1.1f, 1.0f), std::min(dangerRed.y * 1.1f, 1.0f), std::min(dangerRed.z * 1.1f, 1.0f), 1.0f);
@@ -318,9 +789,13 @@ void ImGuiManager::RenderPacketLogControls(size_t displayed_count, size_t total_
     ImGui::PushStyleColor(ImGuiCol_ButtonActive, dangerRedActive);
 
     if (ImGui::Button("Clear Log")) {
-        std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
-        kx::g_packetLog.clear();
-        m_selectedPacketLogIndex = -1; // Reset selected index
+        kx::Analysis::CancelReanalysis(); // Its indices would no longer match; does not wait
+        kx::Export::CancelExport();       // Likewise for the export's indices
+        kx::g_packetLog.Clear();          // Waits for background readers
+        m_packetView.Reset();             // Its indices refer to the cleared packets
+        m_sortedView.Reset();
+        m_rowTextCache.Clear();
+        m_selectedPacketId = 0; // Reset selection
         m_parsedPayloadBuffer.clear(); // Clear parsed buffer
         m_fullLogEntryBuffer.clear(); // Clear full log entry buffer
     }
@@ -328,51 +803,202 @@ void ImGuiManager::RenderPacketLogControls(size_t displayed_count, size_t total_
     ImGui::PopStyleColor(3); // Restore default button colors
 
     ImGui::SameLine();
+    // The clipboard copy runs on the render thread, so it is capped; bigger logs go through the file export.
+    const bool clipboardTooLarge = displayed_count > kx::Export::CLIPBOARD_MAX_PACKETS;
+    ImGui::BeginDisabled(clipboardTooLarge);
     if (ImGui::Button("Copy All")) {
-        if (!packets_to_render.empty()) {
-            std::stringstream ss;
-            for (const auto& packet : packets_to_render) {
-                ss << kx::Utils::FormatFullLogEntryString(packet) << "\n";
+        if (!m_packetView.GetIndices().empty()) {
+            std::string text;
+            for (uint32_t index : m_packetView.GetIndices()) {
+                kx::Utils::AppendLogEntryString(text, kx::g_packetLog[index], -1, kx::g_timestampFormat);
+                text += '\n';
             }
-            ImGui::SetClipboardText(ss.str().c_str());
+            ImGui::SetClipboardText(text.c_str());
         }
     }
+    ImGui::EndDisabled();
+    if (clipboardTooLarge && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip("More than %zu packets shown; use Export to File instead.", kx::Export::CLIPBOARD_MAX_PACKETS);
+    }
 
+    // Each switch disables or re-enables the game hooks (ApplyCaptureState), so capture that
+    // is off costs the game nothing; statistics stop counting with it.
+    ImGui::SameLine();
+    bool paused = kx::g_capturePaused.load(std::memory_order_relaxed);
+    if (ImGui::Checkbox("Pause Capture", &paused)) {
+        kx::g_capturePaused.store(paused, std::memory_order_relaxed);
+        kx::ApplyCaptureState();
+    }
+    ImGui::SameLine();
+    ImGui::BeginGroup(); // One tooltip for both direction checkboxes
+    ImGui::BeginDisabled(paused);
+    bool captureSent = kx::g_captureSent.load(std::memory_order_relaxed);
+    if (ImGui::Checkbox("Sent##Capture", &captureSent)) {
+        kx::g_captureSent.store(captureSent, std::memory_order_relaxed);
+        kx::ApplyCaptureState();
+    }
     ImGui::SameLine();
-    ImGui::Checkbox("Pause Capture", &kx::g_capturePaused);
+    bool captureReceived = kx::g_captureReceived.load(std::memory_order_relaxed);
+    if (ImGui::Checkbox("Received##Capture", &captureReceived)) {
+        kx::g_captureReceived.store(captureReceived, std::memory_order_relaxed);
+        kx::ApplyCaptureState();
+    }
+    ImGui::EndDisabled();
+    ImGui::EndGroup();
+    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip("Directions to capture. A direction that is off has its game hook disabled:\n"
+                          "nothing is captured or counted, and the game runs its original code.");
+    }
+
+    // Re-run classification and parsers over the whole log (e.g. after adding parsers or names)
+    ImGui::SameLine();
+    if (kx::Analysis::IsReanalysisRunning()) {
+        ImGui::ProgressBar(kx::Analysis::GetReanalysisProgress(), ImVec2(120.0f, 0.0f));
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Cancel##Reanalysis")) {
+            kx::Analysis::CancelReanalysis();
+        }
+    }
+    else if (ImGui::Button("Re-analyse All")) {
+        kx::Analysis::StartLogReanalysis();
+    }
+
+    RenderExportControls();
 }
 
-// Renders the list of packets using ImGuiListClipper for efficiency.
-void ImGuiManager::RenderPacketListWithClipping(const std::vector<kx::PacketInfo>& packets_to_render, const std::vector<int>& original_indices_snapshot) {
-    // Use clipper only if there are items to display in our copy
-    if (!packets_to_render.empty())
-    {
-        ImGuiListClipper clipper;
-        clipper.Begin(packets_to_render.size());
-		while (clipper.Step())
-        {
-			// No lock needed here, operating on packets_to_render copy
-			for (int display_index = clipper.DisplayStart; display_index < clipper.DisplayEnd; ++display_index)
-			{
-				// Call the helper function to render the row
-				RenderSinglePacketLogRow(packets_to_render[display_index], display_index, original_indices_snapshot[display_index]);
-			}
-		}
-        clipper.End();
+// Renders the file export format, start/cancel button, progress and last result.
+void ImGuiManager::RenderExportControls() {
+    const bool running = kx::Export::IsExportRunning();
+
+    ImGui::BeginDisabled(running);
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("JSON lines").x + ImGui::GetFrameHeight() + ImGui::GetStyle().FramePadding.x * 2.0f);
+    if (ImGui::BeginCombo("##ExportFormat", kx::Export::GetExportFormatName(m_exportFormat))) {
+        for (kx::Export::ExportFormat format : { kx::Export::ExportFormat::Text, kx::Export::ExportFormat::Csv, kx::Export::ExportFormat::JsonLines }) {
+            if (ImGui::Selectable(kx::Export::GetExportFormatName(format), format == m_exportFormat)) {
+                m_exportFormat = format;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+    if (running) {
+        ImGui::ProgressBar(kx::Export::GetExportProgress(), ImVec2(120.0f, 0.0f));
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Cancel##Export")) {
+            kx::Export::CancelExport();
+        }
+    }
+    else {
+        ImGui::BeginDisabled(m_packetView.GetIndices().empty());
+        if (ImGui::Button("Export to File")) {
+            // Exports the filtered view, like Copy All
+            kx::Export::StartLogExport(m_packetView.GetIndices(), m_exportFormat, kx::g_timestampFormat);
+        }
+        ImGui::EndDisabled();
+    }
+
+    const kx::Export::ExportStatus status = kx::Export::GetExportStatus();
+    if (status.path.empty() || running) {
+        return;
+    }
+    if (!status.lastError.empty()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Export failed: %s", status.lastError.c_str());
+    }
+    else if (status.cancelled) {
+        ImGui::TextDisabled("Export cancelled.");
+    }
+    else {
+        ImGui::TextDisabled("Exported %zu packets (%.1f MB, %.0f ms) to %s", status.writtenCount,
+                            static_cast<double>(status.bytesWritten) / (1024.0 * 1024.0), status.elapsedMs, status.path.c_str());
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Click to copy the path.");
+        }
+        if (ImGui::IsItemClicked()) {
+            ImGui::SetClipboardText(status.path.c_str());
+        }
     }
 }
 
+// Renders the packet table, sorted by the chosen column, using ImGuiListClipper for efficiency.
+void ImGuiManager::RenderPacketListWithClipping(float height) {
+    const ImGuiTableFlags flags = ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable |
+                                  ImGuiTableFlags_Hideable | ImGuiTableFlags_Sortable | ImGuiTableFlags_SizingFixedFit;
+    if (!ImGui::BeginTable("PacketTable", PacketColumn_Count_, flags, ImVec2(0.0f, height))) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_DefaultSort, 0.0f, PacketColumn_Time);
+    ImGui::TableSetupColumn("Delta (ms)", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, PacketColumn_Delta);
+    ImGui::TableSetupColumn("Dir", 0, 0.0f, PacketColumn_Direction);
+    ImGui::TableSetupColumn("Opcode", 0, 0.0f, PacketColumn_Opcode);
+    ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_NoSort, 0.0f, PacketColumn_Name);
+    ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, PacketColumn_Size);
+    ImGui::TableSetupColumn("Data", ImGuiTableColumnFlags_NoSort, 0.0f, PacketColumn_Data);
+    ImGui::TableSetupColumn("##Copy", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_NoHide | ImGuiTableColumnFlags_NoResize, 0.0f, PacketColumn_Copy);
+    ImGui::TableHeadersRow();
+
+    if (ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs && sortSpecs->SpecsDirty) {
+        if (sortSpecs->SpecsCount > 0) {
+            const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[0];
+            m_sortedView.SetOrder(GetPacketSortColumn(spec.ColumnUserID), spec.SortDirection == ImGuiSortDirection_Descending);
+        } else {
+            m_sortedView.SetOrder(kx::Filtering::SortColumn::Arrival, false);
+        }
+        sortSpecs->SpecsDirty = false;
+    }
+    // Sorting reads only the compact key arrays; large sorts finish on the background pool.
+    m_sortedView.Update(kx::g_packetLog, m_packetView);
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(m_sortedView.GetRowCount()));
+    while (clipper.Step()) {
+        // No lock needed here: only the rows the clipper shows are read, in place
+        m_sortedView.GetRows(clipper.DisplayStart, clipper.DisplayEnd - clipper.DisplayStart, m_visibleRows);
+        for (size_t row = 0; row < m_visibleRows.size(); ++row) {
+            const uint32_t storeIndex = m_visibleRows[row];
+            RenderSinglePacketLogRow(kx::g_packetLog[storeIndex], storeIndex, clipper.DisplayStart + static_cast<int>(row));
+        }
+    }
+    clipper.End();
+
+    // Follow new packets while scrolled to the bottom, if they are appended there
+    if (m_sortedView.IsArrivalOrder() && m_sortedView.GetRowCount() > 0 && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.0f);
+    }
+
+    ImGui::EndTable();
+}
+
 void ImGuiManager::RenderPacketLogSection() {
-    // 1. Get packet data snapshot
-    size_t total_packets = 0;
-    std::vector<int> original_indices_snapshot;
-    std::vector<kx::PacketInfo> packets_to_render = GetFilteredPacketsSnapshot(total_packets, original_indices_snapshot);
+    // 1. Refresh the visible packet indices (only new packets are tested unless the filters changed).
+    //    Over the frame budget this happens every few frames; the store is append-only, so the view stays valid.
+    if (m_frameBudget.IsDue(m_frameBudget.GetViewRefreshInterval())) {
+        m_packetView.Update(kx::g_packetLog);
+    }
+    m_rowTextCache.Validate(kx::g_displaySettingsVersion, m_frameBudget.GetHexByteLimit(kx::g_displayHexByteLimit));
+    const size_t total_packets = m_packetView.GetScannedCount();
 
     // 2. Display statistics
-    ImGui::Text("Packet Log (Showing: %zu / Total: %zu)", packets_to_render.size(), total_packets);
+    ImGui::Text("Packet Log (Showing: %zu / Total: %zu)", m_packetView.GetIndices().size(), total_packets);
+    if (m_packetView.IsRebuilding()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(filtering...)");
+    }
+    else if (m_sortedView.IsSorting()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(sorting...)");
+    }
+    if (const uint64_t dropped = kx::g_packetLog.GetDroppedCount(); dropped > 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "(%llu dropped: log full, clear it to resume)",
+            static_cast<unsigned long long>(dropped));
+    }
 
     // 3. Render controls
-    RenderPacketLogControls(packets_to_render.size(), total_packets, packets_to_render);
+    RenderPacketLogControls(m_packetView.GetIndices().size(), total_packets);
 
     ImGui::Spacing();
 
@@ -385,30 +1011,21 @@ void ImGuiManager::RenderPacketLogSection() {
         log_section_height = ImGui::GetTextLineHeight() * 10;
     }
 
-    ImGui::BeginChild("PacketLogScrollingRegion", ImVec2(0, log_section_height), true, ImGuiWindowFlags_HorizontalScrollbar);
-
-    // 5. Render packet list using clipper
-    RenderPacketListWithClipping(packets_to_render, original_indices_snapshot);
-
-    // 6. Handle auto-scrolling
-    if (!packets_to_render.empty() && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
-        ImGui::SetScrollHereY(1.0f);
-    }
-
-    ImGui::EndChild();
+    // 5. Render the packet table (sorted, clipped, auto-scrolling)
+    RenderPacketListWithClipping(log_section_height);
 }
 
 void ImGuiManager::RenderSelectedPacketDetailsSection() {
     if (ImGui::CollapsingHeader("Selected Packet Details", ImGuiTreeNodeFlags_DefaultOpen)) {
-        if (m_selectedPacketLogIndex != -1) {
-            std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
-            if (m_selectedPacketLogIndex >= 0 && m_selectedPacketLogIndex < kx::g_packetLog.size()) {
-                const kx::PacketInfo& selectedPacket = kx::g_packetLog[m_selectedPacketLogIndex];
+        if (m_selectedPacketId != 0) {
+            if (const kx::PacketInfo* selectedPacketPtr = kx::g_packetLog.FindById(m_selectedPacketId)) {
+                const kx::PacketInfo& selectedPacket = *selectedPacketPtr;
 
                 // Only re-parse if the buffer is empty (first time selected or cleared)
-                // or if the selected packet has changed (though m_selectedPacketLogIndex handles this)
+                // or if the selected packet has changed (though m_selectedPacketId handles this)
                 if (m_parsedPayloadBuffer.empty() || m_fullLogEntryBuffer.empty()) { // Check both buffers
-                    m_fullLogEntryBuffer = kx::Utils::FormatFullLogEntryString(selectedPacket); // Populate full log entry
+                    // The payload itself is shown by the hex viewer; a full entry is only built when copied.
+                    m_fullLogEntryBuffer = kx::Utils::FormatDisplayLogEntryString(selectedPacket, 16, kx::g_timestampFormat);
                     auto parsedDataOpt = kx::Parsing::GetParsedDataTooltipString(selectedPacket);
                     if (parsedDataOpt.has_value()) {
                         m_parsedPayloadBuffer = parsedDataOpt.value();
@@ -417,21 +1034,30 @@ void ImGuiManager::RenderSelectedPacketDetailsSection() {
                     }
                 }
 
-                ImGui::Text("Full Log Entry:");
-                ImGui::InputTextMultiline("##FullLogEntry", (char*)m_fullLogEntryBuffer.c_str(), m_fullLogEntryBuffer.size() + 1, ImVec2(-1, ImGui::GetTextLineHeight() * 3), ImGuiInputTextFlags_ReadOnly);
+                ImGui::TextWrapped("%s", m_fullLogEntryBuffer.c_str());
+
+                const kx::Parsing::PacketFieldSpans& fields = m_hexViewer.GetFieldSpans(selectedPacket);
+                if (fields.source != kx::Parsing::FieldSource::None) {
+                    ImGui::Text("Payload (%zu bytes, %zu fields from %s):", selectedPacket.data.size(), fields.spans.size(),
+                                kx::Parsing::GetFieldSourceName(fields.source));
+                } else {
+                    ImGui::Text("Payload (%zu bytes):", selectedPacket.data.size());
+                }
+                const size_t payloadLines = (selectedPacket.data.size() + kx::Gui::HexViewer::BYTES_PER_LINE - 1) / kx::Gui::HexViewer::BYTES_PER_LINE;
+                m_hexViewer.Draw(selectedPacket, kx::Gui::HexViewer::GetHeightForLines(std::clamp<size_t>(payloadLines, 1, m_frameBudget.GetHexViewerLines())));
 
                 ImGui::Text("Parsed Payload:");
                 ImGui::InputTextMultiline("##ParsedPayload", (char*)m_parsedPayloadBuffer.c_str(), m_parsedPayloadBuffer.size() + 1, ImVec2(-1, ImGui::GetTextLineHeight() * 10), ImGuiInputTextFlags_ReadOnly);
 
                 if (ImGui::Button("Copy All Details")) {
                     std::stringstream ss;
-                    ss << "Full Log Entry:\n" << m_fullLogEntryBuffer << "\n\n";
+                    ss << "Full Log Entry:\n" << kx::Utils::FormatFullLogEntryString(selectedPacket, kx::g_timestampFormat) << "\n\n";
                     ss << "Parsed Payload:\n" << m_parsedPayloadBuffer;
                     ImGui::SetClipboardText(ss.str().c_str());
                 }
 
             } else {
-                m_selectedPacketLogIndex = -1; // Invalid index, reset
+                m_selectedPacketId = 0; // Packet no longer stored, reset
                 m_parsedPayloadBuffer.clear();
                 m_fullLogEntryBuffer.clear(); // Clear full log entry buffer
                 ImGui::Text("Selected packet no longer exists (e.g., log cleared).");
@@ -462,6 +1088,10 @@ void ImGuiManager::RenderPacketInspectorWindow() {
     RenderInfoSection();
     RenderStatusControlsSection();
     RenderFilteringSection();
+    RenderDisplaySettingsSection();
+    RenderTrafficStatsSection();
+    RenderReanalysisSection();
+    RenderParserDiagnosticsSection();
     RenderPacketLogSection();
     RenderSelectedPacketDetailsSection(); // Add this call
 
@@ -471,6 +1101,26 @@ void ImGuiManager::RenderPacketInspectorWindow() {
 
 void ImGuiManager::RenderUI()
 {
+    // Pick up finished background re-analysis on the render thread, which is the only
+    // thread that reads packet names outside the capture path.
+    if (kx::Analysis::ApplyCompletedReanalysis()) {
+        m_parsedPayloadBuffer.clear();
+        m_fullLogEntryBuffer.clear();
+        kx::g_filterStateVersion++; // Special types may have changed, so filter results can too
+        m_rowTextCache.Clear();     // Names may have changed
+    }
+
+    // A new schema catalogue can add names: extend the filter list and rename logged packets.
+    // Schema-only updates (the harvester) leave names alone and need neither.
+    const uint64_t namesVersion = kx::Schema::GetCatalogNamesVersion();
+    if (namesVersion != m_seenCatalogNamesVersion) {
+        kx::Filtering::SyncHeaderFilterSelection();
+        // Retried next frame if a re-analysis (possibly using the old names) is still running
+        if (kx::Analysis::StartLogReanalysis()) {
+            m_seenCatalogNamesVersion = namesVersion;
+        }
+    }
+
     // Only render the inspector window if the visibility flag is set
     if (kx::g_showInspectorWindow) {
         RenderPacketInspectorWindow();
@@ -1,6 +1,16 @@
 #pragma once
 
 #include "PacketData.h"
+#include "FilterView.h"
+#include "FrameBudget.h"
+#include "HexViewer.h"
+#include "PacketExporter.h"
+#include "RowTextCache.h"
+#include "SortedPacketView.h"
+#include "TrafficStats.h"
+#include <array>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include <d3d11.h>
@@ -14,9 +24,23 @@ public:
     static void RenderUI();
     static void Shutdown();
 private:
-    static int m_selectedPacketLogIndex; // Stores the index of the selected packet in the global log
+    static uint64_t m_selectedPacketId; // Id of the selected packet in the global log (0: none)
     static std::string m_parsedPayloadBuffer; // Stores the formatted parsed data for display
-    static std::string m_fullLogEntryBuffer; // Stores the full log entry string for display
+    static std::string m_fullLogEntryBuffer; // Log entry header of the selected packet (hex truncated)
+    static uint64_t m_seenCatalogNamesVersion; // Catalogue names version the filters and log were last synced with
+    static kx::Filtering::FilterView m_packetView; // Store indices of the packets passing the filters
+    static kx::Filtering::SortedPacketView m_sortedView; // m_packetView in the packet table's sort order
+    static std::vector<uint32_t> m_visibleRows; // Store indices of the table rows drawn this frame
+    static kx::Utils::RowTextCache m_rowTextCache; // Formatted packet list rows, keyed by packet id
+    static kx::Export::ExportFormat m_exportFormat; // Format used by "Export to File"
+    static kx::Gui::HexViewer m_hexViewer; // Payload view of the selected packet
+    static std::vector<kx::Stats::OpcodeStats> m_trafficStats; // Snapshot shown by the statistics table
+    static uint64_t m_trafficStatsDueFrame; // Frame index at which the statistics snapshot is next refreshed
+    static kx::Gui::FrameBudget m_frameBudget; // Overlay CPU time and the work allowed for it
+    static std::array<char, 512> m_displayFilterInput; // Display filter expression being edited
+    static std::string m_displayFilterError; // Why the edited display filter does not compile (empty: it does)
+    static std::array<char, 512> m_captureFilterInput; // Capture filter expression being edited
+    static std::string m_captureFilterError;
 
     static void RenderPacketInspectorWindow(); // Main window function
     // Helper functions for RenderPacketInspectorWindow sections
@@ -24,12 +48,16 @@ private:
     static void RenderInfoSection();
     static void RenderStatusControlsSection();
     static void RenderFilteringSection();
+    static void RenderDisplaySettingsSection();
+    static void RenderTrafficStatsSection();
+    static void RenderReanalysisSection();
+    static void RenderParserDiagnosticsSection();
     static void RenderPacketLogSection();
     static void RenderSelectedPacketDetailsSection(); // New section for detailed parsed data
-    static void RenderSinglePacketLogRow(const kx::PacketInfo& packet, int display_index, int original_log_index);
+    static void RenderSinglePacketLogRow(const kx::PacketInfo& packet, uint32_t store_index, int display_index);
 
     // Helpers for RenderPacketLogSection
-    static std::vector<kx::PacketInfo> GetFilteredPacketsSnapshot(size_t& out_total_packets, std::vector<int>& out_original_indices);
-    static void RenderPacketLogControls(size_t displayed_count, size_t total_count, const std::vector<kx::PacketInfo>& packets_to_render);
-    static void RenderPacketListWithClipping(const std::vector<kx::PacketInfo>& packets_to_render, const std::vector<int>& original_indices_snapshot);
+    static void RenderPacketLogControls(size_t displayed_count, size_t total_count);
+    static void RenderExportControls();
+    static void RenderPacketListWithClipping(float height);
 };
\ No newline at end of file
@@ -4,6 +4,16 @@
 #include "Console.h"
 #include "Hooks.h"
 #include "AppState.h"   // Include for g_isInspectorWindowOpen, g_isShuttingDown
+#include "BulkAnalyzer.h"
+#include "Config.h"
+#include "PacketExporter.h"
+#include "PatternScanner.h"
+#include "SchemaCatalog.h"
+#include "SchemaHarvester.h"
+#include "ThreadPool.h"
+#include "TrafficStats.h"
+
+#include <filesystem>
 
 HINSTANCE dll_handle;
 
@@ -24,6 +34,16 @@ DWORD WINAPI EjectThread(LPVOID lpParameter) {
     return 0;
 }
 
+// Directory containing this DLL; data files are looked up next to it.
+std::filesystem::path GetModuleDirectory() {
+    wchar_t path[MAX_PATH] = {};
+    const DWORD length = GetModuleFileNameW(dll_handle, path, MAX_PATH);
+    if (length == 0 || length == MAX_PATH) {
+        return std::filesystem::current_path();
+    }
+    return std::filesystem::path(path).parent_path();
+}
+
 void InitializeFilters() {
     // Clear existing (in case of re-init?)
     kx::g_packetHeaderFilterSelection.clear();
@@ -52,6 +72,12 @@ DWORD WINAPI MainThread(LPVOID lpParameter) {
     kx::SetupConsole(); // Only setup console in Debug builds
 #endif // _DEBUG
 
+    // Load the schema catalogue first so its names are used by the filters and capture
+    kx::Schema::InitializeSchemaCatalog(GetModuleDirectory() / kx::SCHEMA_CATALOG_FILENAME);
+    kx::Schema::InitializeSchemaHarvester(GetModuleDirectory() / kx::SCHEMA_HARVEST_FILENAME);
+    kx::Export::SetExportDirectory(GetModuleDirectory());
+    kx::PatternScanner::SetCacheFile(GetModuleDirectory() / kx::SIGNATURE_CACHE_FILENAME);
+
     // *** Initialize Filters Early ***
     InitializeFilters();
 
@@ -72,9 +98,19 @@ DWORD WINAPI MainThread(LPVOID lpParameter) {
 	// This helps prevent calls into ImGui after it's destroyed.
     Sleep(250);
 
+    // Stop background work before the DLL's code goes away
+    kx::Analysis::CancelReanalysis();
+    kx::Export::CancelExport();
+    kx::Threading::ShutdownBackgroundPool();
+
     // Cleanup hooks and ImGui
     kx::CleanupHooks();
 
+    // Catalogues and statistics can only be freed once no hook can be using them
+    kx::Schema::ShutdownSchemaHarvester();
+    kx::Schema::ShutdownSchemaCatalog();
+    kx::Stats::ShutdownTrafficStats();
+
     // Eject the DLL and exit the thread
     CreateThread(0, 0, EjectThread, 0, 0, 0);
 
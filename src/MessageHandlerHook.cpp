@@ -5,6 +5,8 @@
 #include "PacketData.h"
 #include "GameStructs.h"
 #include "AppState.h"
+#include "SchemaHarvester.h"
+#include "HookSiteVerifier.h"
 
 #include <iostream>  // For std::cout, std::cerr (initialization logging)
 #include <iomanip>   // For std::hex
@@ -12,6 +14,8 @@
 #include <debugapi.h> // For OutputDebugStringA (critical hook errors)
 #include <cstdio>    // For sprintf_s (critical hook errors)
 #include <exception> // For std::exception
+#include <algorithm> // For std::min
+#include <optional>
 
 // Global SafetyHook objects for managing the mid-function hooks.
 SafetyHookMid g_handlerHook1{};
@@ -19,16 +23,9 @@ SafetyHookMid g_handlerHook2{};
 SafetyHookMid g_handlerHook3{};
 SafetyHookMid g_handlerHook4{};
 
-// Stack offset relative to RBP to access the message data pointer (local_50).
-// NOTE: This offset is specific to the compiled function's stack frame and may break with game updates.
-constexpr ptrdiff_t STACK_OFFSET_MESSAGE_DATA_PTR = -0x18;
-
-// Offsets within FUN_1412e9390 targeting the start of the 'MOV RDX, [RBP+local_50]' instructions.
-// These pinpoint the locations for the mid-function hooks.
-constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_1 = 0x219; // Before CALL at 1412e95ad
-constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_2 = 0x228; // Before CALL at 1412e95bc
-constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_3 = 0x3D4; // Before CALL at 1412e9768
-constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_4 = 0x3E3; // Before CALL at 1412e9777
+// RBP offset of the message data pointer, as derived by LocateDispatcherHookSites. Written
+// before the hooks are installed and never while they are.
+static ptrdiff_t g_messageDataStackOffset = STACK_OFFSET_MESSAGE_DATA_PTR;
 
 /**
  * @brief Detour executed before a game message handler is called by the dispatcher.
@@ -39,8 +36,9 @@ constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_4 = 0x3E3; // Before CALL at 141
 */
 void hookHandlerCallSite(SafetyHookContext& ctx)
 {
-    // Skip processing if capture is paused or the application is shutting down.
-    if (kx::g_capturePaused || kx::g_isShuttingDown.load(std::memory_order_acquire)) {
+    // Skip processing if the application is shutting down. While capture is paused the
+    // hooks are disabled and this is not reached at all.
+    if (kx::g_isShuttingDown.load(std::memory_order_acquire)) {
         return;
     }
 
@@ -55,7 +53,7 @@ void hookHandlerCallSite(SafetyHookContext& ctx)
         // messageDataPtr is derived from a stack local relative to RBP.
         void* messageDataPtr = nullptr;
         if (ctx.rbp != 0) {
-            messageDataPtr = *reinterpret_cast<void**>(ctx.rbp + STACK_OFFSET_MESSAGE_DATA_PTR);
+            messageDataPtr = *reinterpret_cast<void**>(ctx.rbp + g_messageDataStackOffset);
         }
         else {
             // Also a critical failure.
@@ -101,9 +99,13 @@ void hookHandlerCallSite(SafetyHookContext& ctx)
             return;
         }
 
-        // --- NEW: Automated Discovery Logging ---
-        // Log all three key pieces of information: Opcode, Handler, and Schema.
-        if (handlerFuncPtr && msgDefPtr) {
+        // --- Schema Harvesting ---
+        // Queues the schema for the background harvester the first time this opcode is seen.
+        const bool firstSighting = kx::Schema::NotifyMessageDefinition(messageId, msgDefPtr);
+
+        // --- Automated Discovery Logging ---
+        // Log all three key pieces of information: Opcode, Handler, and Schema (once per opcode).
+        if (firstSighting && handlerFuncPtr && msgDefPtr) {
             char buffer[256];
             uintptr_t gameBase = (uintptr_t)GetModuleHandle(L"Gw2-64.exe");
             uintptr_t handlerOffset = (uintptr_t)handlerFuncPtr - gameBase;
@@ -183,20 +185,49 @@ bool InitializeMessageHandlerHooks(uintptr_t dispatcherFuncAddress) {
         return false;
     }
 
-    // Calculate absolute addresses using the defined constants.
-    const uintptr_t hookSite1 = dispatcherFuncAddress + DISPATCHER_HOOK_OFFSET_SITE_1;
-    const uintptr_t hookSite2 = dispatcherFuncAddress + DISPATCHER_HOOK_OFFSET_SITE_2;
-    const uintptr_t hookSite3 = dispatcherFuncAddress + DISPATCHER_HOOK_OFFSET_SITE_3;
-    const uintptr_t hookSite4 = dispatcherFuncAddress + DISPATCHER_HOOK_OFFSET_SITE_4;
+    // Locate the sites in the running code rather than trusting the recorded offsets.
+    // Decoding stays inside the committed memory the dispatcher lies in.
+    size_t readableSize = kx::Hooking::DISPATCHER_MAX_SIZE;
+    MEMORY_BASIC_INFORMATION memoryInfo{};
+    if (VirtualQuery(reinterpret_cast<LPCVOID>(dispatcherFuncAddress), &memoryInfo, sizeof(memoryInfo)) == 0 ||
+        memoryInfo.State != MEM_COMMIT) {
+        std::cerr << "[MessageHandlerHook] Error: Dispatcher address 0x" << std::hex << dispatcherFuncAddress << std::dec << " is not mapped." << std::endl;
+        return false;
+    }
+    const uintptr_t regionEnd = reinterpret_cast<uintptr_t>(memoryInfo.BaseAddress) + memoryInfo.RegionSize;
+    readableSize = std::min<size_t>(readableSize, regionEnd - dispatcherFuncAddress);
 
     std::string errorMsg; // Store the first error encountered
+    const std::optional<kx::Hooking::DispatcherHookSites> sites = kx::Hooking::LocateDispatcherHookSites(
+        reinterpret_cast<const uint8_t*>(dispatcherFuncAddress), readableSize, &errorMsg);
+    if (!sites) {
+        std::cerr << "[MessageHandlerHook] Error: The dispatcher does not have the expected shape (" << errorMsg
+            << "). Not hooking it." << std::endl;
+        return false;
+    }
+
+    const ptrdiff_t knownOffsets[] = { DISPATCHER_HOOK_OFFSET_SITE_1, DISPATCHER_HOOK_OFFSET_SITE_2,
+                                       DISPATCHER_HOOK_OFFSET_SITE_3, DISPATCHER_HOOK_OFFSET_SITE_4 };
+    std::cout << "[MessageHandlerHook] Verified " << sites->offsets.size() << " hook sites (" << sites->instructionsDecoded
+        << " instructions decoded), message data at [RBP" << std::showpos << sites->messageDataStackOffset << std::noshowpos << "]." << std::endl;
+    for (size_t i = 0; i < sites->offsets.size(); ++i) {
+        if (sites->offsets[i] != knownOffsets[i]) {
+            std::cout << "[MessageHandlerHook] Site " << (i + 1) << " moved: +0x" << std::hex << knownOffsets[i] << " -> +0x" << sites->offsets[i] << std::dec << "." << std::endl;
+        }
+    }
+    if (sites->messageDataStackOffset != STACK_OFFSET_MESSAGE_DATA_PTR) {
+        std::cout << "[MessageHandlerHook] Message data stack offset moved: " << STACK_OFFSET_MESSAGE_DATA_PTR
+            << " -> " << sites->messageDataStackOffset << "." << std::endl;
+    }
+    g_messageDataStackOffset = sites->messageDataStackOffset;
+
+    SafetyHookMid* const hooks[] = { &g_handlerHook1, &g_handlerHook2, &g_handlerHook3, &g_handlerHook4 };
     bool success = true;
 
     // Install hooks sequentially, stopping on the first failure.
-    if (success) { success = InstallSingleMidHook(g_handlerHook1, hookSite1, DISPATCHER_HOOK_OFFSET_SITE_1, 1, errorMsg); }
-    if (success) { success = InstallSingleMidHook(g_handlerHook2, hookSite2, DISPATCHER_HOOK_OFFSET_SITE_2, 2, errorMsg); }
-    if (success) { success = InstallSingleMidHook(g_handlerHook3, hookSite3, DISPATCHER_HOOK_OFFSET_SITE_3, 3, errorMsg); }
-    if (success) { success = InstallSingleMidHook(g_handlerHook4, hookSite4, DISPATCHER_HOOK_OFFSET_SITE_4, 4, errorMsg); }
+    for (size_t i = 0; success && i < sites->offsets.size(); ++i) {
+        success = InstallSingleMidHook(*hooks[i], dispatcherFuncAddress + sites->offsets[i], sites->offsets[i], static_cast<int>(i + 1), errorMsg);
+    }
 
     // Handle failure and cleanup
     if (!success) {
@@ -209,6 +240,42 @@ bool InitializeMessageHandlerHooks(uintptr_t dispatcherFuncAddress) {
     return true;
 }
 
+bool SetMessageHandlerHooksEnabled(bool enabled) {
+    SafetyHookMid* const hooks[] = { &g_handlerHook1, &g_handlerHook2, &g_handlerHook3, &g_handlerHook4 };
+    for (SafetyHookMid* hook : hooks) {
+        if (!*hook) {
+            return false; // Not installed
+        }
+    }
+
+    bool switched[std::size(hooks)] = {};
+    for (size_t i = 0; i < std::size(hooks); ++i) {
+        if (hooks[i]->enabled() == enabled) {
+            continue;
+        }
+        const auto result = enabled ? hooks[i]->enable() : hooks[i]->disable();
+        if (!result) {
+            std::cerr << "[MessageHandlerHook] Failed to " << (enabled ? "enable" : "disable")
+                << " hook " << (i + 1) << " (SafetyHook error " << static_cast<int>(result.error().type) << ")." << std::endl;
+            // Put the sites switched so far back, so all four stay in the same state.
+            for (size_t j = 0; j < i; ++j) {
+                if (switched[j]) {
+                    (void)(enabled ? hooks[j]->disable() : hooks[j]->enable());
+                }
+            }
+            return false;
+        }
+        switched[i] = true;
+    }
+
+    std::cout << "[MessageHandlerHook] Hooks " << (enabled ? "enabled." : "disabled.") << std::endl;
+    return true;
+}
+
+bool AreMessageHandlerHooksEnabled() {
+    return g_handlerHook1 && g_handlerHook1.enabled();
+}
+
 /**
  * @brief Cleans up and removes the installed SafetyHook MidHook(s).
  */
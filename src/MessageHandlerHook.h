@@ -1,9 +1,25 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
+// Last known layout of the dispatcher. The hooks use the sites and stack offset that
+// LocateDispatcherHookSites (HookSiteVerifier.h) derives from the running game; these values
+// are only compared against, so a game update that moves them is logged rather than fatal.
+
+// Stack offset relative to RBP to access the message data pointer (local_50).
+constexpr ptrdiff_t STACK_OFFSET_MESSAGE_DATA_PTR = -0x18;
+
+// Offsets within FUN_1412e9390 targeting the start of the 'MOV RDX, [RBP+local_50]' instructions.
+constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_1 = 0x219; // Before CALL at 1412e95ad
+constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_2 = 0x228; // Before CALL at 1412e95bc
+constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_3 = 0x3D4; // Before CALL at 1412e9768
+constexpr ptrdiff_t DISPATCHER_HOOK_OFFSET_SITE_4 = 0x3E3; // Before CALL at 1412e9777
+
 /**
  * @brief Initializes inline hooks just before message handler calls within the dispatcher.
+ * @details The sites are located by disassembling the dispatcher first; if it does not have
+ *          the expected shape, no hook is installed.
  * @param dispatcherFuncAddress The base address of the message dispatcher function (FUN_1412e9390).
  * @return true If hooks were successfully created and enabled, false otherwise.
  */
@@ -12,4 +28,21 @@ bool InitializeMessageHandlerHooks(uintptr_t dispatcherFuncAddress);
 /**
  * @brief Disables and removes the message handler inline hooks.
  */
-void CleanupMessageHandlerHooks();
\ No newline at end of file
+void CleanupMessageHandlerHooks();
+
+/**
+ * @brief Enables or disables all four installed MidHooks together, without removing them.
+ * @details While disabled the dispatcher runs its original instructions and skips the
+ *          context save/restore entirely. SafetyHook freezes the game's threads while it
+ *          restores or rewrites the bytes; a thread already inside a hook stub finishes
+ *          normally, since the stubs stay allocated until the hooks are removed. If one
+ *          site fails, the sites already switched are switched back, so capture never
+ *          sees only some of the handler calls.
+ * @return true if every hook is now in the requested state, false otherwise.
+ */
+bool SetMessageHandlerHooksEnabled(bool enabled);
+
+/**
+ * @brief True if the hooks are installed and enabled.
+ */
+bool AreMessageHandlerHooksEnabled();
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "MsgSendHook.h"
 #include "PacketProcessor.h" // Include the new processor header
-#include "AppState.h"        // For g_capturePaused, g_isShuttingDown
+#include "AppState.h"        // For g_isShuttingDown
 #include "GameStructs.h"     // For MsgSendContext definition
 #include "HookManager.h"
 
@@ -10,14 +10,16 @@
 MsgSendFunc originalMsgSend = nullptr;
 // Address of the target function, used for cleanup.
 static uintptr_t hookedMsgSendAddress = 0;
+// Whether the installed detour is currently enabled (paused capture disables it).
+static bool msgSendHookEnabled = false;
 
 // Detour function for the game's internal message sending logic.
 // This function now primarily captures the context and delegates processing.
 void __fastcall hookMsgSend(void* param_1) {
 
-    // Check if packet capture is active before processing.
-    // This check happens *before* calling the original function.
-    if (!kx::g_capturePaused && !kx::g_isShuttingDown.load(std::memory_order_acquire)) {
+    // Skip processing while shutting down. While capture is paused the detour is disabled
+    // and not reached at all. This check happens *before* calling the original function.
+    if (!kx::g_isShuttingDown.load(std::memory_order_acquire)) {
         if (param_1 != nullptr) {
             try {
                 // Cast the context pointer.
@@ -75,15 +77,39 @@ bool InitializeMsgSendHook(uintptr_t targetFunctionAddress) {
         return false;
     }
 
+    msgSendHookEnabled = true;
     return true;
 }
 
+bool SetMsgSendHookEnabled(bool enabled) {
+    if (hookedMsgSendAddress == 0) {
+        return false;
+    }
+    if (enabled == msgSendHookEnabled) {
+        return true;
+    }
+
+    LPVOID target = reinterpret_cast<LPVOID>(hookedMsgSendAddress);
+    const bool changed = enabled ? kx::Hooking::HookManager::EnableHook(target)
+                                 : kx::Hooking::HookManager::DisableHook(target);
+    if (!changed) {
+        return false;
+    }
+    msgSendHookEnabled = enabled;
+    std::cout << "[MsgSendHook] Hook " << (enabled ? "enabled." : "disabled.") << std::endl;
+    return true;
+}
+
+bool IsMsgSendHookEnabled() {
+    return hookedMsgSendAddress != 0 && msgSendHookEnabled;
+}
+
 // The explicit disable-remove sequence is employed to avoid potential disconnects or packet loss,
 // ensuring the hook is cleanly removed before the shutdown process completes.
 void CleanupMsgSendHook() {
     if (hookedMsgSendAddress != 0) {
-        // Disable the hook to immediately halt message interception.
-        if (MH_DisableHook(reinterpret_cast<LPVOID>(hookedMsgSendAddress)) != MH_OK) {
+        // Disable the hook to immediately halt message interception (unless paused capture already did).
+        if (msgSendHookEnabled && MH_DisableHook(reinterpret_cast<LPVOID>(hookedMsgSendAddress)) != MH_OK) {
             std::cerr << "[MsgSendHook] Failed to disable hook." << std::endl;
         }
 
@@ -94,6 +120,7 @@ void CleanupMsgSendHook() {
 
         // Reset local state variables.
         hookedMsgSendAddress = 0;
+        msgSendHookEnabled = false;
         originalMsgSend = nullptr;
         std::cout << "[MsgSendHook] Cleaned up." << std::endl;
     }
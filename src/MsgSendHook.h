@@ -39,6 +39,22 @@ bool InitializeMsgSendHook(uintptr_t targetFunctionAddress);
  */
 void CleanupMsgSendHook();
 
+/**
+ * @brief Enables or disables the installed detour without removing it.
+ * @details While disabled the game runs its original code, so the hook costs nothing.
+ *          MinHook suspends the game's threads while it patches and moves any thread out
+ *          of the overwritten prologue; a thread already inside the detour finishes
+ *          through the trampoline, which stays valid until the hook is removed.
+ * @return true if the detour is now in the requested state, false if it is not
+ *         installed or MinHook failed.
+ */
+bool SetMsgSendHookEnabled(bool enabled);
+
+/**
+ * @brief True if the detour is installed and enabled.
+ */
+bool IsMsgSendHookEnabled();
+
 /**
  * @brief The detour function that replaces the original message sending function.
  * @details Intercepts the call, potentially delegates processing to PacketProcessor,
@@ -1,7 +1,7 @@
 #include "PacketData.h"
+#include "PacketStore.h"
 
 namespace kx {
 
-std::deque<PacketInfo> g_packetLog;
-std::mutex g_packetLogMutex;
+PacketStore g_packetLog;
 }
\ No newline at end of file
@@ -2,8 +2,6 @@
 
 #include <vector>
 #include <string>
-#include <mutex>
-#include <deque>
 #include <chrono>
 #include <cstdint>
 #include <optional>
@@ -40,12 +38,7 @@ namespace kx {
         std::string name = "Unprocessed";  // String name (resolved using direction + rawHeaderId or special type)
         int bufferState = -1;              // State read from MsgConn (-1: null ctx, -2: read err, >=0: actual state)
         InternalPacketType specialType = InternalPacketType::NORMAL; // Assume normal unless set otherwise
+        uint64_t id = 0;                   // Session-unique id assigned by PacketStore (0: not stored)
     };
 
-    // Global container for storing captured packet info
-    extern std::deque<PacketInfo> g_packetLog;
-
-    // Mutex to protect access to the global packet log
-    extern std::mutex g_packetLogMutex;
-
 } // namespace kx
@@ -0,0 +1,311 @@
+#include "PacketExporter.h"
+#include "FormattingUtils.h"
+#include "HexFormatter.h"
+#include "PacketStore.h"
+#include "ThreadPool.h"
+#include "TimestampFormatter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+namespace kx::Export {
+
+    namespace {
+        // Packets formatted per read-lock hold; keeps Clear() and annotation writes waiting briefly.
+        constexpr std::size_t EXPORT_CHUNK_SIZE = 4096;
+        // Formatted bytes buffered before each file write.
+        constexpr std::size_t EXPORT_FLUSH_BYTES = 1 << 20;
+
+        // --- Background driver state ---
+        std::mutex g_jobMutex;
+        std::condition_variable g_jobFinished;
+        bool g_jobRunning = false;
+        std::atomic<bool> g_cancelRequested{ false };
+        std::atomic<std::size_t> g_writtenPackets{ 0 };
+        std::atomic<std::size_t> g_totalPackets{ 0 };
+        std::atomic<uint64_t> g_bytesWritten{ 0 };
+        ExportStatus g_status;                // Guarded by g_jobMutex, except the atomic counters above
+        std::filesystem::path g_exportDirectory; // Guarded by g_jobMutex
+
+        void AppendUnsigned(std::string& out, uint64_t value) {
+            char text[24];
+            const auto result = std::to_chars(text, text + sizeof(text), value);
+            out.append(text, result.ptr);
+        }
+
+        void AppendSigned(std::string& out, int64_t value) {
+            char text[24];
+            const auto result = std::to_chars(text, text + sizeof(text), value);
+            out.append(text, result.ptr);
+        }
+
+        // RFC 4180: quote the field if it contains a delimiter, quote or line break.
+        void AppendCsvField(std::string& out, const std::string& value) {
+            if (value.find_first_of(",\"\r\n") == std::string::npos) {
+                out += value;
+                return;
+            }
+            out += '"';
+            for (char c : value) {
+                if (c == '"') {
+                    out += '"';
+                }
+                out += c;
+            }
+            out += '"';
+        }
+
+        void AppendJsonString(std::string& out, const std::string& value) {
+            static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+            out += '"';
+            for (char c : value) {
+                const unsigned char byte = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (byte < 0x20) {
+                    const char escape[] = { '\\', 'u', '0', '0', HEX_DIGITS[byte >> 4], HEX_DIGITS[byte & 0xF] };
+                    out.append(escape, sizeof(escape));
+                } else {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        void AppendOpcodeHex(std::string& out, uint16_t opcode) {
+            static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+            const char text[] = {
+                '0', 'x',
+                HEX_DIGITS[(opcode >> 12) & 0xF], HEX_DIGITS[(opcode >> 8) & 0xF],
+                HEX_DIGITS[(opcode >> 4) & 0xF], HEX_DIGITS[opcode & 0xF]
+            };
+            out.append(text, sizeof(text));
+        }
+
+        std::filesystem::path MakeExportPath(const std::filesystem::path& directory, ExportFormat format) {
+            const std::time_t now = std::time(nullptr);
+            std::tm localTm{};
+            localtime_s(&localTm, &now);
+            char name[64];
+            std::strftime(name, sizeof(name), "kx_packets_%Y%m%d_%H%M%S", &localTm);
+            return directory / (std::string(name) + GetExportFileExtension(format));
+        }
+
+        // Runs on the background pool. Returns an error message, or an empty string on success.
+        std::string RunExport(const std::vector<uint32_t>& indices, uint64_t generation,
+                              const std::filesystem::path& path, ExportFormat format,
+                              TimestampFormat timestampFormat) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                return "Could not create the file.";
+            }
+
+            std::string buffer;
+            buffer.reserve(EXPORT_FLUSH_BYTES + EXPORT_FLUSH_BYTES / 4);
+            AppendExportHeader(buffer, format);
+
+            auto flush = [&]() {
+                file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                g_bytesWritten.fetch_add(buffer.size(), std::memory_order_relaxed);
+                buffer.clear();
+                return static_cast<bool>(file);
+            };
+
+            for (std::size_t begin = 0; begin < indices.size(); begin += EXPORT_CHUNK_SIZE) {
+                if (g_cancelRequested.load(std::memory_order_relaxed)) {
+                    return "Cancelled.";
+                }
+                const std::size_t end = std::min(indices.size(), begin + EXPORT_CHUNK_SIZE);
+                {
+                    auto lock = g_packetLog.LockForReading();
+                    if (g_packetLog.GetGeneration() != generation) {
+                        return "The log was cleared during the export.";
+                    }
+                    for (std::size_t i = begin; i < end; ++i) {
+                        AppendExportRecord(buffer, g_packetLog[indices[i]], format, timestampFormat);
+                    }
+                }
+                g_writtenPackets.store(end, std::memory_order_relaxed);
+
+                if (buffer.size() >= EXPORT_FLUSH_BYTES && !flush()) {
+                    return "Write failed (disk full?).";
+                }
+            }
+
+            if (!flush()) {
+                return "Write failed (disk full?).";
+            }
+            file.close();
+            if (!file) {
+                return "Write failed (disk full?).";
+            }
+            return {};
+        }
+    }
+
+    const char* GetExportFormatName(ExportFormat format) {
+        switch (format) {
+        case ExportFormat::Csv:       return "CSV";
+        case ExportFormat::JsonLines: return "JSON lines";
+        default:                      return "Text";
+        }
+    }
+
+    const char* GetExportFileExtension(ExportFormat format) {
+        switch (format) {
+        case ExportFormat::Csv:       return ".csv";
+        case ExportFormat::JsonLines: return ".jsonl";
+        default:                      return ".txt";
+        }
+    }
+
+    void AppendExportHeader(std::string& out, ExportFormat format) {
+        if (format == ExportFormat::Csv) {
+            out += "id,timestamp_us,time,direction,opcode,name,size,data\n";
+        }
+    }
+
+    void AppendExportRecord(std::string& out, const PacketInfo& packet, ExportFormat format,
+                            TimestampFormat timestampFormat) {
+        if (format == ExportFormat::Text) {
+            Utils::AppendLogEntryString(out, packet, -1, timestampFormat);
+            out += '\n';
+            return;
+        }
+
+        const int64_t epochMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            packet.timestamp.time_since_epoch()).count();
+        const char direction = (packet.direction == PacketDirection::Sent) ? 'S' : 'R';
+        Utils::HexFormatOptions hexOptions;
+        hexOptions.separator = '\0';
+
+        if (format == ExportFormat::Csv) {
+            AppendUnsigned(out, packet.id);
+            out += ',';
+            AppendSigned(out, epochMicros);
+            out += ',';
+            Utils::AppendTimestamp(out, packet.timestamp, timestampFormat);
+            out += ',';
+            out += direction;
+            out += ',';
+            AppendOpcodeHex(out, packet.rawHeaderId);
+            out += ',';
+            AppendCsvField(out, packet.name);
+            out += ',';
+            AppendUnsigned(out, packet.data.size());
+            out += ',';
+            Utils::AppendHex(out, packet.data.data(), packet.data.size(), hexOptions);
+            out += '\n';
+            return;
+        }
+
+        // JSON lines
+        out += "{\"id\":";
+        AppendUnsigned(out, packet.id);
+        out += ",\"timestamp_us\":";
+        AppendSigned(out, epochMicros);
+        out += ",\"time\":\"";
+        Utils::AppendTimestamp(out, packet.timestamp, timestampFormat);
+        out += "\",\"direction\":\"";
+        out += direction;
+        out += "\",\"opcode\":";
+        AppendUnsigned(out, packet.rawHeaderId);
+        out += ",\"name\":";
+        AppendJsonString(out, packet.name);
+        out += ",\"size\":";
+        AppendUnsigned(out, packet.data.size());
+        out += ",\"data\":\"";
+        Utils::AppendHex(out, packet.data.data(), packet.data.size(), hexOptions);
+        out += "\"}\n";
+    }
+
+    void SetExportDirectory(const std::filesystem::path& directory) {
+        std::lock_guard<std::mutex> lock(g_jobMutex);
+        g_exportDirectory = directory;
+    }
+
+    bool StartLogExport(std::vector<uint32_t> indices, ExportFormat format, TimestampFormat timestampFormat) {
+        std::filesystem::path path;
+        {
+            std::lock_guard<std::mutex> lock(g_jobMutex);
+            if (g_jobRunning) {
+                return false;
+            }
+            g_jobRunning = true;
+            path = MakeExportPath(g_exportDirectory.empty() ? std::filesystem::current_path() : g_exportDirectory, format);
+            g_status = ExportStatus{};
+            g_status.path = path.string();
+            g_status.totalCount = indices.size();
+            g_status.running = true;
+        }
+        g_cancelRequested.store(false, std::memory_order_relaxed);
+        g_writtenPackets.store(0, std::memory_order_relaxed);
+        g_totalPackets.store(indices.size(), std::memory_order_relaxed);
+        g_bytesWritten.store(0, std::memory_order_relaxed);
+
+        const uint64_t generation = g_packetLog.GetGeneration(); // The indices belong to this generation
+        Threading::GetBackgroundPool().Submit([indices = std::move(indices), generation, path, format, timestampFormat]() {
+            const auto startTime = std::chrono::steady_clock::now();
+            std::string error;
+            try {
+                error = RunExport(indices, generation, path, format, timestampFormat);
+            }
+            catch (const std::exception& e) {
+                error = e.what();
+            }
+
+            const bool cancelled = !error.empty() && g_cancelRequested.load(std::memory_order_relaxed);
+            if (!error.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(path, ec); // Don't leave a truncated export behind
+            }
+
+            std::lock_guard<std::mutex> lock(g_jobMutex);
+            g_status.lastError = cancelled ? std::string() : std::move(error);
+            g_status.cancelled = cancelled;
+            g_status.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+            g_status.running = false;
+            g_jobRunning = false;
+            g_jobFinished.notify_all();
+        });
+        return true;
+    }
+
+    bool IsExportRunning() {
+        std::lock_guard<std::mutex> lock(g_jobMutex);
+        return g_jobRunning;
+    }
+
+    float GetExportProgress() {
+        const std::size_t total = g_totalPackets.load(std::memory_order_relaxed);
+        if (total == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(g_writtenPackets.load(std::memory_order_relaxed)) / static_cast<float>(total);
+    }
+
+    void CancelExport() {
+        g_cancelRequested.store(true, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(g_jobMutex);
+        g_jobFinished.wait(lock, [] { return !g_jobRunning; });
+    }
+
+    ExportStatus GetExportStatus() {
+        std::lock_guard<std::mutex> lock(g_jobMutex);
+        ExportStatus status = g_status;
+        status.writtenCount = g_writtenPackets.load(std::memory_order_relaxed);
+        status.bytesWritten = g_bytesWritten.load(std::memory_order_relaxed);
+        return status;
+    }
+
+} // namespace kx::Export
@@ -0,0 +1,91 @@
+#pragma once
+
+/**
+ * @file PacketExporter.h
+ * @brief Streams packets from the log to a text, CSV or JSON-lines file.
+ * @details The export runs as a single job on the background pool. It formats the
+ *          selected packets in chunks into a reusable buffer and writes the buffer to
+ *          the file whenever it fills, so neither the render thread nor peak memory pay
+ *          for the size of the log. Each chunk is formatted under the store's read lock
+ *          and checked against the log generation, so a Clear() between chunks stops
+ *          the export instead of writing unrelated packets.
+ */
+
+#include "AppState.h" // For TimestampFormat
+#include "PacketData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace kx::Export {
+
+    enum class ExportFormat {
+        Text,     // Same lines as "Copy All"
+        Csv,      // id,timestamp_us,time,direction,opcode,name,size,data
+        JsonLines // One JSON object per packet
+    };
+
+    // Above this many packets "Copy All" is disabled and the file export is offered instead.
+    constexpr std::size_t CLIPBOARD_MAX_PACKETS = 10000;
+
+    const char* GetExportFormatName(ExportFormat format);
+
+    // File extension including the dot, e.g. ".csv".
+    const char* GetExportFileExtension(ExportFormat format);
+
+    /**
+     * @brief Appends the file header for `format` (the CSV column row; nothing otherwise).
+     */
+    void AppendExportHeader(std::string& out, ExportFormat format);
+
+    /**
+     * @brief Appends one packet in `format`, including the trailing newline.
+     */
+    void AppendExportRecord(std::string& out, const PacketInfo& packet, ExportFormat format,
+                            TimestampFormat timestampFormat);
+
+    // --- In-game export driver ---
+
+    /**
+     * @brief Directory new export files are created in (the DLL directory by default).
+     */
+    void SetExportDirectory(const std::filesystem::path& directory);
+
+    /**
+     * @brief Starts writing the given log packets to a new timestamped file.
+     * @param indices Store indices to export, in output order (e.g. the filtered view).
+     *                They must belong to the current log generation.
+     * @return False if an export is already running.
+     */
+    bool StartLogExport(std::vector<uint32_t> indices, ExportFormat format, TimestampFormat timestampFormat);
+
+    bool IsExportRunning();
+
+    /**
+     * @brief Fraction of the packets written so far (0..1).
+     */
+    float GetExportProgress();
+
+    /**
+     * @brief Requests cancellation and waits for the running export to stop.
+     * @details The partially written file is deleted.
+     */
+    void CancelExport();
+
+    struct ExportStatus {
+        std::string path;          // File of the running or most recent export
+        std::string lastError;     // Empty if the most recent export succeeded
+        std::size_t writtenCount = 0;
+        std::size_t totalCount = 0;
+        uint64_t bytesWritten = 0;
+        double elapsedMs = 0.0;
+        bool running = false;
+        bool cancelled = false;
+    };
+
+    ExportStatus GetExportStatus();
+
+} // namespace kx::Export
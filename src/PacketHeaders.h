@@ -6,8 +6,10 @@
 #include <utility> // For std::pair
 #include <string_view>
 #include <map>
+#include <set>
 
 #include "PacketData.h" // Required for PacketDirection enum definition
+#include "SchemaCatalog.h" // Runtime names override the built-in tables
 
 namespace kx {
 
@@ -76,19 +78,26 @@ namespace kx {
     // --- Public API ---
 
     inline std::string GetPacketName(PacketDirection direction, uint16_t rawHeaderId) {
-        std::string prefix;
+        std::string prefix = direction == PacketDirection::Sent ? "CMSG_" : "SMSG_";
+
+        // The runtime catalogue takes precedence, so renames don't need a rebuild.
+        if (const std::shared_ptr<const Schema::Catalog> catalog = Schema::GetActiveCatalog()) {
+            const Schema::MessageSchema* message = catalog->Find(direction, rawHeaderId);
+            if (message && !message->name.empty()) {
+                return prefix + message->name;
+            }
+        }
+
         std::string_view name_sv;
         bool found = false;
 
         if (direction == PacketDirection::Sent) {
-            prefix = "CMSG_";
             auto it = g_cmsgNames.find(static_cast<CMSG_HeaderId>(rawHeaderId));
             if (it != g_cmsgNames.end()) {
                 name_sv = it->second;
                 found = true;
             }
         } else {
-            prefix = "SMSG_";
             auto it = g_smsgNames.find(static_cast<SMSG_HeaderId>(rawHeaderId));
             if (it != g_smsgNames.end()) {
                 name_sv = it->second;
@@ -111,22 +120,89 @@ namespace kx {
         return "INTERNAL_ERROR"; // Fallback
     }
 
-    inline std::vector<std::pair<uint16_t, std::string>> GetKnownCMSGHeaders() {
-        std::vector<std::pair<uint16_t, std::string>> headers;
-        headers.reserve(g_cmsgNames.size());
-        for (const auto& [value, name_sv] : g_cmsgNames) {
-            headers.emplace_back(static_cast<uint16_t>(value), "CMSG_" + std::string(name_sv));
+    inline bool IsKnownPacketHeader(PacketDirection direction, uint16_t rawHeaderId) {
+        if (const std::shared_ptr<const Schema::Catalog> catalog = Schema::GetActiveCatalog()) {
+            const Schema::MessageSchema* message = catalog->Find(direction, rawHeaderId);
+            if (message && !message->name.empty()) {
+                return true;
+            }
+        }
+        if (direction == PacketDirection::Sent) {
+            return g_cmsgNames.count(static_cast<CMSG_HeaderId>(rawHeaderId)) != 0;
         }
-        return headers;
+        return g_smsgNames.count(static_cast<SMSG_HeaderId>(rawHeaderId)) != 0;
     }
 
-    inline std::vector<std::pair<uint16_t, std::string>> GetKnownSMSGHeaders() {
-        std::vector<std::pair<uint16_t, std::string>> headers;
-        headers.reserve(g_smsgNames.size());
-        for (const auto& [value, name_sv] : g_smsgNames) {
-            headers.emplace_back(static_cast<uint16_t>(value), "SMSG_" + std::string(name_sv));
+    /**
+     * @brief Determines the special type of a packet from its direction, header and payload size.
+     * @details Shared by the capture path and bulk re-analysis so both classify identically.
+     *          Types that are set by the capture layer itself (e.g. ENCRYPTED_RC4) are preserved.
+     */
+    inline InternalPacketType ClassifyPacketType(PacketDirection direction, uint16_t rawHeaderId,
+                                                 size_t dataSize, InternalPacketType currentType) {
+        if (currentType == InternalPacketType::ENCRYPTED_RC4 ||
+            currentType == InternalPacketType::PROCESSING_ERROR) {
+            return currentType;
         }
-        return headers;
+        if (dataSize == 0) {
+            return InternalPacketType::EMPTY_PACKET;
+        }
+        if (direction == PacketDirection::Sent && dataSize < 2) {
+            return InternalPacketType::PACKET_TOO_SMALL;
+        }
+        return IsKnownPacketHeader(direction, rawHeaderId) ? InternalPacketType::NORMAL
+                                                           : InternalPacketType::UNKNOWN_HEADER;
+    }
+
+    /**
+     * @brief Display name for a classified packet: the header name, or the special type name.
+     */
+    inline std::string ResolvePacketName(PacketDirection direction, uint16_t rawHeaderId, InternalPacketType type) {
+        if (type == InternalPacketType::NORMAL || type == InternalPacketType::UNKNOWN_HEADER) {
+            return GetPacketName(direction, rawHeaderId);
+        }
+        return GetSpecialPacketTypeName(type);
+    }
+
+    inline void ClassifyPacket(PacketInfo& info) {
+        info.specialType = ClassifyPacketType(info.direction, info.rawHeaderId, info.data.size(), info.specialType);
+        info.name = ResolvePacketName(info.direction, info.rawHeaderId, info.specialType);
+    }
+
+    // Built-in headers plus any named in the active schema catalogue, sorted by id.
+    inline std::vector<std::pair<uint16_t, std::string>> GetKnownHeaders(PacketDirection direction) {
+        std::set<uint16_t> ids;
+        if (direction == PacketDirection::Sent) {
+            for (const auto& [value, name_sv] : g_cmsgNames) {
+                ids.insert(static_cast<uint16_t>(value));
+            }
+        } else {
+            for (const auto& [value, name_sv] : g_smsgNames) {
+                ids.insert(static_cast<uint16_t>(value));
+            }
+        }
+        if (const std::shared_ptr<const Schema::Catalog> catalog = Schema::GetActiveCatalog()) {
+            for (const Schema::MessageSchema& message : catalog->messages) {
+                if (message.direction == direction && !message.name.empty()) {
+                    ids.insert(message.opcode);
+                }
+            }
+        }
+
+        std::vector<std::pair<uint16_t, std::string>> result;
+        result.reserve(ids.size());
+        for (uint16_t id : ids) {
+            result.emplace_back(id, GetPacketName(direction, id));
+        }
+        return result;
+    }
+
+    inline std::vector<std::pair<uint16_t, std::string>> GetKnownCMSGHeaders() {
+        return GetKnownHeaders(PacketDirection::Sent);
+    }
+
+    inline std::vector<std::pair<uint16_t, std::string>> GetKnownSMSGHeaders() {
+        return GetKnownHeaders(PacketDirection::Received);
     }
 
     inline std::vector<std::pair<InternalPacketType, std::string>> GetSpecialPacketTypesForFilter() {
@@ -1,5 +1,6 @@
 #include "PacketParser.h"
 #include "PacketHeaders.h"
+#include "SchemaDecoder.h"
 #include <map>
 #include <utility>
 
@@ -21,9 +22,6 @@
 
 namespace kx::Parsing {
 
-// Define the type for the parser registry
-using ParserRegistry = std::map<std::pair<kx::PacketDirection, uint16_t>, ParserFunc>;
-
 // Function to initialize and return the parser registry
 const ParserRegistry& GetParserRegistry() {
     static ParserRegistry registry = {
@@ -60,8 +58,8 @@ std::optional<std::string> GetParsedDataTooltipString(const kx::PacketInfo& pack
         return it->second(packet);
     }
 
-    // No parser found for this key
-    return std::nullopt;
+    // No handwritten parser; fall back to the runtime schema catalogue (if it has this message)
+    return kx::Schema::DecodePacketWithSchema(packet);
 }
 
 } // namespace kx::Parsing
@@ -11,12 +11,22 @@ namespace kx::Parsing {
     // Define a function pointer type for parser functions
     using ParserFunc = std::optional<std::string>(*)(const kx::PacketInfo&);
 
+    // Maps (direction, raw header id) to the parser responsible for that packet
+    using ParserRegistry = std::map<std::pair<kx::PacketDirection, uint16_t>, ParserFunc>;
+
+    /**
+     * @brief Returns the registry of all known packet parsers.
+     * @details Every parser must return std::nullopt for packets of any other direction or opcode,
+     *          and must tolerate payloads of any length.
+     */
+    const ParserRegistry& GetParserRegistry();
+
     /**
      * @brief Central dispatcher to get a formatted tooltip string for any known parsed packet.
-     *        Uses a map-based registry for extensibility.
+     *        Uses a map-based registry for extensibility, then the schema catalogue.
      * @param packet The PacketInfo object.
-     * @return An optional string suitable for display in a tooltip if a parser is registered,
-     *         otherwise std::nullopt.
+     * @return An optional string suitable for display in a tooltip if a parser is registered
+     *         or the schema catalogue describes the packet, otherwise std::nullopt.
      */
     std::optional<std::string> GetParsedDataTooltipString(const kx::PacketInfo& packet);
 
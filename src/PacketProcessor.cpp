@@ -4,18 +4,29 @@
 
 #include "PacketProcessor.h"
 #include "PacketData.h"
+#include "PacketStore.h"
 #include "AppState.h"
+#include "FilterExpression.h"
 #include "PacketHeaders.h"
+#include "TrafficStats.h"
 #include "GameStructs.h" // Included via PacketProcessor.h but good practice
 
 #include <vector>
 #include <chrono>
-#include <mutex>
 #include <limits>
+#include <memory>
 #include <cstring> // For memcpy
 
 namespace kx::PacketProcessing {
 
+    namespace {
+        // Applies the capture filter expression (AppState.h) to a classified packet.
+        bool PassesCaptureFilter(const PacketInfo& info) {
+            const std::shared_ptr<const Filtering::FilterProgram> filter = g_captureFilterExpression.load(std::memory_order_acquire);
+            return !filter || filter->Matches(info);
+        }
+    }
+
     void ProcessOutgoingPacket(const GameStructs::MsgSendContext* context) {
         // Basic check (hook should ideally ensure non-null, but double-check)
         if (!context) {
@@ -24,6 +35,12 @@ namespace kx::PacketProcessing {
             return;
         }
 
+        // The hook is disabled while capture is off, but a call that entered the detour just
+        // before that is still delivered here.
+        if (!IsCaptureEnabled(PacketDirection::Sent)) {
+            return;
+        }
+
         try {
             // Skip processing if bufferState indicates the buffer might be invalid or getting reset (state 1).
             if (context->bufferState == 1) {
@@ -66,7 +83,13 @@ namespace kx::PacketProcessing {
             }
             // --- End Sanity Checks ---
 
-            if (dataIsValid && bufferSize > 0) {
+            if (dataIsValid) {
+                uint16_t opcode = 0;
+                if (bufferSize >= sizeof(opcode)) {
+                    memcpy(&opcode, packetData, sizeof(opcode));
+                }
+                Stats::RecordPacket(PacketDirection::Sent, opcode, bufferSize);
+
                 PacketInfo info;
                 info.timestamp = std::chrono::system_clock::now();
                 info.size = static_cast<int>(bufferSize);
@@ -74,43 +97,20 @@ namespace kx::PacketProcessing {
                 info.bufferState = context->bufferState;
                 info.specialType = InternalPacketType::NORMAL; // Assume normal
 
-                // Copy packet data
-                info.data.assign(packetData, packetData + bufferSize);
-
-                // Analyze header
+                // Copy packet data and read the header if present
+                if (bufferSize > 0) {
+                    info.data.assign(packetData, packetData + bufferSize);
+                }
                 if (info.data.size() >= 2) {
                     memcpy(&info.rawHeaderId, info.data.data(), sizeof(info.rawHeaderId));
-                    info.name = GetPacketName(info.direction, info.rawHeaderId); // Use directional lookup
-                } else {
-                    info.specialType = InternalPacketType::PACKET_TOO_SMALL;
-                    info.rawHeaderId = 0; // Assign a default/sentinel value
-                    info.name = GetSpecialPacketTypeName(info.specialType);
                 }
 
-                // Check if the resolved name indicates an unknown header ID
-                if (info.name.find("_UNKNOWN") != std::string::npos) {
-                    info.specialType = InternalPacketType::UNKNOWN_HEADER; // Mark specifically as unknown ID
-                }
+                // Resolve name / special type (empty, too small, unknown header)
+                ClassifyPacket(info);
 
                 // Log the packet
-                {
-                    std::lock_guard<std::mutex> lock(g_packetLogMutex);
-                    g_packetLog.push_back(std::move(info));
-                }
-            }
-            else if (dataIsValid && bufferSize == 0) {
-                PacketInfo info;
-                info.timestamp = std::chrono::system_clock::now();
-                info.size = 0;
-                info.direction = PacketDirection::Sent;
-                info.bufferState = context->bufferState;
-                info.specialType = InternalPacketType::EMPTY_PACKET; // Mark as empty
-                info.name = GetSpecialPacketTypeName(info.specialType);
-                info.rawHeaderId = 0; // Or some default
-                // Log the empty packet info
-                {
-                    std::lock_guard<std::mutex> lock(g_packetLogMutex);
-                    g_packetLog.push_back(std::move(info));
+                if (PassesCaptureFilter(info)) {
+                    g_packetLog.Append(std::move(info));
                 }
             }
         }
@@ -144,6 +144,11 @@ namespace kx::PacketProcessing {
         }
         // Add MAX_REASONABLE check? Maybe less critical here as size is known?
 
+        if (!IsCaptureEnabled(direction)) {
+            return; // Raced with a pause; see ProcessOutgoingPacket
+        }
+        Stats::RecordPacket(direction, messageId, messageSize);
+
         try {
             PacketInfo info;
             info.timestamp = std::chrono::system_clock::now();
@@ -156,23 +161,13 @@ namespace kx::PacketProcessing {
             if (messageSize > 0) {
                 info.data.assign(messageData, messageData + messageSize);
             }
-            else {
-                info.specialType = InternalPacketType::EMPTY_PACKET; // Mark specific empty messages
-            }
 
-            // Get name and potentially refine type
-            info.name = GetPacketName(info.direction, info.rawHeaderId);
-            if (info.name.find("_UNKNOWN") != std::string::npos) {
-                info.specialType = InternalPacketType::UNKNOWN_HEADER;
-            }
-            if (info.specialType == InternalPacketType::EMPTY_PACKET) {
-                info.name = GetSpecialPacketTypeName(info.specialType); // Override name if empty
-            }
+            // Get name and refine type (empty messages, unknown opcodes)
+            ClassifyPacket(info);
 
             // Log the processed message info
-            {
-                std::lock_guard<std::mutex> lock(g_packetLogMutex);
-                g_packetLog.push_back(std::move(info));
+            if (PassesCaptureFilter(info)) {
+                g_packetLog.Append(std::move(info));
             }
         }
         catch (const std::exception& e) {
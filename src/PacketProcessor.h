@@ -15,6 +15,11 @@
 
 namespace kx::PacketProcessing {
 
+    // Both entry points count the packet in the traffic statistics and log it if it passes
+    // the capture filter expression (g_captureFilterExpression, AppState.h). While capture
+    // is paused or its direction is switched off the hooks are disabled; calls already in
+    // flight at that moment are dropped here.
+
     /**
      * @brief Processes data captured from an outgoing packet event (MsgSend).
      * @param context Pointer to the game's MsgSendContext structure containing
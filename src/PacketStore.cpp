@@ -0,0 +1,70 @@
+#include "PacketStore.h"
+
+#include <utility>
+
+namespace kx {
+
+    PacketStore::~PacketStore() {
+        for (std::atomic<PacketInfo*>& chunk : m_chunks) {
+            delete[] chunk.exchange(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t PacketStore::Append(PacketInfo packet) {
+        std::lock_guard<std::mutex> lock(m_appendMutex);
+        const std::size_t index = m_size.load(std::memory_order_relaxed);
+        if (index >= CAPACITY) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        std::atomic<PacketInfo*>& chunkSlot = m_chunks[index >> CHUNK_SHIFT];
+        PacketInfo* chunk = chunkSlot.load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new PacketInfo[CHUNK_SIZE];
+            chunkSlot.store(chunk, std::memory_order_release);
+        }
+
+        const uint64_t id = m_baseId.load(std::memory_order_relaxed) + index;
+        packet.id = id;
+        chunk[index & (CHUNK_SIZE - 1)] = std::move(packet);
+        m_size.store(index + 1, std::memory_order_release); // Publishes the slot to readers
+        return id;
+    }
+
+    const PacketInfo* PacketStore::FindById(uint64_t id) const {
+        const uint64_t baseId = GetBaseId();
+        const std::size_t size = Size();
+        if (id < baseId || id - baseId >= size) {
+            return nullptr;
+        }
+        return &(*this)[static_cast<std::size_t>(id - baseId)];
+    }
+
+    std::vector<PacketInfo> PacketStore::CopyAll(uint64_t& outGeneration) const {
+        ReadLock lock = LockForReading();
+        outGeneration = GetGeneration();
+        const std::size_t size = Size();
+        std::vector<PacketInfo> copy;
+        copy.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            copy.push_back((*this)[i]);
+        }
+        return copy;
+    }
+
+    void PacketStore::Clear() {
+        std::unique_lock<std::shared_mutex> readers(m_readerMutex);
+        std::lock_guard<std::mutex> lock(m_appendMutex);
+        const std::size_t size = m_size.load(std::memory_order_relaxed);
+        m_size.store(0, std::memory_order_release);
+        m_baseId.fetch_add(size, std::memory_order_release); // Ids are never reused
+        m_generation.fetch_add(1, std::memory_order_acq_rel);
+
+        // Release the memory; chunks are reallocated on demand.
+        for (std::atomic<PacketInfo*>& chunk : m_chunks) {
+            delete[] chunk.exchange(nullptr, std::memory_order_acq_rel);
+        }
+    }
+
+} // namespace kx
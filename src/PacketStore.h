@@ -0,0 +1,114 @@
+#pragma once
+
+/**
+ * @file PacketStore.h
+ * @brief Append-only, chunked storage for the captured packet log.
+ * @details Packets live in fixed-size chunks reached through a fixed chunk table, so
+ *          a stored packet never moves and references to it stay valid until the next
+ *          Clear(). Capture threads append under a short lock and publish the new size
+ *          with a release store; readers load the size once and then index any earlier
+ *          packet without locking. Each packet gets a session-unique id, and every
+ *          Clear() bumps the generation so derived state (view indices, caches) can tell
+ *          it is stale.
+ *
+ *          Threading contract:
+ *          - Append(): any thread.
+ *          - Reading [0, Size()): any thread. Threads other than the render thread must
+ *            hold a ReadLock while reading, because the render thread is allowed to
+ *            rewrite packet annotations (name, special type) and to Clear().
+ *          - Clear() and GetMutable(): render thread only. Both take the reader lock
+ *            exclusively, which waits for background readers to finish.
+ */
+
+#include "PacketData.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace kx {
+
+    class PacketStore {
+    public:
+        static constexpr std::size_t CHUNK_SHIFT = 12;
+        static constexpr std::size_t CHUNK_SIZE = std::size_t{ 1 } << CHUNK_SHIFT; // 4096 packets
+        static constexpr std::size_t MAX_CHUNKS = 4096;                            // ~16.7M packets
+        static constexpr std::size_t CAPACITY = CHUNK_SIZE * MAX_CHUNKS;
+
+        using ReadLock = std::shared_lock<std::shared_mutex>;
+
+        PacketStore() = default;
+        ~PacketStore();
+        PacketStore(const PacketStore&) = delete;
+        PacketStore& operator=(const PacketStore&) = delete;
+
+        /**
+         * @brief Stores a packet and assigns its id.
+         * @return The packet id, or 0 if the store is full (the packet is dropped).
+         */
+        uint64_t Append(PacketInfo packet);
+
+        // Number of published packets. Packets below this index are safe to read.
+        std::size_t Size() const { return m_size.load(std::memory_order_acquire); }
+
+        // Incremented by every Clear().
+        uint64_t GetGeneration() const { return m_generation.load(std::memory_order_acquire); }
+
+        // Id of the packet at index 0; the packet at index i has id GetBaseId() + i.
+        uint64_t GetBaseId() const { return m_baseId.load(std::memory_order_acquire); }
+
+        uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        // `index` must be below a value previously returned by Size().
+        const PacketInfo& operator[](std::size_t index) const {
+            return m_chunks[index >> CHUNK_SHIFT].load(std::memory_order_acquire)[index & (CHUNK_SIZE - 1)];
+        }
+
+        /**
+         * @brief The packet with the given id, or nullptr if it was cleared or never existed.
+         */
+        const PacketInfo* FindById(uint64_t id) const;
+
+        /**
+         * @brief Mutable access for annotation updates. Caller holds LockExclusive().
+         */
+        PacketInfo& GetMutable(std::size_t index) {
+            return m_chunks[index >> CHUNK_SHIFT].load(std::memory_order_acquire)[index & (CHUNK_SIZE - 1)];
+        }
+
+        // Held by non-render threads while they read packets.
+        ReadLock LockForReading() const { return ReadLock(m_readerMutex); }
+
+        // Held by the render thread while it rewrites annotations.
+        std::unique_lock<std::shared_mutex> LockExclusive() { return std::unique_lock<std::shared_mutex>(m_readerMutex); }
+
+        /**
+         * @brief Copies all published packets, e.g. for a background job that outlives a Clear().
+         * @param outGeneration Receives the generation the copy belongs to.
+         */
+        std::vector<PacketInfo> CopyAll(uint64_t& outGeneration) const;
+
+        /**
+         * @brief Removes all packets and bumps the generation. Render thread only.
+         */
+        void Clear();
+
+    private:
+        std::array<std::atomic<PacketInfo*>, MAX_CHUNKS> m_chunks{};
+        std::atomic<std::size_t> m_size{ 0 };
+        std::atomic<uint64_t> m_generation{ 0 };
+        std::atomic<uint64_t> m_baseId{ 1 }; // 0 is reserved for "no packet"
+        std::atomic<uint64_t> m_dropped{ 0 };
+        std::mutex m_appendMutex;            // Serialises writers of slots and chunks
+        mutable std::shared_mutex m_readerMutex;
+    };
+
+    // Global container for storing captured packet info
+    extern PacketStore g_packetLog;
+
+} // namespace kx
@@ -0,0 +1,300 @@
+#include "ParserHarness.h"
+#include "FieldLayouts.h"
+#include "PacketHeaders.h"
+#include "PacketParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
+#include <utility>
+
+namespace kx::Parsing {
+
+    namespace {
+        // u16 positions after the header that are tried as layout selectors (e.g. a subtype).
+        constexpr std::size_t LAYOUT_SELECTOR_POSITIONS = 2;
+        // Structured payloads are the layout's complete size plus up to this many trailing bytes.
+        constexpr std::size_t STRUCTURED_MAX_EXTRA_BYTES = 16;
+
+        // Accumulates one parser's statistics while it is being driven.
+        struct ParserRun {
+            ParserFunc parser = nullptr;
+            ParserCheckResult& result;
+            const std::atomic<uint64_t>* allocationCounter = nullptr;
+            std::chrono::steady_clock::duration elapsed{};
+
+            // Runs the parser on an input addressed to it; true if it produced output.
+            bool Feed(const PacketInfo& packet) {
+                bool decoded = false;
+                result.inputs++;
+                const uint64_t allocationsBefore = allocationCounter ? allocationCounter->load(std::memory_order_relaxed) : 0;
+                const auto start = std::chrono::steady_clock::now();
+                try {
+                    std::optional<std::string> output = parser(packet);
+                    if (output) {
+                        decoded = true;
+                        result.decoded++;
+                        result.outputBytes += output->size();
+                    }
+                }
+                catch (...) {
+                    result.exceptions++;
+                }
+                elapsed += std::chrono::steady_clock::now() - start;
+                if (allocationCounter) {
+                    result.allocations += allocationCounter->load(std::memory_order_relaxed) - allocationsBefore;
+                }
+                return decoded;
+            }
+
+            // Runs the parser on an input meant for another parser; output is a violation.
+            void FeedForeign(const PacketInfo& packet) {
+                try {
+                    if (parser(packet)) {
+                        result.contractViolations++;
+                    }
+                }
+                catch (...) {
+                    result.exceptions++;
+                }
+            }
+        };
+
+        // Builds a packet whose data buffer is exactly `size` bytes long.
+        PacketInfo MakePacket(PacketDirection direction, uint16_t opcode, const uint8_t* bytes, std::size_t size) {
+            PacketInfo packet;
+            packet.timestamp = std::chrono::system_clock::now();
+            packet.direction = direction;
+            packet.rawHeaderId = opcode;
+            packet.data.assign(bytes, bytes + size); // Capacity == size, so overreads leave the block
+            packet.size = static_cast<int>(size);
+            packet.name = GetPacketName(direction, opcode);
+            return packet;
+        }
+
+        // Sent packets carry their own header in the first two bytes.
+        void WriteHeader(std::vector<uint8_t>& bytes, PacketDirection direction, uint16_t opcode) {
+            if (direction == PacketDirection::Sent && bytes.size() >= 2) {
+                bytes[0] = static_cast<uint8_t>(opcode & 0xFF);
+                bytes[1] = static_cast<uint8_t>(opcode >> 8);
+            }
+        }
+
+        void WriteU16(std::vector<uint8_t>& bytes, std::size_t offset, uint16_t value) {
+            if (offset + 2 <= bytes.size()) {
+                bytes[offset] = static_cast<uint8_t>(value & 0xFF);
+                bytes[offset + 1] = static_cast<uint8_t>(value >> 8);
+            }
+        }
+
+        // One structure a layout describes: an optional u16 selector and the smallest payload
+        // for which the layout reports all of its fields.
+        struct LayoutVariant {
+            bool hasSelector = false;
+            std::size_t selectorOffset = 0;
+            uint16_t selector = 0;
+            std::size_t completeSize = 0;
+        };
+
+        // Offsets and sizes of the spans a layout reports; equal signatures mean the same structure.
+        using SpanSignature = std::vector<std::pair<std::size_t, std::size_t>>;
+
+        SpanSignature GetSpanSignature(LayoutFunc layout, const PacketInfo& packet, std::vector<FieldSpan>& spans) {
+            spans.clear();
+            layout(packet, spans);
+            SpanSignature signature;
+            signature.reserve(spans.size());
+            for (const FieldSpan& span : spans) {
+                signature.emplace_back(span.offset, span.size);
+            }
+            return signature;
+        }
+
+        /**
+         * Finds the structures a layout distinguishes. Every u16 value is tried at the first
+         * positions after the header of a zeroed payload; a value that changes the reported
+         * spans (a subtype, a sub-opcode) starts a new variant. Each variant's complete size is
+         * the smallest payload size with the most spans.
+         */
+        std::vector<LayoutVariant> FindLayoutVariants(LayoutFunc layout, PacketDirection direction, uint16_t opcode,
+                                                      std::size_t maxSize) {
+            std::vector<FieldSpan> spans;
+            std::vector<uint8_t> bytes(maxSize, 0);
+            WriteHeader(bytes, direction, opcode);
+            PacketInfo probe = MakePacket(direction, opcode, bytes.data(), bytes.size());
+
+            std::vector<LayoutVariant> variants(1);
+            std::set<SpanSignature> seen = { GetSpanSignature(layout, probe, spans) };
+            const std::size_t headerSize = direction == PacketDirection::Sent ? 2 : 0;
+            for (std::size_t position = 0; position < LAYOUT_SELECTOR_POSITIONS; ++position) {
+                const std::size_t offset = headerSize + 2 * position;
+                if (offset + 2 > probe.data.size()) {
+                    break;
+                }
+                for (uint32_t value = 1; value <= 0xFFFF; ++value) {
+                    WriteU16(probe.data, offset, static_cast<uint16_t>(value));
+                    if (seen.insert(GetSpanSignature(layout, probe, spans)).second) {
+                        variants.push_back({ true, offset, static_cast<uint16_t>(value), 0 });
+                    }
+                }
+                WriteU16(probe.data, offset, 0);
+            }
+
+            for (LayoutVariant& variant : variants) {
+                std::size_t mostSpans = 0;
+                for (std::size_t size = 0; size <= maxSize; ++size) {
+                    probe.data.assign(size, 0);
+                    WriteHeader(probe.data, direction, opcode);
+                    if (variant.hasSelector) {
+                        WriteU16(probe.data, variant.selectorOffset, variant.selector);
+                    }
+                    spans.clear();
+                    layout(probe, spans);
+                    if (spans.size() > mostSpans) {
+                        mostSpans = spans.size();
+                        variant.completeSize = size;
+                    }
+                }
+            }
+            return variants;
+        }
+
+        // Fills a field with an edge value (zero, all ones, sign bit, one) or leaves it random.
+        void FillEdgeValue(std::vector<uint8_t>& bytes, const FieldSpan& span, int pattern) {
+            const std::size_t end = std::min(span.offset + span.size, bytes.size());
+            for (std::size_t i = span.offset; i < end; ++i) {
+                switch (pattern) {
+                case 0: bytes[i] = 0x00; break;
+                case 1: bytes[i] = 0xFF; break;
+                case 2: bytes[i] = i + 1 == end ? 0x80 : 0x00; break;
+                case 3: bytes[i] = i == span.offset ? 0x01 : 0x00; break;
+                default: break;
+                }
+            }
+        }
+
+        void CheckParser(const std::pair<PacketDirection, uint16_t>& key, ParserFunc parser,
+                         const ParserCheckOptions& options, ParserCheckResult& result) {
+            const auto [direction, opcode] = key;
+            result.direction = direction;
+            result.opcode = opcode;
+            result.name = GetPacketName(direction, opcode);
+
+            ParserRun run{ parser, result, options.allocationCounter };
+            std::mt19937 rng(options.seed ^ (static_cast<uint32_t>(opcode) << 1) ^ static_cast<uint32_t>(direction));
+            std::uniform_int_distribution<int> byteDist(0, 255);
+            std::vector<uint8_t> bytes;
+
+            // 1. Generated payloads: correct header, random body, every length up to the limit.
+            for (std::size_t size = 0; size <= options.maxGeneratedSize; ++size) {
+                bytes.resize(size);
+                for (uint8_t& b : bytes) {
+                    b = static_cast<uint8_t>(byteDist(rng));
+                }
+                WriteHeader(bytes, direction, opcode);
+                run.Feed(MakePacket(direction, opcode, bytes.data(), bytes.size()));
+            }
+
+            // 2. Structured payloads: every structure the handwritten layout describes, at and
+            //    above its complete size, with edge values in its fields. The layout reads the
+            //    same offsets as the parser, so the parser must decode all of them.
+            const LayoutRegistry& layouts = GetLayoutRegistry();
+            if (const auto layout = layouts.find(key); layout != layouts.end()) {
+                const std::vector<LayoutVariant> variants =
+                    FindLayoutVariants(layout->second, direction, opcode, options.maxGeneratedSize);
+                result.layoutVariants = variants.size();
+                std::uniform_int_distribution<std::size_t> extraDist(0, STRUCTURED_MAX_EXTRA_BYTES);
+                std::uniform_int_distribution<int> patternDist(0, 4);
+                std::vector<FieldSpan> spans;
+                for (const LayoutVariant& variant : variants) {
+                    for (std::size_t i = 0; i < options.structuredInputs; ++i) {
+                        bytes.resize(variant.completeSize + (i == 0 ? 0 : extraDist(rng)));
+                        for (uint8_t& b : bytes) {
+                            b = static_cast<uint8_t>(byteDist(rng));
+                        }
+                        PacketInfo packet = MakePacket(direction, opcode, bytes.data(), bytes.size());
+                        WriteHeader(packet.data, direction, opcode);
+                        if (variant.hasSelector) {
+                            WriteU16(packet.data, variant.selectorOffset, variant.selector);
+                        }
+                        spans.clear();
+                        layout->second(packet, spans);
+                        for (const FieldSpan& span : spans) {
+                            FillEdgeValue(packet.data, span, patternDist(rng));
+                        }
+                        WriteHeader(packet.data, direction, opcode);
+                        if (variant.hasSelector) {
+                            WriteU16(packet.data, variant.selectorOffset, variant.selector);
+                        }
+                        result.structuredInputs++;
+                        if (!run.Feed(packet)) {
+                            result.layoutMismatches++;
+                        }
+                    }
+                }
+            }
+
+            // 3. Random byte soup, header included.
+            std::uniform_int_distribution<std::size_t> sizeDist(0, options.maxRandomSize);
+            for (std::size_t i = 0; i < options.randomInputs; ++i) {
+                bytes.resize(sizeDist(rng));
+                for (uint8_t& b : bytes) {
+                    b = static_cast<uint8_t>(byteDist(rng));
+                }
+                run.Feed(MakePacket(direction, opcode, bytes.data(), bytes.size()));
+            }
+
+            // 4. Recorded packets and every truncated prefix of them.
+            if (options.corpus) {
+                std::size_t used = 0;
+                for (const PacketInfo& recorded : *options.corpus) {
+                    if (used >= options.maxCorpusPackets) {
+                        break;
+                    }
+                    if (recorded.direction != direction || recorded.rawHeaderId != opcode) {
+                        continue;
+                    }
+                    ++used;
+                    for (std::size_t size = recorded.data.size() + 1; size-- > 0;) {
+                        run.Feed(MakePacket(direction, opcode, recorded.data.data(), size));
+                        result.corpusInputs++;
+                    }
+                }
+            }
+
+            // 5. Contract: packets for the other direction or a neighbouring opcode must be ignored.
+            const PacketDirection otherDirection =
+                direction == PacketDirection::Sent ? PacketDirection::Received : PacketDirection::Sent;
+            bytes.assign(options.maxGeneratedSize, 0x01);
+            WriteHeader(bytes, direction, opcode);
+            if (!GetParserRegistry().contains({ otherDirection, opcode })) {
+                run.FeedForeign(MakePacket(otherDirection, opcode, bytes.data(), bytes.size()));
+            }
+            for (uint16_t foreignOpcode : { static_cast<uint16_t>(opcode - 1), static_cast<uint16_t>(opcode + 1) }) {
+                if (GetParserRegistry().contains({ direction, foreignOpcode })) {
+                    continue; // Some parsers legitimately own several opcodes
+                }
+                WriteHeader(bytes, direction, foreignOpcode);
+                run.FeedForeign(MakePacket(direction, foreignOpcode, bytes.data(), bytes.size()));
+            }
+
+            if (result.inputs > 0) {
+                result.nsPerPacket = std::chrono::duration<double, std::nano>(run.elapsed).count() /
+                                     static_cast<double>(result.inputs);
+            }
+        }
+    }
+
+    std::vector<ParserCheckResult> RunParserChecks(const ParserCheckOptions& options) {
+        const ParserRegistry& registry = GetParserRegistry();
+        std::vector<ParserCheckResult> results(registry.size());
+
+        std::size_t index = 0;
+        for (const auto& [key, parser] : registry) {
+            CheckParser(key, parser, options, results[index++]);
+        }
+        return results;
+    }
+
+} // namespace kx::Parsing
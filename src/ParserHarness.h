@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * @file ParserHarness.h
+ * @brief Robustness and timing checks for every parser in the parser registry.
+ * @details Each registered ParserFunc is driven with generated payloads of every length
+ *          up to a limit, structured payloads built from its handwritten layout
+ *          (FieldLayouts.h), random byte soup, every truncated prefix of recorded packets,
+ *          and packets addressed to the wrong direction/opcode. Inputs are copied into
+ *          exactly sized buffers so that an out-of-bounds read lands outside the heap
+ *          block, where AddressSanitizer (offline builds) will report it.
+ *          New parsers are covered automatically once they are added to the registry.
+ *          Nothing here depends on the game or the packet log; the in-game driver is in
+ *          ParserSelfCheck.h and the offline one in tools/parsercheck.
+ */
+
+#include "PacketData.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kx::Parsing {
+
+    struct ParserCheckOptions {
+        uint32_t seed = 0x4B58u;            // Fixed so runs are reproducible
+        std::size_t maxGeneratedSize = 128; // Generated payloads cover every length in [0, max]
+        std::size_t structuredInputs = 64;  // Structured payloads per layout variant
+        std::size_t randomInputs = 2048;    // Fully random payloads per parser
+        std::size_t maxRandomSize = 512;
+        std::size_t maxCorpusPackets = 64;  // Recorded packets per parser (each also truncated)
+        const std::vector<PacketInfo>* corpus = nullptr;
+        // If set, read before and after every parser call; offline tools point it at an
+        // operator new counter to get allocations per packet.
+        const std::atomic<uint64_t>* allocationCounter = nullptr;
+    };
+
+    struct ParserCheckResult {
+        PacketDirection direction = PacketDirection::Sent;
+        uint16_t opcode = 0;
+        std::string name;
+        uint64_t inputs = 0;             // Inputs addressed to this parser
+        uint64_t decoded = 0;            // Inputs for which the parser produced output
+        uint64_t corpusInputs = 0;       // Subset of inputs taken from the corpus
+        uint64_t structuredInputs = 0;   // Subset of inputs built from the layout
+        std::size_t layoutVariants = 0;  // Distinct layout structures found (0 without a layout)
+        uint64_t layoutMismatches = 0;   // Structured inputs the parser did not decode
+        uint64_t exceptions = 0;         // Parser threw (should never happen)
+        uint64_t contractViolations = 0; // Output produced for a packet of another direction/opcode
+        double nsPerPacket = 0.0;
+        std::size_t outputBytes = 0;     // Total size of produced strings, a proxy for allocation volume
+        uint64_t allocations = 0;        // Heap allocations while parsing its own inputs (needs allocationCounter)
+    };
+
+    /**
+     * @brief Runs the checks for every registered parser.
+     * @return One result per registry entry, in registry order.
+     */
+    std::vector<ParserCheckResult> RunParserChecks(const ParserCheckOptions& options);
+
+} // namespace kx::Parsing
@@ -0,0 +1,87 @@
+#include "ParserSelfCheck.h"
+#include "PacketParser.h"
+#include "PacketStore.h"
+#include "ThreadPool.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace kx::Parsing {
+
+    namespace {
+        std::mutex g_selfCheckMutex;
+        bool g_selfCheckRunning = false;
+        std::unique_ptr<std::vector<ParserCheckResult>> g_completedResults; // Guarded by g_selfCheckMutex
+        std::unique_ptr<std::vector<ParserCheckResult>> g_displayedResults; // Render thread only
+
+        // Copies the packets the checks will use, rather than the whole log.
+        std::vector<PacketInfo> CollectCorpus(std::size_t maxPacketsPerParser) {
+            std::map<std::pair<PacketDirection, uint16_t>, std::size_t> remaining;
+            for (const auto& [key, parser] : GetParserRegistry()) {
+                remaining[key] = maxPacketsPerParser;
+            }
+
+            std::vector<PacketInfo> corpus;
+            auto lock = g_packetLog.LockForReading();
+            const std::size_t size = g_packetLog.Size();
+            for (std::size_t i = 0; i < size && !remaining.empty(); ++i) {
+                const PacketInfo& packet = g_packetLog[i];
+                const auto it = remaining.find({ packet.direction, packet.rawHeaderId });
+                if (it == remaining.end()) {
+                    continue;
+                }
+                corpus.push_back(packet);
+                if (--it->second == 0) {
+                    remaining.erase(it);
+                }
+            }
+            return corpus;
+        }
+    }
+
+    bool StartParserSelfCheck() {
+        {
+            std::lock_guard<std::mutex> lock(g_selfCheckMutex);
+            if (g_selfCheckRunning) {
+                return false;
+            }
+            g_selfCheckRunning = true;
+        }
+
+        Threading::GetBackgroundPool().Submit([]() {
+            std::unique_ptr<std::vector<ParserCheckResult>> results;
+            try {
+                ParserCheckOptions options;
+                const std::vector<PacketInfo> corpus = CollectCorpus(options.maxCorpusPackets);
+                options.corpus = &corpus;
+                results = std::make_unique<std::vector<ParserCheckResult>>(RunParserChecks(options));
+            }
+            catch (...) {
+                results.reset();
+            }
+
+            std::lock_guard<std::mutex> lock(g_selfCheckMutex);
+            if (results) {
+                g_completedResults = std::move(results);
+            }
+            g_selfCheckRunning = false;
+        });
+        return true;
+    }
+
+    bool IsParserSelfCheckRunning() {
+        std::lock_guard<std::mutex> lock(g_selfCheckMutex);
+        return g_selfCheckRunning;
+    }
+
+    const std::vector<ParserCheckResult>* GetParserSelfCheckResults() {
+        std::lock_guard<std::mutex> lock(g_selfCheckMutex);
+        if (g_completedResults) {
+            g_displayedResults = std::move(g_completedResults);
+        }
+        return g_displayedResults.get();
+    }
+
+} // namespace kx::Parsing
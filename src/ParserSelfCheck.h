@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+ * @file ParserSelfCheck.h
+ * @brief In-game driver for the parser checks of ParserHarness.h.
+ * @details Takes the corpus from the packet log (up to ParserCheckOptions::maxCorpusPackets
+ *          packets per parser) and runs on the background pool, which drains it before the
+ *          DLL unloads.
+ */
+
+#include "ParserHarness.h"
+
+#include <vector>
+
+namespace kx::Parsing {
+
+    bool StartParserSelfCheck();
+    bool IsParserSelfCheckRunning();
+
+    /**
+     * @brief Results of the last completed self-check, or nullptr. Render thread only.
+     */
+    const std::vector<ParserCheckResult>* GetParserSelfCheckResults();
+
+} // namespace kx::Parsing
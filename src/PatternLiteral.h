@@ -0,0 +1,136 @@
+#pragma once
+
+/**
+ * @file PatternLiteral.h
+ * @brief IDA-style patterns compiled by the compiler: CompilePattern<"48 8B ? 05">().
+ * @details The text is tokenised, validated and turned into fixed-size byte and mask arrays
+ *          in a consteval function, and the anchors are chosen with the same ChooseAnchors()
+ *          as BytePattern::Create(). A malformed pattern is a build error: the diagnostic
+ *          points at the PatternLiteralIsInvalid() call naming the problem. At runtime
+ *          ToBytePattern() only copies the arrays.
+ */
+
+#include "PatternSearch.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace kx::Scanning {
+
+    // A string literal usable as a template argument.
+    template <std::size_t N>
+    struct PatternText {
+        char text[N]{};
+
+        consteval PatternText(const char (&literal)[N]) {
+            for (std::size_t i = 0; i < N; ++i) {
+                text[i] = literal[i];
+            }
+        }
+
+        constexpr std::string_view View() const { return std::string_view(text, N - 1); }
+    };
+
+    template <std::size_t Size>
+    struct CompiledPattern {
+        std::array<uint8_t, Size> bytes{}; // 0 at wildcard positions
+        std::array<uint8_t, Size> mask{};  // 0xFF for fixed bytes, 0x00 for wildcards
+        std::size_t anchor = 0;
+        std::size_t secondAnchor = 0;
+        std::string_view text;
+
+        BytePattern ToBytePattern() const {
+            BytePattern pattern;
+            pattern.bytes.assign(bytes.begin(), bytes.end());
+            pattern.mask.assign(mask.begin(), mask.end());
+            pattern.anchor = anchor;
+            pattern.secondAnchor = secondAnchor;
+            return pattern;
+        }
+    };
+
+    // Not constexpr: reaching it during constant evaluation makes the pattern a build error.
+    inline void PatternLiteralIsInvalid(const char*) {}
+
+    namespace PatternLiteral {
+        constexpr bool IsSeparator(char c) { return c == ' ' || c == '\t'; }
+
+        constexpr int HexDigit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        }
+
+        // Calls f(token) for every whitespace-separated token of `text`.
+        template <typename F>
+        constexpr void ForEachToken(std::string_view text, F&& f) {
+            std::size_t pos = 0;
+            while (pos < text.size()) {
+                if (IsSeparator(text[pos])) {
+                    ++pos;
+                    continue;
+                }
+                std::size_t end = pos;
+                while (end < text.size() && !IsSeparator(text[end])) {
+                    ++end;
+                }
+                f(text.substr(pos, end - pos));
+                pos = end;
+            }
+        }
+
+        consteval std::size_t CountTokens(std::string_view text) {
+            std::size_t count = 0;
+            ForEachToken(text, [&](std::string_view) { ++count; });
+            return count;
+        }
+    }
+
+    /**
+     * @brief Compiles an IDA-style pattern at build time. `?` and `??` are wildcards; every
+     *        other token must be one or two hex digits, and at least one byte must be fixed.
+     */
+    template <PatternText Text>
+    consteval auto CompilePattern() {
+        constexpr std::size_t size = PatternLiteral::CountTokens(Text.View());
+        static_assert(size > 0, "Empty pattern");
+
+        CompiledPattern<size> pattern;
+        pattern.text = Text.View();
+        std::size_t index = 0;
+        bool hasFixed = false;
+        PatternLiteral::ForEachToken(Text.View(), [&](std::string_view token) {
+            if (token == "?" || token == "??") {
+                ++index;
+                return;
+            }
+            int value = 0;
+            for (const char c : token) {
+                const int digit = PatternLiteral::HexDigit(c);
+                if (digit < 0) {
+                    PatternLiteralIsInvalid("a pattern byte is not hex");
+                }
+                value = value * 16 + digit;
+            }
+            if (token.size() > 2) {
+                PatternLiteralIsInvalid("a pattern byte has more than two hex digits");
+            }
+            pattern.bytes[index] = static_cast<uint8_t>(value);
+            pattern.mask[index] = 0xFF;
+            hasFixed = true;
+            ++index;
+        });
+        if (!hasFixed) {
+            PatternLiteralIsInvalid("a pattern needs at least one fixed byte");
+        }
+
+        const PatternAnchors anchors = ChooseAnchors(pattern.bytes.data(), pattern.mask.data(), size);
+        pattern.anchor = anchors.anchor;
+        pattern.secondAnchor = anchors.secondAnchor;
+        return pattern;
+    }
+
+} // namespace kx::Scanning
@@ -1,10 +1,14 @@
 #include "PatternScanner.h"
+#include "FuzzySearch.h"
+#include "PatternSearch.h"
+#include "PeImage.h"
+#include "SectionScan.h"
+#include "SignatureCache.h"
+#include "ThreadPool.h"
 #include <windows.h>
 #include <psapi.h> // For GetModuleInformation
 #include <vector>
 #include <string>
-#include <sstream>
-#include <iomanip>
 #include <optional>
 #include <iostream> // For error logging (temporary, consider a proper logger)
 
@@ -12,48 +16,35 @@
 
 namespace kx {
 
-// Helper to convert pattern string to bytes and mask.
-// Returns true on success, false on parsing error.
-bool PatternScanner::PatternToBytes(const std::string& pattern, std::vector<int>& bytes) {
-    bytes.clear();
-    std::stringstream ss(pattern);
-    std::string byteStr;
+namespace {
 
-    while (ss >> byteStr) {
-        if (byteStr == "?" || byteStr == "??") {
-            bytes.push_back(-1); // Use -1 to represent a wildcard byte
-        } else {
-            try {
-                int byteVal = std::stoi(byteStr, nullptr, 16);
-                if (byteVal >= 0 && byteVal <= 255) {
-                    bytes.push_back(byteVal);
-                } else {
-                    // Invalid byte value
-                    std::cerr << "[PatternScanner] Error: Invalid byte value '" << byteStr << "' in pattern." << std::endl;
-                    return false;
-                }
-            } catch (const std::invalid_argument&) {
-                // Invalid hex string format
-                 std::cerr << "[PatternScanner] Error: Invalid hex string '" << byteStr << "' in pattern." << std::endl;
-                return false;
-            } catch (const std::out_of_range&) {
-                // Hex string out of range for int
-                 std::cerr << "[PatternScanner] Error: Hex string '" << byteStr << "' out of range in pattern." << std::endl;
-                return false;
-            }
-        }
-    }
-    return !bytes.empty(); // Ensure the pattern wasn't empty or just whitespace
-}
+std::filesystem::path g_cacheFile; // Empty: no signature cache
 
-
-std::optional<uintptr_t> PatternScanner::FindPattern(const std::string& pattern, const std::string& moduleName) {
-    std::vector<int> patternBytes;
-    if (!PatternToBytes(pattern, patternBytes)) {
-        std::cerr << "[PatternScanner] Failed to parse pattern string." << std::endl;
-        return std::nullopt;
+// The cache for the build in `moduleData`: the file's contents if it was written for the same
+// build, otherwise an empty cache that replaces it on the next save. A cache of another build
+// is kept in `previousBuild`, whose RVAs rank approximate matches.
+Scanning::SignatureCache LoadCache(const uint8_t* moduleData, const Scanning::PeImage& image, Scanning::SignatureCache& previousBuild) {
+    const uint64_t buildKey = Scanning::SignatureCache::ComputeBuildKey(moduleData, image);
+    std::error_code ec;
+    if (!std::filesystem::exists(g_cacheFile, ec)) {
+        return Scanning::SignatureCache(buildKey);
     }
+    std::string error;
+    std::optional<Scanning::SignatureCache> cache = Scanning::SignatureCache::Load(g_cacheFile, error);
+    if (!cache) {
+        std::cerr << "[PatternScanner] Ignoring signature cache: " << error << std::endl;
+        return Scanning::SignatureCache(buildKey);
+    }
+    if (cache->GetBuildKey() != buildKey) {
+        std::cout << "[PatternScanner] Signature cache is for another game build; rescanning." << std::endl;
+        previousBuild = std::move(*cache);
+        return Scanning::SignatureCache(buildKey);
+    }
+    return std::move(*cache);
+}
 
+// Base address and size of a loaded module, or std::nullopt (with the error logged).
+std::optional<MODULEINFO> GetModuleRange(const std::string& moduleName) {
     HMODULE hModule = GetModuleHandleA(moduleName.c_str());
     if (hModule == NULL) {
         std::cerr << "[PatternScanner] Error: Could not get handle for module '" << moduleName << "'. Error code: " << GetLastError() << std::endl;
@@ -65,34 +56,168 @@ std::optional<uintptr_t> PatternScanner::FindPattern(const std::string& pattern,
         std::cerr << "[PatternScanner] Error: Could not get module information for '" << moduleName << "'. Error code: " << GetLastError() << std::endl;
         return std::nullopt;
     }
+    return moduleInfo;
+}
+
+// Resolves a signature without exact matches to its best approximate match, or returns
+// std::nullopt if there is none or the best one is ambiguous. `hint` is the signature's RVA
+// in the previously cached build.
+std::optional<uint32_t> FindApproximateMatch(const uint8_t* moduleData, const Scanning::PeImage& image,
+                                             const PatternScanner::Signature& signature, std::optional<uint32_t> hint) {
+    const Scanning::BytePattern& pattern = signature.pattern;
+    std::vector<Scanning::ApproximateMatch> matches = Scanning::FindApproximateInSections(
+        moduleData, image, signature.target, pattern, signature.maxMismatches, Threading::GetBackgroundPool());
+    const Scanning::SignatureUniqueness uniqueness = Scanning::MeasureUniqueness(pattern, signature.maxMismatches, matches);
+    std::cout << "[PatternScanner] No exact match for '" << pattern.ToString() << "'; near matches (" << uniqueness.fixedBytes << " fixed bytes):";
+    for (size_t distance = 1; distance <= uniqueness.maxMismatches; ++distance) {
+        std::cout << " " << uniqueness.matchesAtDistance[distance] << " at " << distance << (distance == 1 ? " byte" : " bytes") << (distance < uniqueness.maxMismatches ? "," : "");
+    }
+    std::cout << std::endl;
+    if (matches.empty()) {
+        return std::nullopt;
+    }
+
+    Scanning::RankApproximateMatches(matches, hint);
+    const Scanning::ApproximateMatch& best = matches[0];
+    const bool unique = uniqueness.matchesAtDistance[best.mismatches] == 1;
+    auto distanceToHint = [hint](const Scanning::ApproximateMatch& match) {
+        return match.offset > *hint ? match.offset - *hint : *hint - match.offset;
+    };
+    // Ranking puts the closest to the hint first among equals; it decides only if it is strictly closer.
+    const bool closestToHint = !unique && hint && (matches[1].mismatches > best.mismatches || distanceToHint(matches[1]) > distanceToHint(best));
+    if (!unique && !closestToHint) {
+        std::cerr << "[PatternScanner] Warning: " << uniqueness.matchesAtDistance[best.mismatches] << " matches differ in "
+                  << best.mismatches << " byte(s); not guessing." << std::endl;
+        return std::nullopt;
+    }
+    std::cout << "[PatternScanner] Using the match at RVA 0x" << std::hex << best.offset << std::dec << " with " << best.mismatches
+              << " differing byte(s)" << (unique ? "." : ", the one closest to the previous build's.") << std::endl;
+    return static_cast<uint32_t>(best.offset);
+}
+
+} // namespace
+
+void PatternScanner::SetCacheFile(const std::filesystem::path& path) {
+    g_cacheFile = path;
+}
+
+std::optional<uintptr_t> PatternScanner::FindPattern(const std::string& pattern, const std::string& moduleName) {
+    std::string parseError;
+    std::optional<Scanning::BytePattern> compiledPattern = Scanning::BytePattern::Parse(pattern, &parseError);
+    if (!compiledPattern) {
+        std::cerr << "[PatternScanner] Failed to parse pattern string: " << parseError << std::endl;
+        return std::nullopt;
+    }
+    const std::vector<std::vector<uintptr_t>> matches = FindPatterns({ { std::move(*compiledPattern), Scanning::ScanTarget::Code } }, moduleName);
+    if (matches[0].empty()) {
+        std::cerr << "[PatternScanner] Pattern not found in module '" << moduleName << "'." << std::endl;
+        return std::nullopt;
+    }
+    return matches[0].front();
+}
+
+std::vector<std::vector<uintptr_t>> PatternScanner::FindPatterns(const std::vector<Signature>& signatures, const std::string& moduleName) {
+    std::vector<std::vector<uintptr_t>> addresses(signatures.size());
+    const std::optional<MODULEINFO> moduleInfo = GetModuleRange(moduleName);
+    if (!moduleInfo) {
+        return addresses;
+    }
 
-    uintptr_t baseAddress = reinterpret_cast<uintptr_t>(moduleInfo.lpBaseOfDll);
-    uintptr_t scanSize = moduleInfo.SizeOfImage;
-    size_t patternSize = patternBytes.size();
+    uintptr_t baseAddress = reinterpret_cast<uintptr_t>(moduleInfo->lpBaseOfDll);
+    const uint8_t* moduleData = reinterpret_cast<const uint8_t*>(baseAddress);
+    std::string peError;
+    const std::optional<Scanning::PeImage> image = Scanning::PeImage::Parse(moduleData, moduleInfo->SizeOfImage, Scanning::PeLayout::Mapped, &peError);
+    if (!image) {
+        std::cerr << "[PatternScanner] Could not read the section table of '" << moduleName << "' (" << peError << "). Scanning the whole image." << std::endl;
+    }
 
-    if (scanSize < patternSize) {
-         std::cerr << "[PatternScanner] Error: Module size is smaller than pattern size." << std::endl;
-        return std::nullopt; // Cannot possibly find the pattern
+    std::optional<Scanning::SignatureCache> cache;
+    Scanning::SignatureCache previousBuild;
+    if (image && !g_cacheFile.empty()) {
+        cache = LoadCache(moduleData, *image, previousBuild);
     }
+    size_t cachedCount = 0;
+    size_t scannedCount = 0;
 
-    for (uintptr_t i = 0; i <= scanSize - patternSize; ++i) {
-        bool found = true;
-        for (size_t j = 0; j < patternSize; ++j) {
-            // Check if the byte is a wildcard (-1) or if the memory matches the pattern byte
-            if (patternBytes[j] != -1 && patternBytes[j] != *reinterpret_cast<unsigned char*>(baseAddress + i + j)) {
-                found = false;
-                break;
+    for (const Scanning::ScanTarget target : { Scanning::ScanTarget::Code, Scanning::ScanTarget::ReadOnlyData }) {
+        // Only patterns that the cache could not resolve go into the set;
+        // setIndices maps them back to their input position.
+        Scanning::PatternSet patternSet;
+        std::vector<size_t> setIndices;
+        std::vector<uint64_t> setHashes;
+        for (size_t i = 0; i < signatures.size(); ++i) {
+            if (signatures[i].target != target) {
+                continue;
+            }
+            const Scanning::BytePattern& pattern = signatures[i].pattern;
+            const uint64_t signatureHash = Scanning::SignatureCache::HashSignature(pattern, target);
+            if (cache) {
+                const std::vector<uint32_t>* cachedRvas = cache->Find(signatureHash);
+                if (cachedRvas && Scanning::ValidateCachedMatches(moduleData, *image, target, pattern, *cachedRvas)) {
+                    for (const uint32_t rva : *cachedRvas) {
+                        addresses[i].push_back(baseAddress + rva);
+                    }
+                    ++cachedCount;
+                    continue;
+                }
             }
+            patternSet.Add(pattern);
+            setIndices.push_back(i);
+            setHashes.push_back(signatureHash);
         }
+        if (patternSet.Size() == 0) {
+            continue;
+        }
+        scannedCount += patternSet.Size();
 
-        if (found) {
-            return baseAddress + i;
+        if (image) {
+            const std::vector<std::vector<uint32_t>> rvas = Scanning::FindInSections(moduleData, *image, target, patternSet, Threading::GetBackgroundPool());
+            for (size_t i = 0; i < rvas.size(); ++i) {
+                for (const uint32_t rva : rvas[i]) {
+                    addresses[setIndices[i]].push_back(baseAddress + rva);
+                }
+                std::vector<uint32_t> resolved = rvas[i];
+                const Signature& signature = signatures[setIndices[i]];
+                if (resolved.empty() && signature.maxMismatches > 0) {
+                    // The last RVA this build resolved to (an approximate match cached as a
+                    // hint fails validation, but still ranks), else the previous build's.
+                    const std::vector<uint32_t>* previousRvas = cache ? cache->Find(setHashes[i]) : nullptr;
+                    if (!previousRvas) {
+                        previousRvas = previousBuild.Find(setHashes[i]);
+                    }
+                    std::optional<uint32_t> hint;
+                    if (previousRvas) {
+                        hint = previousRvas->front();
+                    }
+                    if (const std::optional<uint32_t> rva = FindApproximateMatch(moduleData, *image, signature, hint)) {
+                        addresses[setIndices[i]].push_back(baseAddress + *rva);
+                        resolved.push_back(*rva);
+                    }
+                }
+                if (cache) {
+                    cache->Store(setHashes[i], std::move(resolved));
+                }
+            }
+        } else {
+            const std::vector<std::vector<size_t>> offsets = patternSet.FindAll(moduleData, moduleInfo->SizeOfImage);
+            for (size_t i = 0; i < offsets.size(); ++i) {
+                for (const size_t offset : offsets[i]) {
+                    addresses[setIndices[i]].push_back(baseAddress + offset);
+                }
+            }
         }
     }
 
-    // Pattern not found
-    std::cerr << "[PatternScanner] Pattern not found in module '" << moduleName << "'." << std::endl;
-    return std::nullopt;
+    if (cachedCount > 0) {
+        std::cout << "[PatternScanner] " << cachedCount << " signature(s) resolved from the cache, " << scannedCount << " scanned." << std::endl;
+    }
+    if (cache && scannedCount > 0) {
+        std::string error;
+        if (!cache->Save(g_cacheFile, error)) {
+            std::cerr << "[PatternScanner] Could not save the signature cache: " << error << std::endl;
+        }
+    }
+    return addresses;
 }
 
-}
\ No newline at end of file
+}
@@ -4,20 +4,48 @@
 #include <vector>
 #include <string>
 #include <optional>
+#include <filesystem>
+#include "PatternSearch.h"
+#include "PeImage.h"
 
 namespace kx {
 
 class PatternScanner {
 public:
-    // Scans a memory region for a given byte pattern.
+    // A compiled pattern (see PatternLiteral.h for build-time patterns) and the kind of
+    // section it is searched in.
+    struct Signature {
+        Scanning::BytePattern pattern;
+        Scanning::ScanTarget target = Scanning::ScanTarget::Code;
+        // If the pattern has no exact match, accept a match with up to this many differing
+        // fixed bytes (FuzzySearch.h). 0 disables the fallback.
+        size_t maxMismatches = 0;
+    };
+
+    // Remembers signature matches in `path` (SignatureCache.h), keyed by game build. On the
+    // next injection into the same build, FindPatterns re-checks each signature at its cached
+    // addresses and only scans for the ones that no longer match there.
+    static void SetCacheFile(const std::filesystem::path& path);
+
+    // Scans a module's code for a given byte pattern.
     // pattern: IDA-style pattern string (e.g., "48 89 5C 24 ? 57 48 83 EC 20")
     // moduleName: Name of the module to scan within the current process.
     // Returns the address of the first match, or std::nullopt if not found.
+    // The search itself is the portable SIMD scanner in PatternSearch.h.
     static std::optional<uintptr_t> FindPattern(const std::string& pattern, const std::string& moduleName);
 
-private:
-    // Helper to convert pattern string to bytes and mask.
-    static bool PatternToBytes(const std::string& pattern, std::vector<int>& bytes);
+    // Scans a module for several signatures at once. Signatures sharing a target are found in
+    // a single pass (Scanning::PatternSet) over only the sections of that target, split into
+    // chunks searched on the background thread pool (SectionScan.h). The whole image is
+    // scanned if its section table is unreadable.
+    // Returns the addresses of every match of each signature, in the order given. More than
+    // one match means the signature is ambiguous.
+    // A signature that allows mismatches and has no exact match resolves to its best
+    // approximate match, if that one is unambiguous: unique at its mismatch count, or the
+    // one closest to where the signature was found in the previously cached build.
+    // Approximate matches are logged with their near-match counts. They are cached only as
+    // that hint: a cached address is used directly only if the pattern matches it exactly.
+    static std::vector<std::vector<uintptr_t>> FindPatterns(const std::vector<Signature>& signatures, const std::string& moduleName);
 };
 
 }
\ No newline at end of file
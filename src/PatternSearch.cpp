@@ -0,0 +1,431 @@
+#include "PatternSearch.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+#if KX_ARCH_X64
+#include <immintrin.h>
+#endif
+
+namespace kx::Scanning {
+
+    namespace {
+        struct ScanResults {
+            std::vector<std::size_t>* all = nullptr; // nullptr: stop at the first match
+            std::optional<std::size_t> first;
+
+            // Returns true when the scan should stop.
+            bool Add(std::size_t offset) {
+                if (!first) {
+                    first = offset;
+                }
+                if (!all) {
+                    return true;
+                }
+                all->push_back(offset);
+                return false;
+            }
+        };
+
+        // Positions [position, lastPosition] one at a time: the tail after the SIMD blocks, or everything without SIMD.
+        bool ScanScalar(const uint8_t* data, std::size_t lastPosition, const BytePattern& pattern, std::size_t position, ScanResults& results) {
+            const uint8_t first = pattern.bytes[pattern.anchor];
+            const uint8_t second = pattern.bytes[pattern.secondAnchor];
+            while (position <= lastPosition) {
+                // memchr finds the next anchor byte far faster than a byte loop.
+                const void* hit = std::memchr(data + position + pattern.anchor, first, lastPosition - position + 1);
+                if (!hit) {
+                    return false;
+                }
+                position = static_cast<std::size_t>(static_cast<const uint8_t*>(hit) - data) - pattern.anchor;
+                if (data[position + pattern.secondAnchor] == second && pattern.MatchesAt(data + position) && results.Add(position)) {
+                    return true;
+                }
+                ++position;
+            }
+            return false;
+        }
+
+#if KX_ARCH_X64
+        // Checks positions one by one up to the first at which the anchor load is aligned to `alignment`.
+        bool ScanToAlignment(const uint8_t* data, std::size_t lastPosition, const BytePattern& pattern, std::size_t& position,
+                             std::size_t alignment, ScanResults& results) {
+            const uint8_t first = pattern.bytes[pattern.anchor];
+            const uint8_t second = pattern.bytes[pattern.secondAnchor];
+            for (; position <= lastPosition && (reinterpret_cast<uintptr_t>(data + position + pattern.anchor) & (alignment - 1)) != 0; ++position) {
+                if (data[position + pattern.anchor] == first && data[position + pattern.secondAnchor] == second &&
+                    pattern.MatchesAt(data + position) && results.Add(position)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Verifies the candidate positions set in `candidates` (bit i: position + i).
+        bool VerifyCandidates(const uint8_t* data, const BytePattern& pattern, std::size_t position, uint64_t candidates, ScanResults& results) {
+            while (candidates != 0) {
+                const std::size_t offset = position + static_cast<std::size_t>(std::countr_zero(candidates));
+                candidates &= candidates - 1;
+                if (pattern.MatchesAt(data + offset) && results.Add(offset)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // The SIMD scans test a block of candidate positions at once by comparing both anchors.
+        // The first anchor's loads are aligned (the scan is bound by memory bandwidth, and split
+        // loads cost), and loads stay in bounds because a block ends at the last possible match start.
+        bool ScanSse2(const uint8_t* data, std::size_t lastPosition, const BytePattern& pattern, std::size_t& position, ScanResults& results) {
+            if (ScanToAlignment(data, lastPosition, pattern, position, 16, results)) {
+                return true;
+            }
+            const __m128i first = _mm_set1_epi8(static_cast<char>(pattern.bytes[pattern.anchor]));
+            const __m128i second = _mm_set1_epi8(static_cast<char>(pattern.bytes[pattern.secondAnchor]));
+            const uint8_t* firstBase = data + pattern.anchor;
+            const uint8_t* secondBase = data + pattern.secondAnchor;
+            for (; position + 32 <= lastPosition + 1; position += 32) {
+                const __m128i m0 = _mm_and_si128(
+                    _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(firstBase + position)), first),
+                    _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(secondBase + position)), second));
+                const __m128i m1 = _mm_and_si128(
+                    _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(firstBase + position + 16)), first),
+                    _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(secondBase + position + 16)), second));
+                const uint32_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(m0, m1)));
+                if (candidates != 0 &&
+                    VerifyCandidates(data, pattern, position, static_cast<uint32_t>(_mm_movemask_epi8(m0)) |
+                                                              (static_cast<uint32_t>(_mm_movemask_epi8(m1)) << 16), results)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        KX_TARGET_AVX2 bool ScanAvx2(const uint8_t* data, std::size_t lastPosition, const BytePattern& pattern, std::size_t& position, ScanResults& results) {
+            if (ScanToAlignment(data, lastPosition, pattern, position, 32, results)) {
+                return true;
+            }
+            const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern.bytes[pattern.anchor]));
+            const __m256i second = _mm256_set1_epi8(static_cast<char>(pattern.bytes[pattern.secondAnchor]));
+            const uint8_t* firstBase = data + pattern.anchor;
+            const uint8_t* secondBase = data + pattern.secondAnchor;
+            for (; position + 64 <= lastPosition + 1; position += 64) {
+                const __m256i m0 = _mm256_and_si256(
+                    _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(firstBase + position)), first),
+                    _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(secondBase + position)), second));
+                const __m256i m1 = _mm256_and_si256(
+                    _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(firstBase + position + 32)), first),
+                    _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(secondBase + position + 32)), second));
+                const __m256i any = _mm256_or_si256(m0, m1);
+                if (_mm256_testz_si256(any, any)) {
+                    continue;
+                }
+                const uint64_t candidates = static_cast<uint32_t>(_mm256_movemask_epi8(m0)) |
+                                            (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(m1))) << 32);
+                if (VerifyCandidates(data, pattern, position, candidates, results)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+#endif
+
+        void Scan(const uint8_t* data, std::size_t size, const BytePattern& pattern, ScanResults& results) {
+            if (pattern.Size() == 0 || size < pattern.Size()) {
+                return;
+            }
+            const std::size_t lastPosition = size - pattern.Size();
+            std::size_t position = 0;
+#if KX_ARCH_X64
+            const Cpu::Features& features = Cpu::GetFeatures();
+            const bool stopped = features.avx2
+                ? ScanAvx2(data, lastPosition, pattern, position, results)
+                : ScanSse2(data, lastPosition, pattern, position, results); // SSE2 is baseline on x64
+            if (stopped) {
+                return;
+            }
+#endif
+            ScanScalar(data, lastPosition, pattern, position, results);
+        }
+
+#if KX_ARCH_X64
+        // The PatternSet sweeps compare every pattern's anchor pair against a block of positions,
+        // with the first anchor's loads aligned. The caller keeps the second anchor's loads in
+        // bounds: blocks start at or after `position` and end before `end`.
+        template <typename OnCandidates>
+        void SweepSse2(const uint8_t* data, std::size_t end, const uint8_t* firsts, const uint8_t* seconds,
+                       const std::ptrdiff_t* distances, std::size_t count, std::size_t& position, OnCandidates&& onCandidates) {
+            __m128i first[PatternSet::MAX_SIMD_PATTERNS];
+            __m128i second[PatternSet::MAX_SIMD_PATTERNS];
+            for (std::size_t k = 0; k < count; ++k) {
+                first[k] = _mm_set1_epi8(static_cast<char>(firsts[k]));
+                second[k] = _mm_set1_epi8(static_cast<char>(seconds[k]));
+            }
+            for (; position + 32 <= end; position += 32) {
+                const __m128i v0 = _mm_load_si128(reinterpret_cast<const __m128i*>(data + position));
+                const __m128i v1 = _mm_load_si128(reinterpret_cast<const __m128i*>(data + position + 16));
+                __m128i low = _mm_setzero_si128();
+                __m128i high = _mm_setzero_si128();
+                for (std::size_t k = 0; k < count; ++k) {
+                    const uint8_t* secondBase = data + position + distances[k];
+                    low = _mm_or_si128(low, _mm_and_si128(_mm_cmpeq_epi8(v0, first[k]),
+                        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(secondBase)), second[k])));
+                    high = _mm_or_si128(high, _mm_and_si128(_mm_cmpeq_epi8(v1, first[k]),
+                        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(secondBase + 16)), second[k])));
+                }
+                const uint64_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(low)) |
+                                            (static_cast<uint32_t>(_mm_movemask_epi8(high)) << 16);
+                if (candidates != 0) {
+                    onCandidates(position, candidates);
+                }
+            }
+        }
+
+        template <typename OnCandidates>
+        KX_TARGET_AVX2 void SweepAvx2(const uint8_t* data, std::size_t end, const uint8_t* firsts, const uint8_t* seconds,
+                                      const std::ptrdiff_t* distances, std::size_t count, std::size_t& position, OnCandidates&& onCandidates) {
+            __m256i first[PatternSet::MAX_SIMD_PATTERNS];
+            __m256i second[PatternSet::MAX_SIMD_PATTERNS];
+            for (std::size_t k = 0; k < count; ++k) {
+                first[k] = _mm256_set1_epi8(static_cast<char>(firsts[k]));
+                second[k] = _mm256_set1_epi8(static_cast<char>(seconds[k]));
+            }
+            for (; position + 64 <= end; position += 64) {
+                const __m256i v0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(data + position));
+                const __m256i v1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(data + position + 32));
+                __m256i low = _mm256_setzero_si256();
+                __m256i high = _mm256_setzero_si256();
+                for (std::size_t k = 0; k < count; ++k) {
+                    const uint8_t* secondBase = data + position + distances[k];
+                    low = _mm256_or_si256(low, _mm256_and_si256(_mm256_cmpeq_epi8(v0, first[k]),
+                        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(secondBase)), second[k])));
+                    high = _mm256_or_si256(high, _mm256_and_si256(_mm256_cmpeq_epi8(v1, first[k]),
+                        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(secondBase + 32)), second[k])));
+                }
+                const __m256i any = _mm256_or_si256(low, high);
+                if (_mm256_testz_si256(any, any)) {
+                    continue;
+                }
+                onCandidates(position, static_cast<uint32_t>(_mm256_movemask_epi8(low)) |
+                                       (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32));
+            }
+        }
+#endif
+    }
+
+    std::optional<BytePattern> BytePattern::Parse(std::string_view text, std::string* error) {
+        BytePattern pattern;
+        std::size_t pos = 0;
+        while (pos < text.size()) {
+            if (text[pos] == ' ' || text[pos] == '\t') {
+                ++pos;
+                continue;
+            }
+            std::size_t end = pos;
+            while (end < text.size() && text[end] != ' ' && text[end] != '\t') {
+                ++end;
+            }
+            const std::string_view token = text.substr(pos, end - pos);
+            pos = end;
+
+            if (token == "?" || token == "??") {
+                pattern.bytes.push_back(0);
+                pattern.mask.push_back(0x00);
+                continue;
+            }
+            unsigned value = 0;
+            const auto result = std::from_chars(token.data(), token.data() + token.size(), value, 16);
+            if (token.size() > 2 || result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+                if (error) {
+                    *error = "invalid byte '" + std::string(token) + "'";
+                }
+                return std::nullopt;
+            }
+            pattern.bytes.push_back(static_cast<uint8_t>(value));
+            pattern.mask.push_back(0xFF);
+        }
+        return Create(std::move(pattern.bytes), std::move(pattern.mask), error);
+    }
+
+    std::string BytePattern::ToString() const {
+        static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+        std::string text;
+        for (std::size_t i = 0; i < Size(); ++i) {
+            if (i) {
+                text += ' ';
+            }
+            if (mask[i]) {
+                text += HEX_DIGITS[bytes[i] >> 4];
+                text += HEX_DIGITS[bytes[i] & 0xF];
+            } else {
+                text += '?';
+            }
+        }
+        return text;
+    }
+
+    std::optional<BytePattern> BytePattern::Create(std::vector<uint8_t> bytes, std::vector<uint8_t> mask, std::string* error) {
+        BytePattern pattern;
+        pattern.bytes = std::move(bytes);
+        pattern.mask = std::move(mask);
+        if (pattern.mask.size() != pattern.bytes.size()) {
+            if (error) {
+                *error = "byte and mask lengths differ";
+            }
+            return std::nullopt;
+        }
+        for (std::size_t i = 0; i < pattern.Size(); ++i) {
+            pattern.mask[i] = pattern.mask[i] ? 0xFF : 0x00;
+            pattern.bytes[i] &= pattern.mask[i];
+        }
+
+        if (std::find(pattern.mask.begin(), pattern.mask.end(), 0xFF) == pattern.mask.end()) {
+            if (error) {
+                *error = pattern.bytes.empty() ? "empty pattern" : "pattern has no fixed byte";
+            }
+            return std::nullopt;
+        }
+        const PatternAnchors anchors = ChooseAnchors(pattern.bytes.data(), pattern.mask.data(), pattern.Size());
+        pattern.anchor = anchors.anchor;
+        pattern.secondAnchor = anchors.secondAnchor;
+        return pattern;
+    }
+
+    bool BytePattern::MatchesAt(const uint8_t* data) const {
+        // Eight bytes per step: (memory ^ expected) & mask is zero where the pattern matches.
+        const std::size_t size = Size();
+        std::size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t memory;
+            uint64_t expected;
+            uint64_t fixed;
+            std::memcpy(&memory, data + i, 8);
+            std::memcpy(&expected, bytes.data() + i, 8);
+            std::memcpy(&fixed, mask.data() + i, 8);
+            if (((memory ^ expected) & fixed) != 0) {
+                return false;
+            }
+        }
+        for (; i < size; ++i) {
+            if (((data[i] ^ bytes[i]) & mask[i]) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::optional<std::size_t> FindFirst(const uint8_t* data, std::size_t size, const BytePattern& pattern) {
+        ScanResults results;
+        Scan(data, size, pattern, results);
+        return results.first;
+    }
+
+    std::vector<std::size_t> FindAll(const uint8_t* data, std::size_t size, const BytePattern& pattern) {
+        std::vector<std::size_t> matches;
+        ScanResults results;
+        results.all = &matches;
+        Scan(data, size, pattern, results);
+        return matches;
+    }
+
+    std::size_t PatternSet::Add(const BytePattern& pattern) {
+        const uint32_t index = static_cast<uint32_t>(m_patterns.size());
+        m_patterns.push_back(pattern);
+        m_maxPatternSize = std::max(m_maxPatternSize, pattern.Size());
+
+        Entry entry;
+        entry.pattern = index;
+        entry.anchor = static_cast<uint32_t>(pattern.anchor);
+        entry.distance = static_cast<std::ptrdiff_t>(pattern.secondAnchor) - static_cast<std::ptrdiff_t>(pattern.anchor);
+        entry.first = pattern.bytes[pattern.anchor];
+        entry.second = pattern.bytes[pattern.secondAnchor];
+        const auto bucketEnd = std::upper_bound(m_entries.begin(), m_entries.end(), entry.first,
+            [](uint8_t first, const Entry& other) { return first < other.first; });
+        m_entries.insert(bucketEnd, entry);
+
+        m_firstBytes[entry.first] = true;
+        for (unsigned value = entry.first + 1; value <= 256; ++value) {
+            m_bucketStarts[value]++;
+        }
+        return index;
+    }
+
+    void PatternSet::CheckPosition(const uint8_t* data, std::size_t size, std::size_t position,
+                                   std::vector<std::vector<std::size_t>>& results) const {
+        const uint8_t first = data[position];
+        for (uint32_t i = m_bucketStarts[first]; i < m_bucketStarts[first + 1]; ++i) {
+            const Entry& entry = m_entries[i];
+            if (position < entry.anchor) {
+                continue;
+            }
+            const std::size_t start = position - entry.anchor;
+            const BytePattern& pattern = m_patterns[entry.pattern];
+            if (start + pattern.Size() <= size && data[position + entry.distance] == entry.second &&
+                pattern.MatchesAt(data + start)) {
+                results[entry.pattern].push_back(start);
+            }
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> PatternSet::FindAll(const uint8_t* data, std::size_t size) const {
+        std::vector<std::vector<std::size_t>> results(m_patterns.size());
+        if (m_patterns.empty()) {
+            return results;
+        }
+
+        std::size_t position = 0;
+        auto scanScalar = [&](std::size_t end) {
+            for (; position < end; ++position) {
+                if (m_firstBytes[data[position]]) {
+                    CheckPosition(data, size, position, results);
+                }
+            }
+        };
+#if KX_ARCH_X64
+        if (m_entries.size() <= MAX_SIMD_PATTERNS) {
+            uint8_t firsts[MAX_SIMD_PATTERNS];
+            uint8_t seconds[MAX_SIMD_PATTERNS];
+            std::ptrdiff_t distances[MAX_SIMD_PATTERNS];
+            std::ptrdiff_t minDistance = 0;
+            std::ptrdiff_t maxDistance = 0;
+            for (std::size_t k = 0; k < m_entries.size(); ++k) {
+                firsts[k] = m_entries[k].first;
+                seconds[k] = m_entries[k].second;
+                distances[k] = m_entries[k].distance;
+                minDistance = std::min(minDistance, distances[k]);
+                maxDistance = std::max(maxDistance, distances[k]);
+            }
+
+            // Second anchors may lie before or after the first, so the SIMD blocks start late
+            // enough and end early enough to keep every load inside the buffer.
+            const bool avx2 = Cpu::GetFeatures().avx2;
+            const std::size_t alignment = avx2 ? 32 : 16;
+            const std::size_t margin = static_cast<std::size_t>(maxDistance);
+            if (size > margin) {
+                const uintptr_t minimum = reinterpret_cast<uintptr_t>(data) + static_cast<std::size_t>(-minDistance);
+                const uintptr_t aligned = (minimum + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+                scanScalar(std::min(size, static_cast<std::size_t>(aligned - reinterpret_cast<uintptr_t>(data))));
+
+                auto onCandidates = [&](std::size_t blockStart, uint64_t candidates) {
+                    while (candidates != 0) {
+                        CheckPosition(data, size, blockStart + static_cast<std::size_t>(std::countr_zero(candidates)), results);
+                        candidates &= candidates - 1;
+                    }
+                };
+                if (avx2) {
+                    SweepAvx2(data, size - margin, firsts, seconds, distances, m_entries.size(), position, onCandidates);
+                } else {
+                    SweepSse2(data, size - margin, firsts, seconds, distances, m_entries.size(), position, onCandidates); // SSE2 is baseline on x64
+                }
+            }
+        }
+#endif
+        scanScalar(size);
+        return results;
+    }
+
+} // namespace kx::Scanning
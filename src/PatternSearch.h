@@ -0,0 +1,176 @@
+#pragma once
+
+/**
+ * @file PatternSearch.h
+ * @brief Portable, SIMD-accelerated search for IDA-style byte patterns in memory buffers.
+ * @details A pattern is compiled once into byte/mask arrays plus two anchor offsets: the
+ *          fixed bytes that are rarest in typical x64 code. The scan compares both anchors
+ *          against 32 (AVX2) or 16 (SSE2) positions at a time and only verifies the full
+ *          pattern where both match, so most of the image is rejected without a
+ *          per-byte loop. Nothing here depends on Windows, so the same code runs against
+ *          mapped files in offline tools and tests.
+ *
+ *          PatternSet finds any number of patterns in a single pass by comparing the anchor
+ *          pairs of all its patterns in one sweep.
+ *
+ *          Signatures known at build time are compiled by the compiler instead
+ *          (PatternLiteral.h) and only copied into a BytePattern at runtime.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kx::Scanning {
+
+    // How common each byte value is in x64 machine code, log-scaled to 0-255. Measured over
+    // ~13 MB of .text from compiled binaries, with 0xCC (MSVC's int3 padding) raised to
+    // the level of 0x89. Anchoring on rare bytes keeps the candidate rate low.
+    inline constexpr std::array<uint8_t, 256> BYTE_FREQUENCY = {
+        255, 213, 183, 179, 185, 181, 162, 168, 200, 159, 155, 151, 164, 164, 159, 225,
+        200, 173, 150, 150, 160, 156, 152, 151, 186, 140, 139, 140, 149, 142, 157, 194,
+        190, 141, 140, 138, 225, 158, 134, 136, 182, 174, 136, 155, 146, 143, 161, 146,
+        180, 187, 133, 139, 148, 160, 135, 137, 171, 196, 139, 157, 156, 165, 138, 147,
+        187, 202, 150, 174, 204, 184, 157, 163, 248, 204, 146, 146, 214, 181, 142, 144,
+        181, 142, 139, 169, 178, 174, 157, 156, 164, 137, 138, 167, 170, 174, 155, 154,
+        173, 133, 140, 155, 165, 142, 191, 138, 162, 136, 139, 145, 160, 147, 149, 162,
+        185, 137, 144, 154, 200, 182, 147, 148, 165, 139, 137, 157, 179, 160, 152, 161,
+        182, 162, 144, 206, 209, 212, 145, 154, 170, 232, 135, 227, 150, 211, 143, 143,
+        178, 133, 135, 142, 158, 158, 135, 136, 155, 135, 131, 134, 149, 146, 132, 134,
+        163, 136, 133, 138, 145, 143, 137, 134, 156, 135, 142, 144, 150, 140, 133, 141,
+        161, 135, 134, 140, 153, 152, 166, 145, 169, 150, 168, 148, 168, 168, 171, 162,
+        201, 174, 167, 188, 171, 172, 178, 195, 165, 161, 149, 140, 232, 143, 146, 145,
+        171, 148, 172, 147, 142, 146, 147, 150, 163, 143, 151, 160, 143, 149, 158, 180,
+        175, 156, 153, 144, 154, 147, 158, 167, 217, 202, 159, 179, 166, 166, 166, 181,
+        172, 152, 162, 169, 151, 156, 176, 173, 180, 164, 175, 173, 173, 181, 190, 242,
+    };
+
+    struct PatternAnchors {
+        std::size_t anchor = 0;
+        std::size_t secondAnchor = 0;
+    };
+
+    /**
+     * @brief Picks the two rarest fixed bytes (mask 0xFF) of a pattern, preferring two different
+     *        values. The pattern must have a fixed byte. constexpr so pattern literals
+     *        (PatternLiteral.h) choose their anchors at compile time, the same way.
+     */
+    constexpr PatternAnchors ChooseAnchors(const uint8_t* bytes, const uint8_t* mask, std::size_t size) {
+        PatternAnchors anchors;
+        bool hasFixed = false;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (mask[i] && (!hasFixed || BYTE_FREQUENCY[bytes[i]] < BYTE_FREQUENCY[bytes[anchors.anchor]])) {
+                anchors.anchor = i;
+                hasFixed = true;
+            }
+        }
+        anchors.secondAnchor = anchors.anchor;
+        auto rank = [&](std::size_t i) {
+            const bool sameValue = bytes[i] == bytes[anchors.anchor];
+            return (sameValue ? 256 : 0) + BYTE_FREQUENCY[bytes[i]];
+        };
+        for (std::size_t i = 0; i < size; ++i) {
+            if (mask[i] && i != anchors.anchor &&
+                (anchors.secondAnchor == anchors.anchor || rank(i) < rank(anchors.secondAnchor))) {
+                anchors.secondAnchor = i;
+            }
+        }
+        return anchors;
+    }
+
+    struct BytePattern {
+        std::vector<uint8_t> bytes; // Expected bytes; 0 at wildcard positions
+        std::vector<uint8_t> mask;  // 0xFF for fixed bytes, 0x00 for wildcards
+        std::size_t anchor = 0;     // Offset of the rarest fixed byte
+        std::size_t secondAnchor = 0; // Offset of the next rarest fixed byte (== anchor if only one)
+
+        std::size_t Size() const { return bytes.size(); }
+
+        /**
+         * @brief Compiles "48 8B ? ?? 05" style text. `?` and `??` are wildcards.
+         * @param error Receives a description if the text is invalid.
+         * @return The pattern, or std::nullopt if the text is invalid or has no fixed byte.
+         */
+        static std::optional<BytePattern> Parse(std::string_view text, std::string* error = nullptr);
+
+        /**
+         * @brief Builds a pattern from expected bytes and a mask (non-zero: fixed byte).
+         * @return The pattern, or std::nullopt if the lengths differ or no byte is fixed.
+         */
+        static std::optional<BytePattern> Create(std::vector<uint8_t> bytes, std::vector<uint8_t> mask, std::string* error = nullptr);
+
+        /**
+         * @brief True if the pattern matches at `data` (which must hold Size() bytes).
+         */
+        bool MatchesAt(const uint8_t* data) const;
+
+        // "48 8B ? 05" style text, for logging.
+        std::string ToString() const;
+    };
+
+    /**
+     * @brief Offset of the first match of `pattern` in [data, data + size), or std::nullopt.
+     * @details Uses AVX2 or SSE2 when the CPU has them (CpuFeatures.h), scalar code otherwise.
+     */
+    std::optional<std::size_t> FindFirst(const uint8_t* data, std::size_t size, const BytePattern& pattern);
+
+    /**
+     * @brief Offsets of all matches of `pattern` in [data, data + size), in ascending order.
+     */
+    std::vector<std::size_t> FindAll(const uint8_t* data, std::size_t size, const BytePattern& pattern);
+
+    /**
+     * @brief A group of patterns located together in one pass over memory.
+     * @details Patterns are filed in a 256-bucket table under their first anchor byte. The
+     *          sweep compares every pattern's anchor pair (the same two rare bytes FindFirst
+     *          uses) against 64 (AVX2) or 32 (SSE2) positions at a time, and only positions
+     *          where some pair matches are looked up in the table and verified. Sets with
+     *          more than MAX_SIMD_PATTERNS patterns use a per-byte table lookup instead, still
+     *          in a single pass.
+     */
+    class PatternSet {
+    public:
+        // Patterns whose anchors the SIMD sweep compares; larger sets use the scalar sweep.
+        static constexpr std::size_t MAX_SIMD_PATTERNS = 8;
+
+        /**
+         * @brief Adds a pattern and returns its index in the FindAll() results.
+         */
+        std::size_t Add(const BytePattern& pattern);
+
+        std::size_t Size() const { return m_patterns.size(); }
+        std::size_t GetMaxPatternSize() const { return m_maxPatternSize; }
+        const BytePattern& operator[](std::size_t index) const { return m_patterns[index]; }
+
+        /**
+         * @brief All matches of every pattern in [data, data + size), in one pass.
+         * @return One vector of ascending offsets per pattern, in Add() order. A pattern with
+         *         more than one match is ambiguous as a signature.
+         */
+        std::vector<std::vector<std::size_t>> FindAll(const uint8_t* data, std::size_t size) const;
+
+    private:
+        // Anchors of one pattern. Sweep positions are those of the first anchor byte.
+        struct Entry {
+            uint32_t pattern;
+            uint32_t anchor;          // Offset of the first anchor in the pattern
+            std::ptrdiff_t distance;  // Second anchor offset minus first anchor offset
+            uint8_t first;
+            uint8_t second;
+        };
+
+        void CheckPosition(const uint8_t* data, std::size_t size, std::size_t position,
+                           std::vector<std::vector<std::size_t>>& results) const;
+
+        std::vector<BytePattern> m_patterns;
+        std::vector<Entry> m_entries;              // Sorted by first anchor byte
+        std::array<uint32_t, 257> m_bucketStarts{}; // m_entries range of each first anchor byte
+        std::array<bool, 256> m_firstBytes{};
+        std::size_t m_maxPatternSize = 0;
+    };
+
+} // namespace kx::Scanning
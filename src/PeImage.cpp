@@ -0,0 +1,189 @@
+#include "PeImage.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace kx::Scanning {
+
+    namespace {
+        // Constants from the PE/COFF specification (winnt.h is not available everywhere).
+        constexpr uint16_t DOS_SIGNATURE = 0x5A4D;       // "MZ"
+        constexpr uint32_t NT_SIGNATURE = 0x00004550;    // "PE\0\0"
+        constexpr uint16_t OPTIONAL_MAGIC_PE32 = 0x10B;
+        constexpr uint16_t OPTIONAL_MAGIC_PE32_PLUS = 0x20B;
+        constexpr std::size_t FILE_HEADER_SIZE = 20;
+        constexpr std::size_t SECTION_HEADER_SIZE = 40;
+        constexpr uint32_t RESOURCE_DIRECTORY = 2;
+
+        constexpr uint32_t SCN_CNT_CODE = 0x00000020;
+        constexpr uint32_t SCN_CNT_INITIALIZED_DATA = 0x00000040;
+        constexpr uint32_t SCN_MEM_DISCARDABLE = 0x02000000;
+        constexpr uint32_t SCN_MEM_EXECUTE = 0x20000000;
+        constexpr uint32_t SCN_MEM_READ = 0x40000000;
+        constexpr uint32_t SCN_MEM_WRITE = 0x80000000;
+
+        // Little-endian field reads that fail instead of reading past the buffer.
+        class Reader {
+        public:
+            Reader(const uint8_t* data, std::size_t size) : m_data(data), m_size(size) {}
+
+            template <typename T>
+            bool Read(std::size_t offset, T& value) const {
+                if (offset > m_size || m_size - offset < sizeof(T)) {
+                    return false;
+                }
+                std::memcpy(&value, m_data + offset, sizeof(T));
+                return true;
+            }
+
+        private:
+            const uint8_t* m_data;
+            std::size_t m_size;
+        };
+
+        std::optional<PeImage> Fail(std::string* error, const char* message) {
+            if (error) {
+                *error = message;
+            }
+            return std::nullopt;
+        }
+    }
+
+    bool PeSection::IsExecutable() const {
+        return (characteristics & (SCN_MEM_EXECUTE | SCN_CNT_CODE)) != 0;
+    }
+
+    bool PeSection::IsReadOnlyData() const {
+        return (characteristics & SCN_CNT_INITIALIZED_DATA) != 0 && (characteristics & SCN_MEM_READ) != 0 &&
+               (characteristics & (SCN_MEM_WRITE | SCN_MEM_EXECUTE | SCN_MEM_DISCARDABLE)) == 0;
+    }
+
+    std::optional<PeImage> PeImage::Parse(const uint8_t* data, std::size_t size, PeLayout layout, std::string* error) {
+        const Reader reader(data, size);
+        uint16_t dosSignature = 0;
+        uint32_t ntOffset = 0;
+        if (!reader.Read(0, dosSignature) || dosSignature != DOS_SIGNATURE || !reader.Read(0x3C, ntOffset)) {
+            return Fail(error, "missing DOS header");
+        }
+        uint32_t ntSignature = 0;
+        if (!reader.Read(ntOffset, ntSignature) || ntSignature != NT_SIGNATURE) {
+            return Fail(error, "missing PE signature");
+        }
+
+        PeImage image;
+        image.m_layout = layout;
+        image.m_bufferSize = size;
+        const std::size_t fileHeader = static_cast<std::size_t>(ntOffset) + 4;
+        uint16_t sectionCount = 0;
+        uint16_t optionalHeaderSize = 0;
+        if (!reader.Read(fileHeader, image.m_machine) || !reader.Read(fileHeader + 2, sectionCount) ||
+            !reader.Read(fileHeader + 4, image.m_timestamp) || !reader.Read(fileHeader + 16, optionalHeaderSize)) {
+            return Fail(error, "truncated file header");
+        }
+
+        const std::size_t optionalHeader = fileHeader + FILE_HEADER_SIZE;
+        uint16_t magic = 0;
+        if (!reader.Read(optionalHeader, magic) || (magic != OPTIONAL_MAGIC_PE32 && magic != OPTIONAL_MAGIC_PE32_PLUS)) {
+            return Fail(error, "unknown optional header");
+        }
+        image.m_is64Bit = magic == OPTIONAL_MAGIC_PE32_PLUS;
+        bool headerOk = reader.Read(optionalHeader + 56, image.m_sizeOfImage) &&
+                        reader.Read(optionalHeader + 60, image.m_sizeOfHeaders) &&
+                        reader.Read(optionalHeader + 64, image.m_checksum);
+        uint32_t directoryCount = 0;
+        std::size_t directories = 0;
+        if (image.m_is64Bit) {
+            headerOk = headerOk && reader.Read(optionalHeader + 24, image.m_imageBase) && reader.Read(optionalHeader + 108, directoryCount);
+            directories = optionalHeader + 112;
+        } else {
+            uint32_t imageBase = 0;
+            headerOk = headerOk && reader.Read(optionalHeader + 28, imageBase) && reader.Read(optionalHeader + 92, directoryCount);
+            image.m_imageBase = imageBase;
+            directories = optionalHeader + 96;
+        }
+        if (!headerOk) {
+            return Fail(error, "truncated optional header");
+        }
+        if (directoryCount > RESOURCE_DIRECTORY) {
+            reader.Read(directories + RESOURCE_DIRECTORY * 8, image.m_resourceRva);
+        }
+
+        const std::size_t sectionTable = optionalHeader + optionalHeaderSize;
+        for (uint16_t i = 0; i < sectionCount; ++i) {
+            const std::size_t header = sectionTable + static_cast<std::size_t>(i) * SECTION_HEADER_SIZE;
+            std::array<char, 8> name{};
+            PeSection section;
+            if (!reader.Read(header, name) ||
+                !reader.Read(header + 8, section.virtualSize) || !reader.Read(header + 12, section.rva) ||
+                !reader.Read(header + 16, section.rawSize) || !reader.Read(header + 20, section.rawOffset) ||
+                !reader.Read(header + 36, section.characteristics)) {
+                return Fail(error, "truncated section table");
+            }
+            section.name.assign(name.data(), std::find(name.begin(), name.end(), '\0') - name.begin()); // Not terminated if 8 chars long
+            image.m_sections.push_back(std::move(section));
+        }
+        return image;
+    }
+
+    const PeSection* PeImage::FindSection(const std::string& name) const {
+        const auto it = std::find_if(m_sections.begin(), m_sections.end(), [&name](const PeSection& section) { return section.name == name; });
+        return it != m_sections.end() ? &*it : nullptr;
+    }
+
+    PeRange PeImage::GetRange(const PeSection& section) const {
+        // A mapped section spans its virtual size (the loader zero-fills past the raw data);
+        // on disk only the raw data exists, and its tail may be file alignment padding.
+        PeRange range;
+        range.rva = section.rva;
+        if (m_layout == PeLayout::Mapped) {
+            range.offset = section.rva;
+            range.size = section.virtualSize != 0 ? section.virtualSize : section.rawSize;
+        } else {
+            range.offset = section.rawOffset;
+            range.size = section.virtualSize != 0 ? std::min(section.rawSize, section.virtualSize) : section.rawSize;
+        }
+        if (range.offset >= m_bufferSize) {
+            range.size = 0;
+        } else {
+            range.size = std::min(range.size, m_bufferSize - range.offset);
+        }
+        return range;
+    }
+
+    std::vector<PeRange> PeImage::GetRanges(ScanTarget target) const {
+        std::vector<PeRange> ranges;
+        for (const PeSection& section : m_sections) {
+            bool selected = false;
+            if (target == ScanTarget::Code) {
+                selected = section.IsExecutable();
+            } else {
+                const bool holdsResources = m_resourceRva != 0 && m_resourceRva >= section.rva &&
+                                            m_resourceRva - section.rva < std::max(section.virtualSize, section.rawSize);
+                selected = section.IsReadOnlyData() && !holdsResources;
+            }
+            if (!selected) {
+                continue;
+            }
+            const PeRange range = GetRange(section);
+            if (range.size != 0) {
+                ranges.push_back(range);
+            }
+        }
+        return ranges;
+    }
+
+    std::optional<std::size_t> PeImage::RvaToOffset(uint32_t rva) const {
+        if (rva < m_sizeOfHeaders) {
+            return rva < m_bufferSize ? std::optional<std::size_t>(rva) : std::nullopt; // Headers are at the same offset in both layouts
+        }
+        for (const PeSection& section : m_sections) {
+            const PeRange range = GetRange(section);
+            if (rva >= range.rva && rva - range.rva < range.size) {
+                return range.offset + (rva - range.rva);
+            }
+        }
+        return std::nullopt;
+    }
+
+} // namespace kx::Scanning
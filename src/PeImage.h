@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * @file PeImage.h
+ * @brief Portable reader for the headers and section table of a PE (Windows executable) image.
+ * @details Works on a buffer holding either a module as the loader mapped it (sections at
+ *          their RVAs) or the file as stored on disk (sections at their raw offsets), and
+ *          does not include windows.h, so offline tools can parse a game binary anywhere.
+ *          Every read is bounds-checked; malformed headers make Parse() fail rather than
+ *          read outside the buffer.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kx::Scanning {
+
+    enum class PeLayout {
+        Mapped, // Loaded module: buffer offset == RVA
+        File    // File on disk: sections at PointerToRawData
+    };
+
+    // Which sections a signature is searched in.
+    enum class ScanTarget {
+        Code,        // Executable sections (.text)
+        ReadOnlyData // Read-only initialized data (.rdata), without resources
+    };
+
+    struct PeSection {
+        std::string name;
+        uint32_t rva = 0;
+        uint32_t virtualSize = 0;
+        uint32_t rawOffset = 0;
+        uint32_t rawSize = 0;
+        uint32_t characteristics = 0;
+
+        bool IsExecutable() const;
+        bool IsReadOnlyData() const;
+    };
+
+    // A section's bytes within the parsed buffer.
+    struct PeRange {
+        std::size_t offset = 0; // Buffer offset
+        std::size_t size = 0;
+        uint32_t rva = 0;       // RVA of the byte at `offset`
+    };
+
+    class PeImage {
+    public:
+        /**
+         * @brief Parses the headers of the image in [data, data + size).
+         * @param error Receives a description if the image is not a valid PE.
+         */
+        static std::optional<PeImage> Parse(const uint8_t* data, std::size_t size, PeLayout layout, std::string* error = nullptr);
+
+        const std::vector<PeSection>& GetSections() const { return m_sections; }
+        const PeSection* FindSection(const std::string& name) const;
+
+        PeLayout GetLayout() const { return m_layout; }
+        bool Is64Bit() const { return m_is64Bit; }
+        uint16_t GetMachine() const { return m_machine; }
+        uint32_t GetTimestamp() const { return m_timestamp; }
+        uint32_t GetChecksum() const { return m_checksum; }
+        uint32_t GetSizeOfImage() const { return m_sizeOfImage; }
+        uint32_t GetSizeOfHeaders() const { return m_sizeOfHeaders; }
+        uint64_t GetImageBase() const { return m_imageBase; }
+
+        /**
+         * @brief Buffer ranges of the sections a signature with `target` is searched in.
+         */
+        std::vector<PeRange> GetRanges(ScanTarget target) const;
+
+        /**
+         * @brief Buffer offset of the byte at `rva`, if it is stored in the buffer.
+         */
+        std::optional<std::size_t> RvaToOffset(uint32_t rva) const;
+
+    private:
+        PeRange GetRange(const PeSection& section) const;
+
+        std::vector<PeSection> m_sections;
+        PeLayout m_layout = PeLayout::Mapped;
+        std::size_t m_bufferSize = 0;
+        bool m_is64Bit = false;
+        uint16_t m_machine = 0;
+        uint32_t m_timestamp = 0;
+        uint32_t m_checksum = 0;
+        uint32_t m_sizeOfImage = 0;
+        uint32_t m_sizeOfHeaders = 0;
+        uint64_t m_imageBase = 0;
+        uint32_t m_resourceRva = 0; // Resource directory; its section is not scanned as data
+    };
+
+} // namespace kx::Scanning
@@ -0,0 +1,62 @@
+#include "RowTextCache.h"
+#include "AppState.h"
+#include "HexFormatter.h"
+#include "TimestampFormatter.h"
+
+#include <algorithm>
+
+namespace kx::Utils {
+
+    RowTextCache::RowTextCache(std::size_t capacity)
+        : m_capacity(std::max<std::size_t>(1, capacity)) {
+        m_index.reserve(m_capacity);
+    }
+
+    const RowText& RowTextCache::Get(const PacketInfo& packet) {
+        auto it = m_index.find(packet.id);
+        if (it != m_index.end()) {
+            m_hits++;
+            m_entries.splice(m_entries.begin(), m_entries, it->second); // Mark as most recently used
+            return it->second->text;
+        }
+
+        m_misses++;
+        if (m_index.size() >= m_capacity) {
+            // Recycle the least recently used entry's list node.
+            m_index.erase(m_entries.back().packetId);
+            m_entries.splice(m_entries.begin(), m_entries, std::prev(m_entries.end()));
+        } else {
+            m_entries.emplace_front();
+        }
+
+        Entry& entry = m_entries.front();
+        entry.packetId = packet.id;
+        // Recycled entries keep their string capacity.
+        entry.text.timestamp.clear();
+        AppendTimestamp(entry.text.timestamp, packet.timestamp, g_timestampFormat);
+        entry.text.hexPreview.clear();
+        if (packet.data.empty()) {
+            entry.text.hexPreview = "(empty)";
+        } else {
+            HexFormatOptions hexOptions;
+            hexOptions.maxBytes = m_hexByteLimit > 0 ? static_cast<std::size_t>(m_hexByteLimit) : 0;
+            AppendHex(entry.text.hexPreview, packet.data.data(), packet.data.size(), hexOptions);
+        }
+        m_index.emplace(packet.id, m_entries.begin());
+        return entry.text;
+    }
+
+    void RowTextCache::Validate(uint64_t settingsVersion, int hexByteLimit) {
+        if (settingsVersion != m_settingsVersion || hexByteLimit != m_hexByteLimit) {
+            Clear();
+            m_settingsVersion = settingsVersion;
+            m_hexByteLimit = hexByteLimit;
+        }
+    }
+
+    void RowTextCache::Clear() {
+        m_entries.clear();
+        m_index.clear();
+    }
+
+} // namespace kx::Utils
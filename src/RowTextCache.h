@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * @file RowTextCache.h
+ * @brief Bounded LRU cache of formatted packet table cells, keyed by packet id.
+ * @details Formatting the timestamp and hex preview of a row is far more expensive than
+ *          drawing them, and both only change with the display settings. The packet table
+ *          formats them on a row's first display and afterwards draws the cached text;
+ *          the cheap cells (opcode, name, size) are drawn straight from the packet.
+ *          Render thread only.
+ */
+
+#include "PacketData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace kx::Utils {
+
+    struct RowText {
+        std::string timestamp;
+        std::string hexPreview; // Truncated to the hex byte limit, "(empty)" for no payload
+    };
+
+    class RowTextCache {
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 16384;
+
+        explicit RowTextCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+        /**
+         * @brief The cell text for a packet, formatted with the current display settings on a miss.
+         * @return Reference valid until the next call to Get() or Clear().
+         */
+        const RowText& Get(const PacketInfo& packet);
+
+        /**
+         * @brief Drops every entry if `settingsVersion` or `hexByteLimit` differs from what the entries were built with.
+         * @param hexByteLimit Hex bytes per row; below the configured limit when the overlay is over its frame budget.
+         */
+        void Validate(uint64_t settingsVersion, int hexByteLimit);
+
+        /**
+         * @brief Drops every entry, e.g. after packet names were rewritten.
+         */
+        void Clear();
+
+        std::size_t GetSize() const { return m_index.size(); }
+        uint64_t GetHitCount() const { return m_hits; }
+        uint64_t GetMissCount() const { return m_misses; }
+
+    private:
+        struct Entry {
+            uint64_t packetId = 0;
+            RowText text;
+        };
+
+        std::size_t m_capacity;
+        std::list<Entry> m_entries; // Most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+        uint64_t m_settingsVersion = 0;
+        int m_hexByteLimit = 0;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+    };
+
+} // namespace kx::Utils
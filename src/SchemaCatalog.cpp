@@ -0,0 +1,515 @@
+#include "SchemaCatalog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace kx::Schema {
+
+    namespace {
+        constexpr char CATALOG_MAGIC[4] = { 'K', 'X', 'S', 'C' };
+        constexpr uint16_t CATALOG_FORMAT_VERSION = 1;
+        constexpr std::size_t HEADER_SIZE = 20;
+        constexpr std::size_t MESSAGE_ENTRY_SIZE = 16;
+        constexpr std::size_t FIELD_ENTRY_SIZE = 24;
+        constexpr std::size_t MAX_CATALOG_FILE_SIZE = 64 * 1024 * 1024;
+        constexpr auto WATCH_INTERVAL = std::chrono::seconds(1);
+
+        // --- Little-endian helpers ---
+        uint16_t ReadU16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+        uint32_t ReadU32(const uint8_t* p) {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+        void WriteU16(std::vector<uint8_t>& out, uint16_t v) {
+            out.push_back(static_cast<uint8_t>(v));
+            out.push_back(static_cast<uint8_t>(v >> 8));
+        }
+        void WriteU32(std::vector<uint8_t>& out, uint32_t v) {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+            }
+        }
+
+        bool ReadString(const uint8_t* table, std::size_t tableSize, uint32_t offset, std::string& out) {
+            if (offset == NO_NAME) {
+                out.clear();
+                return true;
+            }
+            if (offset >= tableSize) {
+                return false;
+            }
+            const void* end = std::memchr(table + offset, 0, tableSize - offset);
+            if (!end) {
+                return false;
+            }
+            out.assign(reinterpret_cast<const char*>(table + offset), static_cast<const uint8_t*>(end) - (table + offset));
+            return true;
+        }
+
+        // --- Publication state ---
+        // Readers hold a reference for as long as they use a catalogue, so a replaced one
+        // is freed by whichever thread drops the last reference, never while being read.
+        std::atomic<std::shared_ptr<const Catalog>> g_activeCatalog;
+        std::atomic<uint64_t> g_catalogVersion{ 0 };
+        std::atomic<uint64_t> g_namesVersion{ 0 };
+        std::mutex g_publishMutex;    // Serialises publishers
+        Catalog g_curatedCatalog;     // Guarded by g_publishMutex
+        Catalog g_harvestedCatalog;   // Guarded by g_publishMutex
+
+        // True if both catalogues name the same messages the same way (a null one names none).
+        bool HaveSameNames(const Catalog* previous, const Catalog& next) {
+            std::size_t namedCount = 0;
+            for (const MessageSchema& message : next.messages) {
+                if (message.name.empty()) {
+                    continue;
+                }
+                ++namedCount;
+                const MessageSchema* old = previous ? previous->Find(message.direction, message.opcode) : nullptr;
+                if (!old || old->name != message.name) {
+                    return false;
+                }
+            }
+            const std::size_t previousNamedCount = previous ? static_cast<std::size_t>(std::count_if(
+                previous->messages.begin(), previous->messages.end(),
+                [](const MessageSchema& message) { return !message.name.empty(); })) : 0;
+            return namedCount == previousNamedCount;
+        }
+
+        // Builds the merged catalogue and swaps it in. Caller holds g_publishMutex.
+        void PublishMergedLocked() {
+            auto merged = std::make_shared<Catalog>(MergeCatalogs(g_curatedCatalog, g_harvestedCatalog));
+            merged->source = g_curatedCatalog.source;
+            merged->version = g_catalogVersion.load(std::memory_order_relaxed) + 1;
+            const bool namesChanged = !HaveSameNames(g_activeCatalog.load(std::memory_order_acquire).get(), *merged);
+
+            const uint64_t version = merged->version;
+            g_activeCatalog.store(std::move(merged), std::memory_order_release);
+            g_catalogVersion.store(version, std::memory_order_release);
+            if (namesChanged) {
+                g_namesVersion.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        // Appends a copy of src's fields [first, first + count) and their sub-schemas to dst.
+        // Children are placed after their parent, as the file format requires.
+        uint32_t CopyFields(const Catalog& src, uint32_t first, uint32_t count, Catalog& dst) {
+            const uint32_t dstFirst = static_cast<uint32_t>(dst.fields.size());
+            dst.fields.insert(dst.fields.end(), src.fields.begin() + first, src.fields.begin() + first + count);
+            for (uint32_t i = 0; i < count; ++i) {
+                const FieldDef& field = src.fields[first + i];
+                if (field.childCount > 0) {
+                    const uint32_t childFirst = CopyFields(src, field.childFirst, field.childCount, dst);
+                    dst.fields[dstFirst + i].childFirst = childFirst;
+                }
+            }
+            return dstFirst;
+        }
+
+        // --- Watcher state ---
+        std::mutex g_statusMutex;
+        std::string g_catalogPath;
+        std::string g_lastError;
+
+        std::thread g_watcherThread;
+        std::mutex g_watcherMutex;
+        std::condition_variable g_watcherWake;
+        bool g_watcherStop = false;
+
+        void SetLastError(const std::string& error) {
+            std::lock_guard<std::mutex> lock(g_statusMutex);
+            if (error != g_lastError && !error.empty()) {
+                std::cerr << "[SchemaCatalog] " << error << std::endl;
+            }
+            g_lastError = error;
+        }
+
+        bool TryLoadAndPublish(const std::filesystem::path& path) {
+            std::string error;
+            std::optional<Catalog> catalog = LoadCatalogFile(path, error);
+            if (!catalog) {
+                SetLastError(error);
+                return false;
+            }
+            const std::size_t messageCount = catalog->messages.size();
+            PublishCuratedCatalog(std::move(*catalog));
+            SetLastError({});
+            std::cout << "[SchemaCatalog] Loaded " << messageCount << " message schemas from "
+                      << path.string() << " (version " << GetCatalogVersion() << ")." << std::endl;
+            return true;
+        }
+
+        struct FileStamp {
+            std::filesystem::file_time_type time{};
+            std::uintmax_t size = 0;
+            bool operator==(const FileStamp&) const = default;
+        };
+
+        std::optional<FileStamp> GetFileStamp(const std::filesystem::path& path) {
+            std::error_code ec;
+            FileStamp stamp;
+            stamp.time = std::filesystem::last_write_time(path, ec);
+            if (ec) {
+                return std::nullopt;
+            }
+            stamp.size = std::filesystem::file_size(path, ec);
+            if (ec) {
+                return std::nullopt;
+            }
+            return stamp;
+        }
+
+        // Polls the file's timestamp and size. A failed load is retried on the next poll,
+        // which also covers reading a file that was still being written.
+        void WatcherLoop(std::filesystem::path path, std::optional<FileStamp> loaded) {
+            std::unique_lock<std::mutex> lock(g_watcherMutex);
+            while (!g_watcherWake.wait_for(lock, WATCH_INTERVAL, [] { return g_watcherStop; })) {
+                lock.unlock();
+                const std::optional<FileStamp> current = GetFileStamp(path);
+                if (current && current != loaded && TryLoadAndPublish(path)) {
+                    loaded = current;
+                }
+                lock.lock();
+            }
+        }
+    }
+
+    std::string_view GetFieldTypeName(FieldType type) {
+        switch (type) {
+            case FieldType::Short:
+            case FieldType::ShortAlt:          return "short";
+            case FieldType::Byte:              return "byte";
+            case FieldType::CompressedInt:     return "compressed_int";
+            case FieldType::Int64:
+            case FieldType::Int64Alt:          return "long long";
+            case FieldType::Float:
+            case FieldType::Int32:
+            case FieldType::Int32Alt:          return "float";
+            case FieldType::Float2:            return "float[2]";
+            case FieldType::Float3:            return "float[3]";
+            case FieldType::Float4:
+            case FieldType::Float4Alt:         return "float[4]";
+            case FieldType::Vec3CompressedInt: return "special_vec3_and_compressed_int";
+            case FieldType::Guid:              return "guid";
+            case FieldType::WString:           return "string";
+            case FieldType::String:            return "string_utf8";
+            case FieldType::Optional:          return "Optional Block";
+            case FieldType::FixedArray:        return "Fixed Array";
+            case FieldType::VarArrayByte:      return "Variable Array (byte count)";
+            case FieldType::VarArrayShort:     return "Variable Array (short count)";
+            case FieldType::FixedBuffer:       return "Fixed Buffer";
+            case FieldType::VarBufferByte:     return "Variable Buffer (byte count)";
+            case FieldType::VarBufferShort:    return "Variable Buffer (short count)";
+            case FieldType::ServerAlign:       return "MP_SRV_ALIGN";
+            case FieldType::Terminator:        return "terminator";
+        }
+        return "unknown";
+    }
+
+    const MessageSchema* Catalog::Find(PacketDirection direction, uint16_t opcode) const {
+        auto it = m_index.find(MakeKey(direction, opcode));
+        return it != m_index.end() ? &messages[it->second] : nullptr;
+    }
+
+    void Catalog::RebuildIndex() {
+        m_index.clear();
+        m_index.reserve(messages.size());
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            m_index[MakeKey(messages[i].direction, messages[i].opcode)] = i; // Later entries win
+        }
+    }
+
+    std::optional<Catalog> ParseCatalog(const uint8_t* data, std::size_t size, std::string& error) {
+        if (size < HEADER_SIZE || std::memcmp(data, CATALOG_MAGIC, sizeof(CATALOG_MAGIC)) != 0) {
+            error = "Not a schema catalogue (bad magic).";
+            return std::nullopt;
+        }
+        const uint16_t formatVersion = ReadU16(data + 4);
+        if (formatVersion != CATALOG_FORMAT_VERSION) {
+            error = "Unsupported schema catalogue version " + std::to_string(formatVersion) + ".";
+            return std::nullopt;
+        }
+
+        const uint64_t messageCount = ReadU32(data + 8);
+        const uint64_t fieldCount = ReadU32(data + 12);
+        const uint64_t stringTableSize = ReadU32(data + 16);
+        const uint64_t expectedSize = HEADER_SIZE + messageCount * MESSAGE_ENTRY_SIZE +
+                                      fieldCount * FIELD_ENTRY_SIZE + stringTableSize;
+        if (expectedSize != size) {
+            error = "Schema catalogue size mismatch (header describes " + std::to_string(expectedSize) +
+                    " bytes, file has " + std::to_string(size) + ").";
+            return std::nullopt;
+        }
+
+        const uint8_t* messageTable = data + HEADER_SIZE;
+        const uint8_t* fieldTable = messageTable + messageCount * MESSAGE_ENTRY_SIZE;
+        const uint8_t* stringTable = fieldTable + fieldCount * FIELD_ENTRY_SIZE;
+        auto inFieldRange = [fieldCount](uint64_t first, uint64_t count) { return first + count <= fieldCount; };
+
+        Catalog catalog;
+        catalog.fields.resize(static_cast<std::size_t>(fieldCount));
+        for (std::size_t i = 0; i < catalog.fields.size(); ++i) {
+            const uint8_t* entry = fieldTable + i * FIELD_ENTRY_SIZE;
+            FieldDef& field = catalog.fields[i];
+            if (entry[0] == 0 || entry[0] > MAX_FIELD_TYPE || entry[0] == static_cast<uint8_t>(FieldType::Terminator)) {
+                error = "Field " + std::to_string(i) + " has invalid typecode.";
+                return std::nullopt;
+            }
+            field.type = static_cast<FieldType>(entry[0]);
+            field.count = ReadU32(entry + 4);
+            field.elementSize = ReadU32(entry + 8);
+            field.childFirst = ReadU32(entry + 16);
+            field.childCount = ReadU32(entry + 20);
+            if (!ReadString(stringTable, stringTableSize, ReadU32(entry + 12), field.name)) {
+                error = "Field " + std::to_string(i) + " has an invalid name offset.";
+                return std::nullopt;
+            }
+            if (field.childCount > 0 && (field.childFirst <= i || !inFieldRange(field.childFirst, field.childCount))) {
+                error = "Field " + std::to_string(i) + " has an invalid sub-schema range.";
+                return std::nullopt;
+            }
+        }
+
+        catalog.messages.resize(static_cast<std::size_t>(messageCount));
+        for (std::size_t i = 0; i < catalog.messages.size(); ++i) {
+            const uint8_t* entry = messageTable + i * MESSAGE_ENTRY_SIZE;
+            MessageSchema& message = catalog.messages[i];
+            if (entry[0] > 1) {
+                error = "Message " + std::to_string(i) + " has an invalid direction.";
+                return std::nullopt;
+            }
+            message.direction = entry[0] == 0 ? PacketDirection::Sent : PacketDirection::Received;
+            message.opcode = ReadU16(entry + 2);
+            message.firstField = ReadU32(entry + 8);
+            message.fieldCount = ReadU32(entry + 12);
+            if (!ReadString(stringTable, stringTableSize, ReadU32(entry + 4), message.name)) {
+                error = "Message " + std::to_string(i) + " has an invalid name offset.";
+                return std::nullopt;
+            }
+            if (!inFieldRange(message.firstField, message.fieldCount)) {
+                error = "Message " + std::to_string(i) + " has an invalid field range.";
+                return std::nullopt;
+            }
+        }
+
+        catalog.RebuildIndex();
+        return catalog;
+    }
+
+    std::vector<uint8_t> SerializeCatalog(const Catalog& catalog) {
+        // Deduplicated string table
+        std::vector<uint8_t> strings;
+        std::unordered_map<std::string, uint32_t> stringOffsets;
+        auto addString = [&](const std::string& s) -> uint32_t {
+            if (s.empty()) {
+                return NO_NAME;
+            }
+            auto [it, inserted] = stringOffsets.try_emplace(s, static_cast<uint32_t>(strings.size()));
+            if (inserted) {
+                strings.insert(strings.end(), s.begin(), s.end());
+                strings.push_back(0);
+            }
+            return it->second;
+        };
+
+        std::vector<uint8_t> out;
+        out.reserve(HEADER_SIZE + catalog.messages.size() * MESSAGE_ENTRY_SIZE + catalog.fields.size() * FIELD_ENTRY_SIZE);
+        out.resize(sizeof(CATALOG_MAGIC));
+        std::memcpy(out.data(), CATALOG_MAGIC, sizeof(CATALOG_MAGIC));
+        WriteU16(out, CATALOG_FORMAT_VERSION);
+        WriteU16(out, 0);
+        WriteU32(out, static_cast<uint32_t>(catalog.messages.size()));
+        WriteU32(out, static_cast<uint32_t>(catalog.fields.size()));
+        const std::size_t stringSizePos = out.size();
+        WriteU32(out, 0); // Patched below
+
+        for (const MessageSchema& message : catalog.messages) {
+            out.push_back(message.direction == PacketDirection::Sent ? 0 : 1);
+            out.push_back(0);
+            WriteU16(out, message.opcode);
+            WriteU32(out, addString(message.name));
+            WriteU32(out, message.firstField);
+            WriteU32(out, message.fieldCount);
+        }
+        for (const FieldDef& field : catalog.fields) {
+            out.push_back(static_cast<uint8_t>(field.type));
+            out.push_back(0);
+            out.push_back(0);
+            out.push_back(0);
+            WriteU32(out, field.count);
+            WriteU32(out, field.elementSize);
+            WriteU32(out, addString(field.name));
+            WriteU32(out, field.childFirst);
+            WriteU32(out, field.childCount);
+        }
+
+        const uint32_t stringTableSize = static_cast<uint32_t>(strings.size());
+        for (int i = 0; i < 4; ++i) {
+            out[stringSizePos + i] = static_cast<uint8_t>(stringTableSize >> (8 * i));
+        }
+        out.insert(out.end(), strings.begin(), strings.end());
+        return out;
+    }
+
+    std::optional<Catalog> LoadCatalogFile(const std::filesystem::path& path, std::string& error) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            error = "Could not open " + path.string() + ".";
+            return std::nullopt;
+        }
+        const std::streamoff fileSize = file.tellg();
+        if (fileSize < 0 || static_cast<std::size_t>(fileSize) > MAX_CATALOG_FILE_SIZE) {
+            error = "Schema catalogue " + path.string() + " has an unreasonable size.";
+            return std::nullopt;
+        }
+        std::vector<uint8_t> bytes(static_cast<std::size_t>(fileSize));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(bytes.data()), fileSize)) {
+            error = "Could not read " + path.string() + ".";
+            return std::nullopt;
+        }
+
+        std::optional<Catalog> catalog = ParseCatalog(bytes.data(), bytes.size(), error);
+        if (!catalog) {
+            error = path.string() + ": " + error;
+            return std::nullopt;
+        }
+        catalog->source = path.string();
+        return catalog;
+    }
+
+    bool SaveCatalogFile(const Catalog& catalog, const std::filesystem::path& path, std::string& error) {
+        const std::vector<uint8_t> bytes = SerializeCatalog(catalog);
+
+        // Write to a temporary file and rename, so a watcher never sees a partial file.
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file || !file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+                error = "Could not write " + tempPath.string() + ".";
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            error = "Could not replace " + path.string() + ": " + ec.message();
+            return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<const Catalog> GetActiveCatalog() {
+        return g_activeCatalog.load(std::memory_order_acquire);
+    }
+
+    uint64_t GetCatalogVersion() {
+        return g_catalogVersion.load(std::memory_order_acquire);
+    }
+
+    uint64_t GetCatalogNamesVersion() {
+        return g_namesVersion.load(std::memory_order_acquire);
+    }
+
+    Catalog MergeCatalogs(const Catalog& base, const Catalog& supplement) {
+        Catalog merged = base;
+        merged.RebuildIndex();
+        for (const MessageSchema& message : supplement.messages) {
+            const MessageSchema* found = merged.Find(message.direction, message.opcode);
+            if (!found) {
+                MessageSchema copy = message;
+                copy.firstField = CopyFields(supplement, message.firstField, message.fieldCount, merged);
+                merged.messages.push_back(std::move(copy));
+                continue;
+            }
+
+            // Appends never move base messages, so the index built above stays valid.
+            MessageSchema* existing = &merged.messages[static_cast<std::size_t>(found - merged.messages.data())];
+            if (existing->fieldCount == 0 && message.fieldCount > 0) {
+                existing->firstField = CopyFields(supplement, message.firstField, message.fieldCount, merged);
+                existing->fieldCount = message.fieldCount;
+            }
+            if (existing->name.empty()) {
+                existing->name = message.name;
+            }
+        }
+        merged.RebuildIndex();
+        return merged;
+    }
+
+    void PublishCuratedCatalog(Catalog catalog) {
+        std::lock_guard<std::mutex> lock(g_publishMutex);
+        g_curatedCatalog = std::move(catalog);
+        PublishMergedLocked();
+    }
+
+    void PublishHarvestedCatalog(Catalog catalog) {
+        std::lock_guard<std::mutex> lock(g_publishMutex);
+        g_harvestedCatalog = std::move(catalog);
+        PublishMergedLocked();
+    }
+
+    void InitializeSchemaCatalog(const std::filesystem::path& catalogPath) {
+        {
+            std::lock_guard<std::mutex> lock(g_statusMutex);
+            g_catalogPath = catalogPath.string();
+        }
+        {
+            std::lock_guard<std::mutex> lock(g_watcherMutex);
+            if (g_watcherThread.joinable()) {
+                return;
+            }
+            g_watcherStop = false;
+        }
+
+        // Initial load on the calling thread so names are available before capture starts.
+        std::optional<FileStamp> loaded = GetFileStamp(catalogPath);
+        if (!loaded) {
+            std::cout << "[SchemaCatalog] No catalogue at " << catalogPath.string()
+                      << ", using built-in names. It will be loaded when created." << std::endl;
+        }
+        else if (!TryLoadAndPublish(catalogPath)) {
+            loaded.reset(); // Retry from the watcher
+        }
+
+        g_watcherThread = std::thread(WatcherLoop, catalogPath, loaded);
+    }
+
+    void ShutdownSchemaCatalog() {
+        {
+            std::lock_guard<std::mutex> lock(g_watcherMutex);
+            g_watcherStop = true;
+        }
+        g_watcherWake.notify_all();
+        if (g_watcherThread.joinable()) {
+            g_watcherThread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(g_publishMutex);
+        g_activeCatalog.store(nullptr, std::memory_order_release); // Freed once its last reader lets go
+        g_curatedCatalog = {};
+        g_harvestedCatalog = {};
+    }
+
+    CatalogStatus GetCatalogStatus() {
+        CatalogStatus status;
+        {
+            std::lock_guard<std::mutex> lock(g_statusMutex);
+            status.path = g_catalogPath;
+            status.lastError = g_lastError;
+        }
+        if (const std::shared_ptr<const Catalog> catalog = GetActiveCatalog()) {
+            status.messageCount = catalog->messages.size();
+            status.version = catalog->version;
+        }
+        return status;
+    }
+
+} // namespace kx::Schema
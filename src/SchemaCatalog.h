@@ -0,0 +1,191 @@
+#pragma once
+
+/**
+ * @file SchemaCatalog.h
+ * @brief Runtime-loadable catalogue of message names and field schemas.
+ * @details The catalogue is a compact binary file (compiled from JSON or from the
+ *          Cheat Engine schema dumps by tools/schema/kx_schema_compile.py) that is
+ *          loaded at startup and reloaded whenever it changes on disk. Schemas harvested
+ *          from the running game (SchemaHarvester.h) fill in messages the file does not
+ *          describe. Readers on the capture threads obtain the active catalogue with a
+ *          single atomic load and never block; an update builds a new merged catalogue
+ *          and publishes it with an atomic pointer swap. Readers hold a shared reference,
+ *          so a replaced catalogue lives exactly as long as someone is still reading it.
+ *
+ *          Binary format (little-endian, version 1):
+ *            Header    { char magic[4] = "KXSC"; u16 version; u16 reserved;
+ *                        u32 messageCount; u32 fieldCount; u32 stringTableSize; }
+ *            Message[] { u8 direction (0 = CMSG, 1 = SMSG); u8 reserved; u16 opcode;
+ *                        u32 nameOffset; u32 firstField; u32 fieldCount; }
+ *            Field[]   { u8 typecode; u8 reserved[3]; u32 count; u32 elementSize;
+ *                        u32 nameOffset; u32 childFirst; u32 childCount; }
+ *            char stringTable[stringTableSize] (NUL-terminated UTF-8 strings)
+ *          Field ranges index the flattened Field array. A field's children must come
+ *          after the field itself, which rules out cycles. NO_NAME marks an unnamed entry.
+ */
+
+#include "PacketData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace kx::Schema {
+
+    // Typecodes used by the game's schema field definitions (see MsgUnpack::ParseWithSchema).
+    enum class FieldType : uint8_t {
+        Short = 0x01,
+        Byte = 0x02,
+        ShortAlt = 0x03,
+        CompressedInt = 0x04,
+        Int64 = 0x05,
+        Float = 0x06,
+        Float2 = 0x07,
+        Float3 = 0x08,
+        Float4 = 0x09,
+        Vec3CompressedInt = 0x0A,
+        Float4Alt = 0x0B,
+        Guid = 0x0C,
+        WString = 0x0D,
+        String = 0x0E,
+        Optional = 0x0F,
+        FixedArray = 0x10,
+        VarArrayByte = 0x11,
+        VarArrayShort = 0x12,
+        FixedBuffer = 0x13,
+        VarBufferByte = 0x14,
+        VarBufferShort = 0x15,
+        ServerAlign = 0x16,
+        Int32 = 0x17,
+        Terminator = 0x18,
+        Int32Alt = 0x19,
+        Int64Alt = 0x1A,
+    };
+
+    constexpr uint8_t MAX_FIELD_TYPE = 0x1A;
+
+    // Field types whose definition references a sub-schema.
+    inline bool HasSubSchema(FieldType type) {
+        return type == FieldType::Optional || type == FieldType::FixedArray ||
+               type == FieldType::VarArrayByte || type == FieldType::VarArrayShort;
+    }
+
+    std::string_view GetFieldTypeName(FieldType type);
+
+    struct FieldDef {
+        FieldType type = FieldType::Byte;
+        uint32_t count = 0;       // Fixed count, or maximum count/length for variable fields
+        uint32_t elementSize = 0; // Size of one unpacked sub-schema element
+        std::string name;         // Optional, empty if unknown
+        uint32_t childFirst = 0;  // Sub-schema fields, indices into Catalog::fields
+        uint32_t childCount = 0;
+    };
+
+    struct MessageSchema {
+        PacketDirection direction = PacketDirection::Sent;
+        uint16_t opcode = 0;
+        std::string name;         // Without the CMSG_/SMSG_ prefix; empty if unknown
+        uint32_t firstField = 0;  // Top-level fields, indices into Catalog::fields
+        uint32_t fieldCount = 0;
+    };
+
+    class Catalog {
+    public:
+        std::vector<MessageSchema> messages;
+        std::vector<FieldDef> fields;
+        std::string source;   // File the catalogue was loaded from
+        uint64_t version = 0; // Assigned on publication
+
+        const MessageSchema* Find(PacketDirection direction, uint16_t opcode) const;
+
+        /**
+         * @brief Rebuilds the lookup index. Call after modifying `messages`.
+         */
+        void RebuildIndex();
+
+    private:
+        static uint32_t MakeKey(PacketDirection direction, uint16_t opcode) {
+            return (direction == PacketDirection::Sent ? 0u : 0x10000u) | opcode;
+        }
+
+        std::unordered_map<uint32_t, std::size_t> m_index;
+    };
+
+    constexpr uint32_t NO_NAME = 0xFFFFFFFFu;
+
+    /**
+     * @brief Parses and validates a binary catalogue.
+     * @return The catalogue, or std::nullopt with `error` set.
+     */
+    std::optional<Catalog> ParseCatalog(const uint8_t* data, std::size_t size, std::string& error);
+
+    std::vector<uint8_t> SerializeCatalog(const Catalog& catalog);
+
+    std::optional<Catalog> LoadCatalogFile(const std::filesystem::path& path, std::string& error);
+    bool SaveCatalogFile(const Catalog& catalog, const std::filesystem::path& path, std::string& error);
+
+    /**
+     * @brief Returns `base` plus the messages of `supplement` that `base` lacks.
+     * @details A base message without fields takes the supplement's fields; a base message
+     *          without a name takes the supplement's name. Otherwise `base` wins.
+     */
+    Catalog MergeCatalogs(const Catalog& base, const Catalog& supplement);
+
+    // --- Active catalogue (RCU-style publication) ---
+
+    /**
+     * @brief The active catalogue, or nullptr if none is loaded.
+     * @details Never waits for a publisher's merge. Keep the reference for the whole
+     *          lookup or decode; load it again for the next one to see updates.
+     */
+    std::shared_ptr<const Catalog> GetActiveCatalog();
+
+    /**
+     * @brief Incremented on every publication, so consumers can refresh derived state.
+     */
+    uint64_t GetCatalogVersion();
+
+    /**
+     * @brief Incremented only by publications that add, remove or rename a message name.
+     * @details Harvested schemas have no names, so harvesting leaves this unchanged. Use it
+     *          for state that depends only on names (header filters, logged packet names).
+     */
+    uint64_t GetCatalogNamesVersion();
+
+    /**
+     * @brief Replaces the file-backed catalogue and publishes the merged result.
+     */
+    void PublishCuratedCatalog(Catalog catalog);
+
+    /**
+     * @brief Replaces the harvested catalogue and publishes the merged result.
+     */
+    void PublishHarvestedCatalog(Catalog catalog);
+
+    /**
+     * @brief Loads the catalogue file (if present) and starts watching it for changes.
+     */
+    void InitializeSchemaCatalog(const std::filesystem::path& catalogPath);
+
+    /**
+     * @brief Stops the watcher and releases the active catalogue.
+     * @details Call only after the capture hooks have been removed.
+     */
+    void ShutdownSchemaCatalog();
+
+    struct CatalogStatus {
+        std::string path;
+        std::string lastError; // Empty if the last load succeeded
+        std::size_t messageCount = 0;
+        uint64_t version = 0;
+    };
+
+    CatalogStatus GetCatalogStatus();
+
+} // namespace kx::Schema
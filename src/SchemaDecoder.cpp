@@ -0,0 +1,382 @@
+#include "SchemaDecoder.h"
+#include "PacketHeaders.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace kx::Schema {
+
+    namespace {
+        constexpr int MAX_DECODE_DEPTH = 16;
+        constexpr std::size_t MAX_DECODED_FIELDS = 512;
+        constexpr std::size_t MAX_BUFFER_PREVIEW = 32;
+        constexpr std::size_t MAX_STRING_PREVIEW = 128;
+        constexpr std::size_t UNPACKED_POINTER_SIZE = 8;
+
+        std::string Format(const char* format, auto... args) {
+            char buffer[128];
+            std::snprintf(buffer, sizeof(buffer), format, args...);
+            return buffer;
+        }
+
+        template <typename T>
+        T ReadLE(const uint8_t* p) {
+            T value;
+            std::memcpy(&value, p, sizeof(T)); // Both the game and this tool are little-endian x64
+            return value;
+        }
+
+        std::string FormatFloats(const uint8_t* p, int count) {
+            std::string out = "(";
+            for (int i = 0; i < count; ++i) {
+                if (i > 0) {
+                    out += ", ";
+                }
+                out += Format("%.3f", ReadLE<float>(p + i * sizeof(float)));
+            }
+            return out + ")";
+        }
+
+        std::string FormatBytes(const uint8_t* p, std::size_t size) {
+            std::string out;
+            const std::size_t shown = std::min(size, MAX_BUFFER_PREVIEW);
+            for (std::size_t i = 0; i < shown; ++i) {
+                out += Format(i == 0 ? "%02X" : " %02X", p[i]);
+            }
+            if (shown < size) {
+                out += " ...";
+            }
+            return out;
+        }
+
+        // Fixed-size scalars; the layout only matters for CompressedInt.
+        std::size_t GetScalarSize(FieldType type, PayloadLayout layout) {
+            switch (type) {
+                case FieldType::Short:
+                case FieldType::ShortAlt:          return 2;
+                case FieldType::Byte:              return 1;
+                case FieldType::CompressedInt:     return layout == PayloadLayout::Unpacked ? 4 : 0;
+                case FieldType::Int64:
+                case FieldType::Int64Alt:
+                case FieldType::Float2:            return 8;
+                case FieldType::Float:
+                case FieldType::Int32:
+                case FieldType::Int32Alt:          return 4;
+                case FieldType::Float3:            return 12;
+                case FieldType::Float4:
+                case FieldType::Float4Alt:
+                case FieldType::Vec3CompressedInt: return 16;
+                case FieldType::Guid:              return 28;
+                default:                           return 0;
+            }
+        }
+
+        std::string FormatScalar(FieldType type, const uint8_t* p) {
+            switch (type) {
+                case FieldType::Short:
+                case FieldType::ShortAlt: {
+                    const uint16_t v = ReadLE<uint16_t>(p);
+                    return Format("0x%04X (%u)", v, v);
+                }
+                case FieldType::Byte:
+                    return Format("0x%02X (%u)", p[0], p[0]);
+                case FieldType::CompressedInt: {
+                    const uint32_t v = ReadLE<uint32_t>(p);
+                    return Format("%u (0x%X)", v, v);
+                }
+                case FieldType::Int64:
+                case FieldType::Int64Alt: {
+                    const unsigned long long v = ReadLE<uint64_t>(p);
+                    return Format("%llu (0x%llX)", v, v);
+                }
+                case FieldType::Float:
+                case FieldType::Int32:
+                case FieldType::Int32Alt:
+                    return Format("%.3f / 0x%08X", ReadLE<float>(p), ReadLE<uint32_t>(p));
+                case FieldType::Float2: return FormatFloats(p, 2);
+                case FieldType::Float3: return FormatFloats(p, 3);
+                case FieldType::Float4:
+                case FieldType::Float4Alt: return FormatFloats(p, 4);
+                case FieldType::Vec3CompressedInt:
+                    return FormatFloats(p, 3) + Format(" + 0x%08X", ReadLE<uint32_t>(p + 12));
+                case FieldType::Guid:
+                    return FormatBytes(p, 28);
+                default:
+                    return {};
+            }
+        }
+
+        class Decoder {
+        public:
+            Decoder(const Catalog& catalog, const uint8_t* data, std::size_t size, PayloadLayout layout, DecodeResult& result)
+                : m_catalog(catalog), m_data(data), m_size(size), m_layout(layout), m_result(result) {}
+
+            std::size_t GetPosition() const { return m_pos; }
+
+            // Decodes fields [first, first + count). Returns false once decoding must stop.
+            bool DecodeFields(uint32_t first, uint32_t count, const std::string& prefix, int depth) {
+                if (depth > MAX_DECODE_DEPTH) {
+                    return Fail("Schema nesting too deep.");
+                }
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (!DecodeField(m_catalog.fields[first + i], prefix + std::to_string(i), depth)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+        private:
+            bool Fail(std::string error) {
+                if (m_result.error.empty()) {
+                    m_result.error = std::move(error);
+                }
+                return false;
+            }
+
+            bool Need(std::size_t bytes, const std::string& path) {
+                if (m_size - m_pos < bytes) {
+                    return Fail("Payload ends inside field " + path + ".");
+                }
+                return true;
+            }
+
+            bool Emit(const FieldDef& def, const std::string& path, int depth, std::size_t offset, std::string value) {
+                if (m_result.fields.size() >= MAX_DECODED_FIELDS) {
+                    return Fail("Too many fields to display.");
+                }
+                m_result.fields.push_back({ path, &def, offset, m_pos - offset, depth, std::move(value) });
+                return true;
+            }
+
+            bool DecodeChildren(const FieldDef& def, const std::string& prefix, int depth) {
+                return DecodeFields(def.childFirst, def.childCount, prefix, depth + 1);
+            }
+
+            bool DecodeField(const FieldDef& def, const std::string& path, int depth) {
+                const std::size_t start = m_pos;
+
+                if (const std::size_t scalarSize = GetScalarSize(def.type, m_layout); scalarSize > 0) {
+                    if (!Need(scalarSize, path)) {
+                        return false;
+                    }
+                    std::string value = FormatScalar(def.type, m_data + m_pos);
+                    m_pos += scalarSize;
+                    return Emit(def, path, depth, start, std::move(value));
+                }
+
+                if (def.type == FieldType::ServerAlign) {
+                    return Fail("Field " + path + " is server-only (MP_SRV_ALIGN).");
+                }
+                return m_layout == PayloadLayout::Wire ? DecodeWireField(def, path, depth, start)
+                                                       : DecodeUnpackedField(def, path, depth, start);
+            }
+
+            bool DecodeWireField(const FieldDef& def, const std::string& path, int depth, std::size_t start) {
+                switch (def.type) {
+                    case FieldType::CompressedInt: {
+                        // 7 bits per byte, least significant group first, high bit = continuation.
+                        uint64_t value = 0;
+                        for (int shift = 0; ; shift += 7) {
+                            if (!Need(1, path)) {
+                                return false;
+                            }
+                            if (shift > 28) {
+                                return Fail("Compressed integer in field " + path + " is too long.");
+                            }
+                            const uint8_t b = m_data[m_pos++];
+                            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                            if ((b & 0x80) == 0) {
+                                break;
+                            }
+                        }
+                        return Emit(def, path, depth, start, Format("%llu (0x%llX)",
+                            static_cast<unsigned long long>(value), static_cast<unsigned long long>(value)));
+                    }
+                    case FieldType::WString: {
+                        std::string text;
+                        std::size_t chars = 0;
+                        while (true) {
+                            if (!Need(2, path)) {
+                                return false;
+                            }
+                            const uint16_t c = ReadLE<uint16_t>(m_data + m_pos);
+                            m_pos += 2;
+                            if (c == 0) {
+                                break;
+                            }
+                            if (++chars <= MAX_STRING_PREVIEW) {
+                                text += (c >= 0x20 && c < 0x7F) ? static_cast<char>(c) : '?';
+                            }
+                        }
+                        return Emit(def, path, depth, start, "\"" + text + (chars > MAX_STRING_PREVIEW ? "...\"" : "\""));
+                    }
+                    case FieldType::String: {
+                        const void* end = std::memchr(m_data + m_pos, 0, m_size - m_pos);
+                        if (!end) {
+                            return Fail("Unterminated string in field " + path + ".");
+                        }
+                        const std::size_t length = static_cast<const uint8_t*>(end) - (m_data + m_pos);
+                        std::string text(reinterpret_cast<const char*>(m_data + m_pos), std::min(length, MAX_STRING_PREVIEW));
+                        std::replace_if(text.begin(), text.end(), [](char c) { return static_cast<unsigned char>(c) < 0x20; }, '?');
+                        m_pos += length + 1;
+                        return Emit(def, path, depth, start, "\"" + text + (length > MAX_STRING_PREVIEW ? "...\"" : "\""));
+                    }
+                    case FieldType::Optional: {
+                        if (!Need(1, path)) {
+                            return false;
+                        }
+                        const bool present = m_data[m_pos++] != 0;
+                        if (!Emit(def, path, depth, start, present ? "present" : "absent")) {
+                            return false;
+                        }
+                        return !present || DecodeChildren(def, path + ".", depth);
+                    }
+                    case FieldType::FixedArray:
+                        return DecodeArray(def, path, depth, start, def.count);
+                    case FieldType::VarArrayByte:
+                    case FieldType::VarArrayShort: {
+                        const std::size_t countSize = def.type == FieldType::VarArrayByte ? 1 : 2;
+                        if (!Need(countSize, path)) {
+                            return false;
+                        }
+                        const uint32_t count = countSize == 1 ? m_data[m_pos] : ReadLE<uint16_t>(m_data + m_pos);
+                        m_pos += countSize;
+                        if (def.count != 0 && count > def.count) {
+                            return Fail("Array " + path + " exceeds its maximum count.");
+                        }
+                        return DecodeArray(def, path, depth, start, count);
+                    }
+                    case FieldType::FixedBuffer:
+                        if (!Need(def.count, path)) {
+                            return false;
+                        }
+                        m_pos += def.count;
+                        return Emit(def, path, depth, start, FormatBytes(m_data + start, def.count));
+                    case FieldType::VarBufferByte:
+                    case FieldType::VarBufferShort: {
+                        const std::size_t lengthSize = def.type == FieldType::VarBufferByte ? 1 : 2;
+                        if (!Need(lengthSize, path)) {
+                            return false;
+                        }
+                        const uint32_t length = lengthSize == 1 ? m_data[m_pos] : ReadLE<uint16_t>(m_data + m_pos);
+                        m_pos += lengthSize;
+                        if (!Need(length, path)) {
+                            return false;
+                        }
+                        m_pos += length;
+                        return Emit(def, path, depth, start,
+                            Format("[%u] ", length) + FormatBytes(m_data + start + lengthSize, length));
+                    }
+                    default:
+                        return Fail("Field " + path + " has an unsupported type.");
+                }
+            }
+
+            bool DecodeArray(const FieldDef& def, const std::string& path, int depth, std::size_t start, uint32_t count) {
+                if (!Emit(def, path, depth, start, Format("%u element(s)", count))) {
+                    return false;
+                }
+                if (count > 0 && def.childCount == 0) {
+                    return Fail("Array " + path + " has no element schema.");
+                }
+                for (uint32_t element = 0; element < count; ++element) {
+                    if (!DecodeChildren(def, path + "[" + std::to_string(element) + "].", depth)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            bool DecodeUnpackedField(const FieldDef& def, const std::string& path, int depth, std::size_t start) {
+                std::size_t countSize = 0;
+                switch (def.type) {
+                    case FieldType::VarArrayByte:
+                    case FieldType::VarBufferByte:  countSize = 1; break;
+                    case FieldType::VarArrayShort:
+                    case FieldType::VarBufferShort: countSize = 2; break;
+                    case FieldType::WString:
+                    case FieldType::String:
+                    case FieldType::Optional:
+                    case FieldType::FixedArray:
+                    case FieldType::FixedBuffer:    break;
+                    default:
+                        return Fail("Field " + path + " has an unsupported type.");
+                }
+
+                if (!Need(countSize + UNPACKED_POINTER_SIZE, path)) {
+                    return false;
+                }
+                std::string value;
+                if (countSize > 0) {
+                    const uint32_t count = countSize == 1 ? m_data[m_pos] : ReadLE<uint16_t>(m_data + m_pos);
+                    value = Format("count %u, ", count);
+                }
+                const unsigned long long pointer = ReadLE<uint64_t>(m_data + m_pos + countSize);
+                value += pointer == 0 ? "null" : Format("-> 0x%llX (not captured)", pointer);
+                m_pos += countSize + UNPACKED_POINTER_SIZE;
+                return Emit(def, path, depth, start, std::move(value));
+            }
+
+            const Catalog& m_catalog;
+            const uint8_t* m_data;
+            std::size_t m_size;
+            PayloadLayout m_layout;
+            DecodeResult& m_result;
+            std::size_t m_pos = 0;
+        };
+    }
+
+    DecodeResult DecodePayload(const Catalog& catalog, const MessageSchema& message,
+                               const uint8_t* data, std::size_t size, PayloadLayout layout) {
+        DecodeResult result;
+        Decoder decoder(catalog, data, size, layout, result);
+        result.complete = decoder.DecodeFields(message.firstField, message.fieldCount, "", 0);
+        result.bytesConsumed = decoder.GetPosition();
+        return result;
+    }
+
+    std::optional<std::string> DecodePacketWithSchema(const PacketInfo& packet) {
+        const std::shared_ptr<const Catalog> catalog = GetActiveCatalog();
+        if (!catalog) {
+            return std::nullopt;
+        }
+        const MessageSchema* message = catalog->Find(packet.direction, packet.rawHeaderId);
+        if (!message || message->fieldCount == 0) {
+            return std::nullopt;
+        }
+
+        const PayloadLayout layout = GetLayoutForDirection(packet.direction);
+        const DecodeResult result = DecodePayload(*catalog, *message, packet.data.data(), packet.data.size(), layout);
+
+        std::string out = GetPacketName(packet.direction, packet.rawHeaderId) +
+                          Format(" (schema v%llu, %s layout):\n", static_cast<unsigned long long>(catalog->version),
+                                 layout == PayloadLayout::Wire ? "wire" : "unpacked");
+        for (const DecodedField& field : result.fields) {
+            out.append(2 + field.depth * 2, ' ');
+            out += field.path;
+            if (!field.def->name.empty()) {
+                out += ' ';
+                out += field.def->name;
+            }
+            out += " [";
+            out += GetFieldTypeName(field.def->type);
+            out += "]: ";
+            out += field.value;
+            out += '\n';
+        }
+        if (!result.complete) {
+            out += "  (Decoding stopped: " + result.error + ")\n";
+        }
+        else if (result.bytesConsumed < packet.data.size()) {
+            // Outgoing captures hold a whole send buffer, so this is usually the next message.
+            out += Format("  (%zu bytes after the message)\n", packet.data.size() - result.bytesConsumed);
+        }
+        if (!out.empty() && out.back() == '\n') {
+            out.pop_back();
+        }
+        return out;
+    }
+
+} // namespace kx::Schema
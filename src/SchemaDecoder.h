@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * @file SchemaDecoder.h
+ * @brief Generic payload decoder driven by the schema catalogue.
+ * @details Used for any message without a handwritten parser. Two payload layouts exist:
+ *          - Wire: the serialised byte stream, as captured for CMSG (header included).
+ *            Mirrors the reads done by MsgUnpack::ParseWithSchema.
+ *          - Unpacked: the tuple ParseWithSchema writes for SMSG handlers, which is what
+ *            the dispatcher hook captures. Fields are packed without padding; strings,
+ *            blocks and arrays are pointers into the game's message arena, which are not
+ *            captured, so only their inline parts (counts) can be shown.
+ */
+
+#include "PacketData.h"
+#include "SchemaCatalog.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kx::Schema {
+
+    enum class PayloadLayout {
+        Wire,
+        Unpacked
+    };
+
+    inline PayloadLayout GetLayoutForDirection(PacketDirection direction) {
+        return direction == PacketDirection::Sent ? PayloadLayout::Wire : PayloadLayout::Unpacked;
+    }
+
+    struct DecodedField {
+        std::string path;          // Field index path, e.g. "4.2.0" or "3[1].0"
+        const FieldDef* def = nullptr;
+        std::size_t offset = 0;    // Byte range within the payload
+        std::size_t size = 0;
+        int depth = 0;             // Nesting level, 0 for top-level fields
+        std::string value;         // Formatted value
+    };
+
+    struct DecodeResult {
+        std::vector<DecodedField> fields;
+        std::size_t bytesConsumed = 0;
+        bool complete = false;     // All fields decoded without running out of data
+        std::string error;         // Why decoding stopped early
+    };
+
+    /**
+     * @brief Decodes a payload against a message schema from `catalog`.
+     */
+    DecodeResult DecodePayload(const Catalog& catalog, const MessageSchema& message,
+                               const uint8_t* data, std::size_t size, PayloadLayout layout);
+
+    /**
+     * @brief Tooltip text for a packet decoded with the active catalogue.
+     * @return std::nullopt if the catalogue has no field schema for the packet.
+     */
+    std::optional<std::string> DecodePacketWithSchema(const PacketInfo& packet);
+
+} // namespace kx::Schema
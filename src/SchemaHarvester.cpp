@@ -0,0 +1,351 @@
+#include <windows.h> // Included first for platform definitions
+#include "SchemaHarvester.h"
+#include "GameStructs.h"
+#include "SchemaCatalog.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace kx::Schema {
+
+    namespace {
+        constexpr std::size_t OPCODE_COUNT = 0x10000;
+        constexpr std::size_t MAX_SCHEMA_DEPTH = 16;       // Matches the decoder's nesting limit
+        constexpr std::size_t MAX_FIELDS_PER_SCHEMA = 256; // Without a terminator the pointer is bogus
+        constexpr std::size_t MAX_FIELDS_PER_MESSAGE = 4096;
+        constexpr std::chrono::seconds SAVE_INTERVAL{ 60 }; // Unsaved schemas are also saved at shutdown
+
+        struct PendingSchema {
+            uint16_t opcode = 0;
+            uintptr_t definition = 0;
+        };
+
+        struct RawField {
+            uint32_t type = 0;
+            uint32_t count = 0;
+            uintptr_t subSchema = 0;
+            uint32_t elementSize = 0;
+        };
+
+        // --- Hot-path state ---
+        std::array<std::atomic<uint64_t>, OPCODE_COUNT / 64> g_seenOpcodes{};
+        std::atomic<bool> g_harvesterRunning{ false };
+
+        // --- Queue shared with the harvester thread ---
+        std::mutex g_queueMutex;
+        std::condition_variable g_queueWake;
+        std::vector<PendingSchema> g_queue; // Guarded by g_queueMutex
+        bool g_stopRequested = false;       // Guarded by g_queueMutex
+        std::thread g_harvesterThread;
+
+        // --- Harvester thread state (only touched by that thread once it runs) ---
+        Catalog g_liveSchemas;      // Walked in this session
+        Catalog g_persistedSchemas; // Loaded from the harvest file
+        bool g_unsavedChanges = false;
+
+        // --- Status ---
+        std::mutex g_statusMutex;
+        std::string g_harvestPath;
+        std::string g_lastError;
+        std::atomic<std::size_t> g_loadedCount{ 0 };
+        std::atomic<std::size_t> g_harvestedCount{ 0 };
+        std::atomic<std::size_t> g_failedCount{ 0 };
+
+        void SetLastError(const std::string& error) {
+            std::lock_guard<std::mutex> lock(g_statusMutex);
+            g_lastError = error;
+        }
+
+        // ReadProcessMemory on our own process fails cleanly on unmapped or guarded pages,
+        // so a stale or misidentified definition pointer cannot fault the harvester thread.
+        bool ReadGameMemory(uintptr_t address, void* out, std::size_t size) {
+            if (address == 0) {
+                return false;
+            }
+            SIZE_T bytesRead = 0;
+            return ReadProcessMemory(GetCurrentProcess(), reinterpret_cast<LPCVOID>(address), out, size, &bytesRead) &&
+                   bytesRead == size;
+        }
+
+        std::string FormatAddress(uintptr_t address) {
+            std::ostringstream oss;
+            oss << "0x" << std::hex << std::uppercase << address;
+            return oss.str();
+        }
+
+        /**
+         * @brief Copies one message's definition tree into a catalogue.
+         * @details Fields are appended in the catalogue's order (children after their parent).
+         *          Cycles are detected on the current ancestor path only, because the game
+         *          shares sub-schemas between fields.
+         */
+        class SchemaWalker {
+        public:
+            explicit SchemaWalker(Catalog& out) : m_out(out) {}
+
+            bool Walk(uintptr_t definition, uint32_t& first, uint32_t& count) {
+                if (m_ancestors.size() >= MAX_SCHEMA_DEPTH) {
+                    m_error = "Schema nesting deeper than " + std::to_string(MAX_SCHEMA_DEPTH) + " levels.";
+                    return false;
+                }
+                if (std::find(m_ancestors.begin(), m_ancestors.end(), definition) != m_ancestors.end()) {
+                    m_error = "Schema at " + FormatAddress(definition) + " contains itself.";
+                    return false;
+                }
+
+                std::vector<RawField> raw;
+                if (!ReadFields(definition, raw)) {
+                    return false;
+                }
+                if (m_out.fields.size() + raw.size() > MAX_FIELDS_PER_MESSAGE) {
+                    m_error = "Schema has more than " + std::to_string(MAX_FIELDS_PER_MESSAGE) + " fields.";
+                    return false;
+                }
+
+                first = static_cast<uint32_t>(m_out.fields.size());
+                count = static_cast<uint32_t>(raw.size());
+                for (const RawField& field : raw) {
+                    FieldDef def;
+                    def.type = static_cast<FieldType>(field.type);
+                    def.count = field.count;
+                    def.elementSize = field.elementSize;
+                    m_out.fields.push_back(std::move(def));
+                }
+
+                m_ancestors.push_back(definition);
+                for (std::size_t i = 0; i < raw.size(); ++i) {
+                    if (!HasSubSchema(static_cast<FieldType>(raw[i].type)) || raw[i].subSchema == 0) {
+                        continue;
+                    }
+                    uint32_t childFirst = 0;
+                    uint32_t childCount = 0;
+                    if (!Walk(raw[i].subSchema, childFirst, childCount)) {
+                        return false;
+                    }
+                    m_out.fields[first + i].childFirst = childFirst;
+                    m_out.fields[first + i].childCount = childCount;
+                }
+                m_ancestors.pop_back();
+                return true;
+            }
+
+            const std::string& GetError() const { return m_error; }
+
+        private:
+            bool ReadFields(uintptr_t definition, std::vector<RawField>& raw) {
+                uint8_t entry[GameStructs::SCHEMA_FIELD_DEF_SIZE];
+                for (std::size_t i = 0; i < MAX_FIELDS_PER_SCHEMA; ++i) {
+                    const uintptr_t address = definition + i * GameStructs::SCHEMA_FIELD_DEF_SIZE;
+                    if (!ReadGameMemory(address, entry, sizeof(entry))) {
+                        m_error = "Unreadable field definition at " + FormatAddress(address) + ".";
+                        return false;
+                    }
+
+                    RawField field;
+                    std::memcpy(&field.type, entry + GameStructs::SCHEMA_FIELD_TYPE_OFFSET, sizeof(field.type));
+                    if (field.type == 0 || field.type == static_cast<uint32_t>(FieldType::Terminator)) {
+                        return true;
+                    }
+                    if (field.type > MAX_FIELD_TYPE) {
+                        m_error = "Unknown typecode " + std::to_string(field.type) + " at " + FormatAddress(address) + ".";
+                        return false;
+                    }
+                    std::memcpy(&field.count, entry + GameStructs::SCHEMA_FIELD_COUNT_OFFSET, sizeof(field.count));
+                    std::memcpy(&field.subSchema, entry + GameStructs::SCHEMA_FIELD_SUB_SCHEMA_OFFSET, sizeof(field.subSchema));
+                    std::memcpy(&field.elementSize, entry + GameStructs::SCHEMA_FIELD_ELEMENT_SIZE_OFFSET, sizeof(field.elementSize));
+                    raw.push_back(field);
+                }
+                m_error = "No terminator within " + std::to_string(MAX_FIELDS_PER_SCHEMA) + " fields at " +
+                          FormatAddress(definition) + ".";
+                return false;
+            }
+
+            Catalog& m_out;
+            std::vector<uintptr_t> m_ancestors;
+            std::string m_error;
+        };
+
+        // Harvested schemas as published: this session's walks take precedence over the file.
+        Catalog BuildHarvestedCatalog() {
+            Catalog harvested = MergeCatalogs(g_liveSchemas, g_persistedSchemas);
+            harvested.source = g_harvestPath;
+            return harvested;
+        }
+
+        void HarvestBatch(const std::vector<PendingSchema>& batch) {
+            bool changed = false;
+            for (const PendingSchema& pending : batch) {
+                Catalog single;
+                MessageSchema message;
+                message.direction = PacketDirection::Received;
+                message.opcode = pending.opcode;
+
+                SchemaWalker walker(single);
+                if (!walker.Walk(pending.definition, message.firstField, message.fieldCount)) {
+                    std::ostringstream oss;
+                    oss << "SMSG 0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0')
+                        << pending.opcode << ": " << walker.GetError();
+                    std::cerr << "[SchemaHarvester] " << oss.str() << std::endl;
+                    SetLastError(oss.str());
+                    g_failedCount.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                single.messages.push_back(std::move(message));
+                single.RebuildIndex();
+                g_liveSchemas = MergeCatalogs(g_liveSchemas, single);
+                g_harvestedCount.fetch_add(1, std::memory_order_relaxed);
+                changed = true;
+            }
+
+            if (changed) {
+                PublishHarvestedCatalog(BuildHarvestedCatalog());
+                g_unsavedChanges = true;
+            }
+        }
+
+        void SaveHarvestedSchemas() {
+            if (!g_unsavedChanges) {
+                return;
+            }
+            std::string error;
+            if (SaveCatalogFile(BuildHarvestedCatalog(), g_harvestPath, error)) {
+                g_unsavedChanges = false;
+            } else {
+                std::cerr << "[SchemaHarvester] " << error << std::endl;
+                SetLastError(error);
+            }
+        }
+
+        void HarvesterLoop() {
+            // Opcodes arrive in bursts (login, map loads), so saving is deferred until the
+            // burst is over instead of rewriting the file after every batch.
+            std::optional<std::chrono::steady_clock::time_point> saveDue;
+            const auto wakeUp = [] { return g_stopRequested || !g_queue.empty(); };
+
+            std::unique_lock<std::mutex> lock(g_queueMutex);
+            while (true) {
+                if (saveDue) {
+                    g_queueWake.wait_until(lock, *saveDue, wakeUp);
+                } else {
+                    g_queueWake.wait(lock, wakeUp);
+                }
+                if (g_stopRequested) {
+                    return; // ShutdownSchemaHarvester() saves
+                }
+
+                std::vector<PendingSchema> batch;
+                batch.swap(g_queue);
+                lock.unlock();
+                if (!batch.empty()) {
+                    HarvestBatch(batch);
+                }
+                const auto now = std::chrono::steady_clock::now();
+                if (saveDue && now >= *saveDue) {
+                    SaveHarvestedSchemas();
+                    saveDue.reset();
+                }
+                if (g_unsavedChanges && !saveDue) {
+                    saveDue = now + SAVE_INTERVAL; // Also retries a failed save
+                }
+                lock.lock();
+            }
+        }
+    }
+
+    void InitializeSchemaHarvester(const std::filesystem::path& harvestPath) {
+        {
+            std::lock_guard<std::mutex> lock(g_statusMutex);
+            g_harvestPath = harvestPath.string();
+            g_lastError.clear();
+        }
+
+        std::error_code ec;
+        if (std::filesystem::exists(harvestPath, ec)) {
+            std::string error;
+            if (std::optional<Catalog> persisted = LoadCatalogFile(harvestPath, error)) {
+                g_persistedSchemas = std::move(*persisted);
+                g_loadedCount.store(g_persistedSchemas.messages.size(), std::memory_order_relaxed);
+                PublishHarvestedCatalog(BuildHarvestedCatalog());
+                std::cout << "[SchemaHarvester] Loaded " << g_persistedSchemas.messages.size()
+                          << " harvested schemas from " << harvestPath.string() << std::endl;
+            } else {
+                std::cerr << "[SchemaHarvester] " << error << std::endl;
+                SetLastError(error);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_queueMutex);
+            g_stopRequested = false;
+            g_queue.reserve(256);
+        }
+        g_harvesterThread = std::thread(HarvesterLoop);
+        g_harvesterRunning.store(true, std::memory_order_release);
+    }
+
+    bool NotifyMessageDefinition(uint16_t opcode, const void* messageDefinition) {
+        std::atomic<uint64_t>& word = g_seenOpcodes[opcode >> 6];
+        const uint64_t bit = 1ull << (opcode & 63);
+        // Plain load first so repeat sightings never contend on the cache line.
+        if ((word.load(std::memory_order_relaxed) & bit) != 0 ||
+            (word.fetch_or(bit, std::memory_order_relaxed) & bit) != 0) {
+            return false;
+        }
+
+        if (messageDefinition && g_harvesterRunning.load(std::memory_order_acquire)) {
+            {
+                std::lock_guard<std::mutex> lock(g_queueMutex);
+                g_queue.push_back({ opcode, reinterpret_cast<uintptr_t>(messageDefinition) });
+            }
+            g_queueWake.notify_one();
+        }
+        return true;
+    }
+
+    void ShutdownSchemaHarvester() {
+        g_harvesterRunning.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(g_queueMutex);
+            g_stopRequested = true;
+            g_queue.clear();
+        }
+        g_queueWake.notify_all();
+        if (g_harvesterThread.joinable()) {
+            g_harvesterThread.join();
+        }
+
+        SaveHarvestedSchemas();
+        g_liveSchemas = {};
+        g_persistedSchemas = {};
+    }
+
+    HarvesterStatus GetHarvesterStatus() {
+        HarvesterStatus status;
+        {
+            std::lock_guard<std::mutex> lock(g_statusMutex);
+            status.path = g_harvestPath;
+            status.lastError = g_lastError;
+        }
+        {
+            std::lock_guard<std::mutex> lock(g_queueMutex);
+            status.pendingCount = g_queue.size();
+        }
+        status.loadedCount = g_loadedCount.load(std::memory_order_relaxed);
+        status.harvestedCount = g_harvestedCount.load(std::memory_order_relaxed);
+        status.failedCount = g_failedCount.load(std::memory_order_relaxed);
+        return status;
+    }
+
+} // namespace kx::Schema
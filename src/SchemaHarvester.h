@@ -0,0 +1,54 @@
+#pragma once
+
+/**
+ * @file SchemaHarvester.h
+ * @brief Copies SMSG schemas out of the running game into the schema catalogue.
+ * @details The dispatcher hook sees each message's definition pointer (HandlerInfo+0x08),
+ *          which is the same field definition array MsgUnpack::ParseWithSchema walks. The
+ *          first time an opcode is seen the hook queues that pointer; a background thread
+ *          walks the definition tree with validated reads and publishes the result through
+ *          PublishHarvestedCatalog(), so the schema decoder can decode the message
+ *          generically without an offline dump. New schemas are saved to the harvest file
+ *          a minute after they are found, and at shutdown. Harvested schemas have no names;
+ *          names still come from the catalogue file and the built-in tables.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace kx::Schema {
+
+    /**
+     * @brief Loads previously harvested schemas and starts the harvester thread.
+     * @param harvestPath File harvested schemas are loaded from and saved to.
+     */
+    void InitializeSchemaHarvester(const std::filesystem::path& harvestPath);
+
+    /**
+     * @brief Called from the dispatcher hook for every received message.
+     * @details Lock-free after the first sighting of an opcode. The first sighting queues
+     *          the definition for the harvester thread; nothing is read from it here.
+     * @return true if this was the first sighting of the opcode in this session.
+     */
+    bool NotifyMessageDefinition(uint16_t opcode, const void* messageDefinition);
+
+    /**
+     * @brief Stops the harvester thread and saves the harvested schemas.
+     * @details Call after the capture hooks have been removed and before ShutdownSchemaCatalog().
+     */
+    void ShutdownSchemaHarvester();
+
+    struct HarvesterStatus {
+        std::string path;
+        std::string lastError;          // Most recent walk or save failure
+        std::size_t loadedCount = 0;    // Schemas loaded from the harvest file at startup
+        std::size_t harvestedCount = 0; // Schemas walked in this session
+        std::size_t failedCount = 0;
+        std::size_t pendingCount = 0;
+    };
+
+    HarvesterStatus GetHarvesterStatus();
+
+} // namespace kx::Schema
@@ -0,0 +1,54 @@
+#include "SectionScan.h"
+
+#include <algorithm>
+
+namespace kx::Scanning {
+
+    namespace {
+        struct Chunk {
+            PeRange range;      // Section the chunk belongs to
+            std::size_t begin;  // First match start searched, relative to the section
+            std::size_t end;    // One past the last match start searched
+        };
+    }
+
+    std::vector<std::vector<uint32_t>> FindInSections(const uint8_t* data, const PeImage& image, ScanTarget target,
+                                                      const PatternSet& patterns, Threading::ThreadPool& pool) {
+        std::vector<std::vector<uint32_t>> results(patterns.Size());
+        if (patterns.Size() == 0) {
+            return results;
+        }
+
+        std::vector<Chunk> chunks;
+        for (const PeRange& range : image.GetRanges(target)) {
+            for (std::size_t begin = 0; begin < range.size; begin += SECTION_SCAN_CHUNK_SIZE) {
+                chunks.push_back({ range, begin, std::min(range.size, begin + SECTION_SCAN_CHUNK_SIZE) });
+            }
+        }
+
+        // Each chunk writes only its own slot; slots are concatenated in order afterwards,
+        // which keeps every pattern's matches ascending.
+        const std::size_t overlap = patterns.GetMaxPatternSize() - 1;
+        std::vector<std::vector<std::vector<std::size_t>>> chunkResults(chunks.size());
+        pool.ParallelFor(chunks.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                const Chunk& chunk = chunks[i];
+                const std::size_t searchEnd = std::min(chunk.range.size, chunk.end + overlap);
+                chunkResults[i] = patterns.FindAll(data + chunk.range.offset + chunk.begin, searchEnd - chunk.begin);
+            }
+        });
+
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            const Chunk& chunk = chunks[i];
+            for (std::size_t pattern = 0; pattern < results.size(); ++pattern) {
+                for (const std::size_t offset : chunkResults[i][pattern]) {
+                    if (offset < chunk.end - chunk.begin) { // Later starts belong to the next chunk
+                        results[pattern].push_back(chunk.range.rva + static_cast<uint32_t>(chunk.begin + offset));
+                    }
+                }
+            }
+        }
+        return results;
+    }
+
+} // namespace kx::Scanning
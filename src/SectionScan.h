@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @file SectionScan.h
+ * @brief Multi-threaded pattern search restricted to the relevant sections of a PE image.
+ * @details Code signatures are only searched in executable sections and data signatures
+ *          only in read-only data, so neither pays for (or false-matches in) the rest of
+ *          the image. The selected sections are cut into chunks that overlap by one byte
+ *          less than the longest pattern, so a match straddling a chunk boundary is found
+ *          by exactly the chunk it starts in, and the chunks are searched in parallel.
+ */
+
+#include "PatternSearch.h"
+#include "PeImage.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kx::Scanning {
+
+    // Bytes of section data each pool task searches.
+    constexpr std::size_t SECTION_SCAN_CHUNK_SIZE = 1024 * 1024;
+
+    /**
+     * @brief Every match of each pattern in `patterns` within the `target` sections of `image`.
+     * @param data The buffer `image` was parsed from.
+     * @param pool Searches the chunks; the calling thread takes part.
+     * @return One vector of ascending match RVAs per pattern, in PatternSet order.
+     */
+    std::vector<std::vector<uint32_t>> FindInSections(const uint8_t* data, const PeImage& image, ScanTarget target,
+                                                      const PatternSet& patterns, Threading::ThreadPool& pool);
+
+} // namespace kx::Scanning
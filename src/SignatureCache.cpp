@@ -0,0 +1,196 @@
+#include "SignatureCache.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace kx::Scanning {
+
+    namespace {
+        constexpr char CACHE_MAGIC[4] = { 'K', 'X', 'S', 'G' };
+        constexpr uint16_t CACHE_FORMAT_VERSION = 1;
+        constexpr std::size_t HEADER_SIZE = 20;
+        constexpr std::size_t MAX_CACHE_FILE_SIZE = 1024 * 1024;
+
+        // Samples hashed per executable section for the build key.
+        constexpr std::size_t BUILD_KEY_SAMPLES = 64;
+        constexpr std::size_t BUILD_KEY_SAMPLE_SIZE = 256;
+
+        constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+        constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+        uint64_t HashBytes(uint64_t hash, const uint8_t* data, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i) {
+                hash = (hash ^ data[i]) * FNV_PRIME;
+            }
+            return hash;
+        }
+
+        uint64_t HashValue(uint64_t hash, uint64_t value) {
+            for (int i = 0; i < 8; ++i) {
+                hash = (hash ^ static_cast<uint8_t>(value >> (8 * i))) * FNV_PRIME;
+            }
+            return hash;
+        }
+
+        // --- Little-endian helpers ---
+        uint32_t ReadU32(const uint8_t* p) {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+        uint64_t ReadU64(const uint8_t* p) {
+            return static_cast<uint64_t>(ReadU32(p)) | (static_cast<uint64_t>(ReadU32(p + 4)) << 32);
+        }
+        void WriteU32(std::vector<uint8_t>& out, uint32_t v) {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+            }
+        }
+        void WriteU64(std::vector<uint8_t>& out, uint64_t v) {
+            WriteU32(out, static_cast<uint32_t>(v));
+            WriteU32(out, static_cast<uint32_t>(v >> 32));
+        }
+    }
+
+    uint64_t SignatureCache::ComputeBuildKey(const uint8_t* data, const PeImage& image) {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        hash = HashValue(hash, image.GetTimestamp());
+        hash = HashValue(hash, image.GetChecksum());
+        hash = HashValue(hash, image.GetSizeOfImage());
+        if (const std::optional<std::size_t> headers = image.RvaToOffset(0)) {
+            hash = HashBytes(hash, data + *headers, std::min<std::size_t>(image.GetSizeOfHeaders(), 4096));
+        }
+        for (const PeRange& range : image.GetRanges(ScanTarget::Code)) {
+            hash = HashValue(hash, range.rva);
+            hash = HashValue(hash, range.size);
+            if (range.size <= BUILD_KEY_SAMPLES * BUILD_KEY_SAMPLE_SIZE) {
+                hash = HashBytes(hash, data + range.offset, range.size);
+                continue;
+            }
+            const std::size_t stride = (range.size - BUILD_KEY_SAMPLE_SIZE) / (BUILD_KEY_SAMPLES - 1);
+            for (std::size_t i = 0; i < BUILD_KEY_SAMPLES; ++i) {
+                hash = HashBytes(hash, data + range.offset + i * stride, BUILD_KEY_SAMPLE_SIZE);
+            }
+        }
+        return hash;
+    }
+
+    uint64_t SignatureCache::HashSignature(const BytePattern& pattern, ScanTarget target) {
+        uint64_t hash = HashValue(FNV_OFFSET_BASIS, static_cast<uint64_t>(target));
+        hash = HashBytes(hash, pattern.bytes.data(), pattern.bytes.size());
+        return HashBytes(hash, pattern.mask.data(), pattern.mask.size());
+    }
+
+    std::optional<SignatureCache> SignatureCache::Load(const std::filesystem::path& path, std::string& error) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            error = "Could not open " + path.string() + ".";
+            return std::nullopt;
+        }
+        const std::streamoff fileSize = file.tellg();
+        if (fileSize < static_cast<std::streamoff>(HEADER_SIZE) || static_cast<std::size_t>(fileSize) > MAX_CACHE_FILE_SIZE) {
+            error = "Signature cache " + path.string() + " has an unreasonable size.";
+            return std::nullopt;
+        }
+        std::vector<uint8_t> bytes(static_cast<std::size_t>(fileSize));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(bytes.data()), fileSize)) {
+            error = "Could not read " + path.string() + ".";
+            return std::nullopt;
+        }
+
+        if (!std::equal(std::begin(CACHE_MAGIC), std::end(CACHE_MAGIC), bytes.begin()) ||
+            (bytes[4] | (bytes[5] << 8)) != CACHE_FORMAT_VERSION) {
+            error = path.string() + " is not a version " + std::to_string(CACHE_FORMAT_VERSION) + " signature cache.";
+            return std::nullopt;
+        }
+        SignatureCache cache(ReadU64(bytes.data() + 8));
+        const uint32_t entryCount = ReadU32(bytes.data() + 16);
+        std::size_t pos = HEADER_SIZE;
+        for (uint32_t i = 0; i < entryCount; ++i) {
+            if (bytes.size() - pos < 12) {
+                error = path.string() + " is truncated.";
+                return std::nullopt;
+            }
+            const uint64_t signatureHash = ReadU64(bytes.data() + pos);
+            const uint32_t matchCount = ReadU32(bytes.data() + pos + 8);
+            pos += 12;
+            if (matchCount > MAX_CACHED_MATCHES || (bytes.size() - pos) / 4 < matchCount) {
+                error = path.string() + " is truncated.";
+                return std::nullopt;
+            }
+            std::vector<uint32_t> rvas(matchCount);
+            for (uint32_t& rva : rvas) {
+                rva = ReadU32(bytes.data() + pos);
+                pos += 4;
+            }
+            cache.Store(signatureHash, std::move(rvas));
+        }
+        return cache;
+    }
+
+    bool SignatureCache::Save(const std::filesystem::path& path, std::string& error) const {
+        std::vector<uint8_t> bytes(std::begin(CACHE_MAGIC), std::end(CACHE_MAGIC));
+        bytes.push_back(static_cast<uint8_t>(CACHE_FORMAT_VERSION));
+        bytes.push_back(static_cast<uint8_t>(CACHE_FORMAT_VERSION >> 8));
+        bytes.push_back(0);
+        bytes.push_back(0);
+        WriteU64(bytes, m_buildKey);
+        WriteU32(bytes, static_cast<uint32_t>(m_entries.size()));
+        for (const auto& [signatureHash, rvas] : m_entries) {
+            WriteU64(bytes, signatureHash);
+            WriteU32(bytes, static_cast<uint32_t>(rvas.size()));
+            for (const uint32_t rva : rvas) {
+                WriteU32(bytes, rva);
+            }
+        }
+
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file || !file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+                error = "Could not write " + tempPath.string() + ".";
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            error = "Could not replace " + path.string() + ": " + ec.message();
+            return false;
+        }
+        return true;
+    }
+
+    const std::vector<uint32_t>* SignatureCache::Find(uint64_t signatureHash) const {
+        const auto it = m_entries.find(signatureHash);
+        return it != m_entries.end() ? &it->second : nullptr;
+    }
+
+    void SignatureCache::Store(uint64_t signatureHash, std::vector<uint32_t> rvas) {
+        if (rvas.empty() || rvas.size() > MAX_CACHED_MATCHES) {
+            m_entries.erase(signatureHash);
+            return;
+        }
+        m_entries[signatureHash] = std::move(rvas);
+    }
+
+    bool ValidateCachedMatches(const uint8_t* data, const PeImage& image, ScanTarget target,
+                               const BytePattern& pattern, const std::vector<uint32_t>& rvas) {
+        if (rvas.empty()) {
+            return false; // "Not found" is never trusted from the cache
+        }
+        const std::vector<PeRange> ranges = image.GetRanges(target);
+        for (const uint32_t rva : rvas) {
+            const auto range = std::find_if(ranges.begin(), ranges.end(), [&](const PeRange& candidate) {
+                return rva >= candidate.rva && rva - candidate.rva < candidate.size &&
+                       candidate.size - (rva - candidate.rva) >= pattern.Size();
+            });
+            if (range == ranges.end() || !pattern.MatchesAt(data + range->offset + (rva - range->rva))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace kx::Scanning
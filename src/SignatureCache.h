@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file SignatureCache.h
+ * @brief Signature matches remembered per game build, so re-injection skips the scan.
+ * @details Matches are stored as module-relative RVAs under a build key: a 64-bit hash of
+ *          the PE headers (which hold the link timestamp, the checksum and the section
+ *          table) and of evenly spaced samples of every executable section. A cached match
+ *          is only used after the pattern has been re-checked at that RVA, so a stale or
+ *          foreign cache costs one comparison per match before the scan runs as usual.
+ *
+ *          Binary format (little-endian, version 1):
+ *            Header  { char magic[4] = "KXSG"; u16 version; u16 reserved;
+ *                      u64 buildKey; u32 entryCount; }
+ *            Entry[] { u64 signatureHash; u32 matchCount; u32 rvas[matchCount]; }
+ */
+
+#include "PatternSearch.h"
+#include "PeImage.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kx::Scanning {
+
+    // Signatures with more matches than this are not cached.
+    constexpr std::size_t MAX_CACHED_MATCHES = 64;
+
+    class SignatureCache {
+    public:
+        explicit SignatureCache(uint64_t buildKey = 0) : m_buildKey(buildKey) {}
+
+        /**
+         * @brief Identifies the build of the image in `data` (see file comment). Reads about 64 KB.
+         */
+        static uint64_t ComputeBuildKey(const uint8_t* data, const PeImage& image);
+
+        /**
+         * @brief Identifies a signature by its compiled bytes, mask and target.
+         */
+        static uint64_t HashSignature(const BytePattern& pattern, ScanTarget target);
+
+        static std::optional<SignatureCache> Load(const std::filesystem::path& path, std::string& error);
+
+        /**
+         * @brief Writes the cache through a temporary file, so a crash never leaves half a file.
+         */
+        bool Save(const std::filesystem::path& path, std::string& error) const;
+
+        uint64_t GetBuildKey() const { return m_buildKey; }
+
+        // Cached RVAs of a signature, or nullptr.
+        const std::vector<uint32_t>* Find(uint64_t signatureHash) const;
+
+        // Records the matches of a signature; empty or oversized lists are dropped.
+        void Store(uint64_t signatureHash, std::vector<uint32_t> rvas);
+
+    private:
+        uint64_t m_buildKey;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_entries;
+    };
+
+    /**
+     * @brief True if `rvas` is not empty and `pattern` matches at every RVA, inside a section of `target`.
+     */
+    bool ValidateCachedMatches(const uint8_t* data, const PeImage& image, ScanTarget target,
+                               const BytePattern& pattern, const std::vector<uint32_t>& rvas);
+
+} // namespace kx::Scanning
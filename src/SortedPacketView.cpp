@@ -0,0 +1,352 @@
+#include "SortedPacketView.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+
+namespace kx::Filtering {
+
+    namespace {
+        // Rows added since the last full sort are kept in their own run until it reaches this
+        // size or 1/16 of the main run, whichever is larger, and only then merged in.
+        constexpr std::size_t MIN_MERGE_RUN = 4096;
+        constexpr std::size_t MERGE_RUN_DIVISOR = 16;
+
+        // Rows a sort job reads from the store per reader-lock hold.
+        constexpr std::size_t SORT_GATHER_CHUNK = 16 * 1024;
+
+        int64_t GetTimestampUs(const PacketInfo& packet) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(packet.timestamp.time_since_epoch()).count();
+        }
+
+        // Capture threads can store packets slightly out of timestamp order; those count as 0.
+        uint32_t GetDeltaUs(int64_t previousUs, int64_t currentUs) {
+            return static_cast<uint32_t>(std::clamp<int64_t>(currentUs - previousUs, 0, std::numeric_limits<uint32_t>::max()));
+        }
+
+        uint32_t GetSizeKey(const PacketInfo& packet) {
+            return static_cast<uint32_t>(std::min<std::size_t>(packet.data.size(), std::numeric_limits<uint32_t>::max()));
+        }
+
+        uint64_t ComposeSortValue(SortColumn column, bool descending, uint32_t index, uint16_t opcode,
+                                  uint32_t size, uint32_t deltaUs, uint8_t direction) {
+            uint32_t key = 0;
+            switch (column) {
+            case SortColumn::TimeDelta: key = deltaUs; break;
+            case SortColumn::Direction: key = direction; break;
+            case SortColumn::Opcode:    key = (static_cast<uint32_t>(opcode) << 1) | direction; break;
+            case SortColumn::Size:      key = size; break;
+            case SortColumn::Arrival:   break;
+            }
+            if (descending) {
+                key = ~key; // Equal keys stay in arrival order either way
+            }
+            return (static_cast<uint64_t>(key) << 32) | index;
+        }
+
+        // The same value MakeSortValue() builds from the key arrays, read from the packets.
+        uint64_t ReadSortValue(const PacketStore& store, uint32_t index, SortColumn column, bool descending) {
+            const PacketInfo& packet = store[index];
+            const uint32_t deltaUs = column == SortColumn::TimeDelta && index > 0
+                ? GetDeltaUs(GetTimestampUs(store[index - 1]), GetTimestampUs(packet)) : 0;
+            return ComposeSortValue(column, descending, index, packet.rawHeaderId, GetSizeKey(packet), deltaUs,
+                                    packet.direction == PacketDirection::Sent ? 0 : 1);
+        }
+
+        double GetElapsedMs(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // Stable LSD radix sort of (key << 32 | index) values by their key, one byte per pass.
+        // A pass is skipped when every key has the same digit, so 16-bit keys cost two passes.
+        void RadixSortByKey(std::vector<uint64_t>& values, std::vector<uint64_t>& scratch) {
+            const std::size_t count = values.size();
+            if (count < 2) {
+                return;
+            }
+
+            std::array<std::array<std::size_t, 256>, 4> histograms{};
+            for (const uint64_t value : values) {
+                const uint32_t key = static_cast<uint32_t>(value >> 32);
+                histograms[0][key & 0xFF]++;
+                histograms[1][(key >> 8) & 0xFF]++;
+                histograms[2][(key >> 16) & 0xFF]++;
+                histograms[3][key >> 24]++;
+            }
+
+            scratch.resize(count);
+            uint64_t* source = values.data();
+            uint64_t* target = scratch.data();
+            for (std::size_t pass = 0; pass < 4; ++pass) {
+                const unsigned shift = 32 + static_cast<unsigned>(pass) * 8;
+                std::array<std::size_t, 256>& histogram = histograms[pass];
+                if (histogram[(source[0] >> shift) & 0xFF] == count) {
+                    continue; // All keys share this digit
+                }
+
+                std::size_t offset = 0;
+                for (std::size_t& bucket : histogram) {
+                    const std::size_t bucketSize = bucket;
+                    bucket = offset;
+                    offset += bucketSize;
+                }
+                for (std::size_t i = 0; i < count; ++i) {
+                    target[histogram[(source[i] >> shift) & 0xFF]++] = source[i];
+                }
+                std::swap(source, target);
+            }
+            if (source != values.data()) {
+                values.swap(scratch);
+            }
+        }
+    }
+
+    void SortedPacketView::SetOrder(SortColumn column, bool descending) {
+        if (column != m_column || descending != m_descending) {
+            m_column = column;
+            m_descending = descending;
+            m_orderChanged = true;
+        }
+    }
+
+    void SortedPacketView::Update(const PacketStore& store, const FilterView& view) {
+        if (store.GetGeneration() != m_storeGeneration) {
+            Reset();
+            m_storeGeneration = store.GetGeneration();
+        }
+        UpdateKeys(store, view.GetScannedCount());
+        m_viewIndices = &view.GetIndices();
+        m_rowCount = m_viewIndices->size();
+
+        if (m_job && m_job->done.load(std::memory_order_acquire)) {
+            if (!m_job->cancelled.load(std::memory_order_relaxed)) {
+                m_mainRun = std::make_shared<const std::vector<uint64_t>>(std::move(m_job->values));
+                m_newRun.clear();
+                m_lastSortMs = m_job->elapsedMs;
+            }
+            m_job.reset();
+        }
+        if (m_mergeJob && m_mergeJob->done.load(std::memory_order_acquire)) {
+            FinishMerge();
+        }
+
+        if (view.GetVersion() != m_viewVersion || m_orderChanged) {
+            m_viewVersion = view.GetVersion();
+            m_orderChanged = false;
+            StartFullSort(store);
+        }
+        else if (!m_job) {
+            AddNewRows(store);
+        }
+    }
+
+    void SortedPacketView::Reset() {
+        m_opcodes.clear();
+        m_sizes.clear();
+        m_deltaUs.clear();
+        m_directions.clear();
+        m_lastTimestampUs = 0;
+        m_storeGeneration = UINT64_MAX;
+        m_viewIndices = nullptr;
+        m_viewVersion = UINT64_MAX;
+        m_consumed = 0;
+        m_rowCount = 0;
+        m_mainRun.reset();
+        m_newRun.clear();
+        // Running jobs finish into their own buffers, which are then discarded.
+        if (m_job) {
+            m_job->cancelled.store(true, std::memory_order_relaxed);
+            m_job.reset();
+        }
+        m_mergeJob.reset();
+    }
+
+    void SortedPacketView::UpdateKeys(const PacketStore& store, std::size_t count) {
+        for (std::size_t i = m_opcodes.size(); i < count; ++i) {
+            const PacketInfo& packet = store[i];
+            const int64_t timestampUs = GetTimestampUs(packet);
+            const uint32_t deltaUs = i == 0 ? 0 : GetDeltaUs(m_lastTimestampUs, timestampUs);
+            m_lastTimestampUs = timestampUs;
+
+            m_opcodes.push_back(packet.rawHeaderId);
+            m_sizes.push_back(GetSizeKey(packet));
+            m_deltaUs.push_back(deltaUs);
+            m_directions.push_back(packet.direction == PacketDirection::Sent ? 0 : 1);
+        }
+    }
+
+    uint64_t SortedPacketView::MakeSortValue(uint32_t index) const {
+        return ComposeSortValue(m_column, m_descending, index, m_opcodes[index], m_sizes[index], m_deltaUs[index],
+                                m_directions[index]);
+    }
+
+    void SortedPacketView::StartFullSort(const PacketStore& store) {
+        m_mainRun.reset();
+        m_newRun.clear();
+        m_mergeJob.reset();
+        if (m_job) {
+            m_job->cancelled.store(true, std::memory_order_relaxed);
+            m_job.reset();
+        }
+        m_consumed = 0;
+        if (m_column == SortColumn::Arrival) {
+            return; // Rows are read straight from the view
+        }
+
+        const std::vector<uint32_t>& indices = *m_viewIndices;
+        m_consumed = indices.size();
+        if (indices.size() < ASYNC_SORT_THRESHOLD) {
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<uint64_t> values(indices.size());
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                values[i] = MakeSortValue(indices[i]);
+            }
+            RadixSortByKey(values, m_scratch);
+            m_mainRun = std::make_shared<const std::vector<uint64_t>>(std::move(values));
+            m_lastSortMs = GetElapsedMs(start);
+            return;
+        }
+
+        // The render thread only copies the indices, which is sequential; the job reads the
+        // keys itself, because gathering them by index is what costs the most. The
+        // job owns everything it touches, so a superseded job can finish after the view moved on.
+        std::shared_ptr<SortJob> job = std::make_shared<SortJob>();
+        job->indices = indices;
+        job->column = m_column;
+        job->descending = m_descending;
+        job->storeGeneration = m_storeGeneration;
+        m_job = job;
+        Threading::GetBackgroundPool().Submit([job, &store]() {
+            const auto start = std::chrono::steady_clock::now();
+            const std::size_t count = job->indices.size();
+            job->values.resize(count);
+            for (std::size_t begin = 0; begin < count; begin += SORT_GATHER_CHUNK) {
+                if (job->cancelled.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                auto lock = store.LockForReading(); // A Clear() waits for one chunk at most
+                if (store.GetGeneration() != job->storeGeneration) {
+                    job->cancelled.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                const std::size_t end = std::min(count, begin + SORT_GATHER_CHUNK);
+                for (std::size_t i = begin; i < end; ++i) {
+                    job->values[i] = ReadSortValue(store, job->indices[i], job->column, job->descending);
+                }
+            }
+            if (!job->cancelled.load(std::memory_order_relaxed)) {
+                RadixSortByKey(job->values, job->scratch);
+            }
+            job->elapsedMs = GetElapsedMs(start);
+            job->done.store(true, std::memory_order_release);
+        });
+    }
+
+    void SortedPacketView::AddNewRows(const PacketStore& store) {
+        if (m_column == SortColumn::Arrival) {
+            return;
+        }
+        const std::vector<uint32_t>& indices = *m_viewIndices;
+        const std::size_t added = indices.size() - m_consumed;
+        if (added == 0) {
+            return;
+        }
+        if (added >= ASYNC_SORT_THRESHOLD) {
+            StartFullSort(store); // E.g. the view was not updated for a while
+            return;
+        }
+
+        std::vector<uint64_t> values(added);
+        for (std::size_t i = 0; i < added; ++i) {
+            values[i] = MakeSortValue(indices[m_consumed + i]);
+        }
+        m_consumed = indices.size();
+        RadixSortByKey(values, m_scratch);
+
+        m_scratch.resize(m_newRun.size() + values.size());
+        std::merge(m_newRun.begin(), m_newRun.end(), values.begin(), values.end(), m_scratch.begin());
+        m_newRun.swap(m_scratch);
+
+        const std::size_t mainSize = m_mainRun ? m_mainRun->size() : 0;
+        if (!m_mergeJob && m_newRun.size() >= std::max(MIN_MERGE_RUN, mainSize / MERGE_RUN_DIVISOR)) {
+            StartMerge();
+        }
+    }
+
+    void SortedPacketView::StartMerge() {
+        // The job gets a copy of the second run (at most 1/16 of the rows, plus the rows of a
+        // few frames) and shares the immutable main run; rows keep being read from both meanwhile.
+        std::shared_ptr<MergeJob> job = std::make_shared<MergeJob>();
+        job->mainRun = m_mainRun;
+        job->newRun = m_newRun;
+        m_mergeJob = job;
+        Threading::GetBackgroundPool().Submit([job]() {
+            const std::size_t mainSize = job->mainRun ? job->mainRun->size() : 0;
+            job->merged.resize(mainSize + job->newRun.size());
+            if (job->mainRun) {
+                std::merge(job->mainRun->begin(), job->mainRun->end(), job->newRun.begin(), job->newRun.end(), job->merged.begin());
+            } else {
+                std::copy(job->newRun.begin(), job->newRun.end(), job->merged.begin());
+            }
+            job->done.store(true, std::memory_order_release);
+        });
+    }
+
+    void SortedPacketView::FinishMerge() {
+        // Rows added while the job ran stay in the second run. Values are unique (the low
+        // half is the store index), so removing the merged ones is a single linear pass.
+        m_scratch.resize(m_newRun.size());
+        const auto end = std::set_difference(m_newRun.begin(), m_newRun.end(),
+                                             m_mergeJob->newRun.begin(), m_mergeJob->newRun.end(), m_scratch.begin());
+        m_scratch.resize(static_cast<std::size_t>(end - m_scratch.begin()));
+        m_newRun.swap(m_scratch);
+        m_mainRun = std::make_shared<const std::vector<uint64_t>>(std::move(m_mergeJob->merged));
+        m_mergeJob.reset();
+    }
+
+    void SortedPacketView::GetRows(std::size_t first, std::size_t count, std::vector<uint32_t>& out) const {
+        out.clear();
+        if (!m_viewIndices || first >= m_rowCount) {
+            return;
+        }
+        count = std::min(count, m_rowCount - first);
+        const std::vector<uint32_t>& indices = *m_viewIndices;
+
+        // Arrival order, also shown while a background sort is running.
+        if (m_column == SortColumn::Arrival || m_job) {
+            const bool reversed = m_column == SortColumn::Arrival && m_descending;
+            for (std::size_t row = first; row < first + count; ++row) {
+                out.push_back(indices[reversed ? m_rowCount - 1 - row : row]);
+            }
+            return;
+        }
+
+        // Find how many of the first `first` rows come from the main run (binary search on
+        // the split point), then merge the two runs forward from there.
+        static const std::vector<uint64_t> noRows;
+        const std::vector<uint64_t>& mainRun = m_mainRun ? *m_mainRun : noRows;
+        const std::vector<uint64_t>& newRun = m_newRun;
+        std::size_t low = first > newRun.size() ? first - newRun.size() : 0;
+        std::size_t high = std::min(first, mainRun.size());
+        while (low < high) {
+            const std::size_t mid = low + (high - low) / 2;
+            if (newRun[first - mid - 1] > mainRun[mid]) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        std::size_t mainPos = low;
+        std::size_t newPos = first - low;
+        for (std::size_t n = 0; n < count; ++n) {
+            const bool fromMain = newPos >= newRun.size() ||
+                                  (mainPos < mainRun.size() && mainRun[mainPos] < newRun[newPos]);
+            const uint64_t value = fromMain ? mainRun[mainPos++] : newRun[newPos++];
+            out.push_back(static_cast<uint32_t>(value));
+        }
+    }
+
+} // namespace kx::Filtering
@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+ * @file SortedPacketView.h
+ * @brief The filtered packet list (FilterView) in the order chosen in the packet table.
+ * @details Sorting never reads the packet structs. Each packet's sort keys (opcode,
+ *          size, time since the previous packet, direction) are extracted once into
+ *          compact arrays parallel to the store, and the visible indices are sorted as
+ *          64-bit (key << 32 | index) values with an LSD radix sort that skips digits
+ *          all keys share. Large sorts, including reading their keys, run on the background
+ *          pool while the table keeps showing arrival order. Packets arriving after a sort
+ *          are radix-sorted into a small second run, which is merged into the main run on
+ *          the background pool once it has grown, so live traffic costs a few microseconds
+ *          per frame instead of a full re-sort; rows are read from the two runs by rank.
+ *          Render thread only.
+ */
+
+#include "FilterView.h"
+#include "PacketStore.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace kx::Filtering {
+
+    enum class SortColumn {
+        Arrival,   // Store order, i.e. capture time
+        TimeDelta, // Time since the previous captured packet
+        Direction,
+        Opcode,    // Then direction
+        Size
+    };
+
+    class SortedPacketView {
+    public:
+        // Sorts of at least this many rows run on the background pool.
+        static constexpr std::size_t ASYNC_SORT_THRESHOLD = 64 * 1024;
+
+        /**
+         * @brief Selects the row order. Takes effect at the next Update().
+         */
+        void SetOrder(SortColumn column, bool descending);
+
+        /**
+         * @brief Picks up new packets of `view` and finished background sorts.
+         * @details `view` must have been updated against `store` first.
+         */
+        void Update(const PacketStore& store, const FilterView& view);
+
+        /**
+         * @brief Drops all keys and rows, e.g. right after clearing the store.
+         */
+        void Reset();
+
+        std::size_t GetRowCount() const { return m_rowCount; }
+
+        /**
+         * @brief Store indices of rows [first, first + count), in display order.
+         */
+        void GetRows(std::size_t first, std::size_t count, std::vector<uint32_t>& out) const;
+
+        // Microseconds between the packet at `index` and the one stored before it.
+        uint32_t GetTimeDeltaUs(uint32_t index) const { return m_deltaUs[index]; }
+
+        bool IsArrivalOrder() const { return m_column == SortColumn::Arrival && !m_descending; }
+        bool IsSorting() const { return m_job != nullptr; }
+        double GetLastSortMs() const { return m_lastSortMs; }
+
+    private:
+        // Sorts `indices` by the keys it reads from the store (under its reader lock).
+        struct SortJob {
+            std::vector<uint32_t> indices;
+            SortColumn column = SortColumn::Arrival;
+            bool descending = false;
+            uint64_t storeGeneration = 0;
+            std::vector<uint64_t> values;
+            std::vector<uint64_t> scratch;
+            double elapsedMs = 0.0;
+            std::atomic<bool> cancelled{ false };
+            std::atomic<bool> done{ false };
+        };
+
+        // Merges a copy of the second run into the main run.
+        struct MergeJob {
+            std::shared_ptr<const std::vector<uint64_t>> mainRun;
+            std::vector<uint64_t> newRun;
+            std::vector<uint64_t> merged;
+            std::atomic<bool> done{ false };
+        };
+
+        void UpdateKeys(const PacketStore& store, std::size_t count);
+        uint64_t MakeSortValue(uint32_t index) const;
+        void StartFullSort(const PacketStore& store);
+        void AddNewRows(const PacketStore& store);
+        void StartMerge();
+        void FinishMerge();
+
+        // Sort keys, indexed like the store.
+        std::vector<uint16_t> m_opcodes;
+        std::vector<uint32_t> m_sizes;
+        std::vector<uint32_t> m_deltaUs;
+        std::vector<uint8_t> m_directions;
+        int64_t m_lastTimestampUs = 0;
+        uint64_t m_storeGeneration = UINT64_MAX;
+
+        SortColumn m_column = SortColumn::Arrival;
+        bool m_descending = false;
+        bool m_orderChanged = false;
+
+        const std::vector<uint32_t>* m_viewIndices = nullptr; // Indices of the FilterView last updated from
+        uint64_t m_viewVersion = UINT64_MAX;
+        std::size_t m_consumed = 0; // View indices already in a run or in the running sort
+        std::size_t m_rowCount = 0;
+
+        // Sorted (key << 32 | index) values. Immutable once built, so a merge job can read it.
+        std::shared_ptr<const std::vector<uint64_t>> m_mainRun;
+        std::vector<uint64_t> m_newRun;   // Sorted values of rows not yet merged into m_mainRun
+        std::vector<uint64_t> m_scratch;
+        std::shared_ptr<SortJob> m_job;   // Background sort in progress
+        std::shared_ptr<MergeJob> m_mergeJob;
+        double m_lastSortMs = 0.0;
+    };
+
+} // namespace kx::Filtering
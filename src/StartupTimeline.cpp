@@ -0,0 +1,99 @@
+#include "StartupTimeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace kx::Startup {
+
+    namespace {
+        std::mutex g_timelineMutex;
+        int64_t g_timelineStart = 0;
+        std::vector<StageRecord> g_stages;
+        std::vector<std::thread::id> g_threads; // Index = StageRecord::thread
+
+        int64_t Now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        double ToMs(int64_t nanoseconds) {
+            return static_cast<double>(nanoseconds) / 1e6;
+        }
+
+        // Caller holds g_timelineMutex.
+        uint32_t GetThreadIndex(std::thread::id id) {
+            const auto it = std::find(g_threads.begin(), g_threads.end(), id);
+            if (it != g_threads.end()) {
+                return static_cast<uint32_t>(it - g_threads.begin());
+            }
+            g_threads.push_back(id);
+            return static_cast<uint32_t>(g_threads.size() - 1);
+        }
+    }
+
+    void BeginTimeline() {
+        std::lock_guard<std::mutex> lock(g_timelineMutex);
+        g_timelineStart = Now();
+        g_stages.clear();
+        g_threads.clear();
+    }
+
+    ScopedStage::ScopedStage(std::string name) : m_name(std::move(name)), m_start(Now()) {}
+
+    ScopedStage::~ScopedStage() {
+        const int64_t end = Now();
+        StageRecord record;
+        {
+            std::lock_guard<std::mutex> lock(g_timelineMutex);
+            record.name = std::move(m_name);
+            record.thread = GetThreadIndex(std::this_thread::get_id());
+            record.startMs = ToMs(m_start - g_timelineStart);
+            record.durationMs = ToMs(end - m_start);
+            record.succeeded = m_succeeded;
+            g_stages.push_back(record);
+        }
+
+        char line[160];
+        std::snprintf(line, sizeof(line), "[Startup] %s: %.1f ms (from +%.1f ms, thread %u)%s",
+                      record.name.c_str(), record.durationMs, record.startMs, record.thread,
+                      record.succeeded ? "" : " - failed");
+        std::cout << line << std::endl;
+    }
+
+    std::vector<StageRecord> GetTimeline() {
+        std::vector<StageRecord> stages;
+        {
+            std::lock_guard<std::mutex> lock(g_timelineMutex);
+            stages = g_stages;
+        }
+        std::stable_sort(stages.begin(), stages.end(), [](const StageRecord& a, const StageRecord& b) {
+            return a.startMs < b.startMs;
+        });
+        return stages;
+    }
+
+    TimelineSummary GetTimelineSummary() {
+        std::lock_guard<std::mutex> lock(g_timelineMutex);
+        TimelineSummary summary;
+        summary.stageCount = g_stages.size();
+        for (const StageRecord& stage : g_stages) {
+            summary.endMs = std::max(summary.endMs, stage.startMs + stage.durationMs);
+            summary.stageSumMs += stage.durationMs;
+        }
+        return summary;
+    }
+
+    void LogTimelineSummary() {
+        const TimelineSummary summary = GetTimelineSummary();
+        char line[160];
+        std::snprintf(line, sizeof(line), "[Startup] %zu stages done after %.1f ms (%.1f ms if run one after another).",
+                      summary.stageCount, summary.endMs, summary.stageSumMs);
+        std::cout << line << std::endl;
+    }
+
+} // namespace kx::Startup
@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file StartupTimeline.h
+ * @brief Times the stages of hook initialization, including the ones that run concurrently.
+ * @details Each stage records its start (relative to BeginTimeline()), duration, result and
+ *          the thread it ran on, and logs one line when it finishes. The Status section
+ *          draws the records as a timeline, so overlapping stages are visible.
+ *          Thread-safe; nothing here depends on Windows.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kx::Startup {
+
+    struct StageRecord {
+        std::string name;
+        uint32_t thread = 0;    // 0 for the first thread that recorded a stage, 1 for the next, ...
+        double startMs = 0.0;   // Since BeginTimeline()
+        double durationMs = 0.0;
+        bool succeeded = true;
+    };
+
+    struct TimelineSummary {
+        std::size_t stageCount = 0;
+        double endMs = 0.0;      // End of the last stage to finish
+        double stageSumMs = 0.0; // What the stages would take one after another
+    };
+
+    /**
+     * @brief Sets time zero and discards the stages of an earlier initialization.
+     */
+    void BeginTimeline();
+
+    /**
+     * @brief Times the enclosing scope as one stage, recorded when it ends.
+     */
+    class ScopedStage {
+    public:
+        explicit ScopedStage(std::string name);
+        ~ScopedStage();
+
+        ScopedStage(const ScopedStage&) = delete;
+        ScopedStage& operator=(const ScopedStage&) = delete;
+
+        void SetSucceeded(bool succeeded) { m_succeeded = succeeded; }
+
+    private:
+        std::string m_name;
+        int64_t m_start;
+        bool m_succeeded = true;
+    };
+
+    // Stages in the order they started.
+    std::vector<StageRecord> GetTimeline();
+
+    TimelineSummary GetTimelineSummary();
+
+    /**
+     * @brief Logs the wall time so far against the sum of the stage times.
+     */
+    void LogTimelineSummary();
+
+} // namespace kx::Startup
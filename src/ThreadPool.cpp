@@ -0,0 +1,206 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h> // For SetThreadPriority
+#endif
+
+namespace kx::Threading {
+
+    namespace {
+        // Identifies the pool/worker the current thread belongs to, so that tasks
+        // submitted from inside a task land on the submitting worker's own deque.
+        thread_local const ThreadPool* t_currentPool = nullptr;
+        thread_local std::size_t t_workerIndex = 0;
+
+        void ApplyPriority(ThreadPriority priority) {
+#ifdef _WIN32
+            if (priority == ThreadPriority::Low) {
+                SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+            }
+#else
+            (void)priority; // Offline builds run at normal priority.
+#endif
+        }
+
+        std::mutex g_backgroundPoolMutex;
+        std::unique_ptr<ThreadPool> g_backgroundPool;
+    }
+
+    ThreadPool::ThreadPool(std::size_t threadCount, ThreadPriority priority) {
+        if (threadCount == 0) {
+            threadCount = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        m_queues.reserve(threadCount);
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        m_workers.reserve(threadCount);
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i, priority);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_stopping.store(true, std::memory_order_release);
+        }
+        m_wakeCondition.notify_all();
+
+        for (auto& worker : m_workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    void ThreadPool::Submit(std::function<void()> task) {
+        std::size_t target;
+        if (t_currentPool == this) {
+            target = t_workerIndex;
+        } else {
+            target = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        }
+
+        // Count the task before publishing it so the pending counter never underflows
+        // when a thief grabs the task before we return from here.
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_pendingTasks.fetch_add(1, std::memory_order_acq_rel);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_queues[target]->mutex);
+            m_queues[target]->tasks.push_back(std::move(task));
+        }
+        m_wakeCondition.notify_one();
+    }
+
+    bool ThreadPool::TryPopLocal(std::size_t index, std::function<void()>& task) {
+        WorkerQueue& queue = *m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.back()); // LIFO for the owner keeps caches warm
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool ThreadPool::TrySteal(std::size_t thiefIndex, std::function<void()>& task) {
+        const std::size_t queueCount = m_queues.size();
+        for (std::size_t offset = 1; offset < queueCount; ++offset) {
+            WorkerQueue& victim = *m_queues[(thiefIndex + offset) % queueCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front()); // FIFO for thieves takes the oldest (largest) work
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::WorkerLoop(std::size_t index, ThreadPriority priority) {
+        t_currentPool = this;
+        t_workerIndex = index;
+        ApplyPriority(priority);
+
+        while (true) {
+            std::function<void()> task;
+            if (TryPopLocal(index, task) || TrySteal(index, task)) {
+                m_pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+                try {
+                    task();
+                }
+                catch (...) {
+                    // A failing task must never take down the host process.
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCondition.wait(lock, [this] {
+                return m_stopping.load(std::memory_order_acquire) || m_pendingTasks.load(std::memory_order_acquire) > 0;
+            });
+            if (m_stopping.load(std::memory_order_acquire) && m_pendingTasks.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    void ThreadPool::ParallelFor(std::size_t count, std::size_t grainSize,
+                                 const std::function<void(std::size_t, std::size_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+        grainSize = std::max<std::size_t>(1, grainSize);
+        const std::size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+        struct SharedState {
+            std::atomic<std::size_t> nextChunk{ 0 };
+            std::atomic<std::size_t> finishedChunks{ 0 };
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+        auto state = std::make_shared<SharedState>();
+
+        // Chunks are claimed dynamically, so fast threads simply take more of them.
+        auto runChunks = [state, count, grainSize, chunkCount, &fn]() {
+            while (true) {
+                const std::size_t chunk = state->nextChunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= chunkCount) {
+                    return;
+                }
+                const std::size_t begin = chunk * grainSize;
+                const std::size_t end = std::min(count, begin + grainSize);
+                try {
+                    fn(begin, end);
+                }
+                catch (...) {
+                    // Swallow so the chunk still counts as finished and the caller cannot hang.
+                }
+                if (state->finishedChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == chunkCount) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->done.notify_all();
+                }
+            }
+        };
+
+        const std::size_t helpers = std::min(chunkCount - 1, m_workers.size());
+        for (std::size_t i = 0; i < helpers; ++i) {
+            Submit(runChunks);
+        }
+        runChunks();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&] {
+            return state->finishedChunks.load(std::memory_order_acquire) == chunkCount;
+        });
+    }
+
+    ThreadPool& GetBackgroundPool() {
+        std::lock_guard<std::mutex> lock(g_backgroundPoolMutex);
+        if (!g_backgroundPool) {
+            const std::size_t cores = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            g_backgroundPool = std::make_unique<ThreadPool>(std::max<std::size_t>(1, cores / 2), ThreadPriority::Low);
+        }
+        return *g_backgroundPool;
+    }
+
+    void ShutdownBackgroundPool() {
+        std::unique_ptr<ThreadPool> pool;
+        {
+            std::lock_guard<std::mutex> lock(g_backgroundPoolMutex);
+            pool = std::move(g_backgroundPool);
+        }
+        pool.reset(); // Joins the workers outside the lock
+    }
+
+} // namespace kx::Threading
@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * @file ThreadPool.h
+ * @brief A small work-stealing thread pool used for bulk analysis and other
+ *        background work that must not run on the game's threads.
+ * @details Each worker owns a task deque. Workers pop their own tasks LIFO and
+ *          steal from the front of other workers' deques when idle. The pool has
+ *          no Windows dependency apart from thread priority, so the same code is
+ *          usable from offline tooling.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kx::Threading {
+
+    enum class ThreadPriority {
+        Normal,
+        Low // Below-normal priority so in-game work never competes with the render thread
+    };
+
+    class ThreadPool {
+    public:
+        /**
+         * @brief Starts the worker threads.
+         * @param threadCount Number of workers. 0 selects the hardware concurrency.
+         * @param priority Scheduling priority applied to every worker.
+         */
+        explicit ThreadPool(std::size_t threadCount = 0, ThreadPriority priority = ThreadPriority::Normal);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief Queues a task. Tasks submitted from a worker go to that worker's own deque.
+         */
+        void Submit(std::function<void()> task);
+
+        /**
+         * @brief Runs fn(begin, end) over [0, count) split into chunks of at most grainSize.
+         * @details The calling thread participates in the work, so this is safe to call
+         *          from inside a pool task. Returns once every chunk has completed.
+         */
+        void ParallelFor(std::size_t count, std::size_t grainSize,
+                         const std::function<void(std::size_t, std::size_t)>& fn);
+
+        std::size_t GetThreadCount() const { return m_workers.size(); }
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void WorkerLoop(std::size_t index, ThreadPriority priority);
+        bool TryPopLocal(std::size_t index, std::function<void()>& task);
+        bool TrySteal(std::size_t thiefIndex, std::function<void()>& task);
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wakeCondition;
+        std::atomic<std::size_t> m_pendingTasks{ 0 };
+        std::atomic<std::size_t> m_nextQueue{ 0 };
+        std::atomic<bool> m_stopping{ false };
+    };
+
+    /**
+     * @brief Lazily created low-priority pool shared by in-game background work.
+     * @details Uses roughly half of the available cores so the game keeps the rest.
+     */
+    ThreadPool& GetBackgroundPool();
+
+    /**
+     * @brief Joins the background pool's workers. Must be called before the DLL unloads.
+     */
+    void ShutdownBackgroundPool();
+
+} // namespace kx::Threading
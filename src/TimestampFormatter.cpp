@@ -0,0 +1,103 @@
+#include "TimestampFormatter.h"
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace kx::Utils {
+
+    namespace {
+
+        constexpr int64_t SECONDS_PER_HOUR = 3600;
+        constexpr int64_t MICROS_PER_SECOND = 1000000;
+
+        // "00" "01" ... "99"
+        constexpr std::array<char, 200> DIGIT_PAIRS = [] {
+            std::array<char, 200> table{};
+            for (int i = 0; i < 100; ++i) {
+                table[i * 2] = static_cast<char>('0' + i / 10);
+                table[i * 2 + 1] = static_cast<char>('0' + i % 10);
+            }
+            return table;
+        }();
+
+        // The local hour this thread converted most recently.
+        struct LocalHourCache {
+            int64_t hourStart = INT64_MIN; // UTC seconds at the start of the local hour
+            int hour = 0;                  // Local hour of day, 0-23
+        };
+
+        thread_local LocalHourCache t_hourCache;
+
+        int64_t FloorDiv(int64_t value, int64_t divisor) {
+            const int64_t quotient = value / divisor;
+            return (value % divisor < 0) ? quotient - 1 : quotient;
+        }
+
+        void RefreshHourCache(LocalHourCache& cache, int64_t seconds) {
+            const std::time_t time = static_cast<std::time_t>(seconds);
+            std::tm localTm{};
+#ifdef _WIN32
+            const bool converted = localtime_s(&localTm, &time) == 0;
+#else
+            const bool converted = localtime_r(&time, &localTm) != nullptr;
+#endif
+            if (converted) {
+                cache.hour = localTm.tm_hour;
+                cache.hourStart = seconds - (localTm.tm_min * 60 + localTm.tm_sec);
+            } else {
+                // Outside the CRT's range; show UTC rather than garbage.
+                const int64_t secondOfDay = seconds - FloorDiv(seconds, 86400) * 86400;
+                cache.hour = static_cast<int>(secondOfDay / SECONDS_PER_HOUR);
+                cache.hourStart = seconds - secondOfDay % SECONDS_PER_HOUR;
+            }
+        }
+
+        inline char* WritePair(char* out, unsigned value) {
+            std::memcpy(out, &DIGIT_PAIRS[value * 2], 2);
+            return out + 2;
+        }
+
+    } // namespace
+
+    std::size_t FormatTimestampTo(const std::chrono::system_clock::time_point& tp, TimestampFormat format, char* out) {
+        const int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count();
+        const int64_t seconds = FloorDiv(micros, MICROS_PER_SECOND);
+        const unsigned subSecond = static_cast<unsigned>(micros - seconds * MICROS_PER_SECOND);
+
+        // Unsigned difference: one compare rejects both earlier and later hours.
+        LocalHourCache& cache = t_hourCache;
+        uint64_t intoHour = static_cast<uint64_t>(seconds) - static_cast<uint64_t>(cache.hourStart);
+        if (intoHour >= static_cast<uint64_t>(SECONDS_PER_HOUR)) {
+            RefreshHourCache(cache, seconds);
+            intoHour = static_cast<uint64_t>(seconds - cache.hourStart);
+        }
+
+        char* cursor = out;
+        cursor = WritePair(cursor, static_cast<unsigned>(cache.hour));
+        *cursor++ = ':';
+        cursor = WritePair(cursor, static_cast<unsigned>(intoHour / 60));
+        *cursor++ = ':';
+        cursor = WritePair(cursor, static_cast<unsigned>(intoHour % 60));
+        *cursor++ = '.';
+        if (format == TimestampFormat::Micros) {
+            cursor = WritePair(cursor, subSecond / 10000);
+            cursor = WritePair(cursor, (subSecond / 100) % 100);
+            cursor = WritePair(cursor, subSecond % 100);
+        } else {
+            const unsigned millis = subSecond / 1000;
+            *cursor++ = static_cast<char>('0' + millis / 100);
+            cursor = WritePair(cursor, millis % 100);
+        }
+        *cursor = '\0';
+        return static_cast<std::size_t>(cursor - out);
+    }
+
+    void AppendTimestamp(std::string& out, const std::chrono::system_clock::time_point& tp, TimestampFormat format) {
+        char buffer[TIMESTAMP_BUFFER_SIZE];
+        out.append(buffer, FormatTimestampTo(tp, format, buffer));
+    }
+
+} // namespace kx::Utils
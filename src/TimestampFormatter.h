@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file TimestampFormatter.h
+ * @brief Fast local-time formatting of packet timestamps into caller-provided buffers.
+ * @details Packets arrive in time order, so consecutive calls nearly always land in the
+ *          same local hour. Each thread caches the UTC start of the local hour it last
+ *          converted; any timestamp inside that hour is formatted with integer arithmetic
+ *          and digit-pair tables, without calling localtime_s. The cache is refreshed
+ *          when a timestamp falls outside the cached hour, which also picks up daylight
+ *          saving changes (they happen on hour boundaries).
+ */
+
+#include "AppState.h" // For TimestampFormat
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace kx::Utils {
+
+    // Enough for "HH:MM:SS.uuuuuu" plus a NUL terminator.
+    constexpr std::size_t TIMESTAMP_BUFFER_SIZE = 16;
+
+    /**
+     * @brief Formats `tp` as local "HH:MM:SS.mmm" or "HH:MM:SS.uuuuuu" into `out`.
+     * @param out Buffer of at least TIMESTAMP_BUFFER_SIZE chars; the result is NUL-terminated.
+     * @return Number of characters written, excluding the terminator.
+     */
+    std::size_t FormatTimestampTo(const std::chrono::system_clock::time_point& tp, TimestampFormat format, char* out);
+
+    /**
+     * @brief Appends the formatted timestamp to `out`.
+     */
+    void AppendTimestamp(std::string& out, const std::chrono::system_clock::time_point& tp, TimestampFormat format);
+
+} // namespace kx::Utils
@@ -0,0 +1,186 @@
+#include "TrafficStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace kx::Stats {
+
+    namespace {
+        constexpr std::size_t KEY_COUNT = 2 * 65536; // (direction << 16) | opcode
+
+        // A ring bucket packs the second it belongs to (high 32 bits) with its value
+        // (low 32 bits), so a writer can restart a stale bucket with one CAS.
+        struct Bucket {
+            std::atomic<uint64_t> packets{ 0 };
+            std::atomic<uint64_t> bytes{ 0 };
+        };
+
+        struct Slot {
+            std::atomic<uint64_t> count{ 0 };
+            std::atomic<uint64_t> totalBytes{ 0 };
+            std::atomic<uint32_t> minSize{ std::numeric_limits<uint32_t>::max() };
+            std::atomic<uint32_t> maxSize{ 0 };
+            std::array<Bucket, RING_SECONDS> ring;
+        };
+
+        std::array<std::atomic<Slot*>, KEY_COUNT> g_slots{};
+
+        // Keys in allocation order, so snapshots don't scan the whole table. Stored as key + 1; 0 means not yet written.
+        std::array<std::atomic<uint32_t>, KEY_COUNT> g_activeKeys{};
+        std::atomic<std::size_t> g_activeCount{ 0 };
+
+        const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+        uint32_t CurrentSecond() {
+            return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - g_epoch).count());
+        }
+
+        Slot* GetOrCreateSlot(uint32_t key) {
+            std::atomic<Slot*>& entry = g_slots[key];
+            Slot* slot = entry.load(std::memory_order_acquire);
+            if (slot) {
+                return slot;
+            }
+            Slot* created = new Slot();
+            if (entry.compare_exchange_strong(slot, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                const std::size_t index = g_activeCount.fetch_add(1, std::memory_order_acq_rel);
+                g_activeKeys[index].store(key + 1, std::memory_order_release);
+                return created;
+            }
+            delete created; // Another thread won the race; `slot` now holds its slot.
+            return slot;
+        }
+
+        void AddToBucket(std::atomic<uint64_t>& bucket, uint32_t second, uint64_t amount) {
+            uint64_t current = bucket.load(std::memory_order_relaxed);
+            for (;;) {
+                const uint64_t value = (static_cast<uint32_t>(current >> 32) == second)
+                    ? (current & 0xFFFFFFFFull) + amount
+                    : amount;
+                const uint64_t next = (static_cast<uint64_t>(second) << 32) | std::min<uint64_t>(value, 0xFFFFFFFFull);
+                if (bucket.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+        }
+
+        // Value of a bucket if it belongs to `second`, else 0 (it holds an older second).
+        uint32_t ReadBucket(const std::atomic<uint64_t>& bucket, uint32_t second) {
+            const uint64_t current = bucket.load(std::memory_order_relaxed);
+            return static_cast<uint32_t>(current >> 32) == second ? static_cast<uint32_t>(current) : 0;
+        }
+
+        template <typename T>
+        void StoreMin(std::atomic<T>& target, T value) {
+            T current = target.load(std::memory_order_relaxed);
+            while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+        template <typename T>
+        void StoreMax(std::atomic<T>& target, T value) {
+            T current = target.load(std::memory_order_relaxed);
+            while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+    }
+
+    void RecordPacket(PacketDirection direction, uint16_t opcode, std::size_t size) {
+        const uint32_t key = (direction == PacketDirection::Received ? 0x10000u : 0u) | opcode;
+        Slot* slot = GetOrCreateSlot(key);
+        const uint32_t size32 = static_cast<uint32_t>(std::min<std::size_t>(size, std::numeric_limits<uint32_t>::max()));
+
+        slot->count.fetch_add(1, std::memory_order_relaxed);
+        slot->totalBytes.fetch_add(size, std::memory_order_relaxed);
+        StoreMin(slot->minSize, size32);
+        StoreMax(slot->maxSize, size32);
+
+        const uint32_t second = CurrentSecond();
+        Bucket& bucket = slot->ring[second % RING_SECONDS];
+        AddToBucket(bucket.packets, second, 1);
+        AddToBucket(bucket.bytes, second, size32);
+    }
+
+    void Snapshot(std::vector<OpcodeStats>& out) {
+        out.clear();
+        const std::size_t activeCount = g_activeCount.load(std::memory_order_acquire);
+        out.reserve(activeCount);
+
+        // Rates use completed seconds only; the current one is still filling.
+        const uint32_t now = CurrentSecond();
+        for (std::size_t i = 0; i < activeCount; ++i) {
+            const uint32_t storedKey = g_activeKeys[i].load(std::memory_order_acquire);
+            if (storedKey == 0) {
+                continue; // Slot published, key not yet; picked up next snapshot
+            }
+            const uint32_t key = storedKey - 1;
+            const Slot* slot = g_slots[key].load(std::memory_order_acquire);
+
+            OpcodeStats stats;
+            stats.direction = (key & 0x10000u) ? PacketDirection::Received : PacketDirection::Sent;
+            stats.opcode = static_cast<uint16_t>(key & 0xFFFFu);
+            stats.count = slot->count.load(std::memory_order_relaxed);
+            if (stats.count == 0) {
+                continue; // Reset and not seen since
+            }
+            stats.totalBytes = slot->totalBytes.load(std::memory_order_relaxed);
+            const uint32_t minSize = slot->minSize.load(std::memory_order_relaxed);
+            stats.minSize = minSize == std::numeric_limits<uint32_t>::max() ? 0 : minSize;
+            stats.maxSize = slot->maxSize.load(std::memory_order_relaxed);
+
+            uint64_t packets10 = 0;
+            uint64_t packets60 = 0;
+            uint64_t bytes10 = 0;
+            for (std::size_t age = 1; age <= HISTORY_SECONDS && age <= now; ++age) {
+                const uint32_t second = now - static_cast<uint32_t>(age);
+                const Bucket& bucket = slot->ring[second % RING_SECONDS];
+                const uint32_t packets = ReadBucket(bucket.packets, second);
+                stats.history[HISTORY_SECONDS - age] = static_cast<float>(packets);
+                packets60 += packets;
+                if (age <= 10) {
+                    packets10 += packets;
+                    bytes10 += ReadBucket(bucket.bytes, second);
+                }
+                if (age == 1) {
+                    stats.rate1s = static_cast<float>(packets);
+                }
+            }
+            stats.rate10s = static_cast<float>(packets10) / 10.0f;
+            stats.rate60s = static_cast<float>(packets60) / 60.0f;
+            stats.byteRate10s = static_cast<float>(bytes10) / 10.0f;
+            out.push_back(stats);
+        }
+    }
+
+    void ShutdownTrafficStats() {
+        const std::size_t activeCount = g_activeCount.exchange(0, std::memory_order_acq_rel);
+        for (std::size_t i = 0; i < activeCount; ++i) {
+            g_activeKeys[i].store(0, std::memory_order_relaxed);
+        }
+        for (std::atomic<Slot*>& slot : g_slots) {
+            delete slot.exchange(nullptr, std::memory_order_acq_rel);
+        }
+    }
+
+    void Reset() {
+        const std::size_t activeCount = g_activeCount.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < activeCount; ++i) {
+            const uint32_t storedKey = g_activeKeys[i].load(std::memory_order_acquire);
+            if (storedKey == 0) {
+                continue;
+            }
+            // Slots are never freed: a capture thread may be writing to one right now.
+            Slot* slot = g_slots[storedKey - 1].load(std::memory_order_acquire);
+            slot->count.store(0, std::memory_order_relaxed);
+            slot->totalBytes.store(0, std::memory_order_relaxed);
+            slot->minSize.store(std::numeric_limits<uint32_t>::max(), std::memory_order_relaxed);
+            slot->maxSize.store(0, std::memory_order_relaxed);
+            for (Bucket& bucket : slot->ring) {
+                bucket.packets.store(0, std::memory_order_relaxed);
+                bucket.bytes.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+} // namespace kx::Stats
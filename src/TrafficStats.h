@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * @file TrafficStats.h
+ * @brief Live per-(direction, opcode) traffic statistics, independent of the packet log.
+ * @details Every captured packet is counted once at processing time, whatever the log
+ *          filters show, so the numbers describe the traffic rather than what the log
+ *          happens to hold. Pausing capture disables the hooks, so counting pauses too. Recording is O(1) and lock-free: a fixed table of
+ *          lazily allocated slots indexed by (direction << 16) | opcode, atomic
+ *          totals, and a ring of per-second buckets each tagged with its second, so
+ *          stale buckets are recognised without a sweeper thread.
+ */
+
+#include "PacketData.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kx::Stats {
+
+    // Per-second buckets kept per opcode; covers the 60 s rate window plus the current second.
+    constexpr std::size_t RING_SECONDS = 64;
+    constexpr std::size_t HISTORY_SECONDS = 60;
+
+    /**
+     * @brief Counts one packet. Any thread; called from the capture hooks.
+     */
+    void RecordPacket(PacketDirection direction, uint16_t opcode, std::size_t size);
+
+    struct OpcodeStats {
+        PacketDirection direction = PacketDirection::Sent;
+        uint16_t opcode = 0;
+        uint64_t count = 0;
+        uint64_t totalBytes = 0;
+        uint32_t minSize = 0;
+        uint32_t maxSize = 0;
+        // Packets per second over the last 1/10/60 completed seconds.
+        float rate1s = 0.0f;
+        float rate10s = 0.0f;
+        float rate60s = 0.0f;
+        float byteRate10s = 0.0f;
+        std::array<float, HISTORY_SECONDS> history{}; // Packets per completed second, oldest first
+    };
+
+    /**
+     * @brief Copies the statistics of every opcode seen so far into `out`.
+     * @details Cost is proportional to the number of distinct opcodes, not to traffic.
+     */
+    void Snapshot(std::vector<OpcodeStats>& out);
+
+    /**
+     * @brief Zeroes all counters. Packets recorded concurrently may be partly kept.
+     */
+    void Reset();
+
+    /**
+     * @brief Frees all statistics. Call after the capture hooks have been removed.
+     */
+    void ShutdownTrafficStats();
+
+} // namespace kx::Stats
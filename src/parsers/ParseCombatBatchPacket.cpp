@@ -1,12 +1,15 @@
 #include "ParseCombatBatchPacket.h"
 #include "../PacketHeaders.h"
+#include <cstring>
 #include <sstream>
 #include <iomanip>
 
 namespace kx::Parsing {
     std::optional<std::string> ParseCombatBatchPacket(const kx::PacketInfo& packet) {
         // This single parser can handle both opcodes
-        if (packet.rawHeaderId != 0x00DB && packet.rawHeaderId != 0x0032) {
+        if (packet.direction != kx::PacketDirection::Sent ||
+            (packet.rawHeaderId != static_cast<uint16_t>(kx::CMSG_HeaderId::COMBAT_ACTION_BATCH) &&
+             packet.rawHeaderId != static_cast<uint16_t>(kx::CMSG_HeaderId::INTERACTION_CLEANUP))) {
             return std::nullopt;
         }
 
@@ -6,7 +6,8 @@
 
 namespace kx::Parsing {
     std::optional<std::string> ParseSessionTickPacket(const kx::PacketInfo& packet) {
-        if (packet.rawHeaderId != static_cast<uint16_t>(kx::CMSG_HeaderId::SESSION_TICK) || packet.data.size() < 6) {
+        if (packet.direction != kx::PacketDirection::Sent ||
+            packet.rawHeaderId != static_cast<uint16_t>(kx::CMSG_HeaderId::SESSION_TICK) || packet.data.size() < 6) {
             return std::nullopt;
         }
         uint32_t timestamp;
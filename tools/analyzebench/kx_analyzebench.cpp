@@ -0,0 +1,168 @@
+/**
+ * @file kx_analyzebench.cpp
+ * @brief Measures how the bulk analyzer (BulkAnalyzer.h) scales with threads, without the game.
+ * @details Builds a set of synthetic packets, about half of them with opcodes that have a
+ *          registered parser, and runs AnalyzePackets over it on pools of 1, 2, 4 ... n
+ *          threads. As in the DLL's re-analysis, the call is made from a pool task, so a
+ *          pool of t workers analyses with t threads. For each thread count it prints the
+ *          best time of a few runs, the packet rate and the speedup over one thread.
+ *
+ *          Every report must equal the single-threaded one (names, special types and
+ *          per-opcode statistics); the exit status is 0 if they do, 1 otherwise.
+ *
+ *          Usage: kx_analyzebench [--packets n] [--threads n] [--runs n]
+ */
+
+#include "BulkAnalyzer.h"
+#include "PacketHeaders.h"
+#include "PacketParser.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using kx::PacketDirection;
+    using kx::PacketInfo;
+    using kx::Analysis::AnalysisReport;
+
+    // Payloads of 0-255 bytes; half the packets use an opcode with a parser so decoding is exercised.
+    std::vector<PacketInfo> MakePackets(std::size_t count, uint32_t seed) {
+        std::vector<std::pair<PacketDirection, uint16_t>> parsed;
+        for (const auto& [key, parser] : kx::Parsing::GetParserRegistry()) {
+            parsed.push_back(key);
+        }
+
+        std::mt19937 random(seed);
+        const auto now = std::chrono::system_clock::now();
+        std::vector<PacketInfo> packets(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            PacketInfo& packet = packets[i];
+            if (!parsed.empty() && random() % 2) {
+                const auto& [direction, opcode] = parsed[random() % parsed.size()];
+                packet.direction = direction;
+                packet.rawHeaderId = opcode;
+            } else {
+                packet.direction = random() % 2 ? PacketDirection::Sent : PacketDirection::Received;
+                packet.rawHeaderId = static_cast<uint16_t>(random() % 0x300);
+            }
+            const std::size_t size = random() % 8 == 0 ? random() % 4 : 4 + random() % 252;
+            packet.data.resize(size);
+            for (uint8_t& byte : packet.data) {
+                byte = static_cast<uint8_t>(random());
+            }
+            if (size >= 2) {
+                std::memcpy(packet.data.data(), &packet.rawHeaderId, 2); // Opcode first, as captured
+            }
+            packet.size = static_cast<int>(size);
+            packet.timestamp = now - std::chrono::milliseconds(count - i);
+            packet.id = i + 1;
+        }
+        return packets;
+    }
+
+    bool SameResults(const AnalysisReport& a, const AnalysisReport& b) {
+        if (a.nameTable != b.nameTable || a.nameIds != b.nameIds || a.specialTypes != b.specialTypes ||
+            a.changedIndices != b.changedIndices || a.opcodes.size() != b.opcodes.size() ||
+            a.decodedCount != b.decodedCount || a.unknownHeaderCount != b.unknownHeaderCount) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.opcodes.size(); ++i) {
+            const auto& x = a.opcodes[i];
+            const auto& y = b.opcodes[i];
+            if (x.direction != y.direction || x.opcode != y.opcode || x.name != y.name || x.count != y.count ||
+                x.totalBytes != y.totalBytes || x.minSize != y.minSize || x.maxSize != y.maxSize ||
+                x.decodedCount != y.decodedCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Runs the analysis from inside a pool task, like StartLogReanalysis.
+    AnalysisReport AnalyzeOnPool(const std::vector<PacketInfo>& packets, kx::Threading::ThreadPool& pool) {
+        std::promise<AnalysisReport> result;
+        std::future<AnalysisReport> future = result.get_future();
+        pool.Submit([&]() {
+            result.set_value(kx::Analysis::AnalyzePackets(packets, pool));
+        });
+        return future.get();
+    }
+
+    void PrintUsage() {
+        std::cerr << "Usage: kx_analyzebench [--packets n] [--threads n] [--runs n]\n";
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t packetCount = 1000000;
+    std::size_t maxThreads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    std::size_t runs = 3;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--packets" && i + 1 < argc) {
+            packetCount = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            maxThreads = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    const std::vector<PacketInfo> packets = MakePackets(packetCount, 1);
+    std::printf("%zu packets, %zu registered parsers, best of %zu runs\n\n",
+                packets.size(), kx::Parsing::GetParserRegistry().size(), runs);
+    std::printf("%8s %12s %14s %9s %11s\n", "threads", "time (ms)", "packets/s", "speedup", "efficiency");
+
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    AnalysisReport baseline;
+    double baselineMs = 0.0;
+    bool consistent = true;
+    for (std::size_t threads : threadCounts) {
+        kx::Threading::ThreadPool pool(threads);
+        double bestMs = 0.0;
+        for (std::size_t run = 0; run < runs; ++run) {
+            AnalysisReport report = AnalyzeOnPool(packets, pool);
+            bestMs = run == 0 ? report.elapsedMs : std::min(bestMs, report.elapsedMs);
+            if (threads == 1 && run == 0) {
+                baseline = std::move(report);
+            } else if (!SameResults(report, baseline)) {
+                std::printf("  %zu threads: report differs from the single-threaded one\n", threads);
+                consistent = false;
+            }
+        }
+        if (threads == 1) {
+            baselineMs = bestMs;
+        }
+
+        const double speedup = bestMs > 0.0 ? baselineMs / bestMs : 0.0;
+        std::printf("%8zu %12.2f %14.0f %8.2fx %10.0f%%\n", threads, bestMs,
+                    bestMs > 0.0 ? packets.size() / (bestMs / 1000.0) : 0.0, speedup,
+                    100.0 * speedup / static_cast<double>(threads));
+    }
+
+    std::printf("\n%llu decoded, %llu unknown headers, %zu opcodes, %zu chunks\n",
+                static_cast<unsigned long long>(baseline.decodedCount),
+                static_cast<unsigned long long>(baseline.unknownHeaderCount),
+                baseline.opcodes.size(), baseline.chunkCount);
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,315 @@
+/**
+ * @file kx_logbench.cpp
+ * @brief Measures the packet log's per-frame cost on the render thread, without the game.
+ * @details For synthetic logs of 10k, 100k and 1M packets (or the sizes given) the tool
+ *          runs the same calls as ImGuiManager's packet table each frame: FilterView::Update,
+ *          SortedPacketView::Update, GetRows for the ~40 rows the clipper shows and
+ *          RowTextCache::Get for each of them. It prints the average and worst frame in four
+ *          situations:
+ *
+ *          - tail:   following the end of the log while packets arrive;
+ *          - scroll: jumping to a random position every frame, so every row is a cache miss;
+ *          - filter: the frames after a filter change, until the background rebuild is done;
+ *          - sort:   the frames after sorting by size, until the background sort is done.
+ *
+ *          For comparison, "copy" is what the old GetFilteredPacketsSnapshot did every
+ *          frame: deep-copy every visible PacketInfo.
+ *
+ *          After each situation the view's indices and rows are compared with
+ *          ShouldDisplayPacket and a std::stable_sort of the store; the exit status is 0
+ *          if they all agree, 1 otherwise.
+ *
+ *          Usage: kx_logbench [--packets n[,n...]] [--frames n] [--arrivals n]
+ */
+
+#include "AppState.h"
+#include "FilterUtils.h"
+#include "FilterView.h"
+#include "PacketStore.h"
+#include "RowTextCache.h"
+#include "SortedPacketView.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using kx::PacketDirection;
+    using kx::PacketInfo;
+    using kx::PacketStore;
+    using kx::Filtering::FilterView;
+    using kx::Filtering::SortColumn;
+    using kx::Filtering::SortedPacketView;
+
+    constexpr std::size_t VISIBLE_ROWS = 40; // What the clipper shows in a typical window
+    constexpr int HEX_BYTE_LIMIT = 32;
+
+    using Clock = std::chrono::steady_clock;
+
+    double MsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    class PacketGenerator {
+    public:
+        explicit PacketGenerator(uint32_t seed) : m_random(seed), m_time(std::chrono::system_clock::now()) {}
+
+        // Payloads of 0-255 bytes over 0x300 opcodes, a few microseconds to milliseconds apart.
+        void Append(PacketStore& store, std::size_t count) {
+            std::uniform_int_distribution<int> gapUs(0, 2000);
+            for (std::size_t i = 0; i < count; ++i) {
+                PacketInfo packet;
+                packet.direction = m_random() % 2 ? PacketDirection::Sent : PacketDirection::Received;
+                packet.rawHeaderId = static_cast<uint16_t>(m_random() % 0x300);
+                packet.data.resize(m_random() % 256);
+                for (uint8_t& byte : packet.data) {
+                    byte = static_cast<uint8_t>(m_random());
+                }
+                packet.size = static_cast<int>(packet.data.size());
+                packet.name = "MSG_" + std::to_string(packet.rawHeaderId);
+                m_time += std::chrono::microseconds(gapUs(m_random));
+                packet.timestamp = m_time;
+                store.Append(std::move(packet));
+            }
+        }
+
+    private:
+        std::mt19937 m_random;
+        std::chrono::system_clock::time_point m_time;
+    };
+
+    struct FrameStats {
+        std::size_t frames = 0;
+        double totalMs = 0.0;
+        double worstMs = 0.0;
+        double wallMs = 0.0; // From the first frame to the last, including time between frames
+
+        void Add(double ms) {
+            ++frames;
+            totalMs += ms;
+            worstMs = std::max(worstMs, ms);
+        }
+        double AverageMs() const { return frames ? totalMs / static_cast<double>(frames) : 0.0; }
+    };
+
+    // The render thread's packet table, as in ImGuiManager::RenderPacketLogSection/RenderPacketTable.
+    struct PacketTable {
+        FilterView view;
+        SortedPacketView sorted;
+        kx::Utils::RowTextCache rowText;
+        std::vector<uint32_t> visibleRows;
+        std::size_t bytesTouched = 0; // Keeps the row reads from being optimised away
+
+        // One frame; `firstRow` is clamped to the last page (SIZE_MAX follows the tail).
+        double Frame(const PacketStore& store, std::size_t firstRow) {
+            const Clock::time_point start = Clock::now();
+            view.Update(store);
+            rowText.Validate(kx::g_displaySettingsVersion, HEX_BYTE_LIMIT);
+            sorted.Update(store, view);
+            const std::size_t rowCount = sorted.GetRowCount();
+            firstRow = std::min(firstRow, rowCount > VISIBLE_ROWS ? rowCount - VISIBLE_ROWS : 0);
+            sorted.GetRows(firstRow, VISIBLE_ROWS, visibleRows);
+            for (uint32_t index : visibleRows) {
+                const PacketInfo& packet = store[index];
+                const kx::Utils::RowText& text = rowText.Get(packet);
+                bytesTouched += text.timestamp.size() + text.hexPreview.size() + packet.name.size() +
+                                sorted.GetTimeDeltaUs(index);
+            }
+            return MsSince(start);
+        }
+
+        bool IsBusy() const { return view.IsRebuilding() || sorted.IsSorting(); }
+    };
+
+    // Compares the table's rows with ShouldDisplayPacket and a stable sort of the store.
+    bool CheckRows(const PacketStore& store, const PacketTable& table, SortColumn column, bool descending) {
+        std::vector<uint32_t> expected;
+        for (std::size_t i = 0; i < store.Size(); ++i) {
+            if (kx::Filtering::ShouldDisplayPacket(store[i])) {
+                expected.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        if (table.view.GetIndices() != expected) {
+            return false;
+        }
+        if (column == SortColumn::Size) {
+            std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) {
+                return descending ? store[a].data.size() > store[b].data.size()
+                                  : store[a].data.size() < store[b].data.size();
+            });
+        }
+
+        std::vector<uint32_t> rows;
+        table.sorted.GetRows(0, table.sorted.GetRowCount(), rows);
+        std::vector<uint32_t> page;
+        const std::size_t middle = rows.size() / 2;
+        table.sorted.GetRows(middle, VISIBLE_ROWS, page);
+        return rows == expected &&
+               std::equal(page.begin(), page.end(), rows.begin() + static_cast<std::ptrdiff_t>(middle));
+    }
+
+    void PrintRow(const char* situation, const FrameStats& stats, bool checked) {
+        std::printf("  %-8s %8zu %12.3f %12.3f %12.1f   %s\n", situation, stats.frames, stats.AverageMs(),
+                    stats.worstMs, stats.wallMs, checked ? "ok" : "MISMATCH");
+    }
+
+    // Renders frames until the background jobs are done (at least `minFrames`), ~1 ms apart.
+    FrameStats RunUntilIdle(PacketTable& table, const PacketStore& store, std::size_t firstRow, std::size_t minFrames) {
+        FrameStats stats;
+        const Clock::time_point start = Clock::now();
+        for (std::size_t frame = 0; frame < minFrames || table.IsBusy(); ++frame) {
+            stats.Add(table.Frame(store, firstRow));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        stats.wallMs = MsSince(start);
+        return stats;
+    }
+
+    bool RunSize(std::size_t packetCount, std::size_t frames, std::size_t arrivals) {
+        kx::g_packetDirectionFilterMode = kx::DirectionFilterMode::ShowAll;
+        kx::g_filterStateVersion++;
+
+        PacketStore store;
+        PacketGenerator generator(static_cast<uint32_t>(packetCount));
+        generator.Append(store, packetCount);
+
+        PacketTable table;
+        RunUntilIdle(table, store, SIZE_MAX, 1); // Initial scan, as when the overlay opens
+
+        std::printf("%zu packets\n", packetCount);
+        std::printf("  %-8s %8s %12s %12s %12s   %s\n", "", "frames", "avg (ms)", "worst (ms)", "wall (ms)", "rows");
+        bool ok = true;
+
+        // Tail: packets arrive every frame and the table follows them.
+        {
+            FrameStats stats;
+            const Clock::time_point start = Clock::now();
+            for (std::size_t frame = 0; frame < frames; ++frame) {
+                generator.Append(store, arrivals);
+                stats.Add(table.Frame(store, SIZE_MAX));
+            }
+            stats.wallMs = MsSince(start);
+            const bool checked = CheckRows(store, table, SortColumn::Arrival, false);
+            PrintRow("tail", stats, checked);
+            ok &= checked;
+        }
+
+        // Scroll: a new page every frame, so every row misses the text cache.
+        {
+            table.rowText.Clear();
+            std::mt19937 random(7);
+            FrameStats stats;
+            const Clock::time_point start = Clock::now();
+            for (std::size_t frame = 0; frame < frames; ++frame) {
+                stats.Add(table.Frame(store, random() % std::max<std::size_t>(1, table.sorted.GetRowCount())));
+            }
+            stats.wallMs = MsSince(start);
+            const bool checked = CheckRows(store, table, SortColumn::Arrival, false);
+            PrintRow("scroll", stats, checked);
+            ok &= checked;
+        }
+
+        // Filter: sent packets only; large logs are rebuilt on the pool while the old rows stay up.
+        {
+            kx::g_packetDirectionFilterMode = kx::DirectionFilterMode::ShowSentOnly;
+            kx::g_filterStateVersion++;
+            const FrameStats stats = RunUntilIdle(table, store, 0, 1);
+            const bool checked = CheckRows(store, table, SortColumn::Arrival, false);
+            PrintRow("filter", stats, checked);
+            ok &= checked;
+        }
+
+        // Sort: largest first; large views are sorted on the pool while the old order stays up.
+        {
+            table.sorted.SetOrder(SortColumn::Size, true);
+            const FrameStats stats = RunUntilIdle(table, store, 0, 1);
+            const bool checked = CheckRows(store, table, SortColumn::Size, true);
+            PrintRow("sort", stats, checked);
+            ok &= checked;
+        }
+
+        // Copy: the old per-frame snapshot of every visible packet, for comparison.
+        {
+            FrameStats stats;
+            const Clock::time_point start = Clock::now();
+            for (std::size_t frame = 0; frame < std::min<std::size_t>(frames, 10); ++frame) {
+                const Clock::time_point frameStart = Clock::now();
+                auto lock = store.LockForReading();
+                std::vector<PacketInfo> snapshot;
+                snapshot.reserve(table.view.GetIndices().size());
+                for (uint32_t index : table.view.GetIndices()) {
+                    snapshot.push_back(store[index]);
+                }
+                table.bytesTouched += snapshot.size();
+                stats.Add(MsSince(frameStart));
+            }
+            stats.wallMs = MsSince(start);
+            PrintRow("copy", stats, true);
+        }
+
+        std::printf("\n");
+        return ok;
+    }
+
+    std::vector<std::size_t> ParseSizes(const char* text) {
+        std::vector<std::size_t> sizes;
+        for (const char* p = text; *p;) {
+            char* end = nullptr;
+            const std::size_t size = std::strtoul(p, &end, 10);
+            if (end == p) {
+                return {};
+            }
+            sizes.push_back(size);
+            p = *end == ',' ? end + 1 : end;
+        }
+        return sizes;
+    }
+
+    void PrintUsage() {
+        std::cerr << "Usage: kx_logbench [--packets n[,n...]] [--frames n] [--arrivals n]\n";
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes = { 10000, 100000, 1000000 };
+    std::size_t frames = 200;
+    std::size_t arrivals = 50; // Packets per frame, a busy map at 60 fps
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--packets" && i + 1 < argc) {
+            sizes = ParseSizes(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--arrivals" && i + 1 < argc) {
+            arrivals = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (sizes.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::printf("%zu rows per frame, %zu arrivals per frame, %u hardware threads\n\n",
+                VISIBLE_ROWS, arrivals, std::thread::hardware_concurrency());
+    bool ok = true;
+    for (std::size_t size : sizes) {
+        ok &= RunSize(size, frames, arrivals);
+    }
+
+    kx::Threading::ShutdownBackgroundPool();
+    return ok ? 0 : 1;
+}
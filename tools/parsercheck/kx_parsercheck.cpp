@@ -0,0 +1,226 @@
+/**
+ * @file kx_parsercheck.cpp
+ * @brief Runs the parser checks (ParserHarness.h) without the game, under the sanitizers.
+ * @details Drives every registered parser with the harness's generated, layout-structured,
+ *          random, truncated and foreign inputs and prints, per parser, the inputs, decoded
+ *          packets, failures, time and heap allocations per packet. Allocations are counted
+ *          by replacing the global operator new in this executable. Built with
+ *          AddressSanitizer and UBSan (see CMakeLists.txt), an out-of-bounds read in a
+ *          parser aborts the run; kx_parserbench is the same program without sanitizers,
+ *          for timing.
+ *
+ *          --corpus reads recorded packets from a CSV or JSON lines file written by the
+ *          in-game export; they and their truncated prefixes are fed to their parsers.
+ *
+ *          The exit status is 0 if no parser threw, decoded a packet addressed to another
+ *          parser or rejected a payload its layout fully describes, 1 otherwise (2 for bad
+ *          arguments or an unreadable corpus).
+ *
+ *          Usage: kx_parsercheck [--random n] [--seed n] [--corpus file] [--corpus-packets n]
+ */
+
+#include "PacketParser.h"
+#include "ParserHarness.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define KX_SANITIZED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define KX_SANITIZED 1
+#endif
+#endif
+
+namespace {
+
+    std::atomic<uint64_t> g_allocations{ 0 };
+
+    void* CountedAllocate(std::size_t size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* block = std::malloc(size ? size : 1)) {
+            return block;
+        }
+        throw std::bad_alloc();
+    }
+
+    void PrintUsage() {
+        std::cerr << "Usage: kx_parsercheck [--random n] [--seed n] [--corpus file] [--corpus-packets n]\n";
+    }
+
+    std::optional<std::vector<uint8_t>> ParseHexBytes(std::string_view hex) {
+        if (hex.size() % 2 != 0) {
+            return std::nullopt;
+        }
+        std::vector<uint8_t> bytes(hex.size() / 2);
+        for (std::size_t i = 0; i < bytes.size(); ++i) {
+            const char* first = hex.data() + 2 * i;
+            if (std::from_chars(first, first + 2, bytes[i], 16).ptr != first + 2) {
+                return std::nullopt;
+            }
+        }
+        return bytes;
+    }
+
+    // Value of "key": in a JSON lines record written by the export (strings without quotes).
+    std::string_view FindJsonValue(std::string_view line, std::string_view key) {
+        const std::string pattern = "\"" + std::string(key) + "\":";
+        const std::size_t start = line.find(pattern);
+        if (start == std::string_view::npos) {
+            return {};
+        }
+        std::string_view value = line.substr(start + pattern.size());
+        if (value.starts_with('"')) {
+            return value.substr(1, value.find('"', 1) - 1);
+        }
+        return value.substr(0, value.find_first_of(",}"));
+    }
+
+    /**
+     * Reads the packets of a CSV or JSON lines file written by the in-game export. CSV rows
+     * are id,timestamp_us,time,direction,opcode,name,size,data; the name may contain commas,
+     * so data is taken after the last one. Only direction, opcode and data are used.
+     */
+    bool LoadCorpus(const char* path, std::vector<kx::PacketInfo>& corpus, std::string& error) {
+        std::ifstream file(path);
+        if (!file) {
+            error = "cannot open the file";
+            return false;
+        }
+        std::string line;
+        std::size_t lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty() || line.starts_with("id,")) {
+                continue;
+            }
+
+            std::string_view direction, opcode, data;
+            int opcodeBase = 10;
+            if (line.starts_with('{')) {
+                direction = FindJsonValue(line, "direction");
+                opcode = FindJsonValue(line, "opcode");
+                data = FindJsonValue(line, "data");
+            } else {
+                std::string_view rest = line;
+                std::string_view fields[5];
+                for (std::string_view& field : fields) {
+                    const std::size_t comma = rest.find(',');
+                    field = rest.substr(0, comma);
+                    rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+                }
+                direction = fields[3];
+                opcode = fields[4].starts_with("0x") ? fields[4].substr(2) : std::string_view{};
+                opcodeBase = 16;
+                const std::size_t lastComma = line.rfind(',');
+                data = lastComma == std::string::npos ? std::string_view{} : std::string_view(line).substr(lastComma + 1);
+            }
+
+            kx::PacketInfo packet;
+            uint16_t rawHeaderId = 0;
+            const std::optional<std::vector<uint8_t>> bytes = ParseHexBytes(data);
+            const bool opcodeValid = !opcode.empty() &&
+                std::from_chars(opcode.data(), opcode.data() + opcode.size(), rawHeaderId, opcodeBase).ptr ==
+                    opcode.data() + opcode.size();
+            if ((direction != "S" && direction != "R") || !opcodeValid || !bytes) {
+                error = "line " + std::to_string(lineNumber) + " is not an exported packet";
+                return false;
+            }
+            packet.direction = direction == "S" ? kx::PacketDirection::Sent : kx::PacketDirection::Received;
+            packet.rawHeaderId = rawHeaderId;
+            packet.data = *bytes;
+            packet.size = static_cast<int>(packet.data.size());
+            corpus.push_back(std::move(packet));
+        }
+        return true;
+    }
+
+} // namespace
+
+// Replaced for the whole executable, so allocations made by the parsers (and the standard
+// library on their behalf) are counted. The aligned forms keep their default definitions.
+void* operator new(std::size_t size) { return CountedAllocate(size); }
+void* operator new[](std::size_t size) { return CountedAllocate(size); }
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete[](void* block) noexcept { std::free(block); }
+void operator delete(void* block, std::size_t) noexcept { std::free(block); }
+void operator delete[](void* block, std::size_t) noexcept { std::free(block); }
+
+int main(int argc, char** argv) {
+    kx::Parsing::ParserCheckOptions options;
+    const char* corpusPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--random" && i + 1 < argc) {
+            options.randomInputs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--corpus" && i + 1 < argc) {
+            corpusPath = argv[++i];
+        } else if (arg == "--corpus-packets" && i + 1 < argc) {
+            options.maxCorpusPackets = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    options.allocationCounter = &g_allocations;
+
+    std::vector<kx::PacketInfo> corpus;
+    if (corpusPath) {
+        std::string error;
+        if (!LoadCorpus(corpusPath, corpus, error)) {
+            std::cerr << corpusPath << ": " << error << "\n";
+            return 2;
+        }
+        std::printf("%zu recorded packets from %s\n\n", corpus.size(), corpusPath);
+        options.corpus = &corpus;
+    }
+
+    const std::vector<kx::Parsing::ParserCheckResult> results = kx::Parsing::RunParserChecks(options);
+
+    std::printf("%-32s %8s %8s %10s %8s %9s %10s %12s\n", "parser", "inputs", "decoded", "structured", "corpus",
+                "failures", "ns/packet", "allocs/packet");
+    uint64_t totalFailures = 0;
+    for (const kx::Parsing::ParserCheckResult& result : results) {
+        const uint64_t failures = result.exceptions + result.contractViolations + result.layoutMismatches;
+        totalFailures += failures;
+        const double allocationsPerPacket =
+            result.inputs ? static_cast<double>(result.allocations) / static_cast<double>(result.inputs) : 0.0;
+        std::printf("%-32s %8llu %8llu %10llu %8llu %9llu %10.0f %12.2f\n", result.name.c_str(),
+                    static_cast<unsigned long long>(result.inputs), static_cast<unsigned long long>(result.decoded),
+                    static_cast<unsigned long long>(result.structuredInputs),
+                    static_cast<unsigned long long>(result.corpusInputs), static_cast<unsigned long long>(failures),
+                    result.nsPerPacket, allocationsPerPacket);
+        if (result.exceptions > 0) {
+            std::printf("  %llu exception(s)\n", static_cast<unsigned long long>(result.exceptions));
+        }
+        if (result.contractViolations > 0) {
+            std::printf("  decoded %llu packet(s) of another direction or opcode\n",
+                        static_cast<unsigned long long>(result.contractViolations));
+        }
+        if (result.layoutMismatches > 0) {
+            std::printf("  rejected %llu payload(s) its layout fully describes (%zu layout variant(s))\n",
+                        static_cast<unsigned long long>(result.layoutMismatches), result.layoutVariants);
+        }
+    }
+
+    std::printf("\n%zu parsers checked, %llu failure(s)\n", results.size(), static_cast<unsigned long long>(totalFailures));
+#ifdef KX_SANITIZED
+    std::printf("Times include sanitizer overhead; use kx_parserbench for timing.\n");
+#endif
+    return totalFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,538 @@
+/**
+ * @file kx_scancheck.cpp
+ * @brief Checks and benchmarks the byte pattern scanner (PatternSearch.h) and the
+ *        bounded-error search (FuzzySearch.h), without the game.
+ * @details --check compares FindFirst, FindAll, PatternSet::FindAll, CountMismatches and
+ *          FindApproximate with a naive scan (every position, every byte) on each code
+ *          path the CPU has (SSE2, AVX2; see Cpu::RestrictFeatures). Buffers are 0-300
+ *          bytes and a few larger sizes, at every start alignment within 64 bytes, both
+ *          random and drawn from a four-value alphabet so that anchors match often.
+ *          Patterns have random wildcards and are copied into the buffer at its first and
+ *          last possible position, so matches at both edges are covered; for the
+ *          approximate search the copies have 0 to k + 1 fixed bytes changed.
+ *          RankApproximateMatches and MeasureUniqueness are checked against a reference
+ *          ordering and histogram. Every buffer is its own heap block: kx_scancheck is
+ *          built with AddressSanitizer, which reports any read past the end. The exit
+ *          status is 0 if every result agrees with the reference, 1 otherwise.
+ *
+ *          Otherwise the tool builds a synthetic image (bytes drawn with the frequencies of
+ *          BYTE_FREQUENCY, 200 MB by default) with copies of a set of signatures placed
+ *          in it, and prints the throughput of the naive scan, FindFirst, FindAll, a
+ *          PatternSet and FindApproximate at several k per path. Time kx_scanbench, the
+ *          same program built without sanitizers.
+ *
+ *          Usage: kx_scancheck --check [--seed n]
+ *                 kx_scanbench [--megabytes n]
+ */
+
+#include "CpuFeatures.h"
+#include "FuzzySearch.h"
+#include "PatternSearch.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+    using kx::Scanning::ApproximateMatch;
+    using kx::Scanning::BytePattern;
+    using kx::Scanning::PatternSet;
+
+    struct CodePath {
+        const char* name;
+        kx::Cpu::Features allowed;
+        bool supported;
+    };
+
+    // SSE2 is the x64 baseline, so the scanner has no scalar-only path to force there.
+    std::vector<CodePath> GetCodePaths() {
+        const kx::Cpu::Features& detected = kx::Cpu::GetFeatures();
+        kx::Cpu::Features sse2 = detected;
+        sse2.avx2 = false;
+        return {
+            { "sse2", sse2, true },
+            { "avx2", detected, detected.avx2 },
+        };
+    }
+
+    void AllowAllFeatures() {
+        kx::Cpu::RestrictFeatures(kx::Cpu::Features{ true, true, true, true, true });
+    }
+
+    // --- Naive scan: the definition the scanner must agree with ---
+
+    bool MatchesNaive(const uint8_t* data, const BytePattern& pattern) {
+        for (std::size_t i = 0; i < pattern.Size(); ++i) {
+            if (pattern.mask[i] && data[i] != pattern.bytes[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::size_t> FindAllNaive(const uint8_t* data, std::size_t size, const BytePattern& pattern) {
+        std::vector<std::size_t> matches;
+        for (std::size_t position = 0; position + pattern.Size() <= size; ++position) {
+            if (MatchesNaive(data + position, pattern)) {
+                matches.push_back(position);
+            }
+        }
+        return matches;
+    }
+
+    std::size_t CountMismatchesNaive(const uint8_t* data, const BytePattern& pattern) {
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < pattern.Size(); ++i) {
+            mismatches += pattern.mask[i] && data[i] != pattern.bytes[i];
+        }
+        return mismatches;
+    }
+
+    std::size_t GetFixedBytes(const BytePattern& pattern) {
+        return static_cast<std::size_t>(std::count(pattern.mask.begin(), pattern.mask.end(), 0xFF));
+    }
+
+    // FindApproximate's documented clamp: every one of the k + 1 segments keeps a fixed byte.
+    std::size_t ClampMismatches(const BytePattern& pattern, std::size_t maxMismatches) {
+        return std::min({ maxMismatches, kx::Scanning::MAX_FUZZY_MISMATCHES, GetFixedBytes(pattern) - 1 });
+    }
+
+    std::vector<ApproximateMatch> FindApproximateNaive(const uint8_t* data, std::size_t size, const BytePattern& pattern,
+                                                       std::size_t maxMismatches) {
+        maxMismatches = ClampMismatches(pattern, maxMismatches);
+        std::vector<ApproximateMatch> matches;
+        for (std::size_t position = 0; position + pattern.Size() <= size; ++position) {
+            const std::size_t mismatches = CountMismatchesNaive(data + position, pattern);
+            if (mismatches <= maxMismatches) {
+                matches.push_back({ position, mismatches });
+            }
+        }
+        return matches;
+    }
+
+    bool SameMatches(const std::vector<ApproximateMatch>& a, const std::vector<ApproximateMatch>& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const ApproximateMatch& x, const ApproximateMatch& y) {
+            return x.offset == y.offset && x.mismatches == y.mismatches;
+        });
+    }
+
+    // --- Checks ---
+
+    class Checker {
+    public:
+        explicit Checker(uint32_t seed) : m_random(seed) {}
+
+        std::size_t GetChecks() const { return m_checks; }
+        std::size_t GetFailures() const { return m_failures; }
+
+        // Runs every check on a buffer of `size` bytes starting `alignment` bytes into its heap block.
+        void CheckBuffer(std::size_t size, std::size_t alignment, bool smallAlphabet) {
+            // Exactly alignment + size bytes, so AddressSanitizer catches reads past the end.
+            std::vector<uint8_t> block(alignment + size);
+            uint8_t* data = block.data() + alignment;
+            for (std::size_t i = 0; i < size; ++i) {
+                data[i] = static_cast<uint8_t>(smallAlphabet ? m_random() % 4 : m_random());
+            }
+
+            std::vector<BytePattern> patterns;
+            const std::size_t patternCount = 1 + m_random() % (PatternSet::MAX_SIMD_PATTERNS + 4);
+            for (std::size_t k = 0; k < patternCount; ++k) {
+                patterns.push_back(MakePattern(data, size, smallAlphabet));
+            }
+            // Put the first two patterns at the very start and the very end of the buffer.
+            PlaceAt(data, size, patterns[0], 0);
+            if (patterns.size() > 1 && size >= patterns[1].Size()) {
+                PlaceAt(data, size, patterns[1], size - patterns[1].Size());
+            }
+
+            PatternSet set;
+            for (const BytePattern& pattern : patterns) {
+                const std::vector<std::size_t> expected = FindAllNaive(data, size, pattern);
+                Expect(kx::Scanning::FindAll(data, size, pattern) == expected, "FindAll", size, alignment, pattern);
+                const std::optional<std::size_t> first = kx::Scanning::FindFirst(data, size, pattern);
+                Expect(expected.empty() ? !first : first == expected.front(), "FindFirst", size, alignment, pattern);
+                set.Add(pattern);
+            }
+
+            const std::vector<std::vector<std::size_t>> setResults = set.FindAll(data, size);
+            bool setOk = setResults.size() == patterns.size();
+            for (std::size_t k = 0; setOk && k < patterns.size(); ++k) {
+                setOk = setResults[k] == FindAllNaive(data, size, patterns[k]);
+            }
+            Expect(setOk, patterns.size() > PatternSet::MAX_SIMD_PATTERNS ? "PatternSet (table sweep)" : "PatternSet",
+                   size, alignment, patterns[0]);
+        }
+
+        void CheckParse() {
+            struct Case {
+                const char* text;
+                bool valid;
+                std::size_t size;
+            };
+            static constexpr Case CASES[] = {
+                { "48 8B ? ?? 05", true, 5 },
+                { "  e8\t?  ff ", true, 3 },
+                { "90", true, 1 },
+                { "", false, 0 },
+                { "? ??", false, 0 },   // No fixed byte
+                { "48 8B0", false, 0 }, // Three digits
+                { "48 G1", false, 0 },
+                { "48 8B ???", false, 0 },
+            };
+            for (const Case& c : CASES) {
+                const std::optional<BytePattern> pattern = BytePattern::Parse(c.text);
+                ++m_checks;
+                if (pattern.has_value() != c.valid || (pattern && pattern->Size() != c.size)) {
+                    ++m_failures;
+                    std::printf("    Parse(\"%s\") should %s\n", c.text, c.valid ? "succeed" : "fail");
+                }
+            }
+        }
+
+        // FindApproximate and CountMismatches on a buffer like CheckBuffer's, with near copies of the pattern.
+        void CheckApproximate(std::size_t size, std::size_t alignment, bool smallAlphabet) {
+            std::vector<uint8_t> block(alignment + size);
+            uint8_t* data = block.data() + alignment;
+            for (std::size_t i = 0; i < size; ++i) {
+                data[i] = static_cast<uint8_t>(smallAlphabet ? m_random() % 4 : m_random());
+            }
+
+            // Also past MAX_FUZZY_MISMATCHES and past the fixed byte count, to cover the clamp.
+            const std::size_t maxMismatches = m_random() % (kx::Scanning::MAX_FUZZY_MISMATCHES + 3);
+            const BytePattern pattern = MakePattern(data, size, smallAlphabet);
+            const std::size_t k = ClampMismatches(pattern, maxMismatches);
+            if (size >= pattern.Size()) {
+                PlaceNear(data, pattern, 0, m_random() % (k + 2));
+                PlaceNear(data, pattern, size - pattern.Size(), m_random() % (k + 2));
+                PlaceNear(data, pattern, m_random() % (size - pattern.Size() + 1), k);
+            }
+
+            const std::vector<ApproximateMatch> expected = FindApproximateNaive(data, size, pattern, maxMismatches);
+            Expect(SameMatches(kx::Scanning::FindApproximate(data, size, pattern, maxMismatches), expected),
+                   "FindApproximate", size, alignment, pattern);
+
+            bool countsOk = true;
+            for (std::size_t position = 0; position + pattern.Size() <= size; ++position) {
+                countsOk &= kx::Scanning::CountMismatches(data + position, pattern) == CountMismatchesNaive(data + position, pattern);
+            }
+            Expect(countsOk, "CountMismatches", size, alignment, pattern);
+
+            CheckUniqueness(pattern, maxMismatches, expected);
+        }
+
+        void CheckUniqueness(const BytePattern& pattern, std::size_t maxMismatches, const std::vector<ApproximateMatch>& matches) {
+            const kx::Scanning::SignatureUniqueness uniqueness = kx::Scanning::MeasureUniqueness(pattern, maxMismatches, matches);
+            std::array<std::size_t, kx::Scanning::MAX_FUZZY_MISMATCHES + 1> histogram{};
+            std::size_t near = 0;
+            const std::size_t k = ClampMismatches(pattern, maxMismatches);
+            for (const ApproximateMatch& match : matches) {
+                if (match.mismatches <= k) {
+                    histogram[match.mismatches]++;
+                    near += match.mismatches > 0;
+                }
+            }
+            Expect(uniqueness.fixedBytes == GetFixedBytes(pattern) && uniqueness.maxMismatches == k &&
+                   uniqueness.matchesAtDistance == histogram && uniqueness.GetNearMatchCount() == near,
+                   "MeasureUniqueness", 0, 0, pattern);
+        }
+
+        // Ordering cases written out by hand, then random lists against a reference comparison.
+        void CheckRanking() {
+            struct Case {
+                std::vector<ApproximateMatch> matches;
+                std::optional<std::size_t> hint;
+                std::vector<std::size_t> expectedOffsets;
+            };
+            const Case cases[] = {
+                { {}, std::nullopt, {} },
+                { { { 50, 1 }, { 10, 2 }, { 30, 0 } }, std::nullopt, { 30, 50, 10 } },
+                { { { 300, 1 }, { 100, 1 }, { 200, 1 } }, std::nullopt, { 100, 200, 300 } },
+                { { { 300, 1 }, { 100, 1 }, { 200, 1 } }, 290, { 300, 200, 100 } },
+                { { { 90, 1 }, { 110, 1 }, { 100, 2 } }, 100, { 90, 110, 100 } },      // Equal distance: lower offset first
+                { { { 0, 0 }, { 1000, 1 }, { 999, 1 } }, 1000, { 0, 1000, 999 } },     // Mismatches before distance
+                { { { 5, 3 }, { SIZE_MAX, 3 } }, SIZE_MAX, { SIZE_MAX, 5 } },
+            };
+            for (const Case& c : cases) {
+                std::vector<ApproximateMatch> matches = c.matches;
+                kx::Scanning::RankApproximateMatches(matches, c.hint);
+                std::vector<std::size_t> offsets;
+                for (const ApproximateMatch& match : matches) {
+                    offsets.push_back(match.offset);
+                }
+                ++m_checks;
+                if (offsets != c.expectedOffsets) {
+                    ++m_failures;
+                    std::printf("    RankApproximateMatches: wrong order for a %zu-match case\n", c.matches.size());
+                }
+            }
+
+            for (int round = 0; round < 200; ++round) {
+                std::vector<ApproximateMatch> matches(m_random() % 40);
+                for (ApproximateMatch& match : matches) {
+                    match = { m_random() % 64, m_random() % 4 };
+                }
+                const std::optional<std::size_t> hint =
+                    round % 3 == 0 ? std::nullopt : std::optional<std::size_t>(m_random() % 64);
+                std::vector<ApproximateMatch> expected = matches;
+                std::stable_sort(expected.begin(), expected.end(), [&](const ApproximateMatch& a, const ApproximateMatch& b) {
+                    auto key = [&](const ApproximateMatch& m) {
+                        const std::size_t distance = hint ? (m.offset > *hint ? m.offset - *hint : *hint - m.offset) : 0;
+                        return std::tuple(m.mismatches, distance, m.offset);
+                    };
+                    return key(a) < key(b);
+                });
+                kx::Scanning::RankApproximateMatches(matches, hint);
+                ++m_checks;
+                if (!SameMatches(matches, expected)) {
+                    ++m_failures;
+                    std::printf("    RankApproximateMatches differs from the reference order (round %d)\n", round);
+                }
+            }
+        }
+
+    private:
+        // Copies the pattern to `position` with `changes` of its fixed bytes altered.
+        void PlaceNear(uint8_t* data, const BytePattern& pattern, std::size_t position, std::size_t changes) {
+            std::vector<std::size_t> fixed;
+            for (std::size_t i = 0; i < pattern.Size(); ++i) {
+                if (pattern.mask[i]) {
+                    data[position + i] = pattern.bytes[i];
+                    fixed.push_back(i);
+                }
+            }
+            std::shuffle(fixed.begin(), fixed.end(), m_random);
+            for (std::size_t c = 0; c < std::min(changes, fixed.size()); ++c) {
+                data[position + fixed[c]] = static_cast<uint8_t>(pattern.bytes[fixed[c]] + 1 + m_random() % 255);
+            }
+        }
+
+        // 1-40 bytes, ~30% wildcards, usually copied from the buffer so it has at least one match.
+        BytePattern MakePattern(const uint8_t* data, std::size_t size, bool smallAlphabet) {
+            const std::size_t length = 1 + m_random() % 40;
+            std::vector<uint8_t> bytes(length);
+            std::vector<uint8_t> mask(length);
+            const bool copy = size >= length && m_random() % 4 != 0;
+            const std::size_t source = copy ? m_random() % (size - length + 1) : 0;
+            for (std::size_t i = 0; i < length; ++i) {
+                bytes[i] = copy ? data[source + i] : static_cast<uint8_t>(smallAlphabet ? m_random() % 4 : m_random());
+                mask[i] = m_random() % 10 < 3 ? 0x00 : 0xFF;
+            }
+            mask[m_random() % length] = 0xFF;
+            return *BytePattern::Create(std::move(bytes), std::move(mask));
+        }
+
+        void PlaceAt(uint8_t* data, std::size_t size, const BytePattern& pattern, std::size_t position) {
+            if (position + pattern.Size() > size) {
+                return;
+            }
+            for (std::size_t i = 0; i < pattern.Size(); ++i) {
+                if (pattern.mask[i]) {
+                    data[position + i] = pattern.bytes[i];
+                }
+            }
+        }
+
+        void Expect(bool ok, const char* what, std::size_t size, std::size_t alignment, const BytePattern& pattern) {
+            ++m_checks;
+            if (ok) {
+                return;
+            }
+            if (++m_failures <= 10) {
+                std::printf("    %s differs from the naive scan: %zu bytes at alignment %zu, pattern %s\n", what, size,
+                            alignment, pattern.ToString().c_str());
+            }
+        }
+
+        std::mt19937 m_random;
+        std::size_t m_checks = 0;
+        std::size_t m_failures = 0;
+    };
+
+    bool RunChecks(uint32_t seed) {
+        bool ok = true;
+        for (const CodePath& path : GetCodePaths()) {
+            if (!path.supported) {
+                std::printf("%-6s skipped (not supported by this CPU)\n", path.name);
+                continue;
+            }
+            kx::Cpu::RestrictFeatures(path.allowed);
+
+            Checker checker(seed);
+            checker.CheckParse();
+            checker.CheckRanking();
+            for (std::size_t size = 0; size <= 300; ++size) {
+                for (std::size_t alignment = 0; alignment < 64; alignment += (size < 100 ? 1 : 13)) {
+                    checker.CheckBuffer(size, alignment, size % 2 == 0);
+                    checker.CheckApproximate(size, alignment, size % 2 == 0);
+                }
+            }
+            for (std::size_t size : { 4095, 4096, 65537 }) {
+                for (std::size_t alignment : { 0, 1, 31, 33 }) {
+                    checker.CheckBuffer(size, alignment, false);
+                    checker.CheckBuffer(size, alignment, true);
+                    checker.CheckApproximate(size, alignment, false);
+                }
+            }
+            std::printf("%-6s %zu checks, %zu failure(s)\n", path.name, checker.GetChecks(), checker.GetFailures());
+            ok &= checker.GetFailures() == 0;
+        }
+        AllowAllFeatures();
+        return ok;
+    }
+
+    // --- Benchmark ---
+
+    // Signatures of the kind the DLL scans for (Config.h style), placed in the synthetic image.
+    constexpr const char* BENCH_SIGNATURES[] = {
+        "40 ? 48 83 EC ? 48 8D ? ? ? 48 89 ? ? 48 89 ? ? 48 89 ? ? 4C 89 ? ? 48 8B ? ? ? ? ? 48 33 ? 48 89 ? ? 48 8B ? E8",
+        "48 89 5C 24 ? 4C 89 44 24 ? 55 56 57 41 54 41 55 41 56 41 57 48 8B EC 48 83 EC ? 8B 82",
+        "48 8B 0D ? ? ? ? 48 85 C9 74 ? E8 ? ? ? ? 84 C0",
+        "E8 ? ? ? ? 48 8B D8 48 85 C0 0F 84 ? ? ? ? 8B 48 10",
+        "4C 8D 05 ? ? ? ? 48 8D 15 ? ? ? ? 48 8B CB FF 15",
+        "F3 0F 10 05 ? ? ? ? 0F 2F C1 76 ? 0F 28 C8",
+        "41 B8 ? ? ? ? 48 8D 54 24 ? 49 8B CE E8 ? ? ? ? 85 C0 78",
+        "66 0F 6F 05 ? ? ? ? F3 0F 7F 44 24 ? C6 44 24 ? 01",
+    };
+
+    // Bytes drawn with weights that follow BYTE_FREQUENCY (log-scaled), so anchors are about as rare as in .text.
+    std::vector<uint8_t> MakeSyntheticImage(std::size_t size, const std::vector<BytePattern>& patterns) {
+        std::vector<double> weights(256);
+        for (std::size_t value = 0; value < 256; ++value) {
+            weights[value] = std::exp2(static_cast<double>(kx::Scanning::BYTE_FREQUENCY[value]) / 16.0);
+        }
+        std::discrete_distribution<int> distribution(weights.begin(), weights.end());
+        std::mt19937 random(1);
+        std::vector<uint8_t> image(size);
+        for (uint8_t& byte : image) {
+            byte = static_cast<uint8_t>(distribution(random));
+        }
+        // One copy of each signature, spread over the last quarter so FindFirst scans most of the image.
+        for (std::size_t k = 0; k < patterns.size(); ++k) {
+            const BytePattern& pattern = patterns[k];
+            const std::size_t position = size - size / 4 + (k * (size / 4 - pattern.Size())) / patterns.size();
+            for (std::size_t i = 0; i < pattern.Size(); ++i) {
+                image[position + i] = pattern.mask[i] ? pattern.bytes[i] : static_cast<uint8_t>(random());
+            }
+        }
+        return image;
+    }
+
+    template <typename Run>
+    double MeasureGbPerSecond(std::size_t bytes, const Run& run) {
+        double best = 0.0;
+        for (int round = 0; round < 3; ++round) {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = std::max(best, seconds > 0.0 ? static_cast<double>(bytes) / seconds / 1e9 : 0.0);
+        }
+        return best;
+    }
+
+    void RunBenchmark(std::size_t megabytes) {
+        std::vector<BytePattern> patterns;
+        for (const char* text : BENCH_SIGNATURES) {
+            patterns.push_back(*BytePattern::Parse(text));
+        }
+        const std::size_t size = megabytes << 20;
+        const std::vector<uint8_t> image = MakeSyntheticImage(size, patterns);
+        const uint8_t* data = image.data();
+        std::size_t sink = 0;
+
+        std::printf("%zu MB synthetic image, %zu signatures, GB/s (best of 3)\n\n", megabytes, patterns.size());
+        std::printf("%-36s %8s\n", "", "GB/s");
+        std::printf("%-36s %8.2f\n", "naive scan, 1 signature", MeasureGbPerSecond(size, [&]() {
+            sink += FindAllNaive(data, size, patterns[0]).size();
+        }));
+        std::printf("%-36s %8.2f\n", "naive approximate scan, k = 3", MeasureGbPerSecond(size, [&]() {
+            sink += FindApproximateNaive(data, size, patterns[0], 3).size();
+        }));
+
+        PatternSet set;
+        for (const BytePattern& pattern : patterns) {
+            set.Add(pattern);
+        }
+        PatternSet largeSet = set; // Past MAX_SIMD_PATTERNS: the table sweep
+        for (const BytePattern& pattern : patterns) {
+            std::vector<uint8_t> bytes = pattern.bytes;
+            bytes.back() ^= 0x5A;
+            largeSet.Add(*BytePattern::Create(std::move(bytes), pattern.mask));
+        }
+
+        for (const CodePath& path : GetCodePaths()) {
+            if (!path.supported) {
+                std::printf("%s: skipped (not supported by this CPU)\n", path.name);
+                continue;
+            }
+            kx::Cpu::RestrictFeatures(path.allowed);
+            char label[64];
+            std::snprintf(label, sizeof(label), "%s FindFirst, 1 signature", path.name);
+            std::printf("%-36s %8.2f\n", label, MeasureGbPerSecond(size, [&]() {
+                sink += kx::Scanning::FindFirst(data, size, patterns[0]).value_or(0);
+            }));
+            std::snprintf(label, sizeof(label), "%s FindAll, 1 signature", path.name);
+            std::printf("%-36s %8.2f\n", label, MeasureGbPerSecond(size, [&]() {
+                sink += kx::Scanning::FindAll(data, size, patterns[0]).size();
+            }));
+            std::snprintf(label, sizeof(label), "%s PatternSet, %zu signatures", path.name, set.Size());
+            std::printf("%-36s %8.2f\n", label, MeasureGbPerSecond(size, [&]() {
+                sink += set.FindAll(data, size).size();
+            }));
+            std::snprintf(label, sizeof(label), "%s PatternSet, %zu signatures", path.name, largeSet.Size());
+            std::printf("%-36s %8.2f\n", label, MeasureGbPerSecond(size, [&]() {
+                sink += largeSet.FindAll(data, size).size();
+            }));
+            for (std::size_t k : { std::size_t{ 1 }, std::size_t{ 3 }, kx::Scanning::MAX_FUZZY_MISMATCHES }) {
+                std::snprintf(label, sizeof(label), "%s FindApproximate, k = %zu", path.name, k);
+                std::printf("%-36s %8.2f\n", label, MeasureGbPerSecond(size, [&]() {
+                    sink += kx::Scanning::FindApproximate(data, size, patterns[0], k).size();
+                }));
+            }
+        }
+        AllowAllFeatures();
+        std::printf("\n(%zu)\n", sink);
+    }
+
+    void PrintUsage() {
+        std::cerr << "Usage: kx_scancheck --check [--seed n]\n"
+                     "       kx_scanbench [--megabytes n]\n";
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool check = false;
+    uint32_t seed = 1;
+    std::size_t megabytes = 200;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--check") {
+            check = true;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--megabytes" && i + 1 < argc) {
+            megabytes = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (check) {
+        return RunChecks(seed) ? 0 : 1;
+    }
+    RunBenchmark(megabytes);
+    return 0;
+}
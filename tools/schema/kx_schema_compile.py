@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+# Compiles message schemas into the binary catalogue loaded by KXPacketInspector
+# (kx_schema.bin next to the DLL). The inspector reloads the file when it changes,
+# so protocol discoveries no longer need a rebuild and re-injection.
+#
+# Part of the kx-packet-inspector project.
+#
+# Inputs are merged in order; later inputs override names and fields of earlier ones.
+#   *.json  Hand-written catalogue (see example_catalog.json):
+#           { "messages": [ { "direction": "CMSG", "opcode": "0x0002",
+#                             "name": "PERFORMANCE_RESPONSE",
+#                             "fields": [ { "type": "short", "name": "header" },
+#                                         { "type": "0x0F", "children": [ ... ] } ] } ] }
+#           "type" is a typecode (number or "0x..") or a type name from the dumps.
+#           "count" and "elementSize" are optional. An entry without "fields" only
+#           renames the message and keeps fields from earlier inputs.
+#   *.md    Schema dumps written by tools/cheat-engine/KX_CMSG_Full_Schema_Decoder.lua
+#           ("## CMSG 0x0004" sections with "| 4.2.0 | `0x09` | ..." rows).
+#
+# Usage:
+#   python kx_schema_compile.py -o kx_schema.bin CMSG_Complete_Schema_Layout.md names.json
+#   python kx_schema_compile.py --dump kx_schema.bin
+#
+# The binary layout is documented in src/SchemaCatalog.h.
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"KXSC"
+FORMAT_VERSION = 1
+NO_NAME = 0xFFFFFFFF
+HEADER = struct.Struct("<4sHHIII")
+MESSAGE = struct.Struct("<BBHIII")
+FIELD = struct.Struct("<B3xIIIII")
+
+TYPE_NAMES = {
+    0x01: "short", 0x02: "byte", 0x03: "short", 0x04: "compressed_int",
+    0x05: "long long", 0x06: "float", 0x07: "float[2]", 0x08: "float[3]",
+    0x09: "float[4]", 0x0A: "special_vec3_and_compressed_int", 0x0B: "float[4]",
+    0x0C: "guid", 0x0D: "string", 0x0E: "string_utf8", 0x0F: "Optional Block",
+    0x10: "Fixed Array", 0x11: "Variable Array (byte count)",
+    0x12: "Variable Array (short count)", 0x13: "Fixed Buffer",
+    0x14: "Variable Buffer (byte count)", 0x15: "Variable Buffer (short count)",
+    0x16: "MP_SRV_ALIGN", 0x17: "float", 0x19: "float", 0x1A: "long long",
+}
+# First typecode wins for names shared by several typecodes.
+TYPECODES_BY_NAME = {}
+for _code, _name in sorted(TYPE_NAMES.items()):
+    TYPECODES_BY_NAME.setdefault(_name.lower(), _code)
+SUB_SCHEMA_TYPES = {0x0F, 0x10, 0x11, 0x12}
+
+DIRECTIONS = {"CMSG": 0, "SENT": 0, "SMSG": 1, "RECEIVED": 1}
+
+
+class SchemaError(Exception):
+    pass
+
+
+def parse_int(value, what):
+    if isinstance(value, int):
+        return value
+    try:
+        return int(str(value), 0)
+    except ValueError:
+        raise SchemaError(f"Invalid {what}: {value!r}")
+
+
+def parse_type(value):
+    if isinstance(value, str) and value.lower() in TYPECODES_BY_NAME:
+        return TYPECODES_BY_NAME[value.lower()]
+    code = parse_int(value, "field type")
+    if code not in TYPE_NAMES:
+        raise SchemaError(f"Unknown typecode 0x{code:02X}")
+    return code
+
+
+def make_field(code, name="", count=0, element_size=0):
+    return {"type": code, "name": name, "count": count, "elementSize": element_size, "children": []}
+
+
+def parse_json_field(raw):
+    field = make_field(parse_type(raw["type"]), raw.get("name", ""),
+                       parse_int(raw.get("count", 0), "count"),
+                       parse_int(raw.get("elementSize", 0), "elementSize"))
+    field["children"] = [parse_json_field(child) for child in raw.get("children", [])]
+    if field["children"] and field["type"] not in SUB_SCHEMA_TYPES:
+        raise SchemaError(f"Type 0x{field['type']:02X} cannot have children")
+    return field
+
+
+def load_json(path, messages):
+    with open(path, "r", encoding="utf-8") as f:
+        document = json.load(f)
+    for raw in document.get("messages", []):
+        direction = DIRECTIONS.get(str(raw.get("direction", "")).upper())
+        if direction is None:
+            raise SchemaError(f"{path}: invalid direction {raw.get('direction')!r}")
+        key = (direction, parse_int(raw["opcode"], "opcode") & 0xFFFF)
+        entry = messages.setdefault(key, {"name": "", "fields": []})
+        if "name" in raw:
+            entry["name"] = raw["name"]
+        if "fields" in raw:
+            entry["fields"] = [parse_json_field(field) for field in raw["fields"]]
+
+
+SECTION_RE = re.compile(r"^##\s+(CMSG|SMSG)\s+(0x[0-9A-Fa-f]+)")
+ROW_RE = re.compile(r"^\|\s*([0-9.]+)\s*\|\s*`(0x[0-9A-Fa-f]+)`")
+
+
+def load_markdown(path, messages):
+    current = None
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f:
+            section = SECTION_RE.match(line)
+            if section:
+                key = (DIRECTIONS[section.group(1)], int(section.group(2), 16) & 0xFFFF)
+                current = messages.setdefault(key, {"name": "", "fields": []})
+                current["fields"] = []
+                continue
+            row = ROW_RE.match(line)
+            if not row or current is None:
+                continue
+            # "4.2.0" is the first child of field 2 inside top-level field 4.
+            indices = [int(part) for part in row.group(1).split(".")]
+            siblings = current["fields"]
+            for index in indices[:-1]:
+                if index >= len(siblings):
+                    raise SchemaError(f"{path}: row {row.group(1)} has no parent")
+                siblings = siblings[index]["children"]
+            if indices[-1] != len(siblings):
+                raise SchemaError(f"{path}: row {row.group(1)} is out of order")
+            siblings.append(make_field(parse_type(row.group(2))))
+
+
+def build_catalog(messages):
+    strings = bytearray()
+    string_offsets = {}
+
+    def add_string(s):
+        if not s:
+            return NO_NAME
+        if s not in string_offsets:
+            string_offsets[s] = len(strings)
+            strings.extend(s.encode("utf-8") + b"\0")
+        return string_offsets[s]
+
+    fields = []  # Flattened; a field's children are always placed after it
+
+    def place(field_list):
+        first = len(fields)
+        fields.extend([None] * len(field_list))
+        for i, field in enumerate(field_list):
+            child_first, child_count = place(field["children"]) if field["children"] else (0, 0)
+            fields[first + i] = FIELD.pack(field["type"], field["count"], field["elementSize"],
+                                           add_string(field["name"]), child_first, child_count)
+        return first, len(field_list)
+
+    message_entries = []
+    for (direction, opcode), entry in sorted(messages.items()):
+        if not entry["name"] and not entry["fields"]:
+            continue  # e.g. "No schema defined" sections of a dump
+        first, count = place(entry["fields"]) if entry["fields"] else (0, 0)
+        message_entries.append(MESSAGE.pack(direction, 0, opcode, add_string(entry["name"]), first, count))
+
+    header = HEADER.pack(MAGIC, FORMAT_VERSION, 0, len(message_entries), len(fields), len(strings))
+    return header + b"".join(message_entries) + b"".join(fields) + bytes(strings)
+
+
+def dump(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, _, message_count, field_count, string_size = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or version != FORMAT_VERSION:
+        raise SchemaError(f"{path}: not a version {FORMAT_VERSION} schema catalogue")
+    field_base = HEADER.size + message_count * MESSAGE.size
+    string_base = field_base + field_count * FIELD.size
+
+    def name_at(offset):
+        if offset == NO_NAME:
+            return ""
+        end = data.index(b"\0", string_base + offset)
+        return data[string_base + offset:end].decode("utf-8")
+
+    def print_fields(first, count, prefix, depth):
+        for i in range(count):
+            code, cnt, elem, name_offset, child_first, child_count = FIELD.unpack_from(data, field_base + (first + i) * FIELD.size)
+            path = f"{prefix}{i}"
+            extra = f" count={cnt}" if cnt else ""
+            extra += f" elementSize={elem}" if elem else ""
+            print(f"{'  ' * (depth + 1)}{path} 0x{code:02X} {TYPE_NAMES.get(code, 'unknown')} {name_at(name_offset)}{extra}".rstrip())
+            print_fields(child_first, child_count, path + ".", depth + 1)
+
+    for m in range(message_count):
+        direction, _, opcode, name_offset, first, count = MESSAGE.unpack_from(data, HEADER.size + m * MESSAGE.size)
+        print(f"{'CMSG' if direction == 0 else 'SMSG'} 0x{opcode:04X} {name_at(name_offset)}".rstrip())
+        print_fields(first, count, "", 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile KX schema catalogues.")
+    parser.add_argument("inputs", nargs="*", help="JSON catalogues and/or Markdown schema dumps")
+    parser.add_argument("-o", "--output", default="kx_schema.bin", help="output catalogue path")
+    parser.add_argument("--dump", metavar="BIN", help="print an existing catalogue and exit")
+    args = parser.parse_args()
+
+    try:
+        if args.dump:
+            dump(args.dump)
+            return 0
+        if not args.inputs:
+            parser.error("no inputs given")
+
+        messages = {}
+        for path in args.inputs:
+            if path.lower().endswith(".md"):
+                load_markdown(path, messages)
+            else:
+                load_json(path, messages)
+
+        data = build_catalog(messages)
+        # Write to a temporary file first so the inspector never loads a partial catalogue.
+        temp_path = args.output + ".tmp"
+        with open(temp_path, "wb") as f:
+            f.write(data)
+        os.replace(temp_path, args.output)
+        print(f"Wrote {HEADER.unpack_from(data, 0)[3]} messages ({len(data)} bytes) to {args.output}")
+        return 0
+    except (SchemaError, KeyError, OSError, json.JSONDecodeError) as e:
+        print(f"ERROR: {e}", file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
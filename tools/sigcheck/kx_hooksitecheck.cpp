@@ -0,0 +1,157 @@
+/**
+ * @file kx_hooksitecheck.cpp
+ * @brief Checks the dispatcher hook site verifier (HookSiteVerifier.h) on synthetic dispatchers.
+ * @details Builds a small function with the shape of Msg::DispatchStream: four
+ *          MOV RDX, [RBP-0x18] / CALL [RAX+0x18] pairs at +0x219, +0x228, +0x3D4 and +0x3E3,
+ *          reached only through jumps over undecodable bytes, plus decoys that must not count
+ *          as sites (LEA RDX, a 32-bit MOV EDX, and a MOV RDX with a NOP before its call).
+ *          Variants of it must be accepted with the same sites or rejected; each case
+ *          prints the verifier's result. The exit status is 0 if every case behaves as
+ *          expected, 1 otherwise.
+ *
+ *          Usage: kx_hooksitecheck
+ */
+
+#include "HookSiteVerifier.h"
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using kx::Hooking::DispatcherHookSites;
+
+    constexpr std::ptrdiff_t EXPECTED_SITES[] = { 0x219, 0x228, 0x3D4, 0x3E3 };
+    constexpr std::ptrdiff_t EXPECTED_STACK_OFFSET = -0x18;
+
+    // A function image; unwritten bytes are 0x06, which is undecodable in 64-bit mode.
+    struct SyntheticFunction {
+        std::vector<uint8_t> bytes = std::vector<uint8_t>(0x500, 0x06);
+
+        void Put(std::size_t offset, std::initializer_list<int> values) {
+            for (int value : values) {
+                bytes[offset++] = static_cast<uint8_t>(value);
+            }
+        }
+        void Nops(std::size_t from, std::size_t to) {
+            std::memset(bytes.data() + from, 0x90, to - from);
+        }
+        // JMP/CALL rel32 (opcode E9/E8) at `offset` to `target`.
+        void Rel32(std::size_t offset, uint8_t opcode, std::size_t target) {
+            bytes[offset] = opcode;
+            const int32_t displacement =
+                static_cast<int32_t>(static_cast<std::ptrdiff_t>(target) - static_cast<std::ptrdiff_t>(offset + 5));
+            std::memcpy(&bytes[offset + 1], &displacement, 4);
+        }
+    };
+
+    constexpr std::initializer_list<int> SITE = { 0x48, 0x8B, 0x55, 0xE8, 0xFF, 0x50, 0x18 }; // MOV RDX,[RBP-0x18]; CALL [RAX+0x18]
+
+    SyntheticFunction MakeDispatcher() {
+        SyntheticFunction f;
+        f.Put(0x000, { 0x74, 0x0E });                  // JZ +0x010
+        f.Rel32(0x002, 0xE9, 0x200);                   // JMP +0x200
+        f.Put(0x010, { 0x48, 0x8D, 0x55, 0xE0, 0xFF, 0xD0,  // Decoy: LEA RDX,[RBP-0x20]; CALL RAX
+                       0x8B, 0x55, 0xE8, 0xFF, 0xD0,        // Decoy: MOV EDX,[RBP-0x18]; CALL RAX
+                       0x48, 0x8B, 0x55, 0xE0, 0x90, 0xFF, 0xD0 }); // Decoy: MOV RDX,[RBP-0x20]; NOP; CALL RAX
+        f.Rel32(0x022, 0xE8, 0x4000);                  // CALL outside the function (no return)
+        f.Put(0x027, { 0xCC });
+        f.Put(0x200, { 0x75, 0x22 });                  // JNZ +0x224
+        f.Nops(0x202, 0x219);
+        f.Put(0x219, SITE);                            // Site 1
+        f.Put(0x220, { 0xEB, 0x7F });                  // JMP +0x2A1
+        f.Put(0x224, { 0x48, 0x89, 0xC1, 0x90 });      // MOV RCX,RAX; NOP
+        f.Put(0x228, SITE);                            // Site 2
+        f.Rel32(0x22F, 0xE9, 0x3C0);
+        f.Rel32(0x2A1, 0xE9, 0x3C0);
+        f.Put(0x3C0, { 0x0F, 0x84, 0x1A, 0x00, 0x00, 0x00 }); // JZ +0x3E0
+        f.Nops(0x3C6, 0x3D4);
+        f.Put(0x3D4, SITE);                            // Site 3
+        f.Rel32(0x3DB, 0xE9, 0x400);
+        f.Put(0x3E0, { 0x48, 0x89, 0xC1 });            // MOV RCX,RAX
+        f.Put(0x3E3, SITE);                            // Site 4
+        f.Put(0x3EA, { 0xC3 });
+        f.Put(0x400, { 0xC3 });
+        return f;
+    }
+
+    int g_failures = 0;
+
+    // A rejected case must also report an error containing `reason`.
+    void Expect(const char* name, const SyntheticFunction& f, bool accepted, const char* reason = "") {
+        std::string error;
+        const std::optional<DispatcherHookSites> sites =
+            kx::Hooking::LocateDispatcherHookSites(f.bytes.data(), f.bytes.size(), &error);
+        bool ok = sites.has_value() == accepted;
+        if (sites) {
+            std::printf("%-34s sites +0x%tX +0x%tX +0x%tX +0x%tX, [RBP%+td], %zu instructions\n", name, sites->offsets[0],
+                        sites->offsets[1], sites->offsets[2], sites->offsets[3], sites->messageDataStackOffset,
+                        sites->instructionsDecoded);
+            for (std::size_t i = 0; i < kx::Hooking::DISPATCHER_HOOK_SITE_COUNT; ++i) {
+                ok &= sites->offsets[i] == EXPECTED_SITES[i];
+            }
+            ok &= sites->messageDataStackOffset == EXPECTED_STACK_OFFSET;
+        } else {
+            std::printf("%-34s rejected: %s\n", name, error.c_str());
+            ok &= !error.empty() && error.find(reason) != std::string::npos;
+        }
+        if (!ok) {
+            std::printf("  expected it to be %s\n", accepted ? "accepted with the sites above" : "rejected for another reason");
+            ++g_failures;
+        }
+    }
+
+} // namespace
+
+int main() {
+    SyntheticFunction f = MakeDispatcher();
+    Expect("dispatcher", f, true);
+
+    f = MakeDispatcher();
+    f.Put(0x3E3, { 0x48, 0x8B, 0x95, 0xE8, 0xFF, 0xFF, 0xFF, 0xFF, 0x50, 0x18, 0xC3 }); // disp32 form of the same MOV
+    Expect("site 4 with a 32-bit displacement", f, true);
+
+    f = MakeDispatcher();
+    f.Put(0x3C6, { 0x74, 0x0C }); // JZ to the first byte of site 3
+    Expect("branch to a site's first byte", f, true);
+
+    f = MakeDispatcher();
+    f.Put(0x01B, { 0x48, 0x8B, 0x55, 0xE8, 0xFF, 0xD0, 0x90 }); // Third decoy becomes MOV RDX,[RBP-0x18]; CALL RAX
+    Expect("fifth site", f, false, "found 5");
+
+    f = MakeDispatcher();
+    f.Put(0x3D7, { 0xE0 }); // Site 3 reads [RBP-0x20]
+    Expect("site reading another stack slot", f, false, "another stack slot");
+
+    f = MakeDispatcher();
+    f.Put(0x228, { 0x48, 0x89, 0xC1, 0x90 });
+    Expect("missing site", f, false, "found 3");
+
+    f = MakeDispatcher();
+    f.Put(0x3C6, { 0x74, 0x10 }); // JZ +0x3D8, inside the 5 bytes a hook at +0x3D4 overwrites
+    Expect("branch into a hook's patch bytes", f, false, "overwrites");
+
+    f = MakeDispatcher();
+    f.Put(0x3C6, { 0x74, 0x0F }); // JZ +0x3D7, into the middle of site 3's MOV
+    Expect("branch into an instruction", f, false, "inside the instruction");
+
+    f = MakeDispatcher();
+    f.Put(0x3C6, { 0x06 });
+    Expect("undecodable byte on a path", f, false, "undecodable instruction at +0x3C6");
+
+    f = MakeDispatcher();
+    f.bytes.resize(0x3E5);
+    Expect("window ending inside site 4", f, false, "+0x3E3");
+
+    std::string error;
+    const bool nullRejected = !kx::Hooking::LocateDispatcherHookSites(nullptr, 0, &error) && !error.empty();
+    std::printf("%-34s %s: %s\n", "no code", nullRejected ? "rejected" : "accepted", error.c_str());
+    g_failures += nullRejected ? 0 : 1;
+
+    std::printf("\n%d unexpected result(s)\n", g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
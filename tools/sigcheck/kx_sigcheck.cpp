@@ -0,0 +1,339 @@
+/**
+ * @file kx_sigcheck.cpp
+ * @brief Checks the game signatures of Config.h against a copy of Gw2-64.exe, without the game.
+ * @details Maps the file's sections to their RVAs the way the Windows loader does, then runs
+ *          the same scanner code as the DLL (PatternSet over the executable sections, chunked
+ *          on a thread pool) and prints, for every signature:
+ *            - its matches as RVAs and virtual addresses (exactly one is expected),
+ *            - its uniqueness: near matches with 1..k differing fixed bytes (FuzzySearch.h),
+ *              and the best approximate candidates when there is no exact match,
+ *            - the bytes at the match and, for the dispatcher, the mid-hook sites that
+ *              LocateDispatcherHookSites() (HookSiteVerifier.h) finds by disassembling it.
+ *          The exit status is 0 if every signature matched exactly once and the hook sites
+ *          are where MessageHandlerHook.h records them, 1 otherwise, 2 on a usage or file error.
+ *
+ *          Usage: kx_sigcheck <Gw2-64.exe> [--mismatches k] [--threads n] [--dump-dispatcher out.bin]
+ *                 kx_sigcheck --code dispatcher.bin
+ *          --code verifies raw dispatcher bytes (as written by --dump-dispatcher) without the
+ *          executable.
+ */
+
+#include "Config.h"
+#include "FuzzySearch.h"
+#include "HookSiteVerifier.h"
+#include "MessageHandlerHook.h"
+#include "PatternSearch.h"
+#include "PeImage.h"
+#include "SectionScan.h"
+#include "SignatureCache.h"
+#include "ThreadPool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using namespace kx::Scanning;
+
+    struct SignatureInfo {
+        const char* name;
+        BytePattern pattern;
+        bool isDispatcher; // Its match is the entry of the function holding the mid-hook sites
+    };
+
+    const std::vector<SignatureInfo>& GetSignatures() {
+        static const std::vector<SignatureInfo> signatures = {
+            { "MSG_CONN_FLUSH_PACKET_BUFFER_PATTERN", kx::MSG_CONN_FLUSH_PACKET_BUFFER_PATTERN.ToBytePattern(), false },
+            { "MSG_DISPATCH_STREAM_PATTERN", kx::MSG_DISPATCH_STREAM_PATTERN.ToBytePattern(), true },
+        };
+        return signatures;
+    }
+
+    // The sites as MessageHandlerHook.h records them.
+    constexpr ptrdiff_t KNOWN_SITE_OFFSETS[kx::Hooking::DISPATCHER_HOOK_SITE_COUNT] = {
+        DISPATCHER_HOOK_OFFSET_SITE_1, DISPATCHER_HOOK_OFFSET_SITE_2, DISPATCHER_HOOK_OFFSET_SITE_3, DISPATCHER_HOOK_OFFSET_SITE_4,
+    };
+
+    constexpr std::size_t DUMP_BYTES = 16;
+    constexpr std::size_t MAX_CANDIDATES_SHOWN = 5;
+
+    double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::string Hex(uint64_t value) {
+        char buffer[24];
+        std::snprintf(buffer, sizeof(buffer), "0x%llX", static_cast<unsigned long long>(value));
+        return buffer;
+    }
+
+    std::string HexBytes(const uint8_t* data, std::size_t count) {
+        std::string text;
+        char buffer[4];
+        for (std::size_t i = 0; i < count; ++i) {
+            std::snprintf(buffer, sizeof(buffer), i ? " %02X" : "%02X", data[i]);
+            text += buffer;
+        }
+        return text;
+    }
+
+    std::string SignedHex(int64_t value) {
+        char buffer[24];
+        std::snprintf(buffer, sizeof(buffer), "%c0x%llX", value < 0 ? '-' : '+',
+                      static_cast<unsigned long long>(value < 0 ? -value : value));
+        return buffer;
+    }
+
+    // Disassembles the dispatcher at `code` and prints its hook sites next to the recorded
+    // ones. Returns true if they are found and have not moved.
+    bool CheckDispatcherSites(const uint8_t* code, std::size_t size) {
+        std::string error;
+        const std::optional<kx::Hooking::DispatcherHookSites> sites = kx::Hooking::LocateDispatcherHookSites(code, size, &error);
+        if (!sites) {
+            std::cout << "  Hook sites: REJECTED, " << error << " (the DLL will not hook the dispatcher)\n";
+            return false;
+        }
+
+        bool unchanged = sites->messageDataStackOffset == STACK_OFFSET_MESSAGE_DATA_PTR;
+        std::cout << "  Hook sites: " << sites->offsets.size() << " found in " << sites->instructionsDecoded
+                  << " decoded instructions, message data at [RBP" << SignedHex(sites->messageDataStackOffset) << "]";
+        if (sites->messageDataStackOffset != STACK_OFFSET_MESSAGE_DATA_PTR) {
+            std::cout << ", MOVED from " << SignedHex(STACK_OFFSET_MESSAGE_DATA_PTR);
+        }
+        std::cout << "\n";
+        for (std::size_t i = 0; i < sites->offsets.size(); ++i) {
+            const std::size_t offset = static_cast<std::size_t>(sites->offsets[i]);
+            std::cout << "  DISPATCHER_HOOK_OFFSET_SITE_" << (i + 1) << " +" << Hex(offset) << "  "
+                      << HexBytes(code + offset, std::min(DUMP_BYTES, size - offset));
+            if (sites->offsets[i] != KNOWN_SITE_OFFSETS[i]) {
+                std::cout << "  MOVED from +" << Hex(static_cast<uint64_t>(KNOWN_SITE_OFFSETS[i]));
+                unchanged = false;
+            }
+            std::cout << "\n";
+        }
+        if (!unchanged) {
+            std::cout << "  The DLL uses the sites found; update MessageHandlerHook.h to match.\n";
+        }
+        return unchanged;
+    }
+
+    // A read-only memory mapping of a whole file.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() {
+            if (m_data) {
+                munmap(const_cast<uint8_t*>(m_data), m_size);
+            }
+        }
+
+        bool Open(const char* path, std::string& error) {
+            const int fd = open(path, O_RDONLY);
+            if (fd < 0) {
+                error = std::string("Could not open ") + path + ": " + std::strerror(errno);
+                return false;
+            }
+            struct stat info {};
+            if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+                error = std::string("Could not read the size of ") + path + ".";
+                close(fd);
+                return false;
+            }
+            void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (data == MAP_FAILED) {
+                error = std::string("Could not map ") + path + ": " + std::strerror(errno);
+                return false;
+            }
+            m_data = static_cast<const uint8_t*>(data);
+            m_size = static_cast<std::size_t>(info.st_size);
+            return true;
+        }
+
+        const uint8_t* GetData() const { return m_data; }
+        std::size_t GetSize() const { return m_size; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+    };
+
+    // Lays the file out as the loader maps it: headers at 0, each section's raw data at its
+    // RVA, zeros elsewhere. Raw data past the end of the file or image is dropped.
+    std::vector<uint8_t> MapSections(const uint8_t* file, std::size_t fileSize, const PeImage& fileImage) {
+        std::vector<uint8_t> mapped(fileImage.GetSizeOfImage(), 0);
+        std::memcpy(mapped.data(), file, std::min({ fileSize, mapped.size(), static_cast<std::size_t>(fileImage.GetSizeOfHeaders()) }));
+        for (const PeSection& section : fileImage.GetSections()) {
+            std::size_t size = section.virtualSize != 0 ? std::min(section.rawSize, section.virtualSize) : section.rawSize;
+            if (section.rawOffset >= fileSize || section.rva >= mapped.size()) {
+                continue;
+            }
+            size = std::min({ size, fileSize - section.rawOffset, mapped.size() - section.rva });
+            std::memcpy(mapped.data() + section.rva, file + section.rawOffset, size);
+        }
+        return mapped;
+    }
+
+    void PrintUsage() {
+        std::cerr << "Usage: kx_sigcheck <Gw2-64.exe> [--mismatches k] [--threads n] [--dump-dispatcher out.bin]\n"
+                  << "       kx_sigcheck --code dispatcher.bin\n"
+                  << "  --mismatches k         Count near matches with up to k differing bytes (default "
+                  << kx::SIGNATURE_MAX_MISMATCHES << ", at most " << MAX_FUZZY_MISMATCHES << ")\n"
+                  << "  --threads n            Scanner worker threads besides the main thread (default: one per core)\n"
+                  << "  --dump-dispatcher file Write the " << Hex(kx::Hooking::DISPATCHER_MAX_SIZE) << " bytes at the dispatcher match to file\n"
+                  << "  --code file            Check the hook sites in raw dispatcher bytes (e.g. a dump) instead" << std::endl;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    const char* codePath = nullptr;
+    const char* dumpPath = nullptr;
+    std::size_t maxMismatches = kx::SIGNATURE_MAX_MISMATCHES;
+    std::size_t threadCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if ((arg == "--mismatches" || arg == "--threads") && i + 1 < argc) {
+            (arg == "--mismatches" ? maxMismatches : threadCount) = std::strtoul(argv[++i], nullptr, 10);
+        } else if ((arg == "--code" || arg == "--dump-dispatcher") && i + 1 < argc) {
+            (arg == "--code" ? codePath : dumpPath) = argv[++i];
+        } else if (!path && !arg.starts_with("-")) {
+            path = argv[i];
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (!path == !codePath) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::string error;
+    MappedFile file;
+    if (!file.Open(path ? path : codePath, error)) {
+        std::cerr << "[SigCheck] " << error << std::endl;
+        return 2;
+    }
+
+    if (codePath) {
+        std::cout << codePath << ": " << file.GetSize() << " bytes of dispatcher code\n";
+        const bool unchanged = CheckDispatcherSites(file.GetData(), std::min(file.GetSize(), kx::Hooking::DISPATCHER_MAX_SIZE));
+        std::cout << (unchanged ? "The hook sites check out." : "The hook sites need attention.") << std::endl;
+        return unchanged ? 0 : 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const std::optional<PeImage> fileImage = PeImage::Parse(file.GetData(), file.GetSize(), PeLayout::File, &error);
+    if (!fileImage) {
+        std::cerr << "[SigCheck] " << path << " is not a PE image: " << error << std::endl;
+        return 2;
+    }
+    const std::vector<uint8_t> module = MapSections(file.GetData(), file.GetSize(), *fileImage);
+    const std::optional<PeImage> image = PeImage::Parse(module.data(), module.size(), PeLayout::Mapped, &error);
+    if (!image) {
+        std::cerr << "[SigCheck] Could not parse the mapped image: " << error << std::endl;
+        return 2;
+    }
+    const double mapMs = MillisecondsSince(start);
+
+    std::size_t codeBytes = 0;
+    for (const PeRange& range : image->GetRanges(ScanTarget::Code)) {
+        codeBytes += range.size;
+    }
+    std::cout << path << ": " << (image->Is64Bit() ? "PE32+" : "PE32") << ", machine " << Hex(image->GetMachine())
+              << ", timestamp " << Hex(image->GetTimestamp()) << ", image base " << Hex(image->GetImageBase())
+              << ", SizeOfImage " << Hex(image->GetSizeOfImage()) << "\n"
+              << "Build key " << Hex(SignatureCache::ComputeBuildKey(module.data(), *image))
+              << " (matches the key in " << kx::SIGNATURE_CACHE_FILENAME << " once the DLL has scanned this build)\n";
+    std::cout << "Sections:";
+    for (const PeSection& section : image->GetSections()) {
+        std::cout << " " << section.name << (section.IsExecutable() ? "[code]" : "");
+    }
+    std::cout << "\n";
+
+    kx::Threading::ThreadPool pool(threadCount);
+    PatternSet patternSet;
+    for (const SignatureInfo& signature : GetSignatures()) {
+        patternSet.Add(signature.pattern);
+    }
+
+    // The DLL's startup scan: all signatures in one pass over the code sections.
+    start = std::chrono::steady_clock::now();
+    const std::vector<std::vector<uint32_t>> matches = FindInSections(module.data(), *image, ScanTarget::Code, patternSet, pool);
+    const double scanMs = MillisecondsSince(start);
+    std::printf("Mapped in %.1f ms; scanned %.1f MB of code for %zu signatures in %.1f ms (%zu threads)\n\n",
+                mapMs, static_cast<double>(codeBytes) / (1024.0 * 1024.0), patternSet.Size(), scanMs, pool.GetThreadCount() + 1);
+
+    bool allGood = true;
+    for (std::size_t i = 0; i < GetSignatures().size(); ++i) {
+        const SignatureInfo& signature = GetSignatures()[i];
+        const BytePattern& pattern = signature.pattern;
+        const std::vector<uint32_t>& rvas = matches[i];
+        const bool unique = rvas.size() == 1;
+        allGood &= unique;
+        std::cout << signature.name << ": " << (unique ? "OK" : rvas.empty() ? "NOT FOUND" : "AMBIGUOUS")
+                  << ", " << rvas.size() << " exact match(es)\n";
+        for (const uint32_t rva : rvas) {
+            std::cout << "  RVA " << Hex(rva) << "  VA " << Hex(image->GetImageBase() + rva)
+                      << "  " << HexBytes(module.data() + rva, std::min(DUMP_BYTES, module.size() - rva)) << "\n";
+        }
+
+        start = std::chrono::steady_clock::now();
+        std::vector<ApproximateMatch> candidates = FindApproximateInSections(module.data(), *image, ScanTarget::Code, pattern, maxMismatches, pool);
+        const SignatureUniqueness uniqueness = MeasureUniqueness(pattern, maxMismatches, candidates);
+        std::printf("  Uniqueness: %zu fixed bytes; near matches", uniqueness.fixedBytes);
+        for (std::size_t distance = 1; distance <= uniqueness.maxMismatches; ++distance) {
+            std::printf(" %zu at %zu%s", uniqueness.matchesAtDistance[distance], distance, distance < uniqueness.maxMismatches ? "," : "");
+        }
+        std::printf(" (%.1f ms)\n", MillisecondsSince(start));
+        if (rvas.empty()) {
+            RankApproximateMatches(candidates, std::nullopt);
+            for (std::size_t c = 0; c < std::min(candidates.size(), MAX_CANDIDATES_SHOWN); ++c) {
+                std::cout << "  Candidate RVA " << Hex(candidates[c].offset) << " with " << candidates[c].mismatches
+                          << " differing byte(s): " << HexBytes(module.data() + candidates[c].offset, pattern.Size()) << "\n";
+            }
+        }
+
+        if (signature.isDispatcher) {
+            for (const uint32_t rva : rvas) {
+                const std::size_t size = std::min(kx::Hooking::DISPATCHER_MAX_SIZE, module.size() - rva);
+                allGood &= CheckDispatcherSites(module.data() + rva, size);
+            }
+            if (dumpPath && unique) {
+                const std::size_t size = std::min(kx::Hooking::DISPATCHER_MAX_SIZE, module.size() - rvas[0]);
+                FILE* out = std::fopen(dumpPath, "wb");
+                if (!out || std::fwrite(module.data() + rvas[0], 1, size, out) != size) {
+                    std::cerr << "[SigCheck] Could not write " << dumpPath << std::endl;
+                    allGood = false;
+                } else {
+                    std::cout << "  Wrote " << size << " dispatcher bytes to " << dumpPath << "\n";
+                }
+                if (out) {
+                    std::fclose(out);
+                }
+            }
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << (allGood ? "All signatures and hook sites check out." : "Some signatures or hook sites need attention.") << std::endl;
+    return allGood ? 0 : 1;
+}